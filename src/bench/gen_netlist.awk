@@ -0,0 +1,173 @@
+#
+# gen_netlist.awk --- synthetic gate-level netlist for benchmarking
+#
+# Usage:  awk -f gen_netlist.awk -v n=<instances> [-v <var>=<value> ...]
+#
+# Writes a flat structural verilog netlist to stdout, using cells common
+# to the OSU standard cell libraries (tech/osu018, tech/gscl45nm, ...).
+# Variables:
+#
+#	n	total number of instances (default 10000)
+#	depth	logic levels between registers (default 20)
+#	regs	fraction of instances that are flops (default 0.1)
+#	fanout	fanout skew;  1 gives a near-Poisson fanout, larger
+#		values a long tail of high fanout nets (default 2)
+#	reconv	probability that a gate input reconverges with a
+#		signal already in the cone of its first input (default 0.3)
+#	seed	random seed (default 1)
+#	name	module name (default "bench")
+#	rc	if set, also write a qrouter-style .rc file of synthetic
+#		wiring parasitics (for rc2dly and vesta -d) to this file
+#
+# Combinational gates are spread evenly over "depth" levels.  The first
+# input of each gate comes from the level above it, so every level is
+# reached;  flop D inputs and the outputs come from the last level.  The
+# clock is distributed by a tree of CLKBUF1 cells with fanout 16.
+#
+
+function pick(count) {
+    return int(count * (rand() ^ fanout)) + 1
+}
+
+function connect(net, inst, pin) {
+    if (rc != "") {
+	if (net in rcv) rcv[net] = rcv[net] " " inst "/" pin
+	else rcv[net] = inst "/" pin
+    }
+    return "." pin "(" net ")"
+}
+
+function rcvalue(lo, hi) {
+    return sprintf("%.4g", lo + (hi - lo) * rand())
+}
+
+BEGIN {
+    if (n == "") n = 10000
+    if (depth == "") depth = 20
+    if (regs == "") regs = 0.1
+    if (fanout == "") fanout = 2
+    if (reconv == "") reconv = 0.3
+    if (seed == "") seed = 1
+    if (name == "") name = "bench"
+    srand(seed)
+
+    split("INVX1 BUFX2 NAND2X1 NOR2X1 NAND2X1 NOR2X1 AOI21X1 OAI21X1 NAND3X1 XOR2X1",
+		cells, " ")
+    split("1 1 2 2 2 2 3 3 3 2", numin, " ")
+    split("A B C", pins, " ")
+    numcells = 10
+
+    nf = int(n * regs)
+    ni = int(n / 500); if (ni < 4) ni = 4
+    no = ni
+
+    # Clock tree:  nb[t] buffers at tree level t, level 1 drives flops
+    nt = 0
+    nck = 0
+    for (count = nf; count > 1; ) {
+	count = int((count + 15) / 16)
+	nb[++nt] = count
+	nck += count
+    }
+    ng = n - nf - nck
+    if (ng < 1) {
+	print "gen_netlist:  too few instances for the flops and clock tree" > "/dev/stderr"
+	exit 1
+    }
+    if (depth > ng) depth = ng
+
+    # Module header and declarations
+
+    printf "module %s (clk, in, out);\n", name
+    printf "input clk;\n"
+    printf "input [%d:0] in;\n", ni - 1
+    printf "output [%d:0] out;\n", no - 1
+    for (i = 1; i <= ng; i++) printf "wire n%d;\n", i
+    for (i = 1; i <= nf; i++) printf "wire q%d;\n", i
+    for (t = 1; t <= nt; t++)
+	for (j = 1; j <= nb[t]; j++) printf "wire ck%d_%d;\n", t, j
+
+    # Clock tree
+
+    for (t = nt; t >= 1; t--) {
+	for (j = 1; j <= nb[t]; j++) {
+	    src = (t == nt) ? "clk" : sprintf("ck%d_%d", t + 1, int((j - 1) / 16) + 1)
+	    inst = sprintf("cb%d_%d", t, j)
+	    printf "CLKBUF1 %s (%s, .Y(ck%d_%d));\n", inst, connect(src, inst, "A"), t, j
+	}
+    }
+
+    # Level 0 is the inputs and flop outputs
+
+    for (i = 0; i < ni; i++) lev[0, ++cnt[0]] = "in[" i "]"
+    for (i = 1; i <= nf; i++) lev[0, ++cnt[0]] = "q" i
+
+    # Combinational logic
+
+    g = 0
+    for (l = 1; l <= depth; l++) {
+	last = int((ng * l) / depth)
+	while (g < last) {
+	    g++
+	    c = int(rand() * numcells) + 1
+	    inst = "g" g
+	    out = "n" g
+	    first = lev[l - 1, pick(cnt[l - 1])]
+	    line = connect(first, inst, "A")
+	    for (p = 2; p <= numin[c]; p++) {
+		src = ""
+		if (rand() < reconv) {
+		    # Reconverge:  an ancestor of the first input
+		    src = first
+		    for (k = 1 + int(rand() * 3); (k > 0) && (src in par); k--)
+			src = par[src]
+		    if (src == first) src = ""
+		}
+		if (src == "") {
+		    k = int(rand() * l)
+		    src = lev[k, pick(cnt[k])]
+		}
+		line = line ", " connect(src, inst, pins[p])
+	    }
+	    printf "%s %s (%s, .Y(%s));\n", cells[c], inst, line, out
+	    par[out] = first
+	    lev[l, ++cnt[l]] = out
+	}
+    }
+
+    # Flops and outputs
+
+    for (i = 1; i <= nf; i++) {
+	inst = "f" i
+	ck = sprintf("ck1_%d", int((i - 1) / 16) + 1)
+	printf "DFFPOSX1 %s (%s, %s, .Q(q%d));\n", inst, connect(ck, inst, "CLK"),
+		connect(lev[depth, pick(cnt[depth])], inst, "D"), i
+    }
+    for (i = 0; i < no; i++) {
+	src = lev[depth, pick(cnt[depth])]
+	inst = "out" i
+	printf "BUFX2 %s (%s, .Y(out[%d]));\n", inst, connect(src, inst, "A"), i
+	if (rc != "") rcv["out[" i "]"] = "PIN/out[" i "]"
+    }
+    printf "endmodule\n"
+
+    # Wiring parasitics:  a star from the driver to each receiver
+
+    if (rc == "") exit 0
+    drv["clk"] = "PIN/clk"
+    for (i = 0; i < ni; i++) drv["in[" i "]"] = "PIN/in[" i "]"
+    for (i = 1; i <= ng; i++) drv["n" i] = "g" i "/Y"
+    for (i = 1; i <= nf; i++) drv["q" i] = "f" i "/Q"
+    for (i = 0; i < no; i++) drv["out[" i "]"] = "out" i "/Y"
+    for (t = 1; t <= nt; t++)
+	for (j = 1; j <= nb[t]; j++) drv["ck" t "_" j] = "cb" t "_" j "/Y"
+    for (net in rcv) {
+	k = split(rcv[net], recv, " ")
+	line = "( " rcvalue(0.5, 10) " " rcvalue(0.0001, 0.002)
+	for (p = 1; p <= k; p++)
+	    line = line ((p > 1) ? " , " : " ") "( " rcvalue(1, 40) " " \
+			rcvalue(0.0005, 0.005) " " recv[p] " )"
+	printf "%s 1 %s %d %s )\n", net, drv[net], k, line > rc
+    }
+    close(rc)
+}
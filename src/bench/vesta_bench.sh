@@ -0,0 +1,145 @@
+#!/bin/sh
+#
+# vesta_bench.sh --- scaling benchmark of vesta and the netlist tools
+#
+# Usage:  vesta_bench.sh [options] <bindir> <techdir>
+#
+#	-s "<sizes>"	netlist sizes in instances
+#			(default "10000 100000 500000 2000000")
+#	-t "<techs>"	technologies under <techdir> (default "osu018 gscl45nm")
+#	-g "<vars>"	netlist generator settings, as "var=value ..."
+#			(see gen_netlist.awk)
+#	-v "<options>"	vesta options (default "-g")
+#	-T <seconds>	time limit of each run (default 1800)
+#	-o <file>	results file (default bench.out)
+#	-b <file>	baseline results to compare against
+#
+# For each technology and size, generates a synthetic netlist with
+# gen_netlist.awk, then runs vesta (without and with wiring parasitics
+# from a .rc file), vlogFanout, vlog2Def, vlog2Cel, DEF2Verilog and
+# rc2dly on it under benchrun.  The results file has one line per run:
+#
+#	<tech> <size> <tool> <wall_s> <cpu_s> <peak_rss_kB> <exit_status>
+#
+# With -b, the elapsed time and peak memory of each run are also shown
+# relative to the same run in the baseline file.  A run stopped at the
+# time limit has exit status 124.
+#
+
+sizes="10000 100000 500000 2000000"
+techs="osu018 gscl45nm"
+genvars=""
+vestaopts="-g"
+limit=1800
+out=bench.out
+base=""
+
+while getopts s:t:g:v:T:o:b: opt ; do
+    case $opt in
+	s) sizes=$OPTARG ;;
+	t) techs=$OPTARG ;;
+	g) genvars=$OPTARG ;;
+	v) vestaopts=$OPTARG ;;
+	T) limit=$OPTARG ;;
+	o) out=$OPTARG ;;
+	b) base=$OPTARG ;;
+	*) exit 1 ;;
+    esac
+done
+shift `expr $OPTIND - 1`
+if [ $# -ne 2 ] ; then
+    echo "Usage:  vesta_bench.sh [options] <bindir> <techdir>" 1>&2
+    exit 1
+fi
+
+bin=$1
+tech=$2
+dir=`dirname $0`
+tmp=${TMPDIR:-/tmp}/vesta_bench.$$
+status=0
+
+trap "rm -rf $tmp" 0
+mkdir -p $tmp || exit 1
+
+# Generator variables as awk options
+gen=""
+for var in $genvars ; do
+    gen="$gen -v $var"
+done
+
+{
+    echo "# vesta_bench.sh `date '+%Y-%m-%d %H:%M'` on `uname -n` (`uname -m`)"
+    echo "# generator: ${genvars:-defaults}"
+    echo "# vesta options: $vestaopts"
+    echo "# tech size tool wall_s cpu_s peak_rss_kB exit_status"
+} > $out
+
+# run <label> <command> [<args>]:  time one tool and record the result
+
+run() {
+    label=$1
+    shift
+    $bin/benchrun -o $tmp/run -t $limit "$t $size $label" "$@"
+    result=$?
+    # vlogFanout returns the number of gates changed
+    if [ $result -eq 124 ] ; then
+	echo "$t $size $label:  stopped at the time limit of $limit s" 1>&2
+    elif [ $result -ne 0 ] && { [ $label != vlogFanout ] || [ $result -ge 126 ]; } ; then
+	echo "$t $size $label:  failed with exit status $result" 1>&2
+	status=1
+    fi
+}
+
+for t in $techs ; do
+    lib=`ls $tech/$t/*.lib 2>/dev/null | head -1`
+    lef=`ls $tech/$t/*.lef 2>/dev/null | head -1`
+    if [ -z "$lib" ] || [ -z "$lef" ] ; then
+	echo "No liberty or LEF file for technology $t in $tech" 1>&2
+	status=1
+	continue
+    fi
+    for size in $sizes ; do
+	echo "Benchmark $t $size"
+	rm -f $tmp/run $tmp/b.*
+	awk -f $dir/gen_netlist.awk -v n=$size -v rc=$tmp/b.rc $gen > $tmp/b.v || exit 1
+
+	run vesta $bin/vesta $vestaopts $tmp/b.v $lib
+	run vesta-rc $bin/vesta $vestaopts -d $tmp/b.rc $tmp/b.v $lib
+	run vlogFanout $bin/vlogFanout -l 300 -p $lib -b BUFX2 -i A -o Y \
+		$tmp/b.v $tmp/b.sized.v
+	run vlog2Def $bin/vlog2Def -l $lef -o $tmp/b.def $tmp/b.v
+	run vlog2Cel $bin/vlog2Cel -l $lef -o $tmp/b.cel $tmp/b.v
+	run DEF2Verilog $bin/DEF2Verilog -v $tmp/b.v -l $lef -o $tmp/b.anno.v $tmp/b.def
+	run rc2dly $bin/rc2dly -r $tmp/b.rc -l $lib -V $tmp/b.v -d $tmp/b.spef
+	cat $tmp/run >> $out
+    done
+done
+
+# Print the results, relative to the baseline if there is one
+
+awk -v base="$base" '
+    BEGIN {
+	if (base != "")
+	    while ((getline line < base) > 0) {
+		if (line ~ /^#/) continue
+		split(line, f, " ")
+		bwall[f[1] " " f[2] " " f[3]] = f[4]
+		brss[f[1] " " f[2] " " f[3]] = f[6]
+	    }
+	printf "\n%-10s %8s %-12s %10s %10s %11s", "Tech", "Size", "Tool",
+		"Wall (s)", "CPU (s)", "Peak (MB)"
+	if (base != "") printf " %8s %8s", "Wall", "Peak"
+	printf "\n"
+    }
+    /^#/ { next }
+    {
+	key = $1 " " $2 " " $3
+	printf "%-10s %8s %-12s %10.3f %10.3f %11.1f", $1, $2, $3, $4, $5, $6 / 1024
+	if ((base != "") && (key in bwall) && (bwall[key] > 0) && (brss[key] > 0))
+	    printf " %7.2fx %7.2fx", $4 / bwall[key], $6 / brss[key]
+	if ($7 == 124) printf "  (time limit)"
+	else if (($7 != 0) && ($3 != "vlogFanout")) printf "  (exit status %d)", $7
+	printf "\n"
+    }' $out
+
+exit $status
@@ -0,0 +1,134 @@
+/*----------------------------------------------------------------------*/
+/* benchrun.c ---							*/
+/*									*/
+/*	Run a command and report the resources it used, for the		*/
+/*	benchmark suite (see bench/vesta_bench.sh).  One line is	*/
+/*	written to stderr (or appended to <file> with -o):		*/
+/*									*/
+/*	    <label> <wall_s> <cpu_s> <peak_rss_kB> <exit_status>	*/
+/*									*/
+/*	The command's own output is discarded unless -k is given.	*/
+/*	With -t, the command is killed after <seconds>, and the exit	*/
+/*	status is reported as 124.					*/
+/*									*/
+/*	Usage:  benchrun [-k] [-o <file>] [-t <seconds>] <label>	*/
+/*			<command> [<args>]				*/
+/*									*/
+/*	This program is not installed.  Build with "make benchrun".	*/
+/*----------------------------------------------------------------------*/
+/*	Released under GPL as part of the qflow package			*/
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define TIMEOUT_STATUS	124
+
+pid_t child;
+volatile sig_atomic_t timedout = 0;
+
+/*----------------------------------------------------------------------*/
+/* Kill the command when its time limit (option -t) runs out		*/
+/*----------------------------------------------------------------------*/
+
+void timeout(int sig)
+{
+    timedout = 1;
+    kill(child, SIGKILL);
+}
+
+/*----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    struct timespec start, end;
+    struct rusage usage;
+    FILE *fout = stderr;
+    char *label;
+    double wall, cpu;
+    long maxrss;
+    int keep = 0, limit = 0, status, fd, i;
+
+    for (i = 1; (i < argc) && (argv[i][0] == '-'); i++) {
+	if (!strcmp(argv[i], "-k"))
+	    keep = 1;
+	else if (!strcmp(argv[i], "-t") && (i + 1 < argc))
+	    limit = atoi(argv[++i]);
+	else if (!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+	    fout = fopen(argv[++i], "a");
+	    if (fout == NULL) {
+		fprintf(stderr, "benchrun:  Cannot open %s for writing\n", argv[i]);
+		return 1;
+	    }
+	}
+	else
+	    break;
+    }
+    if (argc - i < 2) {
+	fprintf(stderr, "Usage:  benchrun [-k] [-o <file>] [-t <seconds>] <label>"
+		" <command> [<args>]\n");
+	return 1;
+    }
+    label = argv[i++];
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    child = fork();
+    if (child < 0) {
+	fprintf(stderr, "benchrun:  Cannot fork\n");
+	return 1;
+    }
+    if (child == 0) {
+	if (!keep) {
+	    fd = open("/dev/null", O_WRONLY);
+	    if (fd >= 0) {
+		dup2(fd, 1);
+		dup2(fd, 2);
+		close(fd);
+	    }
+	}
+	execvp(argv[i], argv + i);
+	_exit(127);
+    }
+    if (limit > 0) {
+	signal(SIGALRM, timeout);
+	alarm(limit);
+    }
+    while (wait4(child, &status, 0, &usage) < 0) {
+	if (errno == EINTR) continue;
+	fprintf(stderr, "benchrun:  Lost command %s\n", argv[i]);
+	return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    wall = (double)(end.tv_sec - start.tv_sec) +
+		1.0e-9 * (double)(end.tv_nsec - start.tv_nsec);
+    cpu = (double)usage.ru_utime.tv_sec + 1.0e-6 * (double)usage.ru_utime.tv_usec
+		+ (double)usage.ru_stime.tv_sec + 1.0e-6 * (double)usage.ru_stime.tv_usec;
+#ifdef __APPLE__
+    maxrss = usage.ru_maxrss / 1024;	/* bytes */
+#else
+    maxrss = usage.ru_maxrss;		/* kB */
+#endif
+
+    if (timedout)
+	status = TIMEOUT_STATUS;
+    else if (WIFEXITED(status))
+	status = WEXITSTATUS(status);
+    else
+	status = 128 + WTERMSIG(status);
+
+    fprintf(fout, "%s %.3f %.3f %ld %d\n", label, wall, cpu, maxrss, status);
+    if (fout != stderr) fclose(fout);
+
+    return status;
+}
@@ -0,0 +1,29 @@
+module skew (clk, in, out);
+input clk;
+input in;
+output out;
+wire c1;
+wire c2;
+wire qa;
+wire qb;
+wire qd;
+wire na;
+wire nb;
+wire nb1;
+wire d;
+wire o1;
+wire ni;
+CLKBUF1 cb0 (.A(clk), .Y(c1));
+CLKBUF1 cb1 (.A(c1), .Y(c2));
+DFFPOSX1 ffa (.CLK(c2), .D(qd), .Q(qa));
+DFFPOSX1 ffb (.CLK(clk), .D(qa), .Q(qb));
+INVX1 ia (.A(qa), .Y(na));
+BUFX2 bb (.A(qb), .Y(nb1));
+INVX1 ib (.A(nb1), .Y(nb));
+NAND2X1 g (.A(na), .B(nb), .Y(d));
+DFFPOSX1 ffc (.CLK(clk), .D(d), .Q(qd));
+NAND2X1 go (.A(na), .B(nb), .Y(o1));
+BUFX2 ob (.A(o1), .Y(out));
+INVX1 ii (.A(in), .Y(ni));
+DFFPOSX1 ffd (.CLK(c1), .D(ni), .Q());
+endmodule
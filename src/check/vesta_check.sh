@@ -0,0 +1,150 @@
+#!/bin/sh
+#
+# vesta_check.sh --- regression check of the vesta timing engines
+#
+# Usage:  vesta_check.sh <vesta> <liberty>
+#
+# Runs vesta on skew.v (a netlist with clock skew between the launching
+# flops) with the exhaustive path search (-e) and with the levelized
+# engines (-g and -M), and checks that the levelized engines never
+# report a path to an endpoint that is less critical than the one
+# reported by the exhaustive search, which allows for the transition
+# time of every path.  The levelized engines include the launch clock
+# arrival when choosing the worst path into a register, so in skew.v
+# they must also find the paths from ffa (late clock) for setup and
+# from ffb (early clock) for hold into ffc.  Finally, -M must report
+# the same paths as -g.
+#
+# Also checks that the threaded search (-j) reports the same paths as
+# the unthreaded one.
+#
+# Also runs every engine on a chain of 200000 inverters between two
+# flops, to check that no traversal of the path runs out of stack.
+#
+
+vesta=$1
+lib=$2
+dir=`dirname $0`
+tmp=${TMPDIR:-/tmp}/vesta_check.$$
+status=0
+
+trap "rm -f $tmp.*" 0
+
+# Reduce vesta output to lines of "section kind endpoint start delay"
+
+paths() {
+    $vesta "$@" -n 1000 -L $dir/skew.v $lib | awk '
+	/^Top .* maximum/ { sec++; kind = "max" }
+	/^Top .* minimum/ { sec++; kind = "min" }
+	/^Path / {
+	    end = $0; sub(/^Path .* to /, "", end); sub(/ delay .*/, "", end)
+	    for (i = 1; i < NF; i++) if ($i == "delay") d = $(i + 1)
+	    print sec, kind, end, $2, d
+	}'
+}
+
+paths -e > $tmp.ref || exit 1
+
+for opt in -g -M ; do
+    paths $opt > $tmp.out || exit 1
+    awk -v opt=$opt '
+	NR == FNR { ref[$1 " " $3] = $5; next }
+	{
+	    key = $1 " " $3
+	    if (!(key in ref)) next
+	    if ((($2 == "max") && ($5 < ref[key] - 0.01)) ||
+		    (($2 == "min") && ($5 > ref[key] + 0.01))) {
+		printf "vesta %s: %s delay %s to %s less critical than %s\n",
+			opt, $2, $5, $3, ref[key]
+		bad = 1
+	    }
+	    if ($3 == "ffc/D") {
+		want = ($2 == "max") ? "ffa/CLK" : "ffb/CLK"
+		if ($4 != want) {
+		    printf "vesta %s: %s path to ffc/D starts at %s, not %s\n",
+			    opt, $2, $4, want
+		    bad = 1
+		}
+	    }
+	}
+	END { exit bad }' $tmp.ref $tmp.out || status=1
+done
+
+# -M runs the -g analysis for maximum and minimum delay in one sweep,
+# so the two must report the same paths.
+
+paths -g > $tmp.g || exit 1
+paths -M > $tmp.M || exit 1
+if ! cmp -s $tmp.g $tmp.M ; then
+    echo "vesta -M: paths differ from vesta -g:"
+    diff $tmp.g $tmp.M
+    status=1
+fi
+
+# The threaded search keeps one path into each endpoint, as the
+# unthreaded search does, whatever the number of threads.  64 flops,
+# each followed by a chain of 500 inverters so that the threads share
+# out the start points, are reduced by a tree of gates to one flop.
+
+awk 'BEGIN {
+    n = 64
+    c = 500
+    print "module tree (clk, a, y);"
+    print "input clk, a;"
+    print "output y;"
+    for (i = 0; i < 2 * n; i++) print "wire w" i ";"
+    for (i = 0; i < n; i++)
+	for (k = 0; k < c; k++) print "wire v" i "_" k ";"
+    for (i = 0; i < n; i++) {
+	print "DFFPOSX1 f" i " (.CLK(clk), .D(a), .Q(v" i "_0));"
+	for (k = 1; k < c; k++)
+	    print "INVX1 h" i "_" k " (.A(v" i "_" k - 1 "), .Y(v" i "_" k "));"
+	print "BUFX2 b" i " (.A(v" i "_" c - 1 "), .Y(w" n + i "));"
+    }
+    for (i = n - 1; i > 0; i--)
+	print "NAND2X1 g" i " (.A(w" 2 * i "), .B(w" 2 * i + 1 "), .Y(w" i "));"
+    print "DFFPOSX1 r (.CLK(clk), .D(w1), .Q(y));"
+    print "endmodule"
+}' > $tmp.tree.v
+
+for opt in "" -e ; do
+    $vesta $opt -n 1000 -L $tmp.tree.v $lib > $tmp.1 2>&1 || exit 1
+    for j in 1 3 ; do
+	$vesta $opt -j $j -n 1000 -L $tmp.tree.v $lib > $tmp.j 2>&1 || exit 1
+	if ! cmp -s $tmp.1 $tmp.j ; then
+	    echo "vesta $opt -j $j: paths differ from the unthreaded search:"
+	    diff $tmp.1 $tmp.j
+	    status=1
+	fi
+    done
+done
+
+# A path of 200000 stages must be timed by every engine
+
+awk 'BEGIN {
+    n = 200000
+    print "module chain (clk, a, y);"
+    print "input clk, a;"
+    print "output y;"
+    for (i = 0; i <= n; i++) print "wire w" i ";"
+    print "DFFPOSX1 f0 (.CLK(clk), .D(a), .Q(w0));"
+    for (i = 1; i <= n; i++)
+	print "INVX1 g" i " (.A(w" i - 1 "), .Y(w" i "));"
+    print "DFFPOSX1 f1 (.CLK(clk), .D(w" n "), .Q(y));"
+    print "endmodule"
+}' > $tmp.v
+
+for opt in "" -g -M -R "-K 2" ; do
+    if ! $vesta $opt $tmp.v $lib > $tmp.out 2>&1 ; then
+	echo "vesta $opt: failed on a chain of 200000 stages"
+	status=1
+    elif ! grep -q "^Path f0/CLK to f1/D" $tmp.out ; then
+	echo "vesta $opt: no path f0/CLK to f1/D in a chain of 200000 stages"
+	status=1
+    fi
+done
+
+if [ $status = 0 ] ; then
+    echo "vesta_check: all checks passed"
+fi
+exit $status
@@ -0,0 +1,196 @@
+/*----------------------------------------------------------------------*/
+/* nldm.c --								*/
+/*									*/
+/*	Lookup table evaluation for nonlinear delay model (NLDM)	*/
+/*	tables as found in liberty format files.  Index entries are	*/
+/*	found by binary search, and values are interpolated linearly	*/
+/*	between the two bounding entries, or extrapolated from the	*/
+/*	two end entries.  Where two tables share the same index, as	*/
+/*	is the case for the rising and falling tables of a timing	*/
+/*	arc, both values are interpolated together (using SSE2	*/
+/*	where available).						*/
+/*									*/
+/*	Results are identical to the linear search and scalar	*/
+/*	interpolation used previously by vesta.			*/
+/*----------------------------------------------------------------------*/
+/*	Released under GPL as part of the qflow package			*/
+/*----------------------------------------------------------------------*/
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "nldm.h"
+
+/*----------------------------------------------------------------------*/
+/* Find the index entries bounding "x", or the two nearest entries if	*/
+/* extrapolating.  Return the index of the upper entry.			*/
+/*----------------------------------------------------------------------*/
+
+int nldm_bracket(double *idx, int size, double x)
+{
+    int base, half, n, hi;
+
+    if (x < idx[0])
+	hi = 1;
+    else if (x >= idx[size - 1])
+	hi = size - 1;
+    else {
+	/* Find the last entry not greater than x among entries	*/
+	/* 0 to size - 2.  The loop body compiles to a conditional	*/
+	/* move, avoiding mispredicted branches on small tables.	*/
+	base = 0;
+	n = size - 1;
+	while (n > 1) {
+	    half = n >> 1;
+	    base = (idx[base + half] <= x) ? base + half : base;
+	    n -= half;
+	}
+	hi = base + 1;
+    }
+    return hi;
+}
+
+/*----------------------------------------------------------------------*/
+/* Fractional position of "x" between idx[i - 1] and idx[i]		*/
+/*----------------------------------------------------------------------*/
+
+double nldm_fraction(double *idx, int i, double x)
+{
+    return (x - idx[i - 1]) / (idx[i] - idx[i - 1]);
+}
+
+/*----------------------------------------------------------------------*/
+/* Interpolate/extrapolate a value from a vector of values.		*/
+/*----------------------------------------------------------------------*/
+
+double nldm_vector(double *idx, int size, double *values, double x)
+{
+    int i;
+    double frac, vlow, vhigh;
+
+    i = nldm_bracket(idx, size, x);
+    frac = nldm_fraction(idx, i, x);
+
+    vlow = values[i - 1];
+    vhigh = values[i];
+    return vlow + (vhigh - vlow) * frac;
+}
+
+/*----------------------------------------------------------------------*/
+/* Interpolate/extrapolate values from two vectors with the same index.	*/
+/* The index search and fraction are shared, and the two values are	*/
+/* computed in one packed operation.  The arithmetic is the same as	*/
+/* nldm_vector(), so the results are identical.				*/
+/*----------------------------------------------------------------------*/
+
+void nldm_vector_pair(double *idx, int size, double *values1, double *values2,
+		double x, double *result1, double *result2)
+{
+    int i;
+    double frac;
+#ifdef __SSE2__
+    __m128d vlow, vhigh, value;
+    double packed[2];
+#else
+    double vlow, vhigh;
+#endif
+
+    i = nldm_bracket(idx, size, x);
+    frac = nldm_fraction(idx, i, x);
+
+#ifdef __SSE2__
+    vlow = _mm_set_pd(values2[i - 1], values1[i - 1]);
+    vhigh = _mm_set_pd(values2[i], values1[i]);
+    value = _mm_add_pd(vlow, _mm_mul_pd(_mm_sub_pd(vhigh, vlow), _mm_set1_pd(frac)));
+    _mm_storeu_pd(packed, value);
+    *result1 = packed[0];
+    *result2 = packed[1];
+#else
+    vlow = values1[i - 1];
+    vhigh = values1[i];
+    *result1 = vlow + (vhigh - vlow) * frac;
+    vlow = values2[i - 1];
+    vhigh = values2[i];
+    *result2 = vlow + (vhigh - vlow) * frac;
+#endif
+}
+
+/*----------------------------------------------------------------------*/
+/* Collapse a two-dimensional table to a vector at "x" in the second	*/
+/* index, by interpolating between the two bounding columns.		*/
+/*----------------------------------------------------------------------*/
+
+void nldm_collapse(double *idx2, int size1, int size2, double *values,
+		double x, double *vector)
+{
+    int i, j;
+    double frac, vlow, vhigh;
+
+    if (size2 <= 1) {
+	for (i = 0; i < size1; i++)
+	    vector[i] = values[i];
+	return;
+    }
+
+    j = nldm_bracket(idx2, size2, x);
+    frac = nldm_fraction(idx2, j, x);
+
+    for (i = 0; i < size1; i++) {
+	vlow = values[i * size2 + (j - 1)];
+	vhigh = values[i * size2 + j];
+	vector[i] = vlow + (vhigh - vlow) * frac;
+    }
+}
+
+/*----------------------------------------------------------------------*/
+/* Interpolate/extrapolate a value from a two-dimensional table.	*/
+/* Rows of "values" are taken to be "size1" entries apart, as vesta	*/
+/* has always done for setup and hold tables.				*/
+/*----------------------------------------------------------------------*/
+
+double nldm_binomial(double *idx1, int size1, double *idx2, int size2,
+		double *values, double x1, double x2)
+{
+    int i, j;
+    double frac1, frac2, vlow, vhigh, valuel, valueh;
+
+    i = nldm_bracket(idx1, size1, x1);
+    frac1 = nldm_fraction(idx1, i, x1);
+
+    if (size2 == 0) {
+	vlow = values[i - 1];
+	vhigh = values[i];
+	return vlow + (vhigh - vlow) * frac1;
+    }
+
+    j = nldm_bracket(idx2, size2, x2);
+    frac2 = nldm_fraction(idx2, j, x2);
+
+    /* Interpolate at the lower and upper bounds of x2, then between	*/
+    /* them.								*/
+
+    vlow = values[(i - 1) * size1 + (j - 1)];
+    vhigh = values[i * size1 + (j - 1)];
+    valuel = vlow + (vhigh - vlow) * frac1;
+
+    vlow = values[(i - 1) * size1 + j];
+    vhigh = values[i * size1 + j];
+    valueh = vlow + (vhigh - vlow) * frac1;
+
+    return valuel + (valueh - valuel) * frac2;
+}
+
+/*----------------------------------------------------------------------*/
+/* Return 1 if two index arrays are the same, 0 if not.			*/
+/*----------------------------------------------------------------------*/
+
+int nldm_same_index(double *idx1, int size1, double *idx2, int size2)
+{
+    if (size1 != size2) return 0;
+    if (idx1 == idx2) return 1;
+    if ((idx1 == NULL) || (idx2 == NULL)) return 0;
+    return (memcmp(idx1, idx2, size1 * sizeof(double)) == 0) ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+/*----------------------------------------------------------------------*/
+/* nldm.h -- Lookup table evaluation for nonlinear delay model tables	*/
+/*----------------------------------------------------------------------*/
+
+#ifndef _NLDM_H
+#define _NLDM_H
+
+/* Find the index "i" of the table entries bounding "x" such that	*/
+/* idx[i - 1] <= x < idx[i].  Values off either end of the table	*/
+/* return the two end entries (i = 1 or i = size - 1), so that the	*/
+/* value is extrapolated.  "idx" must be monotonically increasing.	*/
+
+extern int nldm_bracket(double *idx, int size, double x);
+
+/* Return the fraction of the distance of "x" between idx[i - 1] and	*/
+/* idx[i].								*/
+
+extern double nldm_fraction(double *idx, int i, double x);
+
+/* Interpolate or extrapolate a value from vector "values" indexed	*/
+/* by "idx".								*/
+
+extern double nldm_vector(double *idx, int size, double *values, double x);
+
+/* Same as nldm_vector(), for two vectors sharing the same index	*/
+/* (e.g., rising and falling delays of one timing arc).  The two	*/
+/* values are interpolated together.					*/
+
+extern void nldm_vector_pair(double *idx, int size, double *values1,
+		double *values2, double x, double *result1, double *result2);
+
+/* Collapse the "size1" x "size2" table "values" to the vector of	*/
+/* "size1" values at "x" in the second index "idx2", written into	*/
+/* "vector".  A table with "size2" of 0 or 1 is copied.			*/
+
+extern void nldm_collapse(double *idx2, int size1, int size2, double *values,
+		double x, double *vector);
+
+/* Interpolate or extrapolate a value from table "values" at "x1" in	*/
+/* index "idx1" and "x2" in index "idx2".  If "size2" is 0, the table	*/
+/* is one-dimensional.							*/
+
+extern double nldm_binomial(double *idx1, int size1, double *idx2, int size2,
+		double *values, double x1, double x2);
+
+/* Return non-zero if two index arrays have identical entries		*/
+
+extern int nldm_same_index(double *idx1, int size1, double *idx2, int size2);
+
+#endif /* _NLDM_H */
@@ -0,0 +1,336 @@
+/*----------------------------------------------------------------------*/
+/* nldm_bench.c ---							*/
+/*									*/
+/*	Micro-benchmark for the lookup table routines in nldm.c,	*/
+/*	comparing them against the linear search and scalar		*/
+/*	interpolation formerly used by vesta.  Results of each method	*/
+/*	are checked against the reference.				*/
+/*									*/
+/*	Usage:  nldm_bench [<evaluations> [<table_size>]]		*/
+/*									*/
+/*	This program is not installed.  Build with "make nldm_bench".	*/
+/*----------------------------------------------------------------------*/
+/*	Released under GPL as part of the qflow package			*/
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "nldm.h"
+
+#define NUMTABLES	64
+
+/*----------------------------------------------------------------------*/
+/* Reference version (linear search), as in vesta vector_get_value()	*/
+/*----------------------------------------------------------------------*/
+
+double ref_vector(double *idx, int size, double *vector, double trans)
+{
+    int i;
+    double tfrac, vlow, vhigh, value;
+
+    if (trans < idx[0])
+        i = 1;
+    else if (trans >= idx[size - 1])
+        i = size - 1;
+    else {
+        for (i = 0; i < size; i++)
+            if (idx[i] > trans)
+                break;
+    }
+
+    tfrac = (trans - idx[i - 1]) / (idx[i] - idx[i - 1]);
+
+    vlow = *(vector + (i - 1));
+    vhigh = *(vector + i);
+    value = vlow + (vhigh - vlow) * tfrac;
+    return value;
+}
+
+/*----------------------------------------------------------------------*/
+/* Reference version (linear search), as in vesta table_collapse()	*/
+/*----------------------------------------------------------------------*/
+
+void ref_collapse(double *caps, int size1, int size2, double *values,
+		double load, double *vector)
+{
+    double cfrac, vlow, vhigh;
+    int i, j;
+
+    if (size2 <= 1) {
+       for (i = 0; i < size1; i++) {
+          *(vector + i) = *(values + i);
+       }
+       return;
+    }
+
+    if (load < caps[0])
+        j = 1;
+    else if (load >= caps[size2 - 1])
+        j = size2 - 1;
+    else {
+        for (j = 0; j < size2; j++)
+            if (caps[j] > load)
+                break;
+    }
+
+    cfrac = (load - caps[j - 1]) / (caps[j] - caps[j - 1]);
+
+    for (i = 0; i < size1; i++) {
+        vlow = *(values + i * size2 + (j - 1));
+        vhigh = *(values + i * size2 + j);
+        *(vector + i) = vlow + (vhigh - vlow) * cfrac;
+    }
+}
+
+/*----------------------------------------------------------------------*/
+/* Reference version (linear search), as in vesta binomial_get_value()	*/
+/*----------------------------------------------------------------------*/
+
+double ref_binomial(double *rel, int size1, double *cons, int size2,
+		double *values, double rtrans, double ctrans)
+{
+    int i, j;
+    double rfrac, cfrac, vlow, vhigh, valuel, valueh;
+
+    if (rtrans < rel[0])
+        i = 1;
+    else if (rtrans >= rel[size1 - 1])
+        i = size1 - 1;
+    else {
+        for (i = 0; i < size1; i++)
+            if (rel[i] > rtrans)
+                break;
+    }
+    rfrac = (rtrans - rel[i - 1]) / (rel[i] - rel[i - 1]);
+
+    if (ctrans < cons[0])
+        j = 1;
+    else if (ctrans >= cons[size2 - 1])
+        j = size2 - 1;
+    else {
+        for (j = 0; j < size2; j++)
+            if (cons[j] > ctrans)
+                break;
+    }
+    cfrac = (ctrans - cons[j - 1]) / (cons[j] - cons[j - 1]);
+
+    vlow = *(values + (i - 1) * size1 + (j - 1));
+    vhigh = *(values + i * size1 + (j - 1));
+    valuel = vlow + (vhigh - vlow) * rfrac;
+
+    vlow = *(values + (i - 1) * size1 + j);
+    vhigh = *(values + i * size1 + j);
+    valueh = vlow + (vhigh - vlow) * rfrac;
+
+    return valuel + (valueh - valuel) * cfrac;
+}
+
+/*----------------------------------------------------------------------*/
+/* Elapsed time in seconds						*/
+/*----------------------------------------------------------------------*/
+
+double elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) +
+		1.0E-9 * (double)(now.tv_nsec - start->tv_nsec);
+}
+
+/*----------------------------------------------------------------------*/
+/* Main program								*/
+/*----------------------------------------------------------------------*/
+
+int
+main(int argc, char *argv[])
+{
+    int numevals = 10000000;
+    int size = 7;
+    int i, j, t, errors;
+    double *idx, *rise, *fall, *trans, *result1, *result2;
+    double *table, *vector, *refvector;
+    double x, sum, tref, tbin, tpair, tcref, tcbin, tbref, tbbin;
+    struct timespec start;
+
+    if (argc > 1) numevals = atoi(argv[1]);
+    if (argc > 2) size = atoi(argv[2]);
+    if ((numevals <= 0) || (size < 2)) {
+	fprintf(stderr, "Usage:  nldm_bench [<evaluations> [<table_size>]]\n");
+	exit(1);
+    }
+
+    /* Make a set of tables with increasing index values, similar	*/
+    /* to the transition time index of a liberty table.		*/
+
+    srand(1);
+    idx = (double *)malloc(NUMTABLES * size * sizeof(double));
+    rise = (double *)malloc(NUMTABLES * size * sizeof(double));
+    fall = (double *)malloc(NUMTABLES * size * sizeof(double));
+    for (t = 0; t < NUMTABLES; t++) {
+	x = 5.0 * (double)(rand() % 10);
+	for (i = 0; i < size; i++) {
+	    x += 10.0 + (double)(rand() % 200);
+	    idx[t * size + i] = x;
+	    rise[t * size + i] = 20.0 + x * 0.8 + (double)(rand() % 50);
+	    fall[t * size + i] = 15.0 + x * 0.6 + (double)(rand() % 50);
+	}
+    }
+
+    /* Query values, including some off each end of the tables */
+
+    trans = (double *)malloc(numevals * sizeof(double));
+    for (i = 0; i < numevals; i++)
+	trans[i] = (double)(rand() % (int)(1.2 * idx[size - 1])) - 10.0;
+
+    result1 = (double *)malloc(numevals * sizeof(double));
+    result2 = (double *)malloc(numevals * sizeof(double));
+
+    /* Two-dimensional tables (size x size), indexed by "idx" in both	*/
+    /* dimensions, for table_collapse() and binomial_get_value()	*/
+
+    table = (double *)malloc(NUMTABLES * size * size * sizeof(double));
+    for (t = 0; t < NUMTABLES; t++)
+	for (i = 0; i < size * size; i++)
+	    table[t * size * size + i] = 10.0 + (double)(rand() % 500);
+    vector = (double *)malloc(size * sizeof(double));
+    refvector = (double *)malloc(size * sizeof(double));
+
+    /* Reference:  linear search, rise and fall separately */
+
+    sum = 0.0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < numevals; i++) {
+	t = (i % NUMTABLES) * size;
+	x = ref_vector(idx + t, size, rise + t, trans[i]);
+	x += ref_vector(idx + t, size, fall + t, trans[i]);
+	sum += x;
+    }
+    tref = elapsed(&start);
+    for (i = 0; i < numevals; i++) {
+	t = (i % NUMTABLES) * size;
+	result1[i] = ref_vector(idx + t, size, rise + t, trans[i]);
+	result2[i] = ref_vector(idx + t, size, fall + t, trans[i]);
+    }
+
+    /* Binary search, rise and fall separately */
+
+    errors = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < numevals; i++) {
+	t = (i % NUMTABLES) * size;
+	x = nldm_vector(idx + t, size, rise + t, trans[i]);
+	x += nldm_vector(idx + t, size, fall + t, trans[i]);
+	sum += x;
+    }
+    tbin = elapsed(&start);
+    for (i = 0; i < numevals; i++) {
+	t = (i % NUMTABLES) * size;
+	if ((nldm_vector(idx + t, size, rise + t, trans[i]) != result1[i]) ||
+		(nldm_vector(idx + t, size, fall + t, trans[i]) != result2[i]))
+	    errors++;
+    }
+
+    /* Binary search, rise and fall together */
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < numevals; i++) {
+	t = (i % NUMTABLES) * size;
+	nldm_vector_pair(idx + t, size, rise + t, fall + t, trans[i], &x, &tpair);
+	sum += x + tpair;
+    }
+    tpair = elapsed(&start);
+    for (i = 0; i < numevals; i++) {
+	double r1, r2;
+	t = (i % NUMTABLES) * size;
+	nldm_vector_pair(idx + t, size, rise + t, fall + t, trans[i], &r1, &r2);
+	if ((r1 != result1[i]) || (r2 != result2[i])) errors++;
+    }
+
+    /* Table collapse to a vector at a load.  Each collapse does	*/
+    /* "size" interpolations, so there are fewer of them.		*/
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < numevals / size; i++) {
+	t = i % NUMTABLES;
+	ref_collapse(idx + t * size, size, size, table + t * size * size,
+			trans[i], vector);
+	sum += vector[0];
+    }
+    tcref = elapsed(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < numevals / size; i++) {
+	t = i % NUMTABLES;
+	nldm_collapse(idx + t * size, size, size, table + t * size * size,
+			trans[i], vector);
+	sum += vector[0];
+    }
+    tcbin = elapsed(&start);
+    for (i = 0; i < numevals / size; i++) {
+	t = i % NUMTABLES;
+	ref_collapse(idx + t * size, size, size, table + t * size * size,
+			trans[i], refvector);
+	nldm_collapse(idx + t * size, size, size, table + t * size * size,
+			trans[i], vector);
+	for (j = 0; j < size; j++)
+	    if (vector[j] != refvector[j]) break;
+	if (j < size) errors++;
+    }
+
+    /* Two-dimensional lookup (setup and hold tables) */
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < numevals; i++) {
+	t = i % NUMTABLES;
+	sum += ref_binomial(idx + t * size, size, idx + t * size, size,
+			table + t * size * size, trans[i], trans[numevals - 1 - i]);
+    }
+    tbref = elapsed(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < numevals; i++) {
+	t = i % NUMTABLES;
+	sum += nldm_binomial(idx + t * size, size, idx + t * size, size,
+			table + t * size * size, trans[i], trans[numevals - 1 - i]);
+    }
+    tbbin = elapsed(&start);
+    for (i = 0; i < numevals; i++) {
+	t = i % NUMTABLES;
+	if (nldm_binomial(idx + t * size, size, idx + t * size, size,
+			table + t * size * size, trans[i], trans[numevals - 1 - i]) !=
+			ref_binomial(idx + t * size, size, idx + t * size, size,
+			table + t * size * size, trans[i], trans[numevals - 1 - i]))
+	    errors++;
+    }
+
+    printf("Table size %d, %d rise/fall evaluations\n", size, numevals);
+#ifdef __SSE2__
+    printf("Paired interpolation uses SSE2\n");
+#endif
+    printf("  linear search (reference):  %8.2f ns/eval\n", 1.0E9 * tref / numevals);
+    printf("  binary search:              %8.2f ns/eval  (%.2fx)\n",
+		1.0E9 * tbin / numevals, tref / tbin);
+    printf("  binary search, paired:      %8.2f ns/eval  (%.2fx)\n",
+		1.0E9 * tpair / numevals, tref / tpair);
+    printf("  table collapse, reference:  %8.2f ns/table\n",
+		1.0E9 * tcref / (numevals / size));
+    printf("  table collapse:             %8.2f ns/table  (%.2fx)\n",
+		1.0E9 * tcbin / (numevals / size), tcref / tcbin);
+    printf("  2D lookup, reference:       %8.2f ns/eval\n", 1.0E9 * tbref / numevals);
+    printf("  2D lookup:                  %8.2f ns/eval  (%.2fx)\n",
+		1.0E9 * tbbin / numevals, tbref / tbbin);
+    printf("Mismatches against reference:  %d\n", errors);
+    if (sum == 0.0) printf("\n");	/* Keep the results live */
+
+    free(idx);
+    free(rise);
+    free(fall);
+    free(trans);
+    free(result1);
+    free(result2);
+    free(table);
+    free(vector);
+    free(refvector);
+    return (errors == 0) ? 0 : 1;
+}
@@ -728,7 +728,7 @@ int main (int argc, char* argv[]) {
 	fprintf(outfile, "*DELIMITER %c\n", delimiter);
 	fprintf(outfile, "*BUS_DELIMITER %s\n", "<>");
 	fprintf(outfile, "*T_UNIT 1 PS\n");
-	fprintf(outfile, "*C_UNIT 1 FF\n");
+	fprintf(outfile, "*C_UNIT 1 PF\n");
 	fprintf(outfile, "*R_UNIT 1 OHM\n");
 	fprintf(outfile, "*L_UNIT 1 HENRY\n");
 	fprintf(outfile, "\n");
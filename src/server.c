@@ -0,0 +1,170 @@
+/*----------------------------------------------------------------------*/
+/* server.c --								*/
+/*									*/
+/*	Unix-domain socket command server, used by vesta to keep a	*/
+/*	design loaded between timing queries.  One client is served	*/
+/*	at a time.  While a client is connected, its connection is	*/
+/*	both the command stream and the standard output and error of	*/
+/*	the process, so that reports go back to the client.  Worker	*/
+/*	processes of the partitioned path search talk to vesta over	*/
+/*	a socket pair in the same way.					*/
+/*----------------------------------------------------------------------*/
+/*	Released under GPL as part of the qflow package			*/
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "server.h"
+
+/*----------------------------------------------------------------------*/
+/* Remove a socket left at "path" (e.g., by a server that was killed).	*/
+/* Anything at "path" that is not a socket is left alone.  Return 0 if	*/
+/* "path" is now free, or -1 on error.					*/
+/*----------------------------------------------------------------------*/
+
+static int server_unlink(char *path)
+{
+    struct stat sbuf;
+
+    if (lstat(path, &sbuf) < 0) {
+	if (errno == ENOENT) return 0;
+	fprintf(stderr, "Cannot check %s: %s\n", path, strerror(errno));
+	return -1;
+    }
+    if (!S_ISSOCK(sbuf.st_mode)) {
+	fprintf(stderr, "%s exists and is not a socket\n", path);
+	return -1;
+    }
+    if (unlink(path) < 0) {
+	fprintf(stderr, "Cannot remove %s: %s\n", path, strerror(errno));
+	return -1;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------*/
+/* Create the listening socket						*/
+/*----------------------------------------------------------------------*/
+
+int server_open(char *path)
+{
+    struct sockaddr_un addr;
+    int sockfd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+	fprintf(stderr, "Socket name %s is too long\n", path);
+	return -1;
+    }
+    if (server_unlink(path) < 0) return -1;
+    sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sockfd < 0) {
+	fprintf(stderr, "Cannot create socket: %s\n", strerror(errno));
+	return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if ((bind(sockfd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+		(listen(sockfd, 1) < 0)) {
+	fprintf(stderr, "Cannot listen on %s: %s\n", path, strerror(errno));
+	close(sockfd);
+	return -1;
+    }
+
+    /* A client hanging up early must not stop the server */
+    signal(SIGPIPE, SIG_IGN);
+    return sockfd;
+}
+
+/*----------------------------------------------------------------------*/
+/* Wait for the next client						*/
+/*----------------------------------------------------------------------*/
+
+FILE *server_accept(int sockfd, int *savefd)
+{
+    FILE *fcmd;
+    int clientfd;
+
+    while ((clientfd = accept(sockfd, NULL, NULL)) < 0) {
+	if (errno != EINTR) {
+	    fprintf(stderr, "Server error: %s\n", strerror(errno));
+	    return NULL;
+	}
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    savefd[0] = dup(STDOUT_FILENO);
+    savefd[1] = dup(STDERR_FILENO);
+    dup2(clientfd, STDOUT_FILENO);
+    dup2(clientfd, STDERR_FILENO);
+
+    fcmd = fdopen(clientfd, "r");
+    if (fcmd == NULL) server_hangup(NULL, savefd);
+    return fcmd;
+}
+
+/*----------------------------------------------------------------------*/
+/* End a client connection						*/
+/*----------------------------------------------------------------------*/
+
+void server_hangup(FILE *fcmd, int *savefd)
+{
+    fflush(stdout);
+    fflush(stderr);
+    dup2(savefd[0], STDOUT_FILENO);
+    dup2(savefd[1], STDERR_FILENO);
+    close(savefd[0]);
+    close(savefd[1]);
+    if (fcmd != NULL) fclose(fcmd);
+}
+
+/*----------------------------------------------------------------------*/
+/* Shut down the server							*/
+/*----------------------------------------------------------------------*/
+
+void server_close(int sockfd, char *path)
+{
+    close(sockfd);
+    server_unlink(path);
+}
+
+/*----------------------------------------------------------------------*/
+/* Start a worker process connected to this one by a socket		*/
+/*----------------------------------------------------------------------*/
+
+pid_t server_worker(FILE **fstream)
+{
+    int fds[2];
+    pid_t pid;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+	fprintf(stderr, "Cannot create socket: %s\n", strerror(errno));
+	return -1;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    if (pid < 0) {
+	fprintf(stderr, "Cannot start worker process: %s\n", strerror(errno));
+	close(fds[0]);
+	close(fds[1]);
+	return -1;
+    }
+    if (pid == 0) {
+	close(fds[0]);
+	*fstream = fdopen(fds[1], "w");
+    }
+    else {
+	close(fds[1]);
+	*fstream = fdopen(fds[0], "r");
+    }
+    return pid;
+}
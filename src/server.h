@@ -0,0 +1,40 @@
+/*----------------------------------------------------------------------*/
+/* server.h -- Unix-domain socket command server (vesta server mode)	*/
+/*----------------------------------------------------------------------*/
+
+#ifndef _SERVER_H
+#define _SERVER_H
+
+#include <stdio.h>
+#include <sys/types.h>
+
+/* Create a socket listening for clients at "path", replacing a	*/
+/* stale socket there.  If "path" exists and is not a socket, it is	*/
+/* not removed.  Return the socket descriptor, or -1 on error.		*/
+
+extern int server_open(char *path);
+
+/* Wait for a client to connect to "sockfd".  Standard output and	*/
+/* error are redirected to the client, and the original descriptors	*/
+/* saved in "savefd".  Return a stream for reading the client's	*/
+/* commands, or NULL on error.						*/
+
+extern FILE *server_accept(int sockfd, int *savefd);
+
+/* Close the client stream "fcmd" and restore standard output and	*/
+/* error.								*/
+
+extern void server_hangup(FILE *fcmd, int *savefd);
+
+/* Close the listening socket and remove "path" if it is a socket.	*/
+
+extern void server_close(int sockfd, char *path);
+
+/* Fork a worker process connected to this one by a socket.  In the	*/
+/* worker, return 0 with a stream for writing to this process in	*/
+/* "fstream";  here, return the worker's process ID with a stream	*/
+/* for reading from the worker.  Return -1 on error.			*/
+
+extern pid_t server_worker(FILE **fstream);
+
+#endif /* _SERVER_H */
@@ -12,7 +12,8 @@
 /*                                                              */
 /*      Options are supplied as command-line arguments:         */
 /*                                                              */
-/*              -d <delay_file> Wiring delays (see below)       */
+/*              -d <delay_file> Wiring delays or parasitics     */
+/*				(.dly, .spef or .rc, see below)	*/
 /*              -p <value>      Clock period, in ps             */
 /*              -l <value>      Output load, in fF              */
 /*              -v <level>      set verbose mode                */
@@ -20,9 +21,48 @@
 /*              -V              report version number           */
 /*		-n <number>	number of paths to print	*/
 /*		-L 		Long format (print paths)	*/
+/*		-E		report worst path per endpoint	*/
+/*		-K <number>	find the <number> worst paths	*/
+/*				into each endpoint (implies -g)	*/
 /*              -e              exhaustive search               */
+/*				(with Pareto pruning)		*/
 /*		-s <file>	summary file or directory	*/
+/*		-r <file>	machine-readable report, as	*/
+/*				JSON Lines or CSV (<file>.csv)	*/
+/*		-a		report the worst path to every	*/
+/*				endpoint (with -r)		*/
 /*		-c		cleanup of net name syntax	*/
+/*		-g		levelized (graph-based) analysis */
+/*		-j <number>	threads for path search		*/
+/*		-w <number>	worker processes for path	*/
+/*				search (see below)		*/
+/*		-M		max and min delay in one sweep	*/
+/*				(implies -g)			*/
+/*		-u <eco_file>	incremental analysis of edits	*/
+/*				(implies -g, see below)		*/
+/*		-C <directory>	cache parsed liberty files	*/
+/*				in <directory>			*/
+/*		-S		server mode, commands from	*/
+/*				stdin (same as -u -)		*/
+/*		-k <name>	server mode, commands from	*/
+/*				clients of socket <name>	*/
+/*		-P		report time and memory used by	*/
+/*				each phase, and search counts	*/
+/*		-R		required times and slack at	*/
+/*				every pin (implies -g)		*/
+/*		-X <name>=<files>					*/
+/*				time corner <name> with the	*/
+/*				liberty files <files> (comma	*/
+/*				separated;  see below)		*/
+/*		-A <file>	write an extracted timing	*/
+/*				model of the module to liberty	*/
+/*				file <file> (see below)		*/
+/*		-T <pattern>	time only the paths into the	*/
+/*				instances, pins or nets named	*/
+/*				by <pattern> (see below)	*/
+/*		-F <pattern>	time only the paths out of the	*/
+/*				instances, pins or nets named	*/
+/*				by <pattern> (see below)	*/
 /*                                                              */
 /*      Currently the only output this tool generates is a      */
 /*      list of paths with negative slack.  If no paths have    */
@@ -54,7 +94,15 @@
 /*--------------------------------------------------------------*/
 /*      Wiring delay file:                                      */
 /*      For qflow, the wiring delay is generated by the tool    */
-/*      "def2delays".  The file format is as follows:           */
+/*      "rc2dly" from the RC file written by qrouter.  The	*/
+/*	format of option -d is chosen by the file extension:	*/
+/*	".spef" for SPEF (such as made by rc2dly), ".rc" for	*/
+/*	the qrouter RC file, and otherwise the delay file	*/
+/*	format below.  From SPEF and RC files, the RC tree of	*/
+/*	each net is built, and the Elmore delay to each		*/
+/*	receiver is computed as rc2dly does.			*/
+/*								*/
+/*	The delay file format is as follows:			*/
 /*                                                              */
 /*      <net_name>                                              */
 /*      <output_terminal>  <net_capacitance>                    */
@@ -68,6 +116,118 @@
 /*       line                                                   */
 /*--------------------------------------------------------------*/
 
+/*--------------------------------------------------------------*/
+/*	Analysis corners (option -X):  each -X option names a	*/
+/*	corner and its liberty files, which replace the files	*/
+/*	after the netlist on the command line.  The netlist is	*/
+/*	read and linked, and the timing graph built, only once.	*/
+/*	The corners are then timed one after another (each as	*/
+/*	a full analysis, with its own report), with the cells	*/
+/*	of every instance bound to the cells of the same name	*/
+/*	in the corner's liberty files.  Last, the worst delay	*/
+/*	into each endpoint over all corners is reported, with	*/
+/*	the corner where it is found.  Not available with	*/
+/*	incremental analysis (-u, -S, -k).			*/
+/*--------------------------------------------------------------*/
+
+/*--------------------------------------------------------------*/
+/*	Extracted timing model (option -A):  after the analysis	*/
+/*	the module is written as a single liberty cell, so that	*/
+/*	a timed block can be used as one cell of a larger	*/
+/*	design.  The cell has the module's inputs and outputs,	*/
+/*	with input to output delay arcs, clock to output arcs	*/
+/*	through the flops, and setup and hold arcs from the	*/
+/*	inputs to the clock inputs (module inputs that reach a	*/
+/*	flop clock).  The tables are made by timing the module	*/
+/*	at each input transition and output load of the index	*/
+/*	of the cell library's delay tables.  Each table holds	*/
+/*	the worst of the rising and falling values, and latches	*/
+/*	are not modeled.  With -X, one file is written for each	*/
+/*	corner.  Not available with incremental analysis.	*/
+/*--------------------------------------------------------------*/
+
+/*--------------------------------------------------------------*/
+/*	Partitioned path search (option -w):  the netlist is	*/
+/*	cut at its registers into <number> partitions, by	*/
+/*	dividing up the start points of the paths, and each	*/
+/*	partition is searched by a separate worker process.	*/
+/*	The workers send the paths they find back over a	*/
+/*	socket, and the reports are made from the merged	*/
+/*	paths, of which no more than one into each endpoint is	*/
+/*	held at a time.  The path search memory of each		*/
+/*	partition is released when its worker exits.  A worker	*/
+/*	does not get the pruning that the start points of the	*/
+/*	other partitions would give, so on one machine -w uses	*/
+/*	more memory and time in all than the search without	*/
+/*	it;  it does not make a search fit that does not fit	*/
+/*	already.  May be combined with -j (each worker then	*/
+/*	uses that many threads).  Only the depth-first search	*/
+/*	is partitioned;  -w has no effect on the levelized	*/
+/*	analysis (-g, -M).					*/
+/*--------------------------------------------------------------*/
+
+/*--------------------------------------------------------------*/
+/*	Cone of influence (options -T and -F):  each option	*/
+/*	may be given more than once, and <pattern> may use the	*/
+/*	wildcards "*", "?" and "[...]".  <pattern> is matched	*/
+/*	against <instance>/<pin>, <instance> and <net> names.	*/
+/*	An instance stands for its inputs, or for a register,	*/
+/*	its data inputs (-T) or its clock (-F).  A net or an	*/
+/*	output pin stands for the receivers of the net.  Only	*/
+/*	the start points and gates in the fanin or the fanout	*/
+/*	of the named pins are timed;  with both options, only	*/
+/*	those in the cones of both.  Paths that touch the	*/
+/*	cones without passing through a named pin (for example	*/
+/*	where logic reconverges) may still be reported.		*/
+/*--------------------------------------------------------------*/
+
+/*--------------------------------------------------------------*/
+/*	ECO file (option -u) and server commands (-S, -k):	*/
+/*	After the design is analyzed, edits are read from the	*/
+/*	ECO file and the design is analyzed again after each	*/
+/*	"update" command (and at the end of the file, if there	*/
+/*	are edits not yet analyzed).  Only the part of the	*/
+/*	timing graph downstream of the edits is re-timed, so	*/
+/*	the analysis always uses the levelized engine (as -g);	*/
+/*	a warning is given if -g was not requested, or if -M	*/
+/*	was (-M is then ignored).  One command per line;  lines	*/
+/*	beginning with "#" are ignored.				*/
+/*								*/
+/*	swap <instance> <cell>	Replace the cell of an instance	*/
+/*				with a pin-compatible cell	*/
+/*	load <net> <value>	Add <value> fF to the net load	*/
+/*	delays <delay_file>	Read a wiring delay file	*/
+/*				(any format as above) for the	*/
+/*				nets that it lists		*/
+/*	period <value>		Set the clock period, in ps	*/
+/*	update			Analyze and report		*/
+/*	report [<number>]	Same as update, optionally	*/
+/*				changing the number of paths	*/
+/*	slack <endpoint>	Report the worst delays into	*/
+/*				<instance>/<pin> or an output	*/
+/*				from the last analysis		*/
+/*	paths <endpoint> [<number>]				*/
+/*				Report the <number> worst	*/
+/*				maximum delay paths into	*/
+/*				<endpoint> from the last	*/
+/*				analysis (default: as -n)	*/
+/*	minpaths <endpoint> [<number>]				*/
+/*				Same for minimum delay paths	*/
+/*	pinslack <name>		Report the setup and hold slack	*/
+/*				at <instance>/<pin>, or the	*/
+/*				worst on a net (needs -R)	*/
+/*	critical [<slack> [<number>]]				*/
+/*				Report worst and total negative	*/
+/*				slack, and the pins with setup	*/
+/*				slack below <slack> (default 0)	*/
+/*				(needs -R)			*/
+/*	quit			Stop reading commands		*/
+/*								*/
+/*	In socket mode, the server keeps running between	*/
+/*	clients until a client sends "quit".  Reports and	*/
+/*	errors go to the client while it is connected.		*/
+/*--------------------------------------------------------------*/
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -77,8 +237,20 @@
 #include <sys/types.h>	// For mkdir()
 #include <sys/stat.h>	// For mkdir()
 #include <math.h>       // Temporary, for fabs()
+#include <pthread.h>    // For multi-threaded path search
+#include <sys/wait.h>   // For partitioned path search
+#include <stdint.h>     // For liberty cache
+#include <unistd.h>     // For liberty cache
+#include <fcntl.h>      // For liberty cache
+#include <sys/mman.h>   // For liberty cache
+#include <sys/time.h>   // For profiling
+#include <sys/resource.h> // For profiling
+#include <time.h>       // For profiling
+#include <fnmatch.h>    // For -T and -F patterns
 #include "hash.h"       // For net hash table
 #include "readverilog.h"
+#include "nldm.h"       // For lookup table evaluation
+#include "server.h"     // For server mode
 
 #define LIB_LINE_MAX  65535
 
@@ -168,6 +340,10 @@ int fileCurrentLine;
 #define FALLING         2
 #define EITHER          3
 
+// Pin table index sharing (pin "pairidx" field)
+#define PAIR_DELAY	0x01	// propdelr and propdelf
+#define PAIR_TRANS	0x02	// transr and transf
+
 // Function translation
 #define GROUPBEGIN      1
 #define GROUPEND        2
@@ -196,6 +372,23 @@ int fileCurrentLine;
 #define LATCH           0x40    // Latch type
 #define EN_SENSE_MASK   0x80    // Latch enable edge mask (0=positive, 1=negative)
 
+// Report sections, one for each analysis pass
+#define REG_MAX         0       // Register-to-register, maximum delay
+#define REG_MIN         1       // Register-to-register, minimum delay
+#define PIN_MAX         2       // Pin-to-register and register-to-pin, maximum
+#define PIN_MIN         3       // Pin-to-register and register-to-pin, minimum
+
+// Machine-readable report formats (option -r)
+#define REPORT_JSON     0       // JSON Lines, one record per line
+#define REPORT_CSV      1       // CSV, one record per line
+
+// Parasitics file formats (option -d)
+#define DELAY_FILE      0       // Delay file from rc2dly
+#define SPEF_FILE       1       // SPEF
+#define RC_FILE         2       // RC file from qrouter
+
+#define DRIVER_RES      1.0     // Driver resistance for Elmore delay, in ohms
+
 // Some names for cell types based on masks
 
 #define DFFCP           0x01    // Pos clock
@@ -275,6 +468,7 @@ typedef struct _pin {
     lutable *propdelf;  // Reference table for falling output prop delay relative to driver
     lutable *transr;    // Reference table for transition rise time
     lutable *transf;    // Reference table for transition fall time
+    char pairidx;       // Rise and fall tables share an index (PAIR_* bits)
 
     cellptr refcell;    // Pointer back to parent cell
 
@@ -313,6 +507,23 @@ typedef struct _net {
 
 typedef struct _instance *instptr;
 
+// Lookup tables of a pin collapsed at one output load.  Connections to
+// the same pin of cells driving the same load share one record (see
+// connection_vectors()).
+
+typedef struct _vectorset *vectorsetptr;
+
+typedef struct _vectorset {
+   pinptr   pin;
+   double   loadr;		/* Rising output load of the vectors */
+   double   loadf;		/* Falling output load of the vectors */
+   double   *prvector;          /* Prop delay rising (at load condition) vector */
+   double   *pfvector;          /* Prop delay falling (at load condition) vector */
+   double   *trvector;          /* Transition time rising (at load condition) vector */
+   double   *tfvector;          /* Transition time falling (at load condition) vector */
+   vectorsetptr next;		/* Next record in the same hash bin */
+} vectorset;
+
 typedef struct _connect {
    double   metric;             /* Delay metric at connection */
    double   icDelay;            /* interconnect delay in ps */
@@ -320,11 +531,9 @@ typedef struct _connect {
    pinptr   refpin;
    netptr   refnet;
    unsigned char visited;	/* To check for common clock points */
+   int      index;		/* Connection number (-1 if not numbered) */
    ddataptr tag;                /* Tag value for checking for loops and endpoints */
-   double   *prvector;          /* Prop delay rising (at load condition) vector */
-   double   *pfvector;          /* Prop delay falling (at load condition) vector */
-   double   *trvector;          /* Transition time rising (at load condition) vector */
-   double   *tfvector;          /* Transition time falling (at load condition) vector */
+   vectorsetptr vectors;	/* Collapsed tables, or NULL until first used */
    connptr  next;
 } connect;
 
@@ -336,6 +545,74 @@ typedef struct _instance {
    instptr next;
 } instance;
 
+// Block allocator.  Records are carved from large blocks, so that
+// records allocated together lie together in memory, and without
+// the overhead of a malloc() for each record.  Records cannot be
+// freed individually.
+
+#define ARENA_BLOCKSIZE	65536
+
+typedef struct _arenablock *arenablockptr;
+
+typedef struct _arenablock {
+   arenablockptr next;
+   size_t   used;		/* Bytes allocated from this block */
+   size_t   size;		/* Size of data[] */
+   double   data[1];		/* Records (double aligned) */
+} arenablock;
+
+typedef struct _arena {
+   arenablockptr blocks;	/* Current block first */
+   arenablockptr spare;		/* Emptied blocks, kept for reuse */
+} arena;
+
+// Work stack of the iterative network traversals (find_path_delay(),
+// graph_backtrace() and others), in place of recursion.  Frames of a fixed size for
+// each traversal are pushed and popped at the top, and the storage is
+// kept for the next traversal.  Each thread has its own (workmem).
+
+typedef struct _workstack {
+   char     *frames;
+   size_t   top;		/* Bytes in use */
+   size_t   size;		/* Bytes allocated */
+} workstack;
+
+#define WORK_ALIGN(size) (((size) + sizeof(double) - 1) & ~(sizeof(double) - 1))
+
+// RC tree of one net, read from a SPEF or qrouter .rc file.  The
+// Elmore delay to each receiver is computed from the tree.
+
+typedef struct _rcnode *rcnodeptr;
+typedef struct _rcedge *rcedgeptr;
+
+typedef struct _rcedge {
+   rcnodeptr node;		/* Node at the other end of the resistor */
+   double    res;		/* Resistance, in ohms */
+   rcedgeptr next;
+} rcedge;
+
+typedef struct _rcnode {
+   char      *name;		/* Node name, or NULL if not named */
+   connptr   conn;		/* Pin at this node, or NULL */
+   unsigned char port;		/* Node is a port of the design */
+   unsigned char visited;
+   double    cap;		/* Wiring capacitance, in fF */
+   double    pincap;		/* Pin capacitance, in fF */
+   double    down;		/* Capacitance at and below the node, in fF */
+   double    delay;		/* Elmore delay from the driver, in ps */
+   double    res;		/* Resistance to the parent node, in ohms */
+   rcnodeptr parent;		/* Parent node (toward the driver) */
+   rcedgeptr edges;		/* Resistors on the node */
+   rcnodeptr next;		/* Next node of the net */
+} rcnode;
+
+typedef struct _rctree {
+   arena     mem;		/* Node and edge records */
+   struct hashtable names;	/* Named nodes, by name */
+   rcnodeptr nodes;		/* All nodes of the net */
+   int       numnodes;
+} rctree;
+
 // Linked list of delays (backtrace to source)
 
 typedef struct _btdata *btptr;
@@ -360,6 +637,16 @@ typedef struct _delaydata {
    ddataptr  next;
 } delaydata;
 
+// Storage for the backtrace and delay records of one analysis pass.
+// Records released during the pass are kept on free lists for reuse,
+// and everything is released together at the end of the pass.
+
+typedef struct _pathpool {
+   arena    mem;
+   btptr    freebt;		/* Free backtrace records (linked by next) */
+   ddataptr freedd;		/* Free delay records (linked by next) */
+} pathpool;
+
 // Linked list of connection pointers
 // (Much like delaydata, but without all the timing information)
 
@@ -370,12 +657,442 @@ typedef struct _connlist {
    connlistptr next;
 } connlist;
 
+// Levelized timing graph.  Each node is a connection record that can
+// receive or launch a signal (instance inputs, module inputs and module
+// outputs).  Arrays of per-edge data are indexed by (node * 2 + edge),
+// where edge is 0 for a rising and 1 for a falling transition.
+
+#define GRAPH_SOURCE	0x01	// Path start (module input or flop clock)
+#define GRAPH_THROUGH	0x02	// Propagates through a gate
+#define GRAPH_SINK	0x04	// Path end (module output or register input)
+
+#define NOPRED		-2	// No arrival recorded at this node and edge
+
+// Sinks recorded by graph_capture()
+
+#define CAPTURE_ALL		0	// All sinks
+#define CAPTURE_CLOCKED		1	// Register inputs (clock skew applies)
+#define CAPTURE_UNCLOCKED	2	// Module outputs and other sinks
+
+typedef struct _tgraph *tgraphptr;
+
+typedef struct _tgraph {
+   int      numnodes;
+   connptr  *nodes;		/* Connection records, by node number */
+   unsigned char *role;		/* Mask of GRAPH_SOURCE, GRAPH_THROUGH, GRAPH_SINK */
+   int      numorder;
+   int      *order;		/* Propagating nodes in topological order */
+   int      *orderpos;		/* Position of node in order (-1 if none) */
+   int      *fanoutidx;		/* Fanout of node n is fanout[fanoutidx[n] ..	*/
+   int      *fanout;		/*	fanoutidx[n + 1] - 1]			*/
+   int      *faninidx;		/* Fanin, similarly (transpose of fanout) */
+   int      *fanin;
+   double   *arrival;		/* Arrival time at node input */
+   double   *trans;		/* Transition time at node input */
+   int      *pred;		/* Predecessor (node * 2 + edge), -1 at a source */
+   double   *outdelay;		/* Arrival time at output of the node's gate */
+   double   *outtrans;		/* Transition time at output of the node's gate */
+   int      *outedge;		/* Input edge producing outdelay */
+   double   *captured;		/* Arrival time captured at a sink */
+   double   *captrans;		/* Transition time captured at a sink */
+   int      *cappred;		/* Predecessor of the captured arrival */
+   double   *launch;		/* Launch clock arrival at each start point */
+   struct _clockcache *clocks;	/* Clock cache given to graph_seed() */
+   unsigned char skewed;	/* Some start point has a launch clock arrival */
+   tgraphptr unclocked;		/* Same analysis without launch clock arrivals */
+} tgraph;
+
+/* Path into an endpoint of a timing graph, for the enumeration of	*/
+/* the worst paths into each endpoint (see graph_kpaths()).  A path	*/
+/* is the path it deviates from ("parent"), but arriving at node	*/
+/* edge "node" from predecessor "pred" instead, and following the	*/
+/* worst predecessors recorded in the graph from there back to its	*/
+/* start point.  A path with no parent is the worst path into edge	*/
+/* "node" of the endpoint.						*/
+
+typedef struct _kpath *kpathptr;
+
+typedef struct _kpath {
+   double   delay;		/* Arrival at the endpoint (see graph_kpaths()) */
+   int      node;		/* Node edge where the path deviates */
+   int      pred;		/* Predecessor taken at that node edge */
+   kpathptr parent;
+} kpath;
+
+/* Pareto frontier of the arrivals at each connection, used by the	*/
+/* exhaustive path search (see find_path_frontier()) and by the	*/
+/* levelized engine (see graph_frontier()).  An arrival whose delay	*/
+/* and transition time are both no worse than those of another	*/
+/* arrival in the same direction cannot produce a worse result	*/
+/* downstream, and is dropped.  Points at each connection are	*/
+/* kept in a list indexed by the connection number;  lists whose	*/
+/* stamp does not match "current" are empty.				*/
+
+typedef struct _paretopoint {
+   double   delay;
+   double   trans;
+   short    dir;
+   btptr    backtrace;		/* Path to this arrival (holds a reference) */
+   int      next;		/* Index of next point in list, or -1 */
+} paretopoint;
+
+typedef struct _frontier *frontptr;
+
+typedef struct _frontier {
+   int      *head;		/* First point at each connection */
+   unsigned int *stamp;		/* Value of "current" when head was set */
+   unsigned int *queued;	/* Value of "current" when node was queued */
+   unsigned int current;	/* Stamp value for valid entries */
+   int      *touched;		/* Connections with a non-empty list */
+   int      numtouched;
+   int      *heap;		/* Queue of graph order positions */
+   paretopoint *points;		/* Storage for points */
+   int      numpoints;		/* Points allocated from storage */
+   int      maxpoints;		/* Size of storage */
+   int      freelist;		/* Points removed from the frontier */
+   pathpool *pool;		/* Storage for path records */
+} frontier;
+
+/* Slack at every pin from the last analysis (option -R), by	*/
+/* connection number and indexed by minmax:  setup slack for	*/
+/* MAXIMUM_TIME and hold slack for MINIMUM_TIME.  The slack of a	*/
+/* pin is the worst slack of all paths through it, found by		*/
+/* propagating required times back from the endpoints (see		*/
+/* graph_required()).  Pins on no timed path have slack NOSLACK.	*/
+
+#define NOSLACK		1.0E50
+
+typedef struct _slackdb *slackptr;
+
+typedef struct _slackdb {
+   int      numconns;
+   connptr  *conns;		/* Connection records, by number */
+   double   *slack[2];		/* Worst slack of each pin */
+   double   *endslack[2];	/* Worst slack of each endpoint */
+   double   period;		/* Clock period for setup slack */
+} slackdb;
+
+/* State of an incremental analysis session (options -u, --server,	*/
+/* --socket).  Commands are read from "fcmd" (see eco_read()).		*/
+
+typedef struct _session *sessionptr;
+
+typedef struct _session {
+   FILE     *fcmd;		/* Command stream (NULL if none) */
+   char     *name;		/* Name of the command stream, for messages */
+   int      lineno;		/* Lines read from the command stream */
+   unsigned char quit;		/* Set by the "quit" command */
+   struct hashtable *nethash;	/* Nets by name */
+   struct hashtable *insthash;	/* Instances by name */
+   cellptr  cells;		/* Liberty cells */
+   double   outload;		/* Output load (option -l) */
+   double   *period;		/* Clock period (option -p) */
+   int      *numpaths;		/* Number of paths to report (option -n) */
+   unsigned char *dirty;	/* Connections changed since last analysis */
+   double   *endmax;		/* Maximum delay at each endpoint, by	*/
+   double   *endmin;		/*	connection number (or INITVAL)	*/
+   slackptr slacks;		/* Pin slacks (option -R), or NULL */
+   tgraphptr *views;		/* Graph of each analysis pass */
+   struct _clockcache *clocks;	/* Clock tree cache */
+} session;
+
+/* Analysis corner (option -X).  The netlist, the timing graph and	*/
+/* the wiring parasitics are shared by all corners.  Each corner has	*/
+/* its own liberty files, and the instances are bound to the cells	*/
+/* of a corner before it is timed (see corner_bind()).			*/
+
+typedef struct _corner {
+   char     *name;
+   char     *libs;		/* Liberty files, separated by commas */
+   lutable  *tables;
+   cell     *cells;
+   struct hashtable cellhash;	/* Cells by name */
+} corner;
+
+/* Worst delay into each endpoint over all corners, for each report	*/
+/* section (REG_MAX, ...), by connection number (see corner_merge()).	*/
+
+typedef struct _cornermerge {
+   double   *delay[4];		/* Worst delay, or INITVAL */
+   int      *corner[4];		/* Corner of the worst delay */
+   connptr  *conns;		/* Endpoint connection records */
+} cornermerge;
+
+/* State of a timing analysis, shared by its four passes (see	*/
+/* time_pass()).  The options that edits can change (see	*/
+/* eco_read()) are copied in before each analysis.		*/
+
+typedef struct _timingrun {
+   netptr   netlist;
+   connptr  inputlist;		/* Input pin connections */
+   connlistptr clockconns;	/* Start points of the register passes */
+   connlistptr inputconns;	/* Start points of the pin passes */
+   tgraphptr graph;		/* Timing graph (of maximum delays, -M) */
+   tgraphptr mingraph;		/* Timing graph of minimum delays (-M) */
+   tgraphptr *views;		/* Graph of each analysis pass (see -u) */
+   struct _clockcache *clocks;	/* Clock tree cache */
+   unsigned char *dirty;	/* Connections changed since last analysis */
+   double   period;		/* Clock period (option -p) */
+   int      numpaths;		/* Number of paths to report (option -n) */
+   int      endpointonly;	/* Report one path per endpoint (option -E) */
+   int      longformat;		/* Long report format (option -L) */
+   int      allendpoints;	/* Report every endpoint (option -a) */
+   int      analysis;		/* Number of the analysis (see -u) */
+   char     *summarydir;	/* Directory of summary files, or NULL */
+   char     *summaryfile;	/* Single summary file, or NULL */
+   FILE     *fsum;		/* Summary file being written */
+   FILE     *freport;		/* Machine-readable report, or NULL */
+   int      reportformat;
+   slackptr slacks;		/* Pin slacks (option -R), or NULL */
+   sessionptr sess;		/* Incremental analysis, or NULL */
+   cornermerge *merged;		/* Worst delays over corners, or NULL */
+   int      curcorner;		/* Corner being timed (option -X) */
+   ddataptr minpathlist;	/* Minimum delay paths found early (-M) */
+   pathpool *minpathmem;	/* Storage for minpathlist */
+   int      numminpaths;
+} timingrun;
+
+/* Per-thread path search state.  This replaces the "metric" and	*/
+/* "tag" fields of the connection records when several searches	*/
+/* run at once, and is indexed by the connection number.  Entries	*/
+/* whose stamp does not match "current" have not been set yet.	*/
+
+typedef struct _searchdata *searchptr;
+
+typedef struct _searchdata {
+   double   *metric;		/* Delay metric at connection */
+   ddataptr *tag;		/* Tag value for loops and endpoints */
+   unsigned int *stamp;		/* Value of "current" when entry was set */
+   unsigned int current;	/* Stamp value for valid entries */
+   pathpool *pool;		/* Storage for path records */
+} searchdata;
+
+/* Clock tree structure cached for find_clock_skews().  Where the	*/
+/* clock to a register passes only through single-input gates (the	*/
+/* usual buffer or inverter tree), the path back to the clock root	*/
+/* is a simple chain, and the clock arrival times along it can be	*/
+/* computed once and reused for every timing path that starts or	*/
+/* ends at the register.  Arrays of arrival times are indexed by	*/
+/* minmax.								*/
+
+typedef struct _clockchain *chainptr;
+
+typedef struct _clockchain {
+   int      length;		/* Number of connections in the chain */
+   connptr  *conns;		/* Root first;  conns[length - 1] is the clock pin */
+   double   *launch[2];		/* Arrival at each connection from the root */
+   double   *capture[2];	/* Arrival at the clock pin from each connection */
+   double   *captrans[2];	/* Transition time at the clock pin, likewise */
+   unsigned char *capdone[2];	/* Capture entry has been computed */
+} clockchain;
+
+typedef struct _clockcache *clockcacheptr;
+
+typedef struct _clockcache {
+   chainptr *chains;		/* Chain for each clock pin, by connection number */
+   unsigned char *checked;	/* Chain has been looked for */
+   int      *markowner;		/* Clock pin whose chain last marked the connection */
+   int      *markpos;		/* Position of the connection in that chain */
+} clockcache;
+
+/* Start points for a threaded search, divided into one range per	*/
+/* thread.  A thread works from the bottom of its own range, and	*/
+/* when that is exhausted, steals the top half of another range.	*/
+
+typedef struct _workrange {
+   int lo;
+   int hi;
+   pthread_mutex_t lock;
+} workrange;
+
+typedef struct _pathjob *pathjobptr;
+
+typedef struct _pathjob {
+   connptr  *starts;		/* Start point of each search */
+   ddataptr *results;		/* Delay list found from each start point */
+   int      numstarts;
+   int      numranges;
+   workrange *ranges;
+   int      completed;		/* Progress count, for verbose output */
+   pthread_mutex_t lock;	/* Protects "completed" */
+   char     minmax;
+   tgraphptr graph;		/* Timing graph for exhaustive search */
+} pathjob;
+
+typedef struct _pathworker {
+   pathjobptr job;
+   int      id;			/* Thread number (range owned) */
+   pathpool *pool;		/* Storage for the thread's path records */
+} pathworker;
+
+/* Paths from searches of parts of the start point list (threads or	*/
+/* partitions) being merged into one path into each endpoint, as	*/
+/* the search of the whole list gives (see pathmerge_add()).		*/
+
+typedef struct _pathmerge {
+   int      numstarts;
+   int      *startpos;		/* Start point index, by connection number */
+   ddataptr *ends;		/* Path kept into each endpoint, likewise */
+   int      *endstart;		/* Start point index of each path kept */
+   int      *endfirst;		/* Delay list in which to put each path kept */
+   int      *order;		/* Endpoints in the order first added */
+   int      numends;
+   char     minmax;
+} pathmerge;
+
+/* Event counters for option --profile.  Each thread counts in its	*/
+/* own copy (see profcount), and path search threads add theirs to	*/
+/* proftotal when they finish.					*/
+
+typedef struct _profcounts {
+   unsigned long nldm;		/* Lookup table evaluations */
+   unsigned long visits;	/* Path search node visits */
+   unsigned long pruned;	/* Visits stopped by the delay metric or a loop */
+   unsigned long btdata;	/* Backtrace records created */
+   unsigned long vectors;	/* Pin tables collapsed at a load */
+   unsigned long shared;	/* Collapsed tables found already made */
+} profcounts;
+
+/* Time and memory used by one phase of the analysis (--profile)	*/
+
+typedef struct _profphase {
+   char     *name;
+   double   wall;		/* Elapsed time, in s */
+   double   cpu;		/* CPU time of all threads, in s */
+   long     maxrss;		/* Peak resident set size at the end, in kB */
+   int      count;		/* Number of times the phase ran */
+} profphase;
+
+#define PROF_MAX_PHASES 32
+
 /* Global variables */
 
 unsigned char verbose;       /* Level of user output generated */
 unsigned char debug;	     /* Level of debug output generated */
 unsigned char exhaustive;    /* Exhaustive search mode */
 unsigned char cleanup;       /* Clean up net name syntax */
+unsigned char graphmode;     /* Levelized (block-based) analysis */
+unsigned char minmaxmode;    /* Maximum and minimum analysis in one sweep */
+int numthreads;		     /* Threads for path search (0 = no threads) */
+int numparts;		     /* Worker processes for path search (-w) */
+int pathsperend;	     /* Paths recorded into each endpoint (-K) */
+unsigned char *conemask;     /* Connections in the cone of -T and -F, or NULL */
+int numconnects;	     /* Number of connections numbered */
+char *modulename;	     /* Name of the module read */
+int *connorder;		     /* Topological position of each connection */
+arena netarena;		     /* Net, instance, and connection records */
+
+vectorsetptr *vectorbins;    /* Hash table of collapsed pin tables */
+int numvectorbins, numvectorsets;
+arena vectormem;	     /* Storage for the collapsed pin tables */
+pthread_mutex_t vectorlock = PTHREAD_MUTEX_INITIALIZER;
+pathpool pathmem;	     /* Path records of the current analysis pass */
+
+unsigned char profile;	     /* Report time and memory of each phase */
+__thread profcounts profcount;	/* Event counts of this thread */
+__thread workstack workmem;  /* Traversal work stack of this thread */
+profcounts proftotal;	     /* Event counts of finished threads */
+profphase profphases[PROF_MAX_PHASES];
+int numprofphases;
+char *profcurrent;	     /* Phase being timed, or NULL */
+double profwall, profcpu;    /* Times at the start of profcurrent */
+
+/*--------------------------------------------------------------*/
+/* Get the elapsed time and the CPU time of all threads, in s.	*/
+/*--------------------------------------------------------------*/
+
+void
+profile_times(double *wall, double *cpu)
+{
+    struct timespec now;
+    struct rusage usage;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    *wall = (double)now.tv_sec + 1.0e-9 * (double)now.tv_nsec;
+    getrusage(RUSAGE_SELF, &usage);
+    *cpu = (double)usage.ru_utime.tv_sec + 1.0e-6 * (double)usage.ru_utime.tv_usec
+		+ (double)usage.ru_stime.tv_sec + 1.0e-6 * (double)usage.ru_stime.tv_usec;
+}
+
+/*--------------------------------------------------------------*/
+/* End the phase being timed (if any) and start phase "name"	*/
+/* (none if NULL).  Time is added to any earlier run of the	*/
+/* same phase.  Does nothing unless option --profile was given.	*/
+/*--------------------------------------------------------------*/
+
+void
+profile_phase(char *name)
+{
+    struct rusage usage;
+    double wall, cpu;
+    int i;
+
+    if (!profile) return;
+    profile_times(&wall, &cpu);
+
+    if (profcurrent != NULL) {
+	for (i = 0; i < numprofphases; i++)
+	    if (!strcmp(profphases[i].name, profcurrent))
+		break;
+	if ((i == numprofphases) && (i < PROF_MAX_PHASES)) {
+	    profphases[i].name = profcurrent;
+	    profphases[i].wall = 0.0;
+	    profphases[i].cpu = 0.0;
+	    profphases[i].count = 0;
+	    numprofphases++;
+	}
+	if (i < numprofphases) {
+	    getrusage(RUSAGE_SELF, &usage);
+	    profphases[i].wall += wall - profwall;
+	    profphases[i].cpu += cpu - profcpu;
+#ifdef __APPLE__
+	    profphases[i].maxrss = usage.ru_maxrss / 1024;	/* bytes */
+#else
+	    profphases[i].maxrss = usage.ru_maxrss;		/* kB */
+#endif
+	    profphases[i].count++;
+	}
+    }
+    profcurrent = name;
+    profwall = wall;
+    profcpu = cpu;
+}
+
+/*--------------------------------------------------------------*/
+/* Print the time and memory used by each phase, and the event	*/
+/* counts, to "file".						*/
+/*--------------------------------------------------------------*/
+
+void
+profile_report(FILE *file)
+{
+    double wall = 0.0, cpu = 0.0;
+    int i;
+
+    fprintf(file, "\nProfile:\n");
+    fprintf(file, "  %-28s %5s %10s %10s %10s\n", "Phase", "Runs", "Wall (s)",
+		"CPU (s)", "Peak (MB)");
+    for (i = 0; i < numprofphases; i++) {
+	fprintf(file, "  %-28s %5d %10.3f %10.3f %10.1f\n", profphases[i].name,
+		profphases[i].count, profphases[i].wall, profphases[i].cpu,
+		(double)profphases[i].maxrss / 1024.0);
+	wall += profphases[i].wall;
+	cpu += profphases[i].cpu;
+    }
+    fprintf(file, "  %-28s %5s %10.3f %10.3f\n", "Total", "", wall, cpu);
+
+    fprintf(file, "  Lookup table evaluations:    %lu\n",
+		proftotal.nldm + profcount.nldm);
+    fprintf(file, "  Path search node visits:     %lu\n",
+		proftotal.visits + profcount.visits);
+    fprintf(file, "  Visits pruned:               %lu\n",
+		proftotal.pruned + profcount.pruned);
+    fprintf(file, "  Backtrace records created:   %lu\n",
+		proftotal.btdata + profcount.btdata);
+    fprintf(file, "  Pin tables collapsed:        %lu (%lu shared)\n",
+		proftotal.vectors + profcount.vectors,
+		proftotal.shared + profcount.shared);
+}
 
 /*--------------------------------------------------------------*/
 /* Grab a token from the input                                  */
@@ -650,10 +1367,189 @@ pinptr parse_pin(cellptr newcell, char *token)
     newpin->propdelf = NULL;
     newpin->transr = NULL;
     newpin->transf = NULL;
+    newpin->pairidx = 0;
     newpin->refcell = newcell;  // Create link back to cell
     return newpin;
 }
 
+/*--------------------------------------------------------------*/
+/* Allocate a record of "size" bytes from arena "ap".		*/
+/*--------------------------------------------------------------*/
+
+void *arena_alloc(arena *ap, size_t size)
+{
+    arenablockptr block;
+    void *rec;
+
+    size = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+    block = ap->blocks;
+    if ((block == NULL) || (block->used + size > block->size)) {
+	if ((size <= ARENA_BLOCKSIZE) && (ap->spare != NULL)) {
+	    block = ap->spare;
+	    ap->spare = block->next;
+	}
+	else {
+	    size_t bsize = (size > ARENA_BLOCKSIZE) ? size : ARENA_BLOCKSIZE;
+	    block = (arenablockptr)malloc(sizeof(arenablock) + bsize);
+	    block->size = bsize;
+	}
+	block->used = 0;
+	block->next = ap->blocks;
+	ap->blocks = block;
+    }
+    rec = (void *)((char *)block->data + block->used);
+    block->used += size;
+    return rec;
+}
+
+/*--------------------------------------------------------------*/
+/* Release everything allocated from arena "ap".  Blocks of the	*/
+/* standard size are kept for reuse.				*/
+/*--------------------------------------------------------------*/
+
+void arena_reset(arena *ap)
+{
+    arenablockptr block;
+
+    while (ap->blocks != NULL) {
+	block = ap->blocks;
+	ap->blocks = block->next;
+	if (block->size == ARENA_BLOCKSIZE) {
+	    block->next = ap->spare;
+	    ap->spare = block;
+	}
+	else
+	    free(block);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Move all blocks of arena "src" to arena "dest".  The current	*/
+/* block of "dest" stays current.				*/
+/*--------------------------------------------------------------*/
+
+void arena_merge(arena *dest, arena *src)
+{
+    arenablockptr block, *tail;
+
+    if (src->blocks != NULL) {
+	for (block = src->blocks; block->next; block = block->next);
+	if (dest->blocks == NULL)
+	    dest->blocks = src->blocks;
+	else {
+	    block->next = dest->blocks->next;
+	    dest->blocks->next = src->blocks;
+	}
+    }
+    for (tail = &dest->spare; *tail; tail = &(*tail)->next);
+    *tail = src->spare;
+    src->blocks = NULL;
+    src->spare = NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Push a frame of "size" bytes on work stack "ws" and return	*/
+/* it.  Frames pushed before may move, so pointers to them must	*/
+/* be taken again with work_top().				*/
+/*--------------------------------------------------------------*/
+
+void *work_push(workstack *ws, size_t size)
+{
+    void *frame;
+
+    size = WORK_ALIGN(size);
+    if (ws->top + size > ws->size) {
+	if (ws->size == 0) ws->size = 4096;
+	while (ws->top + size > ws->size) ws->size *= 2;
+	ws->frames = (char *)realloc(ws->frames, ws->size);
+    }
+    frame = (void *)(ws->frames + ws->top);
+    ws->top += size;
+    return frame;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the top frame of work stack "ws" (of "size" bytes),	*/
+/* and remove the top frame.					*/
+/*--------------------------------------------------------------*/
+
+void *work_top(workstack *ws, size_t size)
+{
+    return (void *)(ws->frames + ws->top - WORK_ALIGN(size));
+}
+
+void work_pop(workstack *ws, size_t size)
+{
+    ws->top -= WORK_ALIGN(size);
+}
+
+/*--------------------------------------------------------------*/
+/* Release the storage of work stack "ws".			*/
+/*--------------------------------------------------------------*/
+
+void work_free(workstack *ws)
+{
+    free(ws->frames);
+    ws->frames = NULL;
+    ws->top = ws->size = 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Allocate and release backtrace and delay records in pool	*/
+/* "pool".  Records are not initialized.			*/
+/*--------------------------------------------------------------*/
+
+btptr create_btdata(pathpool *pool)
+{
+    btptr newbt;
+
+    profcount.btdata++;
+    if (pool->freebt != NULL) {
+	newbt = pool->freebt;
+	pool->freebt = newbt->next;
+    }
+    else
+	newbt = (btptr)arena_alloc(&pool->mem, sizeof(btdata));
+    return newbt;
+}
+
+void release_btdata(pathpool *pool, btptr oldbt)
+{
+    oldbt->next = pool->freebt;
+    pool->freebt = oldbt;
+}
+
+ddataptr create_delaydata(pathpool *pool)
+{
+    ddataptr newdd;
+
+    if (pool->freedd != NULL) {
+	newdd = pool->freedd;
+	pool->freedd = newdd->next;
+    }
+    else
+	newdd = (ddataptr)arena_alloc(&pool->mem, sizeof(delaydata));
+    return newdd;
+}
+
+void release_delaydata(pathpool *pool, ddataptr olddd)
+{
+    olddd->next = pool->freedd;
+    pool->freedd = olddd;
+}
+
+/*--------------------------------------------------------------*/
+/* Release all records in "pool" at once, at the end of an	*/
+/* analysis pass.						*/
+/*--------------------------------------------------------------*/
+
+void pathpool_reset(pathpool *pool)
+{
+    arena_reset(&pool->mem);
+    pool->freebt = NULL;
+    pool->freedd = NULL;
+}
+
 /*--------------------------------------------------------------*/
 /* Create a new net record                                      */
 /*--------------------------------------------------------------*/
@@ -662,7 +1558,7 @@ netptr create_net(netptr *netlist) {
 
     netptr newnet;
 
-    newnet = (netptr)malloc(sizeof(net));
+    newnet = (netptr)arena_alloc(&netarena, sizeof(net));
     newnet->name = NULL;
     newnet->next = *netlist;
     *netlist = newnet;
@@ -678,49 +1574,20 @@ netptr create_net(netptr *netlist) {
 
 /*----------------------------------------------------------------------*/
 /* Interpolate or extrapolate a vector from a time vs. capacitance      */
-/* lookup table.                                                        */
+/* lookup table.  The result is written into "vector" if non-NULL,      */
+/* otherwise into newly allocated memory.                               */
 /*----------------------------------------------------------------------*/
 
-double *table_collapse(lutableptr tableptr, double load)
+double *table_collapse(lutableptr tableptr, double load, double *vector)
 {
-    double *vector;
-    double cfrac, vlow, vhigh;
-    int i, j;
-
-    vector = (double *)malloc(tableptr->size1 * sizeof(double));
-
-    // If the table is 1-dimensional, then just return a copy of the table.
-    if (tableptr->size2 <= 1) {
-       for (i = 0; i < tableptr->size1; i++) {
-          *(vector + i) = *(tableptr->values + i);
-       }
-       return vector;
-    }
-
-    // Find cap load index entries bounding  "load", or the two nearest
-    // entries, if extrapolating
-
-    if (load < tableptr->idx2.caps[0])
-        j = 1;
-    else if (load >= tableptr->idx2.caps[tableptr->size2 - 1])
-        j = tableptr->size2 - 1;
-    else {
-        for (j = 0; j < tableptr->size2; j++)
-            if (tableptr->idx2.caps[j] > load)
-                break;
-    }
-
-    cfrac = (load - tableptr->idx2.caps[j - 1]) /
-                        (tableptr->idx2.caps[j] - tableptr->idx2.caps[j - 1]);
-
-    for (i = 0; i < tableptr->size1; i++) {
+    if (vector == NULL)
+        vector = (double *)malloc(tableptr->size1 * sizeof(double));
 
-        // Interpolate value at cap load for each transition value
+    profcount.nldm++;
 
-        vlow = *(tableptr->values + i * tableptr->size2 + (j - 1));
-        vhigh = *(tableptr->values + i * tableptr->size2 + j);
-        *(vector + i) = vlow + (vhigh - vlow) * cfrac;
-    }
+    // See nldm.c
+    nldm_collapse(tableptr->idx2.caps, tableptr->size1, tableptr->size2,
+		tableptr->values, load, vector);
     return vector;
 }
 
@@ -732,107 +1599,164 @@ double *table_collapse(lutableptr tableptr, double load)
 
 double vector_get_value(lutableptr tableptr, double *vector, double trans)
 {
-    int i;
-    double tfrac, vlow, vhigh, value;
-
-    // Find time index entries bounding  "trans", or the two nearest
-    // entries, if extrapolating
-
-    if (trans < tableptr->idx1.times[0])
-        i = 1;
-    else if (trans >= tableptr->idx1.times[tableptr->size1 - 1])
-        i = tableptr->size1 - 1;
-    else {
-        for (i = 0; i < tableptr->size1; i++)
-            if (tableptr->idx1.times[i] > trans)
-                break;
-    }
-
-    // Compute transition time as a fraction of the nearest table indexes
-    // for transition times
+    profcount.nldm++;
 
-    tfrac = (trans - tableptr->idx1.times[i - 1]) /
-                (tableptr->idx1.times[i] - tableptr->idx1.times[i - 1]);
-
-    // Interpolate value
-    vlow = *(vector + (i - 1));
-    vhigh = *(vector + i);
-    value = vlow + (vhigh - vlow) * tfrac;
-    return value;
+    // See nldm.c
+    return nldm_vector(tableptr->idx1.times, tableptr->size1, vector, trans);
 }
 
 /*----------------------------------------------------------------------*/
-/* Interpolate or extrapolate a value from a related time vs.           */
-/* constrained time lookup table.                                       */
+/* Hash bin of the tables of pin "testpin" collapsed at the loads	*/
+/* "loadr" and "loadf".							*/
 /*----------------------------------------------------------------------*/
 
-double binomial_get_value(lutableptr tableptr, double rtrans, double ctrans)
+unsigned long vectorset_hash(pinptr testpin, double loadr, double loadf)
 {
-    int i, j;
-    double rfrac, cfrac, vlow, vhigh, valuel, valueh, value;
+    uint64_t h, bits;
+
+    h = (uint64_t)(uintptr_t)testpin;
+    memcpy(&bits, &loadr, sizeof(uint64_t));
+    h = (h ^ bits) * 0x9e3779b97f4a7c15ULL;
+    memcpy(&bits, &loadf, sizeof(uint64_t));
+    h = (h ^ bits) * 0x9e3779b97f4a7c15ULL;
+    return (unsigned long)((h >> 32) % numvectorbins);
+}
 
-    /* Tables have been arranged such that idx1 is related time,        */
-    /* idx2 is constrained time */
+/*----------------------------------------------------------------------*/
+/* Return the lookup tables of the pin of connection "testconn"		*/
+/* collapsed at the load on the instance output.  The tables are	*/
+/* collapsed the first time they are needed, and not at all for pins	*/
+/* that no timing path reaches.  Connections to the same pin driving	*/
+/* the same load (same cell, same fanout) share the collapsed tables,	*/
+/* which are kept in a hash table for the rest of the run.		*/
+/*									*/
+/* Path search threads may call this at the same time, so the tables	*/
+/* are made while holding vectorlock.					*/
+/*----------------------------------------------------------------------*/
 
-    // Find time index entries bounding  "rtrans", or the two nearest
-    // entries, if extrapolating
+vectorsetptr connection_vectors(connptr testconn)
+{
+    vectorsetptr vs, *oldbins;
+    pinptr testpin;
+    netptr loadnet;
+    double loadr, loadf, *vector;
+    unsigned long h;
+    int nvalues, i, oldnum;
+    char pairidx;
+
+    vs = __atomic_load_n(&testconn->vectors, __ATOMIC_ACQUIRE);
+    if (vs != NULL) return vs;
+
+    pthread_mutex_lock(&vectorlock);
+    if ((vs = testconn->vectors) != NULL) {
+	pthread_mutex_unlock(&vectorlock);
+	return vs;
+    }
 
-    if (rtrans < tableptr->idx1.rel[0])
-        i = 1;
-    else if (rtrans >= tableptr->idx1.rel[tableptr->size1 - 1])
-        i = tableptr->size1 - 1;
+    testpin = testconn->refpin;
+    if (testconn->refinst->out_connects != NULL) {
+	loadnet = testconn->refinst->out_connects->refnet;
+	loadr = loadnet->loadr;
+	loadf = loadnet->loadf;
+    }
     else {
-        for (i = 0; i < tableptr->size1; i++)
-            if (tableptr->idx1.rel[i] > rtrans)
-                break;
+	loadr = 0.0;
+	loadf = 0.0;
     }
 
-    // Compute transition time as a fraction of the nearest table indexes
-    // for transition times
-
-    rfrac = (rtrans - tableptr->idx1.rel[i - 1]) /
-                (tableptr->idx1.rel[i] - tableptr->idx1.rel[i - 1]);
-
-    // 1-dimensional computation, if this table is 1-dimensional
-
-    if (tableptr->size2 == 0) {
-        vlow = *(tableptr->values + (i - 1));
-        vhigh = *(tableptr->values + i);
-        value = vlow + (vhigh - vlow) * rfrac;
-        return value;
+    // Grow the hash table as it fills
+
+    if (numvectorsets >= numvectorbins) {
+	oldbins = vectorbins;
+	oldnum = numvectorbins;
+	numvectorbins = (oldnum == 0) ? 1024 : 4 * oldnum;
+	vectorbins = (vectorsetptr *)calloc(numvectorbins, sizeof(vectorsetptr));
+	for (i = 0; i < oldnum; i++) {
+	    while ((vs = oldbins[i]) != NULL) {
+		oldbins[i] = vs->next;
+		h = vectorset_hash(vs->pin, vs->loadr, vs->loadf);
+		vs->next = vectorbins[h];
+		vectorbins[h] = vs;
+	    }
+	}
+	free(oldbins);
     }
 
-    // Find cons index entries bounding  "ctrans", or the two nearest
-    // entries, if extrapolating
+    h = vectorset_hash(testpin, loadr, loadf);
+    for (vs = vectorbins[h]; vs; vs = vs->next)
+	if ((vs->pin == testpin) && (vs->loadr == loadr) && (vs->loadf == loadf))
+	    break;
 
-    if (ctrans < tableptr->idx2.cons[0])
-        j = 1;
-    else if (ctrans >= tableptr->idx2.cons[tableptr->size2 - 1])
-        j = tableptr->size2 - 1;
+    if (vs != NULL)
+	profcount.shared++;
     else {
-        for (j = 0; j < tableptr->size2; j++)
-            if (tableptr->idx2.cons[j] > ctrans)
-                break;
+	// Allocate the record and the pin's vectors together as one block
+	nvalues = 0;
+	if (testpin->propdelr) nvalues += testpin->propdelr->size1;
+	if (testpin->propdelf) nvalues += testpin->propdelf->size1;
+	if (testpin->transr) nvalues += testpin->transr->size1;
+	if (testpin->transf) nvalues += testpin->transf->size1;
+	vs = (vectorsetptr)arena_alloc(&vectormem, sizeof(vectorset) +
+		nvalues * sizeof(double));
+	vector = (double *)(vs + 1);
+	vs->pin = testpin;
+	vs->loadr = loadr;
+	vs->loadf = loadf;
+	vs->prvector = vs->pfvector = vs->trvector = vs->tfvector = NULL;
+
+	if (testpin->propdelr) {
+	    vs->prvector = table_collapse(testpin->propdelr, loadr, vector);
+	    vector += testpin->propdelr->size1;
+	}
+	if (testpin->propdelf) {
+	    vs->pfvector = table_collapse(testpin->propdelf, loadf, vector);
+	    vector += testpin->propdelf->size1;
+	}
+	if (testpin->transr) {
+	    vs->trvector = table_collapse(testpin->transr, loadr, vector);
+	    vector += testpin->transr->size1;
+	}
+	if (testpin->transf)
+	    vs->tfvector = table_collapse(testpin->transf, loadf, vector);
+
+	// Note which rise/fall table pairs can be evaluated together
+	pairidx = 0;
+	if (testpin->propdelr && testpin->propdelf &&
+		    nldm_same_index(testpin->propdelr->idx1.times,
+		    testpin->propdelr->size1, testpin->propdelf->idx1.times,
+		    testpin->propdelf->size1))
+	    pairidx |= PAIR_DELAY;
+	if (testpin->transr && testpin->transf &&
+		    nldm_same_index(testpin->transr->idx1.times,
+		    testpin->transr->size1, testpin->transf->idx1.times,
+		    testpin->transf->size1))
+	    pairidx |= PAIR_TRANS;
+	testpin->pairidx = pairidx;
+
+	vs->next = vectorbins[h];
+	vectorbins[h] = vs;
+	numvectorsets++;
     }
+    profcount.vectors++;
 
-    // Compute cons transition as a fraction of the nearest table indexes for cons
-
-    cfrac = (ctrans - tableptr->idx2.cons[j - 1]) /
-                        (tableptr->idx2.cons[j] - tableptr->idx2.cons[j - 1]);
+    __atomic_store_n(&testconn->vectors, vs, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&vectorlock);
+    return vs;
+}
 
-    // Interpolate value at cons lower bound
-    vlow = *(tableptr->values + (i - 1) * tableptr->size1 + (j - 1));
-    vhigh = *(tableptr->values + i * tableptr->size1 + (j - 1));
-    valuel = vlow + (vhigh - vlow) * rfrac;
+/*----------------------------------------------------------------------*/
+/* Interpolate or extrapolate a value from a related time vs.           */
+/* constrained time lookup table.                                       */
+/*----------------------------------------------------------------------*/
 
-    // Interpolate value at cons upper bound
-    vlow = *(tableptr->values + (i - 1) * tableptr->size1 + j);
-    vhigh = *(tableptr->values + i * tableptr->size1 + j);
-    valueh = vlow + (vhigh - vlow) * rfrac;
+double binomial_get_value(lutableptr tableptr, double rtrans, double ctrans)
+{
+    /* Tables have been arranged such that idx1 is related time,        */
+    /* idx2 is constrained time (see nldm.c)				*/
 
-    // Final interpolation (binomial interpolation)
-    value = valuel + (valueh - valuel) * cfrac;
-    return value;
+    profcount.nldm++;
+    return nldm_binomial(tableptr->idx1.rel, tableptr->size1, tableptr->idx2.cons,
+		tableptr->size2, tableptr->values, rtrans, ctrans);
 }
 
 /*----------------------------------------------------------------------*/
@@ -896,6 +1820,7 @@ short calc_dir(pinptr testpin, short dir)
 double calc_prop_delay(double trans, connptr testconn, short sense, char minmax)
 {
     pinptr testpin;
+    vectorsetptr vs;
     double propdelayr, propdelayf;
 
     propdelayr = 0.0;
@@ -903,17 +1828,36 @@ double calc_prop_delay(double trans, connptr testconn, short sense, char minmax)
 
     testpin = testconn->refpin;
     if (testpin == NULL) return 0.0;
+    vs = connection_vectors(testconn);
+
+    // If both are needed and the tables share an index, evaluate together
+
+    if ((sense != SENSE_POSITIVE) && (sense != SENSE_NEGATIVE) &&
+		(testpin->pairidx & PAIR_DELAY) && vs->prvector &&
+		vs->pfvector) {
+	nldm_vector_pair(testpin->propdelr->idx1.times, testpin->propdelr->size1,
+		vs->prvector, vs->pfvector, trans,
+		&propdelayr, &propdelayf);
+	profcount.nldm += 2;
+	if (propdelayr < 0.0) propdelayr = 0.0;
+	if (propdelayf < 0.0) propdelayf = 0.0;
+
+	if (minmax == MAXIMUM_TIME)
+	    return (propdelayr > propdelayf) ? propdelayr : propdelayf;
+	else
+	    return (propdelayr < propdelayf) ? propdelayr : propdelayf;
+    }
 
     if (sense != SENSE_NEGATIVE) {
-        if (testconn->prvector)
-            propdelayr = vector_get_value(testpin->propdelr, testconn->prvector, trans);
+        if (vs->prvector)
+            propdelayr = vector_get_value(testpin->propdelr, vs->prvector, trans);
 	if (propdelayr < 0.0) propdelayr = 0.0;
         if (sense == SENSE_POSITIVE) return propdelayr;
     }
 
     if (sense != SENSE_POSITIVE) {
-        if (testconn->pfvector)
-            propdelayf = vector_get_value(testpin->propdelf, testconn->pfvector, trans);
+        if (vs->pfvector)
+            propdelayf = vector_get_value(testpin->propdelf, vs->pfvector, trans);
 	if (propdelayf < 0.0) propdelayf = 0.0;
         if (sense == SENSE_NEGATIVE) return propdelayf;
     }
@@ -934,24 +1878,44 @@ double calc_prop_delay(double trans, connptr testconn, short sense, char minmax)
 double calc_transition(double trans, connptr testconn, short sense, char minmax)
 {
     pinptr testpin;
+    vectorsetptr vs;
     double transr, transf;
 
+    // A module input passes its transition on unchanged
     testpin = testconn->refpin;
-    if (testpin == NULL) return 0.0;
+    if (testpin == NULL) return trans;
+    vs = connection_vectors(testconn);
 
     transr = 0.0;
     transf = 0.0;
 
+    // If both are needed and the tables share an index, evaluate together
+
+    if ((sense != SENSE_POSITIVE) && (sense != SENSE_NEGATIVE) &&
+		(testpin->pairidx & PAIR_TRANS) && vs->trvector &&
+		vs->tfvector) {
+	nldm_vector_pair(testpin->transr->idx1.times, testpin->transr->size1,
+		vs->trvector, vs->tfvector, trans, &transr, &transf);
+	profcount.nldm += 2;
+	if (transr < 0.0) transr = 0.0;
+	if (transf < 0.0) transf = 0.0;
+
+	if (minmax == MAXIMUM_TIME)
+	    return (transr > transf) ? transr : transf;
+	else
+	    return (transr < transf) ? transr : transf;
+    }
+
     if (sense != SENSE_NEGATIVE) {
-        if (testconn->trvector)
-            transr = vector_get_value(testpin->transr, testconn->trvector, trans);
+        if (vs->trvector)
+            transr = vector_get_value(testpin->transr, vs->trvector, trans);
 	if (transr < 0.0) transr = 0.0;
         if (sense == SENSE_POSITIVE) return transr;
     }
 
     if (sense != SENSE_POSITIVE) {
-        if (testconn->tfvector)
-            transf = vector_get_value(testpin->transf, testconn->tfvector, trans);
+        if (vs->tfvector)
+            transf = vector_get_value(testpin->transf, vs->tfvector, trans);
 	if (transf < 0.0) transf = 0.0;
         if (sense == SENSE_NEGATIVE) return transf;
     }
@@ -1056,23 +2020,42 @@ double calc_setup_time(double trans, pinptr testpin, double clktrans, short sens
 /* If mode == 2, return TRUE if the search ended on a		*/
 /* connection found in a mode 1 search.  Otherwise, return	*/
 /* FALSE.							*/
+/*								*/
+/* The search is depth first, on the work stack (one frame for	*/
+/* each connection on the way back from "testlink", see		*/
+/* clock_source_visit()).					*/
+/*--------------------------------------------------------------*/
+
+typedef struct _clockframe {
+   btptr    bt;			/* Backtrace record of the connection */
+   connptr  iinput;		/* Next input of the upstream instance */
+   int      type;		/* Pin type of the inputs to follow (0 = all) */
+   short    dir;
+} clockframe;
+
+/*--------------------------------------------------------------*/
+/* One step of find_clock_source():  add connection "testlink"	*/
+/* to the backtrace "btrace".  If the clock source is found,	*/
+/* add the backtrace to "clocklist";  otherwise push a frame to	*/
+/* follow the inputs of the upstream instance.  Return TRUE if	*/
+/* a mode 2 search has ended.					*/
 /*--------------------------------------------------------------*/
 
 unsigned char
-find_clock_source(connptr testlink, ddataptr *clocklist, btptr btrace, short dir,
-		unsigned char mode)
+clock_source_visit(workstack *ws, connptr testlink, ddataptr *clocklist,
+		btptr btrace, short dir, unsigned char mode)
 {
     netptr clknet;
-    connptr driver, iinput;
+    connptr driver;
     instptr iupstream;
     btptr newclock;
     ddataptr newdataptr;
-    short newdir;
+    clockframe *frame;
     unsigned char result = 0;
 
     /* Add this connection record to the backtrace */
 
-    newclock = (btptr)malloc(sizeof(btdata));
+    newclock = create_btdata(&pathmem);
     newclock->delay = -1.0E50;	/* Initialization constant */
     newclock->trans = 0.0;
     newclock->dir = dir;
@@ -1100,38 +2083,23 @@ find_clock_source(connptr testlink, ddataptr *clocklist, btptr btrace, short dir
     /* If a flop or latch output is reached, add the clock-to-output delay  */
     /* and continue tracing from the DFF clock or LATCH input.		    */
 
-    if (driver->refpin->type & DFFOUT) {
-	for (iinput = driver->refinst->in_connects; iinput; iinput = iinput->next) {
-	    if (iinput->refpin->type & DFFCLK) {
-		newdir = calc_dir(iinput->refpin, dir);
-		result = find_clock_source(iinput, clocklist, newclock, newdir, mode);
-		if (result == (unsigned char)1) return result;
-	    }
-	}
-    }
-    else if (driver->refpin->type & LATCHOUT) {
-	for (iinput = driver->refinst->in_connects; iinput; iinput = iinput->next) {
-	    if (iinput->refpin->type & LATCHIN) {
-		newdir = calc_dir(iinput->refpin, dir);
-		result = find_clock_source(iinput, clocklist, newclock, newdir, mode);
-		if (result == (unsigned char)1) return result;
-	    }
-	}
-    }
-    else {
-	for (iinput = iupstream->in_connects; iinput; iinput = iinput->next) {
-	    newdir = calc_dir(iinput->refpin, dir);
-	    result = find_clock_source(iinput, clocklist, newclock, newdir, mode);
-	    if (result == (unsigned char)1) return result;
-	}
-    }
+    frame = (clockframe *)work_push(ws, sizeof(clockframe));
+    frame->bt = newclock;
+    frame->iinput = iupstream->in_connects;
+    frame->dir = dir;
+    if (driver->refpin->type & DFFOUT)
+	frame->type = DFFCLK;
+    else if (driver->refpin->type & LATCHOUT)
+	frame->type = LATCHIN;
+    else
+	frame->type = 0;
     return (unsigned char)0;
     
 makehead:
     /* Reached the head of a clock tree, so save the position	*/
     /* in the list of backtraces.				*/
 
-    newdataptr = (ddataptr)malloc(sizeof(delaydata));
+    newdataptr = create_delaydata(&pathmem);
     newdataptr->backtrace = newclock;
     if (newclock) newclock->refcnt++;
     newdataptr->delay = 0.0;
@@ -1144,6 +2112,37 @@ makehead:
     return result;
 }
 
+unsigned char
+find_clock_source(connptr testlink, ddataptr *clocklist, btptr btrace, short dir,
+		unsigned char mode)
+{
+    workstack *ws = &workmem;
+    clockframe *frame;
+    connptr iinput;
+    size_t base;
+    short newdir;
+    unsigned char result;
+
+    base = ws->top;
+    result = clock_source_visit(ws, testlink, clocklist, btrace, dir, mode);
+
+    while ((result == (unsigned char)0) && (ws->top > base)) {
+	frame = (clockframe *)work_top(ws, sizeof(clockframe));
+	for (iinput = frame->iinput; iinput; iinput = iinput->next)
+	    if ((frame->type == 0) || (iinput->refpin->type & frame->type))
+		break;
+	if (iinput == NULL) {
+	    work_pop(ws, sizeof(clockframe));
+	    continue;
+	}
+	frame->iinput = iinput->next;
+	newdir = calc_dir(iinput->refpin, frame->dir);
+	result = clock_source_visit(ws, iinput, clocklist, frame->bt, newdir, mode);
+    }
+    ws->top = base;
+    return result;
+}
+
 /*--------------------------------------------------------------*/
 /* Determine the delay to a clock pin from the farthest point   */
 /* back in the network, either to an input pin or the output of */
@@ -1154,121 +2153,224 @@ makehead:
 /* recorded (it is only necessary to find a common root of all  */
 /* other related clocks downstream).                            */
 /*                                                              */
-/* This is a recursive routine, continuing to find all delays   */
-/* through the circuit until it reaches "terminal".  The        */
-/* "delaylist" linked list is not modified by this routine.     */
-/* However, it depends on routine find_clock_source marking	*/
-/* each connection as visited, so that the search is restricted	*/
-/* to the space visited on the upstream search, so it is not	*/
-/* blindly recursive.						*/
+/* The search continues to find all delays through the circuit	*/
+/* until it reaches "terminal", taking each rising and falling	*/
+/* step from the work stack in turn, as a recursive search	*/
+/* would.  The "delaylist" linked list is not modified by this	*/
+/* routine.  However, it depends on routine find_clock_source	*/
+/* marking each connection as visited, so that the search is	*/
+/* restricted to the space visited on the upstream search, so	*/
+/* it is not blindly recursive.					*/
 /*--------------------------------------------------------------*/
 
+typedef struct _clkdelayframe {
+   btptr    backtrace;		/* Backtrace record reached */
+   double   delay;
+   double   trans;
+   int      dir;
+} clkdelayframe;
+
 void find_clock_delay(int dir, double delay, double trans,
                 btptr backtrace, connptr terminal, char minmax,
 		unsigned char mode) {
 
     pinptr  testpin;
-    netptr  loadnet;
     cellptr testcell;
     connptr receiver;
-    connptr nextrcvr;
-    instptr testinst;
-    btptr   testbtdata, newbtdata;
+    workstack *ws = &workmem;
+    clkdelayframe *frame;
     double  newdelayr, newdelayf, newtransr, newtransf;
     short   outdir;
-    int     i;
+    size_t  base;
+
+    base = ws->top;
+    frame = (clkdelayframe *)work_push(ws, sizeof(clkdelayframe));
+    frame->backtrace = backtrace;
+    frame->delay = delay;
+    frame->trans = trans;
+    frame->dir = dir;
+
+    while (ws->top > base) {
+	frame = (clkdelayframe *)work_top(ws, sizeof(clkdelayframe));
+	backtrace = frame->backtrace;
+	delay = frame->delay;
+	trans = frame->trans;
+	dir = frame->dir;
+	work_pop(ws, sizeof(clkdelayframe));
+
+	receiver = backtrace->receiver;
+
+	if (minmax == MAXIMUM_TIME) {
+	    /* Is delay greater than that already recorded?  If so, replace it */
+	    if ((delay > backtrace->delay) || (backtrace->delay == INITVAL)) {
+		backtrace->delay = delay;
+		backtrace->trans = trans;
+		backtrace->dir = dir;
+	    }
+	}
+	else {
+	    /* Is delay less than that already recorded?  If so, replace it */
+	    if ((delay < backtrace->delay) || (backtrace->delay == INITVAL)) {
+		backtrace->delay = delay;
+		backtrace->trans = trans;
+		backtrace->dir = dir;
+	    }
+	}
 
-    receiver = backtrace->receiver;
+	// Stop when receiver matches terminal.
 
-    if (minmax == MAXIMUM_TIME) {
-        /* Is delay greater than that already recorded?  If so, replace it */
-        if ((delay > backtrace->delay) || (backtrace->delay == INITVAL)) {
-            backtrace->delay = delay;
-            backtrace->trans = trans;
-            backtrace->dir = dir;
-        }
-    }
-    else {
-        /* Is delay less than that already recorded?  If so, replace it */
-        if ((delay < backtrace->delay) || (backtrace->delay == INITVAL)) {
-            backtrace->delay = delay;
-            backtrace->trans = trans;
-            backtrace->dir = dir;
-        }
-    }
-
-    // Stop when receiver matches terminal.
-
-    if (receiver != terminal) {
+	if (receiver == terminal) continue;
 
-        // Don't follow signal through any DFF pins
+	// Don't follow signal through any DFF pins
 	testpin = receiver->refpin;
-        testinst = receiver->refinst;
-        testcell = (testpin) ? testpin->refcell : NULL;
-        if (testcell && (testcell->type & DFF)) return;
+	testcell = (testpin) ? testpin->refcell : NULL;
+	if (testcell && (testcell->type & DFF)) continue;
 
-        // Compute delay from gate input to output
+	// Compute delay from gate input to output
 
-        outdir = calc_dir(testpin, dir);
-        if (outdir & RISING) {
-            newdelayr = backtrace->delay +
+	outdir = calc_dir(testpin, dir);
+	if (outdir & RISING) {
+	    newdelayr = backtrace->delay +
 			calc_prop_delay(trans, receiver, RISING, minmax);
-            newtransr = calc_transition(trans, receiver, RISING, minmax);
-        }
-        if (outdir & FALLING) {
-            newdelayf = backtrace->delay +
+	    newtransr = calc_transition(trans, receiver, RISING, minmax);
+	}
+	if (outdir & FALLING) {
+	    newdelayf = backtrace->delay +
 			calc_prop_delay(trans, receiver, FALLING, minmax);
-            newtransf = calc_transition(trans, receiver, FALLING, minmax);
-        }
+	    newtransf = calc_transition(trans, receiver, FALLING, minmax);
+	}
 
-        /* Continue calculating down the backtrace */
+	/* Continue calculating down the backtrace, rising first */
 
-	if (outdir & RISING)
-	    find_clock_delay(RISING, newdelayr, newtransr, backtrace->next,
-			terminal, minmax, mode);
-	if (outdir & FALLING)
-	    find_clock_delay(FALLING, newdelayf, newtransf, backtrace->next,
-			terminal, minmax, mode);
+	if (outdir & FALLING) {
+	    frame = (clkdelayframe *)work_push(ws, sizeof(clkdelayframe));
+	    frame->backtrace = backtrace->next;
+	    frame->delay = newdelayf;
+	    frame->trans = newtransf;
+	    frame->dir = FALLING;
+	}
+	if (outdir & RISING) {
+	    frame = (clkdelayframe *)work_push(ws, sizeof(clkdelayframe));
+	    frame->backtrace = backtrace->next;
+	    frame->delay = newdelayr;
+	    frame->trans = newtransr;
+	    frame->dir = RISING;
+	}
     }
 }
 
+/*--------------------------------------------------------------*/
+/* Return 1 if connection "testconn" (of an instance input)	*/
+/* propagates a signal through its gate, that is, if it is not	*/
+/* a register input or an input without timing information.	*/
+/*--------------------------------------------------------------*/
+
+int
+conn_is_through(connptr testconn)
+{
+    return (testconn->refinst && testconn->refpin &&
+		!(testconn->refpin->type & REGISTER_IN)) ? 1 : 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the net driven through connection "testconn" (the	*/
+/* output of its instance, or the net of a module input), or	*/
+/* NULL if there is none.					*/
+/*--------------------------------------------------------------*/
+
+netptr
+conn_load_net(connptr testconn)
+{
+    instptr testinst = testconn->refinst;
+
+    if (testinst == NULL) return testconn->refnet;
+    if (testinst->out_connects == NULL) return NULL;
+    return testinst->out_connects->refnet;
+}
+
 /*--------------------------------------------------------------*/
 /* Determine the delay from input to output through a gate      */
 /*                                                              */
-/* This is a recursive routine, continuing to find all delays   */
-/* through the circuit until it reaches a terminal or flop      */
-/* input.  It is similar to find_clock_delay, but stops on all  */
-/* terminal points found in the path, rather than stopping on   */
-/* a specific connection.                                       */
+/* The search continues to find all delays through the circuit	*/
+/* until it reaches a terminal or flop input.  It is similar to	*/
+/* find_clock_delay, but stops on all terminal points found in	*/
+/* the path, rather than stopping on a specific connection.	*/
 /*                                                              */
 /* Also unlike find_clock_delay, the routine keeps a running    */
 /* record of the path followed from the source, as a character  */
 /* string.  When a terminal is found, the path and delay are    */
-/* saved and added to "delaylist".  After the recursive search, */
+/* saved and added to "delaylist".  After the search,		*/
 /* "delaylist" contains a list of all paths starting from the   */
 /* original connection "receiver" and ending on a clock or an   */
 /* output pin.  Where multiple paths exist between source and   */
 /* destination, only the path with the longest delay is kept.   */
 /*                                                              */
+/* The search is depth first, on the work stack:  a frame is	*/
+/* kept for each gate on the path from "receiver" (see		*/
+/* path_delay_visit()), and the fanout of the gate output is	*/
+/* taken from it in turn, rising before falling.		*/
+/*                                                              */
+/* If "search" is non-NULL, the delay metric and tag are kept   */
+/* in the search state instead of in the connection record, so  */
+/* that several searches may run at once.                       */
+/*                                                              */
 /* Return the number of new paths recorded.                     */
 /*--------------------------------------------------------------*/
 
-int find_path_delay(int dir, double delay, double trans, connptr receiver,
-                btptr backtrace, ddataptr *delaylist, char minmax) {
+typedef struct _pathframe {
+   connptr  receiver;		/* Gate input reached */
+   btptr    btdata;		/* Backtrace record of the receiver */
+   double   delay;		/* Delay at the receiver */
+   double   newdelay[2];	/* Delay at the gate output, rising and falling */
+   double   newtrans[2];	/* Transition at the gate output */
+   double   *metric;		/* Delay metric of the receiver */
+   ddataptr *tag;		/* Tag of the receiver */
+   netptr   loadnet;		/* Net driven by the gate, or NULL */
+   int      next;		/* Next fanout edge, times two (+1 falling) */
+   short    outdir;
+} pathframe;
+
+/*--------------------------------------------------------------*/
+/* One step of find_path_delay():  reach connection "receiver"	*/
+/* with delay "delay" and transition "trans" from the path	*/
+/* "backtrace".  An endpoint is recorded in "delaylist" at	*/
+/* once;  for a gate input, a frame is pushed on "ws" to follow	*/
+/* the gate's fanout.  Return the number of new paths recorded.	*/
+/*--------------------------------------------------------------*/
+
+int path_delay_visit(workstack *ws, int dir, double delay, double trans,
+		connptr receiver, btptr backtrace, ddataptr *delaylist,
+		char minmax, searchptr search) {
 
     pinptr   testpin;
-    netptr   loadnet;
-    cellptr  testcell;
     instptr  testinst;
-    btptr    newbtdata, freebt, testbt;
+    btptr    newbtdata, freebt;
     ddataptr testddata, newddata;
-    double   newdelayr, newdelayf, newtransr, newtransf;
-    short    outdir;
+    pathframe *frame;
     char     replace;
-    int      i, numpaths;
+    int      n, numpaths;
+    double   *metric;
+    ddataptr *tag;
+    pathpool *pool;
 
     numpaths = 0;
     testpin = receiver->refpin;
+    pool = (search) ? search->pool : &pathmem;
+
+    if (search) {
+	n = receiver->index;
+	if (search->stamp[n] != search->current) {
+	    search->stamp[n] = search->current;
+	    search->metric[n] = (minmax == MAXIMUM_TIME) ? -1.0 : 1E50;
+	    search->tag[n] = NULL;
+	}
+	metric = &search->metric[n];
+	tag = &search->tag[n];
+    }
+    else {
+	metric = &receiver->metric;
+	tag = &receiver->tag;
+    }
 
     // Prevent exhaustive search by stopping on a metric.  Note that the
     // nonlinear table-based delay data requires an exhaustive search;
@@ -1280,27 +2382,43 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
     // metric is to use only the delay.  Any relaxing of the metric
     // implies that the final result may not be the absolute maximum delay,
     // although it will typically vary by less than an average gate delay.
+    // (With option -e, find_path_frontier() is used instead.)
+
+    // Paths do not leave the cone of influence of options -T and -F.
 
+    if (conemask && (receiver->index >= 0) && !conemask[receiver->index])
+        return numpaths;
+
+    profcount.visits++;
     if (!exhaustive) {
         if (minmax == MAXIMUM_TIME) {
-            if (delay <= receiver->metric)
+            if (delay <= *metric) {
+                profcount.pruned++;
                 return numpaths;
+            }
         }
         else {
-            if (delay >= receiver->metric)
+            if (delay >= *metric) {
+                profcount.pruned++;
                 return numpaths;
+            }
         }
     }
 
-    // Check for a logic loop, and truncate the path to avoid infinite
-    // looping in the path search.
+    // Logic loops are broken where find_logic_loops() found them, by
+    // not following the edges back into the loop (see find_path_delay()).
+    // Only the start point is marked, so that a path back into its own
+    // clock is not followed.
 
-    if (receiver->tag == (ddataptr)(-1)) return numpaths;
-    else if (receiver->tag == NULL) receiver->tag = (ddataptr)(-1);
+    if (*tag == (ddataptr)(-1)) {
+        profcount.pruned++;
+        return numpaths;
+    }
+    else if ((backtrace == NULL) && (*tag == NULL)) *tag = (ddataptr)(-1);
 
     // Record this position and delay/transition information
 
-    newbtdata = (btptr)malloc(sizeof(btdata));
+    newbtdata = create_btdata(pool);
     newbtdata->receiver = receiver;
     newbtdata->delay = delay + newbtdata->receiver->icDelay;
     newbtdata->trans = trans;
@@ -1316,99 +2434,151 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
     if ((backtrace == NULL) || (testpin && ((testpin->type & REGISTER_IN) == 0))) {
 
         testinst = receiver->refinst;
-        testcell = (testpin) ? testpin->refcell : NULL;
 
-        // Compute delay from gate input to output
-
-        outdir = calc_dir(testpin, dir);
-        if (outdir & RISING) {
-            newdelayr = delay + calc_prop_delay(trans, receiver, RISING, minmax);
-            newtransr = calc_transition(trans, receiver, RISING, minmax);
+        // Compute delay from gate input to output, and leave the
+        // fanout to find_path_delay().  The metric and tag are set
+        // and the record released when the frame is taken off.
+
+	frame = (pathframe *)work_push(ws, sizeof(pathframe));
+	frame->receiver = receiver;
+	frame->btdata = newbtdata;
+	frame->delay = delay;
+	frame->metric = metric;
+	frame->tag = tag;
+	frame->next = 0;
+        frame->outdir = calc_dir(testpin, dir);
+        if (frame->outdir & RISING) {
+            frame->newdelay[0] = delay + calc_prop_delay(trans, receiver, RISING, minmax);
+            frame->newtrans[0] = calc_transition(trans, receiver, RISING, minmax);
         }
-        if (outdir & FALLING) {
-            newdelayf = delay + calc_prop_delay(trans, receiver, FALLING, minmax);
-            newtransf = calc_transition(trans, receiver, FALLING, minmax);
+        if (frame->outdir & FALLING) {
+            frame->newdelay[1] = delay + calc_prop_delay(trans, receiver, FALLING, minmax);
+            frame->newtrans[1] = calc_transition(trans, receiver, FALLING, minmax);
         }
 
-	if (!testinst || testinst->out_connects) {
-	    loadnet = (testinst) ?  testinst->out_connects->refnet : receiver->refnet;
-	    for (i = 0; i < loadnet->fanout; i++) {
-		if (outdir & RISING)
-		    numpaths += find_path_delay(RISING, newdelayr, newtransr,
-				loadnet->receivers[i], newbtdata, delaylist, minmax);
-		if (outdir & FALLING)
-		    numpaths += find_path_delay(FALLING, newdelayf, newtransf,
-				loadnet->receivers[i], newbtdata, delaylist, minmax);
-	    }
-	}
-        receiver->tag = NULL;
+	if (!testinst || testinst->out_connects)
+	    frame->loadnet = (testinst) ?  testinst->out_connects->refnet :
+			receiver->refnet;
+	else
+	    frame->loadnet = NULL;
+	return numpaths;
     }
-    else {
 
-        /* Is receiver already in delaylist? */
-        if ((receiver->tag != (ddataptr)(-1)) && (receiver->tag != NULL)) {
+    /* Is receiver already in delaylist? */
+    if ((*tag != (ddataptr)(-1)) && (*tag != NULL)) {
 
-            /* Position in delaylist is recorded in tag field */
-            testddata = receiver->tag;
+        /* Position in delaylist is recorded in tag field */
+        testddata = *tag;
 
-            if (testddata->backtrace->receiver == receiver) {
-                replace = 0;
-                if (minmax == MAXIMUM_TIME) {
-                    /* Is delay greater than that already recorded?  If so, replace it */
-                    if (delay > testddata->backtrace->delay)
-                        replace = 1;
-                }
-                else {
-                    /* Is delay less than that already recorded?  If so, replace it */
-                    if (delay < testddata->backtrace->delay)
-                        replace = 1;
+        if (testddata->backtrace->receiver == receiver) {
+            replace = 0;
+            if (minmax == MAXIMUM_TIME) {
+                /* Is delay greater than that already recorded?  If so, replace it */
+                if (delay > testddata->backtrace->delay)
+                    replace = 1;
+            }
+            else {
+                /* Is delay less than that already recorded?  If so, replace it */
+                if (delay < testddata->backtrace->delay)
+                    replace = 1;
+            }
+            if (replace) {
+
+                /* Remove the existing path record and replace it */
+                while (testddata->backtrace != NULL) {
+                    freebt = testddata->backtrace;
+                    testddata->backtrace = testddata->backtrace->next;
+                    freebt->refcnt--;
+                    if (freebt->refcnt == 0) release_btdata(pool, freebt);
+		    else break;
                 }
-                if (replace) {
-
-                    /* Remove the existing path record and replace it */
-                    while (testddata->backtrace != NULL) {
-                        freebt = testddata->backtrace;
-                        testddata->backtrace = testddata->backtrace->next;
-                        freebt->refcnt--;
-                        if (freebt->refcnt == 0) free(freebt);
-			else break;
-                    }
-                    testddata->backtrace = newbtdata;
-		    if (newbtdata) newbtdata->refcnt++;
+                testddata->backtrace = newbtdata;
+		if (newbtdata) newbtdata->refcnt++;
 
-		    /* Update the delay at testddata */
-		    testddata->delay = newbtdata->delay + testddata->setup
+		/* Update the delay at testddata */
+		testddata->delay = newbtdata->delay + testddata->setup
 				+ testddata->skew;
-                }
             }
-            else
-                fprintf(stderr, "ERROR:  Bad endpoint tag!\n");
         }
         else
-            testddata = NULL;
-
-        // If we have found a propagation path from source to dest,
-        // record it in delaylist.
-
-        if (testddata == NULL) {
-            numpaths++;
-            newddata = (ddataptr)malloc(sizeof(delaydata));
-            newddata->delay = 0.0;
-            newddata->setup = 0.0;
-            newddata->skew = 0.0;
-            newddata->trans = 0.0;
-            newddata->backtrace = newbtdata;
-	    if (newbtdata) newbtdata->refcnt++;
-            newddata->next = *delaylist;
-            *delaylist = newddata;
-
-            /* Mark the receiver as having been visited */
-            receiver->tag = *delaylist;
-        }
+            fprintf(stderr, "ERROR:  Bad endpoint tag!\n");
+    }
+    else
+        testddata = NULL;
+
+    // If we have found a propagation path from source to dest,
+    // record it in delaylist.
+
+    if (testddata == NULL) {
+        numpaths++;
+        newddata = create_delaydata(pool);
+        newddata->delay = 0.0;
+        newddata->setup = 0.0;
+        newddata->skew = 0.0;
+        newddata->trans = 0.0;
+        newddata->backtrace = newbtdata;
+	if (newbtdata) newbtdata->refcnt++;
+        newddata->next = *delaylist;
+        *delaylist = newddata;
+
+        /* Mark the receiver as having been visited */
+        *tag = *delaylist;
     }
 
-    receiver->metric = delay;
-    if (newbtdata->refcnt <= 0) free(newbtdata);
+    *metric = delay;
+    if (newbtdata->refcnt <= 0) release_btdata(pool, newbtdata);
+    return numpaths;
+}
+
+int find_path_delay(int dir, double delay, double trans, connptr receiver,
+                btptr backtrace, ddataptr *delaylist, char minmax,
+		searchptr search) {
+
+    workstack *ws = &workmem;
+    pathframe *frame;
+    connptr  rcvr;
+    netptr   loadnet;
+    pathpool *pool;
+    size_t   base;
+    int      i, numpaths, newdir;
+
+    pool = (search) ? search->pool : &pathmem;
+    base = ws->top;
+    numpaths = path_delay_visit(ws, dir, delay, trans, receiver, backtrace,
+		delaylist, minmax, search);
+
+    while (ws->top > base) {
+	frame = (pathframe *)work_top(ws, sizeof(pathframe));
+	loadnet = frame->loadnet;
+
+	if ((loadnet == NULL) || (frame->next >= 2 * loadnet->fanout)) {
+	    /* Fanout done */
+	    *frame->tag = NULL;
+	    *frame->metric = frame->delay;
+	    if (frame->btdata->refcnt <= 0) release_btdata(pool, frame->btdata);
+	    work_pop(ws, sizeof(pathframe));
+	    continue;
+	}
+
+	i = frame->next >> 1;
+	newdir = (frame->next & 1) ? FALLING : RISING;
+	rcvr = loadnet->receivers[i];
+
+	// Logic loops are broken by not following an edge back into
+	// the loop, to a connection earlier in the order found by
+	// find_logic_loops().
+
+	if (conn_is_through(rcvr) &&
+		(connorder[rcvr->index] <= connorder[frame->receiver->index])) {
+	    frame->next = 2 * (i + 1);
+	    continue;
+	}
+	frame->next++;
+	if (frame->outdir & newdir)
+	    numpaths += path_delay_visit(ws, newdir, frame->newdelay[newdir == FALLING],
+			frame->newtrans[newdir == FALLING], rcvr, frame->btdata,
+			delaylist, minmax, search);
+    }
     return numpaths;
 }
 
@@ -1492,29 +2662,54 @@ connptr find_register_clock(instptr testinst)
 /*--------------------------------------------------------------*/
 /* Given an edge direction (RISING or FALLING) at a source net, */
 /* and given a destination net, find the sense of the signal    */
-/* when it arrives at the destination net.                      */
+/* when it arrives at the destination net.  The search is depth	*/
+/* first, with a frame on the work stack for each net.		*/
 /*--------------------------------------------------------------*/
 
+typedef struct _edgeframe {
+   netptr   net;
+   int      next;		/* Next receiver of the net */
+   short    dir;		/* Signal sense on the net */
+} edgeframe;
+
 short find_edge_dir(short dir, netptr sourcenet, netptr destnet) {
-    int i;
-    short outdir, rdir;
+    short outdir;
     connptr testconn, nextconn;
     instptr testinst;
     netptr nextnet;
-
-    for (i = 0; i < sourcenet->fanout; i++) {
-        testconn = sourcenet->receivers[i];
+    workstack *ws = &workmem;
+    edgeframe *frame;
+    size_t base;
+
+    base = ws->top;
+    frame = (edgeframe *)work_push(ws, sizeof(edgeframe));
+    frame->net = sourcenet;
+    frame->next = 0;
+    frame->dir = dir;
+
+    while (ws->top > base) {
+	frame = (edgeframe *)work_top(ws, sizeof(edgeframe));
+	if (frame->next >= frame->net->fanout) {
+	    work_pop(ws, sizeof(edgeframe));
+	    continue;
+	}
+        testconn = frame->net->receivers[frame->next++];
         testinst = testconn->refinst;
         if (testinst == NULL) continue;
         if (testconn->refpin == NULL) continue;
         if ((testconn->refpin->type & REGISTER_IN) != 0) continue;
         nextconn = testinst->out_connects;
         nextnet  = nextconn->refnet;
-        outdir = calc_dir(testconn->refpin, dir);
-        if (nextnet == destnet) return outdir;
+        outdir = calc_dir(testconn->refpin, frame->dir);
+        if (nextnet == destnet) {
+	    ws->top = base;
+	    return outdir;
+	}
 
-        rdir = find_edge_dir(outdir, nextnet, destnet);
-        if (rdir != 0) return rdir;
+	frame = (edgeframe *)work_push(ws, sizeof(edgeframe));
+	frame->net = nextnet;
+	frame->next = 0;
+	frame->dir = outdir;
     }
     return 0;
 }
@@ -1544,8 +2739,9 @@ reset_all(netptr netlist, char minmax)
 
 /*--------------------------------------------------------------*/
 /* Reset all entries in the feed-forward tree from connection	*/
-/* testconn (recursively).  Resets the tag entry, "visited"	*/
-/* flag, and stop metric.					*/
+/* testconn.  Resets the tag entry, "visited" flag, and stop	*/
+/* metric.  Connections still to be reset are kept on the work	*/
+/* stack;  the reset stops at connections with no tag.		*/
 /*--------------------------------------------------------------*/
 
 void
@@ -1555,2221 +2751,8879 @@ reset_path(connptr testconn, double metric)
     instptr testinst;
     netptr loadnet;
     connptr nextconn;
+    workstack *ws = &workmem;
+    size_t base;
+
+    base = ws->top;
+    *(connptr *)work_push(ws, sizeof(connptr)) = testconn;
+
+    while (ws->top > base) {
+	nextconn = *(connptr *)work_top(ws, sizeof(connptr));
+	work_pop(ws, sizeof(connptr));
+
+	// Already reset from another path
+	if ((nextconn != testconn) && (nextconn->tag == NULL)) continue;
 
-    testconn->tag = NULL;
-    testconn->visited = (unsigned char)0;
-    testconn->metric = metric;
+	nextconn->tag = NULL;
+	nextconn->visited = (unsigned char)0;
+	nextconn->metric = metric;
 
-    testinst = testconn->refinst;
-    loadnet = (testinst) ? testinst->out_connects->refnet : testconn->refnet;
+	testinst = nextconn->refinst;
+	loadnet = (testinst) ? testinst->out_connects->refnet : nextconn->refnet;
 
-    for (i = 0; i < loadnet->fanout; i++) {
-	nextconn = loadnet->receivers[i];
-	if (nextconn->tag != NULL)
-	    reset_path(loadnet->receivers[i], metric);
+	for (i = loadnet->fanout - 1; i >= 0; i--)
+	    if (loadnet->receivers[i]->tag != NULL)
+		*(connptr *)work_push(ws, sizeof(connptr)) = loadnet->receivers[i];
     }
 }
 
 /*--------------------------------------------------------------*/
-/* Search all paths from the clocked data outputs of            */
-/* "clockedlist" to either output pins or data inputs of other  */
-/* flops.                                                       */
-/*                                                              */
-/* Return a master list of all backtraces in "masterlist".      */
-/*                                                              */
-/* Return value is the number of paths recorded in masterlist.  */
-/*                                                              */
-/* If minmax == MAXIMUM_TIME, return the maximum delay.         */
-/* If minmax == MINIMUM_TIME, return the minimum delay.         */
+/* Equivalent of reset_path() for the search state of a thread.	*/
+/* The "visited" flag is shared and is not touched.		*/
 /*--------------------------------------------------------------*/
 
-int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netptr netlist,
-                char minmax)
+void
+reset_search(searchptr search, connptr testconn, double metric)
 {
-    netptr      testnet;
-    connptr     testconn, thisconn;
-    connlistptr testlink;
-    pinptr      testpin;
-    cellptr     testcell;
-    instptr     testinst;
-    btptr       backtrace, freebt;
-    ddataptr    delaylist, testddata, freeddata;
-
-    short       srcdir, destdir;             // Signal direction in/out
-    double      tdriver, setupdelay, holddelay, ddelay;
-    int         numpaths, n, i, t, j;
-    unsigned char result;
-
-    delaylist = NULL;
-
-    t = j = 0;
-    if (verbose > 0) {
-        for (testlink = clockedlist; testlink; testlink = testlink->next) 
-	    t++;
-	fprintf(stdout, "Length of list of clocked nets = %d\n", t); 	
-	fflush(stdout);
-    }
-
-    numpaths = 0;
-    for (testlink = clockedlist; testlink; testlink = testlink->next) {
-	if (verbose > 0) {
-	    j++;
-	    if ((j % 100) == 0) {
-		fprintf(stdout, "Completed %d traces (%3.1f%%).\n",
-			j, 100.0 * ((float)j / (float)t));
-		fflush(stdout);
-	    }
-	}
-
-        // Remove all tags and reset delay metrics in testlink tree
-	// before each run
-
-	reset_path(testlink->connection, (minmax == MAXIMUM_TIME) ? -1.0 : 1E50);
-
-        thisconn = testlink->connection;
-        testpin = thisconn->refpin;
-        if (testpin) {
-            testcell = testpin->refcell;
-
-            // Sense is positive for rising edge-triggered flops, negative for
-            // falling edge-triggered flops
-            srcdir = (testcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
-
-            // Report on paths and their maximum delays
-            if (verbose > 1)
-                fprintf(stdout, "Paths starting at flop \"%s\" clock:\n\n",
-                                thisconn->refinst->name);
-        }
-        else {
-            // Connection is an input pin;  must calculate both rising and falling edges.
-            srcdir = EITHER;
-
-            // Report on paths and their maximum delays
-            if (verbose > 1)
-                fprintf(stdout, "Paths starting at input pin \"%s\"\n\n",
-                                thisconn->refnet->name);
-        }
+    int i, n;
+    instptr testinst;
+    netptr loadnet;
+    connptr nextconn;
+    workstack *ws = &workmem;
+    size_t base;
 
-        if (verbose > 1) fflush(stdout);
+    base = ws->top;
+    *(connptr *)work_push(ws, sizeof(connptr)) = testconn;
 
-        // Find all paths from "thisconn" to output or a flop input, and compute delay
-        n = find_path_delay(srcdir, 0.0, 0.0, thisconn, NULL, &delaylist, minmax);
-        numpaths += n;
+    while (ws->top > base) {
+	nextconn = *(connptr *)work_top(ws, sizeof(connptr));
+	work_pop(ws, sizeof(connptr));
 
-        if (verbose > 1) fprintf(stdout, "%d paths traced (%d total).\n\n", n, numpaths);
+	// Already reset from another path
+	n = nextconn->index;
+	if ((nextconn != testconn) && ((search->stamp[n] != search->current) ||
+		(search->tag[n] == NULL)))
+	    continue;
 
-        // Link delaylist data to the beginning of masterlist, and null out
-        // delaylist for the next set of paths.
+	search->stamp[n] = search->current;
+	search->tag[n] = NULL;
+	search->metric[n] = metric;
 
-        if (delaylist) {
-            for (testddata = delaylist; testddata->next; testddata = testddata->next);
-            testddata->next = *masterlist;
-            *masterlist = delaylist;
-            delaylist = NULL;
-        }
+	testinst = nextconn->refinst;
+	loadnet = (testinst) ? testinst->out_connects->refnet : nextconn->refnet;
 
+	for (i = loadnet->fanout - 1; i >= 0; i--) {
+	    n = loadnet->receivers[i]->index;
+	    if ((search->stamp[n] == search->current) && (search->tag[n] != NULL))
+		*(connptr *)work_push(ws, sizeof(connptr)) = loadnet->receivers[i];
+	}
     }
-    return numpaths;
 }
 
 /*--------------------------------------------------------------*/
-/* A version of strcasecmp() with a built-in check for		*/
-/* surrounding quotes (which are ignored).  Quotes are only	*/
-/* checked in str1.						*/
+/* Drop one reference to backtrace "bt", releasing each record	*/
+/* along the path that is no longer referenced.			*/
 /*--------------------------------------------------------------*/
 
-int
-tokencasecmp(char *str1, char *str2)
+void
+release_backtrace(pathpool *pool, btptr bt)
 {
-    char *ss1, *sf1;
-    int result;
-
-    ss1 = str1;
-    sf1 = NULL;
-    while (*ss1 == '\"') ss1++;
-    if (ss1 != str1) {
-        sf1 = ss1 + 1;
-	while (*sf1 && (*sf1 != '\"')) sf1++;
-	if (*sf1 == '\"')
-	    *sf1 = '\0';
-	else
-	    sf1 = NULL;
+    btptr nextbt;
+
+    while (bt != NULL) {
+	bt->refcnt--;
+	if (bt->refcnt > 0) break;
+	nextbt = bt->next;
+	release_btdata(pool, bt);
+	bt = nextbt;
     }
+}
 
-    result = strcasecmp(ss1, str2);
+/*--------------------------------------------------------------*/
+/* Allocate and release the arrays of a Pareto frontier for	*/
+/* the nodes of timing graph "graph".  Path records are		*/
+/* allocated from "pool".					*/
+/*--------------------------------------------------------------*/
 
-    if (sf1 != NULL) *sf1 = '\"';
+void
+frontier_init(frontptr front, tgraphptr graph, pathpool *pool)
+{
+    front->head = (int *)malloc(graph->numnodes * sizeof(int));
+    front->stamp = (unsigned int *)calloc(graph->numnodes, sizeof(unsigned int));
+    front->queued = (unsigned int *)calloc(graph->numnodes, sizeof(unsigned int));
+    front->current = 1;
+    front->touched = (int *)malloc(graph->numnodes * sizeof(int));
+    front->numtouched = 0;
+    front->heap = (int *)malloc((graph->numorder + 1) * sizeof(int));
+    front->maxpoints = 256;
+    front->points = (paretopoint *)malloc(front->maxpoints * sizeof(paretopoint));
+    front->numpoints = 0;
+    front->freelist = -1;
+    front->pool = pool;
+}
 
-    return result;
+void
+frontier_free(frontptr front)
+{
+    free(front->head);
+    free(front->stamp);
+    free(front->queued);
+    free(front->touched);
+    free(front->heap);
+    free(front->points);
 }
 
 /*--------------------------------------------------------------*/
-/* Parse a table variable type from a liberty format file       */
+/* Empty the frontier, dropping the references held by its	*/
+/* points.  "numnodes" is the size of the stamp arrays.		*/
 /*--------------------------------------------------------------*/
 
-int get_table_type(char *token) {
-    if (!tokencasecmp(token, "input_net_transition"))
-        return TRANSITION_TIME;
-    else if (!tokencasecmp(token, "total_output_net_capacitance"))
-        return OUTPUT_CAP;
-    else if (!tokencasecmp(token, "related_pin_transition"))
-        return RELATED_TIME;
-    else if (!tokencasecmp(token, "constrained_pin_transition"))
-        return CONSTRAINED_TIME;
-    else
-        return UNKNOWN;
+void
+frontier_reset(frontptr front, int numnodes)
+{
+    int i, p;
+
+    for (i = 0; i < front->numtouched; i++)
+	for (p = front->head[front->touched[i]]; p >= 0; p = front->points[p].next)
+	    release_backtrace(front->pool, front->points[p].backtrace);
+
+    front->numtouched = 0;
+    front->numpoints = 0;
+    front->freelist = -1;
+    front->current++;
+    if (front->current == 0) {
+	/* Stamp wrapped around;  clear all stamps */
+	memset(front->stamp, 0, numnodes * sizeof(unsigned int));
+	memset(front->queued, 0, numnodes * sizeof(unsigned int));
+	front->current = 1;
+    }
 }
 
 /*--------------------------------------------------------------*/
-/* Expand a bus into individual pins.				*/
+/* Add an arrival to the frontier at node "n".  If an arrival	*/
+/* already there in the same direction dominates it (has delay	*/
+/* and transition time at least as large for maximum delay, or	*/
+/* at least as small for minimum delay), return -1.  Otherwise,	*/
+/* remove the arrivals that the new one dominates, add it, and	*/
+/* return the index of its point.  The caller sets the		*/
+/* backtrace of the new point.					*/
 /*--------------------------------------------------------------*/
 
-void
-expand_buses(pin *curpin, bus *curbus, char *busformat)
+int
+frontier_add(frontptr front, int n, short dir, double delay, double trans,
+	char minmax)
 {
-    pin *newpin;
-    char *rootname;
-    int low, high, i;
-    char busbit[1024];
+    int p, *prev;
+    paretopoint *pt;
 
-    rootname = curpin->name;
+    if (front->stamp[n] != front->current) {
+	front->stamp[n] = front->current;
+	front->head[n] = -1;
+	front->touched[front->numtouched++] = n;
+    }
 
-    if (curbus == NULL) {
-	fprintf(stderr, "Error:  Pin %s is a bus, but no bus definition exists!\n",
-			curpin->name);
-	return;
+    profcount.visits++;
+    for (p = front->head[n]; p >= 0; p = pt->next) {
+	pt = &front->points[p];
+	if (pt->dir != dir) continue;
+	if ((minmax == MAXIMUM_TIME) ?
+			((pt->delay >= delay) && (pt->trans >= trans)) :
+			((pt->delay <= delay) && (pt->trans <= trans))) {
+	    profcount.pruned++;
+	    return -1;
+	}
     }
-    if (curbus->from > curbus->to) {
-	low = curbus->to;
-	high = curbus->from;
+
+    prev = &front->head[n];
+    while (*prev >= 0) {
+	p = *prev;
+	pt = &front->points[p];
+	if ((pt->dir == dir) && ((minmax == MAXIMUM_TIME) ?
+			((delay >= pt->delay) && (trans >= pt->trans)) :
+			((delay <= pt->delay) && (trans <= pt->trans)))) {
+	    *prev = pt->next;
+	    release_backtrace(front->pool, pt->backtrace);
+	    pt->next = front->freelist;
+	    front->freelist = p;
+	}
+	else
+	    prev = &pt->next;
+    }
+
+    if (front->freelist >= 0) {
+	p = front->freelist;
+	front->freelist = front->points[p].next;
     }
     else {
-	low = curbus->from;
-	high = curbus->to;
+	if (front->numpoints == front->maxpoints) {
+	    front->maxpoints <<= 1;
+	    front->points = (paretopoint *)realloc(front->points,
+			front->maxpoints * sizeof(paretopoint));
+	}
+	p = front->numpoints++;
     }
+    pt = &front->points[p];
+    pt->delay = delay;
+    pt->trans = trans;
+    pt->dir = dir;
+    pt->backtrace = NULL;
+    pt->next = front->head[n];
+    front->head[n] = p;
+    return p;
+}
 
-    for (i = low; i <= high; i++) {
-	sprintf(busbit, busformat, rootname, i);
+/*--------------------------------------------------------------*/
+/* Exhaustive version of find_path_delay(), used with option	*/
+/* -e.  Find the worst (minmax) path from "thisconn" to each	*/
+/* terminal point reachable from it, allowing for the		*/
+/* dependence of the delay tables on the transition time.	*/
+/*								*/
+/* Rather than following every path (which grows exponentially	*/
+/* with reconvergent logic), the arrivals at each node are	*/
+/* kept in the Pareto frontier "front", and the nodes of the	*/
+/* fanout cone of "thisconn" are visited in the topological	*/
+/* order of "graph".  When a node is visited, its frontier is	*/
+/* complete, and each arrival in it is propagated to the	*/
+/* fanout.  As long as delay and transition time tables	*/
+/* increase monotonically with the input transition time (the	*/
+/* same assumption made by the non-exhaustive search), the	*/
+/* arrivals dropped cannot lead to the worst path, so the	*/
+/* result is the same as following all paths.			*/
+/*								*/
+/* Paths are added to "delaylist", and endpoints are tagged,	*/
+/* as in find_path_delay() (including the use of "search").	*/
+/* Return the number of new paths recorded.			*/
+/*--------------------------------------------------------------*/
 
-	if (i == low)
-	    newpin = curpin;
+int
+find_path_frontier(tgraphptr graph, frontptr front, connptr thisconn,
+		short srcdir, ddataptr *delaylist, char minmax, searchptr search)
+{
+    connptr  testconn, rcvr;
+    btptr    backtrace, newbtdata;
+    ddataptr newddata, testddata, *tag;
+    paretopoint *pt;
+    double   delay, trans, newdelay, newtrans;
+    short    dir, outdir, odir;
+    int      *heap;
+    int      i, j, c, n, m, p, q, s, best, count, numpaths;
+
+    s = thisconn->index;
+    if ((s < 0) || (graph->orderpos[s] < 0)) return 0;
+
+    heap = front->heap;
+    count = 0;
+
+    /* Heap of order positions, smallest first (as in update_graph_paths()) */
+
+#define HEAP_PUSH(pos) { \
+	c = count++; \
+	while ((c > 0) && (heap[(c - 1) / 2] > (pos))) { \
+	    heap[c] = heap[(c - 1) / 2]; \
+	    c = (c - 1) / 2; \
+	} \
+	heap[c] = (pos); \
+    }
+
+    p = frontier_add(front, s, srcdir, 0.0, 0.0, minmax);
+    newbtdata = create_btdata(front->pool);
+    newbtdata->receiver = thisconn;
+    newbtdata->delay = thisconn->icDelay;
+    newbtdata->trans = 0.0;
+    newbtdata->dir = srcdir;
+    newbtdata->refcnt = 1;
+    newbtdata->next = NULL;
+    front->points[p].backtrace = newbtdata;
+    front->queued[s] = front->current;
+    HEAP_PUSH(graph->orderpos[s]);
+
+    while (count > 0) {
+	i = heap[0];
+	p = heap[--count];
+	j = 0;
+	while ((c = 2 * j + 1) < count) {
+	    if ((c + 1 < count) && (heap[c + 1] < heap[c])) c++;
+	    if (p <= heap[c]) break;
+	    heap[j] = heap[c];
+	    j = c;
+	}
+	heap[j] = p;
+
+	n = graph->order[i];
+	testconn = graph->nodes[n];
+
+	/* Register inputs terminate the path, except at the start */
+	if ((n != s) && !(graph->role[n] & GRAPH_THROUGH)) continue;
+
+	/* Points are addressed by index, as adding to the frontier	*/
+	/* downstream may move the storage.				*/
+
+	for (p = front->head[n]; p >= 0; p = front->points[p].next) {
+	    pt = &front->points[p];
+	    delay = pt->delay;
+	    trans = pt->trans;
+	    dir = pt->dir;
+	    backtrace = pt->backtrace;
+
+	    outdir = calc_dir(testconn->refpin, dir);
+	    for (odir = RISING; odir <= FALLING; odir++) {
+		if (!(outdir & odir)) continue;
+		newdelay = delay + calc_prop_delay(trans, testconn, odir, minmax);
+		newtrans = calc_transition(trans, testconn, odir, minmax);
+
+		for (j = graph->fanoutidx[n]; j < graph->fanoutidx[n + 1]; j++) {
+		    m = graph->fanout[j];
+
+		    /* Ignore edges back into a broken logic loop */
+		    if ((graph->role[m] & GRAPH_THROUGH) && (graph->orderpos[m] <= i))
+			continue;
+		    if (conemask && !conemask[m]) continue;
+
+		    q = frontier_add(front, m, odir, newdelay, newtrans, minmax);
+		    if (q < 0) continue;
+
+		    rcvr = graph->nodes[m];
+		    newbtdata = create_btdata(front->pool);
+		    newbtdata->receiver = rcvr;
+		    newbtdata->delay = newdelay + rcvr->icDelay;
+		    newbtdata->trans = newtrans;
+		    newbtdata->dir = odir;
+		    newbtdata->refcnt = 1;
+		    newbtdata->next = backtrace;
+		    backtrace->refcnt++;
+		    front->points[q].backtrace = newbtdata;
+
+		    if ((graph->role[m] & GRAPH_THROUGH) &&
+				(front->queued[m] != front->current)) {
+			front->queued[m] = front->current;
+			HEAP_PUSH(graph->orderpos[m]);
+		    }
+		}
+	    }
+	}
+    }
+#undef HEAP_PUSH
+
+    /* Record the worst arrival at each terminal point reached.  As	*/
+    /* in find_path_delay(), an endpoint already in a delay list is	*/
+    /* found from its tag, and its path is replaced if the new one is	*/
+    /* worse.								*/
+
+    numpaths = 0;
+    for (i = 0; i < front->numtouched; i++) {
+	n = front->touched[i];
+	if ((n == s) || !(graph->role[n] & GRAPH_SINK)) continue;
+
+	/* Points are listed newest first;  of equal arrivals, take	*/
+	/* the one found first, as find_path_delay() would.		*/
+
+	p = front->head[n];
+	if (p < 0) continue;
+	best = p;
+	for (p = front->points[p].next; p >= 0; p = front->points[p].next) {
+	    pt = &front->points[p];
+	    if (((minmax == MAXIMUM_TIME) && (pt->delay >= front->points[best].delay))
+			|| ((minmax != MAXIMUM_TIME) &&
+			(pt->delay <= front->points[best].delay)))
+		best = p;
+	}
+	pt = &front->points[best];
+	rcvr = graph->nodes[n];
+
+	if (search) {
+	    if (search->stamp[n] != search->current) {
+		search->stamp[n] = search->current;
+		search->metric[n] = (minmax == MAXIMUM_TIME) ? -1.0 : 1E50;
+		search->tag[n] = NULL;
+	    }
+	    tag = &search->tag[n];
+	}
 	else
-	    newpin = (pin *)malloc(sizeof(pin));
-	newpin->name = tokendup(busbit);
-	newpin->next = NULL;
-	if (i != low) {
-	    curpin->next = newpin;
+	    tag = &rcvr->tag;
+
+	if ((*tag != NULL) && (*tag != (ddataptr)(-1))) {
+	    testddata = *tag;
+	    if (((minmax == MAXIMUM_TIME) && (pt->delay > testddata->backtrace->delay))
+			|| ((minmax != MAXIMUM_TIME) &&
+			(pt->delay < testddata->backtrace->delay))) {
+		release_backtrace(front->pool, testddata->backtrace);
+		testddata->backtrace = pt->backtrace;
+		pt->backtrace->refcnt++;
+		testddata->delay = pt->backtrace->delay + testddata->setup
+			+ testddata->skew;
+	    }
+	}
+	else {
+	    numpaths++;
+	    newddata = create_delaydata(front->pool);
+	    newddata->delay = 0.0;
+	    newddata->setup = 0.0;
+	    newddata->skew = 0.0;
+	    newddata->trans = 0.0;
+	    newddata->backtrace = pt->backtrace;
+	    pt->backtrace->refcnt++;
+	    newddata->next = *delaylist;
+	    *delaylist = newddata;
+	    *tag = newddata;
+	}
+    }
 
-	    /* Copy all pin properties from the old pin to the new pin */
-	    newpin->type = curpin->type;
-	    newpin->capr = curpin->capr;
-	    newpin->capf = curpin->capf;
-	    newpin->sense = curpin->sense;
-	    newpin->transr = curpin->transr;
-	    newpin->transf = curpin->transf;
-	    newpin->propdelr = curpin->propdelr;
-	    newpin->propdelf = curpin->propdelf;
-	    newpin->refcell = curpin->refcell;
+    frontier_reset(front, graph->numnodes);
+    return numpaths;
+}
 
-	    curpin = newpin;
+/*--------------------------------------------------------------*/
+/* Take the next start point for thread "id".  Start points are	*/
+/* taken from the bottom of the thread's own range.  When that	*/
+/* is empty, the top half of the largest remaining range of	*/
+/* another thread is moved to the thread's own range.		*/
+/*								*/
+/* Return the start point index, or -1 if no work remains.	*/
+/*--------------------------------------------------------------*/
+
+int
+next_start_point(pathjobptr job, int id)
+{
+    workrange *own, *victim;
+    int i, best, remain, size, mid, hi, idx;
+
+    own = &job->ranges[id];
+
+    while (1) {
+	pthread_mutex_lock(&own->lock);
+	if (own->lo < own->hi) {
+	    idx = own->lo++;
+	    pthread_mutex_unlock(&own->lock);
+	    return idx;
+	}
+	pthread_mutex_unlock(&own->lock);
+
+	/* Find the range with the most work remaining */
+	best = -1;
+	remain = 0;
+	for (i = 0; i < job->numranges; i++) {
+	    if (i == id) continue;
+	    pthread_mutex_lock(&job->ranges[i].lock);
+	    size = job->ranges[i].hi - job->ranges[i].lo;
+	    pthread_mutex_unlock(&job->ranges[i].lock);
+	    if (size > remain) {
+		remain = size;
+		best = i;
+	    }
+	}
+	if (best < 0) return -1;
+
+	victim = &job->ranges[best];
+	pthread_mutex_lock(&victim->lock);
+	remain = victim->hi - victim->lo;
+	if (remain <= 0) {
+	    /* Someone else got there first;  look again */
+	    pthread_mutex_unlock(&victim->lock);
+	    continue;
 	}
+	hi = victim->hi;
+	mid = victim->lo + remain / 2;
+	victim->hi = mid;
+	pthread_mutex_unlock(&victim->lock);
+
+	pthread_mutex_lock(&own->lock);
+	own->lo = mid;
+	own->hi = hi;
+	pthread_mutex_unlock(&own->lock);
     }
-    free(rootname);
 }
 
 /*--------------------------------------------------------------*/
-/* Read a liberty format file and collect information about     */
-/* the timing properties of each standard cell.                 */
+/* Set up "merge" for the paths from the "numstarts" start	*/
+/* points "starts", in the order of the search of the whole	*/
+/* list.							*/
 /*--------------------------------------------------------------*/
 
 void
-libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
+pathmerge_init(pathmerge *merge, connptr *starts, int numstarts, char minmax)
 {
-    char *token;
-    char *libname = NULL;
-    int section = INIT;
+    int i;
 
-    double time_unit = 1.0;     // Time unit multiplier, to get ps
-    double cap_unit = 1.0;      // Capacitive unit multiplier, to get fF
+    merge->numstarts = numstarts;
+    merge->startpos = (int *)malloc(numconnects * sizeof(int));
+    merge->ends = (ddataptr *)calloc(numconnects, sizeof(ddataptr));
+    merge->endstart = (int *)malloc(numconnects * sizeof(int));
+    merge->endfirst = (int *)malloc(numconnects * sizeof(int));
+    merge->order = (int *)malloc(numconnects * sizeof(int));
+    merge->numends = 0;
+    merge->minmax = minmax;
+    for (i = 0; i < numstarts; i++)
+	merge->startpos[starts[i]->index] = i;
+}
 
-    pinptr testpin;
-    lutable *tableptr;
+/*--------------------------------------------------------------*/
+/* Add path "testddata" to "merge".  It is kept if it is the	*/
+/* worst (minmax) path into its endpoint so far, or if it ties	*/
+/* with the path kept and its start point comes first, as the	*/
+/* endpoint tag of the search of the whole list would keep it.	*/
+/* The path not kept is released to "pool".  "listidx" is the	*/
+/* index of the start point in whose delay list the path was	*/
+/* found, or -1 to take its own start point;  the path kept	*/
+/* goes in the first such list.					*/
+/*--------------------------------------------------------------*/
 
-    pin proxypin;
-    int i, j;
-    double gval;
-    char *iptr;
-    char *busformat;
-    short timing_type;
+void
+pathmerge_add(pathmerge *merge, ddataptr testddata, int listidx, pathpool *pool)
+{
+    ddataptr keep;
+    btptr bt;
+    double delay, kdelay;
+    int n, idx;
+
+    /* A search may have moved a path from a later start point	*/
+    /* into the list of an earlier one, so the start point of the	*/
+    /* path is found from its backtrace.				*/
+
+    for (bt = testddata->backtrace; bt->next; bt = bt->next);
+    idx = merge->startpos[bt->receiver->index];
+    if (listidx < 0) listidx = idx;
+
+    n = testddata->backtrace->receiver->index;
+    keep = merge->ends[n];
+    if (keep == NULL) {
+	merge->endfirst[n] = listidx;
+	merge->order[merge->numends++] = n;
+    }
+    else {
+	if (listidx < merge->endfirst[n]) merge->endfirst[n] = listidx;
+	delay = testddata->backtrace->delay;
+	kdelay = keep->backtrace->delay;
+	if ((delay == kdelay) ? (idx > merge->endstart[n]) :
+			((merge->minmax == MAXIMUM_TIME) ? (delay < kdelay) :
+			(delay > kdelay))) {
+	    release_backtrace(pool, testddata->backtrace);
+	    release_delaydata(pool, testddata);
+	    return;
+	}
+	release_backtrace(pool, keep->backtrace);
+	release_delaydata(pool, keep);
+    }
+    testddata->next = NULL;
+    merge->ends[n] = testddata;
+    merge->endstart[n] = idx;
+}
 
-    lutable *newtable, *reftable;
-    cell *newcell, *lastcell;
-    pin *newpin;
-    bus *buses = NULL, *newbus, *curbus = NULL;
+/*--------------------------------------------------------------*/
+/* Put the paths kept by "merge" in front of "masterlist", in	*/
+/* the order of the search of the whole list:  the delay list	*/
+/* of each start point in front of those before it, each in the	*/
+/* order its paths were added.  Free the merge.			*/
+/*								*/
+/* Return value is the number of paths.				*/
+/*--------------------------------------------------------------*/
 
-    lastcell = NULL;
-    timing_type = UNKNOWN;
+int
+pathmerge_finish(pathmerge *merge, ddataptr *masterlist)
+{
+    ddataptr *lists, testddata;
+    int i, n, numpaths;
+
+    lists = (ddataptr *)calloc(merge->numstarts, sizeof(ddataptr));
+    for (i = merge->numends - 1; i >= 0; i--) {
+	n = merge->order[i];
+	merge->ends[n]->next = lists[merge->endfirst[n]];
+	lists[merge->endfirst[n]] = merge->ends[n];
+    }
+    for (i = 0; i < merge->numstarts; i++) {
+	if (lists[i]) {
+	    for (testddata = lists[i]; testddata->next; testddata = testddata->next);
+	    testddata->next = *masterlist;
+	    *masterlist = lists[i];
+	}
+    }
+    numpaths = merge->numends;
+
+    free(lists);
+    free(merge->order);
+    free(merge->endfirst);
+    free(merge->endstart);
+    free(merge->ends);
+    free(merge->startpos);
+    return numpaths;
+}
 
-    /* Set up pin placeholder */
-    proxypin.name = NULL;
-    proxypin.type = GATE;
-    proxypin.capr = 0.0;
-    proxypin.capf = 0.0;
-    proxypin.sense = SENSE_NONE;
-    proxypin.propdelr = NULL;
-    proxypin.propdelf = NULL;
-    proxypin.transr = NULL;
-    proxypin.transf = NULL;
-    proxypin.refcell = NULL;
-    proxypin.next = NULL;
+/*--------------------------------------------------------------*/
+/* Path search thread.  Each thread keeps its own search state	*/
+/* and runs find_path_delay() for each start point it takes,	*/
+/* saving the resulting delay list in the slot for that start	*/
+/* point.							*/
+/*--------------------------------------------------------------*/
 
-    /* Set default bus format (verilog style) */
-    busformat = strdup("%s[%d]");
+void *
+path_search_thread(void *arg)
+{
+    pathworker *worker = (pathworker *)arg;
+    pathjobptr job = worker->job;
+    searchdata search;
+    frontier front;
+    connptr thisconn;
+    ddataptr delaylist;
+    short srcdir;
+    int idx, j;
+
+    search.metric = (double *)malloc(numconnects * sizeof(double));
+    search.tag = (ddataptr *)malloc(numconnects * sizeof(ddataptr));
+    search.stamp = (unsigned int *)calloc(numconnects, sizeof(unsigned int));
+    search.current = 1;
+    search.pool = worker->pool;
+    if (exhaustive) frontier_init(&front, job->graph, worker->pool);
+
+    while ((idx = next_start_point(job, worker->id)) >= 0) {
+	thisconn = job->starts[idx];
+	reset_search(&search, thisconn, (job->minmax == MAXIMUM_TIME) ? -1.0 : 1E50);
+
+	if (thisconn->refpin)
+	    srcdir = (thisconn->refpin->refcell->type & CLK_SENSE_MASK) ?
+			FALLING : RISING;
+	else
+	    srcdir = EITHER;
 
-    /* Read tokens off of the line */
-    token = advancetoken(flib, 0);
+	delaylist = NULL;
+	if (exhaustive)
+	    find_path_frontier(job->graph, &front, thisconn, srcdir, &delaylist,
+			job->minmax, &search);
+	else
+	    find_path_delay(srcdir, 0.0, 0.0, thisconn, NULL, &delaylist,
+			job->minmax, &search);
+	job->results[idx] = delaylist;
 
-    while (token != NULL) {
+	if (verbose > 0) {
+	    pthread_mutex_lock(&job->lock);
+	    j = ++job->completed;
+	    if ((j % 100) == 0) {
+		fprintf(stdout, "Completed %d traces (%3.1f%%).\n",
+			j, 100.0 * ((float)j / (float)job->numstarts));
+		fflush(stdout);
+	    }
+	    pthread_mutex_unlock(&job->lock);
+	}
+    }
 
-        switch (section) {
-            case INIT:
-		if (debug == 2) fprintf(stdout, "INIT: %s\n", token);
-                if (!tokencasecmp(token, "library")) {
-                    token = advancetoken(flib, 0);
-                    if (strcmp(token, "("))
-                        fprintf(stderr, "Library not followed by name\n");
-                    else
-                        token = advancetoken(flib, ')');
-		    /* Diagnostic */
-                    fprintf(stdout, "Parsing library \"%s\"\n", token);
-                    libname = tokendup(token);
-                    token = advancetoken(flib, 0);
-                    if (strcmp(token, "{")) {
-                        fprintf(stderr, "Did not find opening brace "
-                                        "on library block\n");
-                        exit(1);
-                    }
-                    section = LIBBLOCK;
-                }
-                else
-                    fprintf(stderr, "Unknown input \"%s\", looking for "
-                                        "\"library\"\n", token);
-                break;
+    if (profile) {
+	pthread_mutex_lock(&job->lock);
+	proftotal.nldm += profcount.nldm;
+	proftotal.visits += profcount.visits;
+	proftotal.pruned += profcount.pruned;
+	proftotal.btdata += profcount.btdata;
+	proftotal.vectors += profcount.vectors;
+	proftotal.shared += profcount.shared;
+	pthread_mutex_unlock(&job->lock);
+    }
 
-            case LIBBLOCK:
-                // Here we check for the main blocks, again not rigorously. . .
+    free(search.metric);
+    free(search.tag);
+    free(search.stamp);
+    work_free(&workmem);
+    if (exhaustive) frontier_free(&front);
+    return NULL;
+}
 
-		if (debug == 2) fprintf(stdout, "LIBBLOCK: %s\n", token);
-                if (!strcasecmp(token, "}")) {
-                    fprintf(stdout, "End of library at line %d\n", fileCurrentLine);
-                    section = INIT;                     // End of library block
-                }
-                else if (!tokencasecmp(token, "delay_model")) {
-                    token = advancetoken(flib, 0);
-                    if (strcmp(token, ":"))
-                        fprintf(stderr, "Input missing colon\n");
-                    token = advancetoken(flib, ';');
-                    if (tokencasecmp(token, "table_lookup")) {
-                        fprintf(stderr, "Sorry, only know how to "
-                                        "handle table lookup!\n");
-                        exit(1);
-                    }
-                }
-                else if (!tokencasecmp(token, "lu_table_template") ||
-                         !tokencasecmp(token, "power_lut_template")) {
-                    // Read in template information;
-                    newtable = (lutable *)malloc(sizeof(lutable));
-                    newtable->name = NULL;
-                    newtable->invert = 0;
-                    newtable->var1 = UNKNOWN;
-                    newtable->var2 = UNKNOWN;
-                    newtable->size1 = 0;
-                    newtable->size2 = 0;
-                    newtable->idx1.times = NULL;
-                    newtable->idx2.caps = NULL;
-                    newtable->values = NULL;
-                    newtable->next = *tablelist;
-                    *tablelist = newtable;
+/*--------------------------------------------------------------*/
+/* Multi-threaded version of find_clock_to_term_paths().  The	*/
+/* start points are divided among "numthreads" threads.  As in	*/
+/* the unthreaded search, the delay metric carries over from	*/
+/* one start point to the next within a thread, which prunes	*/
+/* paths dominated by a path already found, and each thread	*/
+/* tags the endpoints it reaches, so that it records at most	*/
+/* one path into each.  The delay lists of the threads are then	*/
+/* merged to keep one path into each endpoint, listed in	*/
+/* masterlist where the unthreaded search would list it (see	*/
+/* pathmerge_add()), so the number and order of the paths do	*/
+/* not depend on the number of threads.				*/
+/*								*/
+/* Return value is the number of paths recorded in masterlist.	*/
+/*--------------------------------------------------------------*/
 
-                    token = advancetoken(flib, 0);
-                    if (strcmp(token, "("))
-                        fprintf(stderr, "Input missing open parens\n");
-                    else
-                        token = advancetoken(flib, ')');
-                    newtable->name = tokendup(token);
-                    while (*token != '}') {
-                        token = advancetoken(flib, 0);
-                        if (!tokencasecmp(token, "variable_1")) {
-                            token = advancetoken(flib, 0);
-                            token = advancetoken(flib, ';');
-                            newtable->var1 = get_table_type(token);
-                            if (newtable->var1 == OUTPUT_CAP || newtable->var1 == CONSTRAINED_TIME)
-                                newtable->invert = 1;
-                        }
-                        else if (!tokencasecmp(token, "variable_2")) {
-                            token = advancetoken(flib, 0);
-                            token = advancetoken(flib, ';');
-                            newtable->var2 = get_table_type(token);
-                            if (newtable->var2 == TRANSITION_TIME || newtable->var2 == RELATED_TIME)
-                                newtable->invert = 1;
-                        }
-                        else if (!tokencasecmp(token, "index_1")) {
-			    char dnum = ',';
+int
+find_clock_to_term_paths_threaded(connlistptr clockedlist, ddataptr *masterlist,
+		tgraphptr graph, char minmax)
+{
+    pathjob job;
+    pathworker *workers;
+    pthread_t *threads;
+    connlistptr testlink;
+    ddataptr testddata, nextddata;
+    pathmerge merge;
+    int i, t, numpaths;
 
-                            token = advancetoken(flib, 0);      // Open parens
-                            token = advancetoken(flib, 0);      // Quote
-                            if (!strcmp(token, "\""))
-                                token = advancetoken(flib, '\"');
+    t = 0;
+    for (testlink = clockedlist; testlink; testlink = testlink->next) t++;
 
-                            iptr = token;
+    if (verbose > 0) {
+	fprintf(stdout, "Length of list of clocked nets = %d\n", t);
+	fflush(stdout);
+    }
+    if (t == 0) return 0;
+
+    job.numstarts = t;
+    job.starts = (connptr *)malloc(t * sizeof(connptr));
+    job.results = (ddataptr *)calloc(t, sizeof(ddataptr));
+    job.numranges = (numthreads < t) ? numthreads : t;
+    job.ranges = (workrange *)malloc(job.numranges * sizeof(workrange));
+    job.completed = 0;
+    job.minmax = minmax;
+    job.graph = graph;
+    pthread_mutex_init(&job.lock, NULL);
 
-			    // Check if table is space or comma separated
-			    if (strchr(iptr, dnum) == NULL)
-				if (strchr(iptr, ' ') != NULL)
-				    dnum = ' ';
+    i = 0;
+    for (testlink = clockedlist; testlink; testlink = testlink->next)
+	job.starts[i++] = testlink->connection;
 
-                            if (newtable->invert == 1) {
-                                // Count entries
-                                newtable->size2 = 1;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    newtable->size2++;
-                                }
-                                newtable->idx2.caps = (double *)malloc(newtable->size2 *
-                                        sizeof(double));
-                                newtable->size2 = 0;
-                                iptr = token;
-                                sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
-                                if (newtable->var2 == OUTPUT_CAP)
-                                    newtable->idx2.caps[0] *= cap_unit;
-                                else
-                                    newtable->idx2.caps[0] *= time_unit;
+    for (i = 0; i < job.numranges; i++) {
+	job.ranges[i].lo = (int)(((long)t * i) / job.numranges);
+	job.ranges[i].hi = (int)(((long)t * (i + 1)) / job.numranges);
+	pthread_mutex_init(&job.ranges[i].lock, NULL);
+    }
 
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    newtable->size2++;
-                                    sscanf(iptr, "%lg",
-                                                &newtable->idx2.caps[newtable->size2]);
-                                    if (newtable->var2 == OUTPUT_CAP)
+    workers = (pathworker *)malloc(job.numranges * sizeof(pathworker));
+    threads = (pthread_t *)malloc(job.numranges * sizeof(pthread_t));
+    for (i = 0; i < job.numranges; i++) {
+	workers[i].job = &job;
+	workers[i].id = i;
+	workers[i].pool = (pathpool *)calloc(1, sizeof(pathpool));
+	if (pthread_create(&threads[i], NULL, path_search_thread, &workers[i]) != 0) {
+	    fprintf(stderr, "Error:  Cannot create path search thread.\n");
+	    exit(1);
+	}
+    }
+    for (i = 0; i < job.numranges; i++)
+	pthread_join(threads[i], NULL);
+
+    /* The paths found belong to the pass, so move the threads' record	*/
+    /* storage to the pass storage.  Free lists are dropped.		*/
+
+    for (i = 0; i < job.numranges; i++) {
+	arena_merge(&pathmem.mem, &workers[i].pool->mem);
+	free(workers[i].pool);
+    }
+
+    /* Keep one path into each endpoint */
+
+    pathmerge_init(&merge, job.starts, t, minmax);
+    for (i = 0; i < t; i++) {
+	for (testddata = job.results[i]; testddata; testddata = nextddata) {
+	    nextddata = testddata->next;
+	    pathmerge_add(&merge, testddata, i, &pathmem);
+	}
+    }
+    numpaths = pathmerge_finish(&merge, masterlist);
+
+    for (i = 0; i < job.numranges; i++)
+	pthread_mutex_destroy(&job.ranges[i].lock);
+    pthread_mutex_destroy(&job.lock);
+    free(workers);
+    free(threads);
+    free(job.ranges);
+    free(job.results);
+    free(job.starts);
+
+    return numpaths;
+}
+
+/*--------------------------------------------------------------*/
+/* Partitioned path search (option -w).  The netlist is cut at	*/
+/* its registers:  the start points (flop clocks and module	*/
+/* inputs) are divided into "numparts" partitions, and the	*/
+/* fanout cone of each partition, up to the next registers or	*/
+/* the module outputs, is searched by a worker process.  Paths	*/
+/* never cross a register, so the only data that crosses a	*/
+/* partition boundary is the path to each endpoint, with its	*/
+/* arrival and transition.  The workers send their paths back	*/
+/* over a socket, and the clock arrivals and setup or hold at	*/
+/* the endpoints are applied to the merged paths as usual.	*/
+/*								*/
+/* The stream holds, for each path, PART_PATH, the delay	*/
+/* record, and its backtrace from the endpoint back to the	*/
+/* start point.  Each backtrace record is PART_NEW followed by	*/
+/* the record (receiver by connection index), and the chain	*/
+/* ends with PART_END or with the number of a record already	*/
+/* sent, whose chain is shared.  The stream ends with		*/
+/* PART_DONE, the number of paths, and the search counts of	*/
+/* the worker.							*/
+/*--------------------------------------------------------------*/
+
+#define PART_DONE  0
+#define PART_PATH  1
+#define PART_NEW  -1
+#define PART_END  -2
+
+/*--------------------------------------------------------------*/
+/* Send the paths in "pathlist" ("numpaths" as counted by the	*/
+/* search) to stream "fout".  Run by a worker, which exits	*/
+/* afterward:  the refcnt field of each record sent is		*/
+/* overwritten with its number in the stream.			*/
+/*--------------------------------------------------------------*/
+
+void
+partition_send(FILE *fout, ddataptr pathlist, int numpaths)
+{
+    ddataptr testddata;
+    btptr bt;
+    int code, numsent = 0;
+    profcounts counts;
+
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	code = PART_PATH;
+	fwrite(&code, sizeof(int), 1, fout);
+	fwrite(&testddata->delay, sizeof(double), 1, fout);
+	fwrite(&testddata->skew, sizeof(double), 1, fout);
+	fwrite(&testddata->setup, sizeof(double), 1, fout);
+	fwrite(&testddata->trans, sizeof(double), 1, fout);
+	for (bt = testddata->backtrace; bt && (bt->refcnt >= 0); bt = bt->next) {
+	    code = PART_NEW;
+	    fwrite(&code, sizeof(int), 1, fout);
+	    fwrite(&bt->receiver->index, sizeof(int), 1, fout);
+	    fwrite(&bt->delay, sizeof(double), 1, fout);
+	    fwrite(&bt->trans, sizeof(double), 1, fout);
+	    fwrite(&bt->dir, sizeof(short), 1, fout);
+	    bt->refcnt = -1 - numsent++;
+	}
+	code = (bt) ? -1 - bt->refcnt : PART_END;
+	fwrite(&code, sizeof(int), 1, fout);
+    }
+    code = PART_DONE;
+    fwrite(&code, sizeof(int), 1, fout);
+    fwrite(&numpaths, sizeof(int), 1, fout);
+
+    counts.nldm = proftotal.nldm + profcount.nldm;
+    counts.visits = proftotal.visits + profcount.visits;
+    counts.pruned = proftotal.pruned + profcount.pruned;
+    counts.btdata = proftotal.btdata + profcount.btdata;
+    counts.vectors = proftotal.vectors + profcount.vectors;
+    counts.shared = proftotal.shared + profcount.shared;
+    fwrite(&counts, sizeof(profcounts), 1, fout);
+}
+
+/*--------------------------------------------------------------*/
+/* Read the paths sent by a worker on stream "fin" and add each	*/
+/* to "merge" (see pathmerge_add()) as it is read, with records	*/
+/* from pathmem, so that no more than one path into each	*/
+/* endpoint is held at a time.  "conns" gives the connection	*/
+/* for each connection index.					*/
+/*								*/
+/* Return value is the number of paths counted by the worker,	*/
+/* or -1 if the stream is cut short or malformed.		*/
+/*--------------------------------------------------------------*/
+
+int
+partition_receive(FILE *fin, connptr *conns, pathmerge *merge)
+{
+    ddataptr newddata;
+    btptr newbt, *link, *recs = NULL;
+    int code, index, i, bad, numrecs = 0, maxrecs = 0, numpaths = -1;
+    profcounts counts;
+
+    while (1) {
+	if (fread(&code, sizeof(int), 1, fin) != 1) break;
+	if (code == PART_DONE) {
+	    if ((fread(&numpaths, sizeof(int), 1, fin) != 1) ||
+			(fread(&counts, sizeof(profcounts), 1, fin) != 1)) {
+		numpaths = -1;
+		break;
+	    }
+	    proftotal.nldm += counts.nldm;
+	    proftotal.visits += counts.visits;
+	    proftotal.pruned += counts.pruned;
+	    proftotal.btdata += counts.btdata;
+	    proftotal.vectors += counts.vectors;
+	    proftotal.shared += counts.shared;
+	    break;
+	}
+	if (code != PART_PATH) break;
+
+	newddata = create_delaydata(&pathmem);
+	newddata->backtrace = NULL;
+	newddata->next = NULL;
+	bad = (fread(&newddata->delay, sizeof(double), 1, fin) != 1) ||
+		(fread(&newddata->skew, sizeof(double), 1, fin) != 1) ||
+		(fread(&newddata->setup, sizeof(double), 1, fin) != 1) ||
+		(fread(&newddata->trans, sizeof(double), 1, fin) != 1);
+
+	/* Each record read holds a reference from "recs" until the	*/
+	/* end of the stream, as later paths may share it.		*/
+
+	link = &newddata->backtrace;
+	while (!bad) {
+	    if (fread(&code, sizeof(int), 1, fin) != 1)
+		bad = 1;
+	    else if (code == PART_END)
+		break;
+	    else if (code != PART_NEW) {
+		if ((code < 0) || (code >= numrecs))
+		    bad = 1;
+		else {
+		    *link = recs[code];
+		    (*link)->refcnt++;
+		}
+		break;
+	    }
+	    else if ((fread(&index, sizeof(int), 1, fin) != 1) ||
+			(index < 0) || (index >= numconnects) ||
+			(conns[index] == NULL))
+		bad = 1;
+	    else {
+		newbt = create_btdata(&pathmem);
+		newbt->receiver = conns[index];
+		newbt->refcnt = 2;
+		newbt->next = NULL;
+		*link = newbt;
+		link = &newbt->next;
+		if (numrecs == maxrecs) {
+		    maxrecs = (maxrecs == 0) ? 1024 : 2 * maxrecs;
+		    recs = (btptr *)realloc(recs, maxrecs * sizeof(btptr));
+		}
+		recs[numrecs++] = newbt;
+		bad = (fread(&newbt->delay, sizeof(double), 1, fin) != 1) ||
+			(fread(&newbt->trans, sizeof(double), 1, fin) != 1) ||
+			(fread(&newbt->dir, sizeof(short), 1, fin) != 1);
+	    }
+	}
+	if (bad || (newddata->backtrace == NULL)) {
+	    release_backtrace(&pathmem, newddata->backtrace);
+	    release_delaydata(&pathmem, newddata);
+	    break;
+	}
+	pathmerge_add(merge, newddata, -1, &pathmem);
+    }
+
+    for (i = 0; i < numrecs; i++)
+	release_backtrace(&pathmem, recs[i]);
+    free(recs);
+    return numpaths;
+}
+
+/*--------------------------------------------------------------*/
+/* Multi-process version of find_clock_to_term_paths().  The	*/
+/* start points are divided into "numparts" partitions (see	*/
+/* above), each searched by a forked worker process.  A worker	*/
+/* searches its partition as find_clock_to_term_paths() does	*/
+/* (with threads, if -j is given), and sends one path into each	*/
+/* endpoint it reaches.  The paths are merged as they are read,	*/
+/* keeping one path into each endpoint, as the search of the	*/
+/* whole list does (see pathmerge_add()), so this process holds	*/
+/* no more paths than that search.  A path is listed with its	*/
+/* own start point, which orders paths of equal delay		*/
+/* differently from the unpartitioned search where the worst	*/
+/* path into an endpoint was found after another path into it.	*/
+/*								*/
+/* Workers share the netlist with this process (copy on write)	*/
+/* and keep their own search state and path records, which are	*/
+/* released when they exit;  only the paths found are sent	*/
+/* back.  The stream is the same over any socket, so a worker	*/
+/* could as well run on another machine with its own copy of	*/
+/* the netlist.  Each worker loses the pruning of paths that	*/
+/* the delay metric of the start points before its partition	*/
+/* would give, so the search does more work in all than the	*/
+/* unpartitioned search, and can take longer.			*/
+/*								*/
+/* Return value is the number of paths recorded in masterlist.	*/
+/*--------------------------------------------------------------*/
+
+int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist,
+		netptr netlist, tgraphptr graph, char minmax);
+
+int
+find_clock_to_term_paths_partitioned(connlistptr clockedlist,
+		ddataptr *masterlist, netptr netlist, tgraphptr graph, char minmax)
+{
+    connlistptr testlink, firstlink;
+    connptr *conns, *starts, testconn;
+    netptr testnet;
+    ddataptr delaylist;
+    pathmerge merge;
+    FILE **fin, *fstream;
+    pid_t *pids;
+    int i, k, n, t, lo, hi, numpaths, status, parts;
+
+    t = 0;
+    for (testlink = clockedlist; testlink; testlink = testlink->next) t++;
+    if (t == 0) return 0;
+    parts = (numparts < t) ? numparts : t;
+
+    /* Table of connections by index, for the paths read back.  A	*/
+    /* path is made of receivers, except for its start point.		*/
+
+    conns = (connptr *)calloc(numconnects + 1, sizeof(connptr));
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	for (i = 0; i < testnet->fanout; i++) {
+	    testconn = testnet->receivers[i];
+	    if (testconn->index >= 0) conns[testconn->index] = testconn;
+	}
+    starts = (connptr *)malloc(t * sizeof(connptr));
+    i = 0;
+    for (testlink = clockedlist; testlink; testlink = testlink->next) {
+	conns[testlink->connection->index] = testlink->connection;
+	starts[i++] = testlink->connection;
+    }
+
+    fin = (FILE **)malloc(parts * sizeof(FILE *));
+    pids = (pid_t *)malloc(parts * sizeof(pid_t));
+
+    for (k = 0; k < parts; k++) {
+	lo = (int)(((long)t * k) / parts);
+	hi = (int)(((long)t * (k + 1)) / parts);
+	pids[k] = server_worker(&fstream);
+	if (pids[k] < 0) {
+	    fprintf(stderr, "Error:  Cannot start worker for partition %d.\n", k);
+	    exit(1);
+	}
+	if (pids[k] == 0) {
+	    /* Worker:  search the start points lo to hi - 1 */
+	    for (i = 0; i < k; i++) fclose(fin[i]);
+	    memset(&profcount, 0, sizeof(profcounts));
+	    memset(&proftotal, 0, sizeof(profcounts));
+
+	    firstlink = clockedlist;
+	    for (i = 0; i < lo; i++) firstlink = firstlink->next;
+	    for (testlink = firstlink, i = lo; i < hi - 1; i++)
+		testlink = testlink->next;
+	    testlink->next = NULL;
+
+	    numparts = 0;
+	    delaylist = NULL;
+	    n = find_clock_to_term_paths(firstlink, &delaylist, netlist, graph,
+			minmax);
+	    partition_send(fstream, delaylist, n);
+	    fflush(stdout);
+	    _exit((fclose(fstream) == 0) ? 0 : 1);
+	}
+	fin[k] = fstream;
+    }
+
+    /* Merge in the order of clockedlist */
+
+    pathmerge_init(&merge, starts, t, minmax);
+    for (k = 0; k < parts; k++) {
+	n = partition_receive(fin[k], conns, &merge);
+	fclose(fin[k]);
+	waitpid(pids[k], &status, 0);
+	if ((n < 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+	    fprintf(stderr, "Error:  Worker for partition %d failed.\n", k);
+	    exit(1);
+	}
+    }
+    numpaths = pathmerge_finish(&merge, masterlist);
+
+    if (verbose > 0) {
+	fprintf(stdout, "Path search in %d partitions:  %d paths.\n", parts,
+		numpaths);
+	fflush(stdout);
+    }
+
+    free(starts);
+    free(conns);
+    free(fin);
+    free(pids);
+    return numpaths;
+}
+
+/*--------------------------------------------------------------*/
+/* Search all paths from the clocked data outputs of            */
+/* "clockedlist" to either output pins or data inputs of other  */
+/* flops.                                                       */
+/*                                                              */
+/* Return a master list of all backtraces in "masterlist".      */
+/*                                                              */
+/* Return value is the number of paths recorded in masterlist.  */
+/*                                                              */
+/* If minmax == MAXIMUM_TIME, return the maximum delay.         */
+/* If minmax == MINIMUM_TIME, return the minimum delay.         */
+/*                                                              */
+/* If numthreads is non-zero, the search is handed off to       */
+/* find_clock_to_term_paths_threaded(), and if numparts is more */
+/* than one, to find_clock_to_term_paths_partitioned().         */
+/*                                                              */
+/* In exhaustive mode, paths are found by find_path_frontier()  */
+/* over the timing graph "graph" (otherwise unused).            */
+/*--------------------------------------------------------------*/
+
+int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netptr netlist,
+                tgraphptr graph, char minmax)
+{
+    netptr      testnet;
+    connptr     testconn, thisconn;
+    connlistptr testlink;
+    pinptr      testpin;
+    cellptr     testcell;
+    instptr     testinst;
+    btptr       backtrace, freebt;
+    ddataptr    delaylist, testddata, freeddata;
+    frontier    front;
+
+    short       srcdir, destdir;             // Signal direction in/out
+    double      tdriver, setupdelay, holddelay, ddelay;
+    int         numpaths, n, i, t, j;
+    unsigned char result;
+
+    if (numparts > 1)
+	return find_clock_to_term_paths_partitioned(clockedlist, masterlist, netlist,
+		graph, minmax);
+    if (numthreads > 0)
+	return find_clock_to_term_paths_threaded(clockedlist, masterlist, graph, minmax);
+
+    delaylist = NULL;
+
+    t = j = 0;
+    if (verbose > 0) {
+        for (testlink = clockedlist; testlink; testlink = testlink->next) 
+	    t++;
+	fprintf(stdout, "Length of list of clocked nets = %d\n", t); 	
+	fflush(stdout);
+    }
+
+    if (exhaustive) frontier_init(&front, graph, &pathmem);
+
+    numpaths = 0;
+    for (testlink = clockedlist; testlink; testlink = testlink->next) {
+	if (verbose > 0) {
+	    j++;
+	    if ((j % 100) == 0) {
+		fprintf(stdout, "Completed %d traces (%3.1f%%).\n",
+			j, 100.0 * ((float)j / (float)t));
+		fflush(stdout);
+	    }
+	}
+
+        // Remove all tags and reset delay metrics in testlink tree
+	// before each run
+
+	reset_path(testlink->connection, (minmax == MAXIMUM_TIME) ? -1.0 : 1E50);
+
+        thisconn = testlink->connection;
+        testpin = thisconn->refpin;
+        if (testpin) {
+            testcell = testpin->refcell;
+
+            // Sense is positive for rising edge-triggered flops, negative for
+            // falling edge-triggered flops
+            srcdir = (testcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
+
+            // Report on paths and their maximum delays
+            if (verbose > 1)
+                fprintf(stdout, "Paths starting at flop \"%s\" clock:\n\n",
+                                thisconn->refinst->name);
+        }
+        else {
+            // Connection is an input pin;  must calculate both rising and falling edges.
+            srcdir = EITHER;
+
+            // Report on paths and their maximum delays
+            if (verbose > 1)
+                fprintf(stdout, "Paths starting at input pin \"%s\"\n\n",
+                                thisconn->refnet->name);
+        }
+
+        if (verbose > 1) fflush(stdout);
+
+        // Find all paths from "thisconn" to output or a flop input, and compute delay
+        if (exhaustive)
+            n = find_path_frontier(graph, &front, thisconn, srcdir, &delaylist,
+			minmax, NULL);
+        else
+            n = find_path_delay(srcdir, 0.0, 0.0, thisconn, NULL, &delaylist, minmax,
+			NULL);
+        numpaths += n;
+
+        if (verbose > 1) fprintf(stdout, "%d paths traced (%d total).\n\n", n, numpaths);
+
+        // Link delaylist data to the beginning of masterlist, and null out
+        // delaylist for the next set of paths.
+
+        if (delaylist) {
+            for (testddata = delaylist; testddata->next; testddata = testddata->next);
+            testddata->next = *masterlist;
+            *masterlist = delaylist;
+            delaylist = NULL;
+        }
+
+    }
+    if (exhaustive) frontier_free(&front);
+    return numpaths;
+}
+
+/*--------------------------------------------------------------*/
+/* Give each connection that can start or end a path segment a	*/
+/* number, for use as an index into arrays of per-connection	*/
+/* data.  Returns the number of connections numbered.		*/
+/*--------------------------------------------------------------*/
+
+int
+number_connections(instptr instlist, connptr inputlist, connptr outputlist)
+{
+    instptr testinst;
+    connptr testconn;
+    int numconns;
+
+    numconns = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	    testconn->index = numconns++;
+    for (testconn = inputlist; testconn; testconn = testconn->next)
+	testconn->index = numconns++;
+    for (testconn = outputlist; testconn; testconn = testconn->next)
+	testconn->index = numconns++;
+
+    return numconns;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the logic loops of the netlist, and put the connections	*/
+/* that propagate a signal in an order in which every edge	*/
+/* goes forward, except for the edges that break the loops.	*/
+/* All path searches ignore an edge from connection n into a	*/
+/* gate input m with connorder[m] <= connorder[n], so that	*/
+/* loops are broken at the same points, independently of the	*/
+/* order of the search or the number of threads.  Only the cut	*/
+/* is shared:  the default search still prunes on delay alone	*/
+/* (see path_delay_visit()), and may report a less critical	*/
+/* path than -e or -g, with or without loops.			*/
+/*								*/
+/* The loops are the strongly connected components of the	*/
+/* connections, found with Tarjan's algorithm (iteratively, as	*/
+/* paths can be very long).  The components come out in	*/
+/* reverse topological order.  The connections of a loop are	*/
+/* ordered by a depth-first search from one of its connections	*/
+/* (see below), so that the loop is broken where that search	*/
+/* finds an edge back into the connections above it.		*/
+/*								*/
+/* connorder[n] is set for each connection number n, or -1 if	*/
+/* the connection does not propagate a signal (a module output,	*/
+/* a register data input, or an input without timing data).	*/
+/* Return the number of loops.					*/
+/*--------------------------------------------------------------*/
+
+int
+find_logic_loops(instptr instlist, connptr inputlist, connptr outputlist)
+{
+    instptr testinst;
+    connptr testconn, rcvr, *nodes;
+    netptr loadnet;
+    int *index, *low, *stack, *frame, *edge, *comp, *compstart, *post, *entry;
+    unsigned char *onstack;
+    int numnodes, numcomps, numloops, count, sp, fp, n, m, r, i, c, k, pos;
+
+    numnodes = numconnects;
+    connorder = (int *)malloc(numnodes * sizeof(int));
+    nodes = (connptr *)calloc(numnodes, sizeof(connptr));
+
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    n = testconn->index;
+	    /* Sources are flop clocks and module inputs */
+	    if (conn_is_through(testconn) || (testconn->refpin &&
+			(testconn->refpin->type & DFFCLK)))
+		nodes[n] = testconn;
+	}
+    for (testconn = inputlist; testconn; testconn = testconn->next)
+	nodes[testconn->index] = testconn;
+
+    index = (int *)malloc(numnodes * sizeof(int));
+    low = (int *)malloc(numnodes * sizeof(int));
+    onstack = (unsigned char *)calloc(numnodes, sizeof(unsigned char));
+    stack = (int *)malloc(numnodes * sizeof(int));
+    frame = (int *)malloc(numnodes * sizeof(int));
+    edge = (int *)malloc(numnodes * sizeof(int));
+    comp = (int *)malloc(numnodes * sizeof(int));
+    compstart = (int *)malloc((numnodes + 1) * sizeof(int));
+
+    for (n = 0; n < numnodes; n++) {
+	index[n] = -1;
+	connorder[n] = -1;
+    }
+
+    /* Edges are followed only into gate inputs that propagate;	*/
+    /* others cannot be part of a loop.  "frame" is the call stack	*/
+    /* of the depth-first search, and "edge" the next receiver to	*/
+    /* follow from each node on it.					*/
+
+    count = numcomps = c = 0;
+    for (r = 0; r < numnodes; r++) {
+	if ((nodes[r] == NULL) || (index[r] >= 0)) continue;
+	sp = fp = 0;
+	frame[fp++] = r;
+	edge[r] = 0;
+	index[r] = low[r] = count++;
+	stack[sp++] = r;
+	onstack[r] = 1;
+
+	while (fp > 0) {
+	    n = frame[fp - 1];
+	    loadnet = conn_load_net(nodes[n]);
+	    if (loadnet && (edge[n] < loadnet->fanout)) {
+		rcvr = loadnet->receivers[edge[n]++];
+		m = rcvr->index;
+		if ((m < 0) || !conn_is_through(rcvr)) continue;
+		if (index[m] < 0) {
+		    frame[fp++] = m;
+		    edge[m] = 0;
+		    index[m] = low[m] = count++;
+		    stack[sp++] = m;
+		    onstack[m] = 1;
+		}
+		else if (onstack[m] && (index[m] < low[n]))
+		    low[n] = index[m];
+		continue;
+	    }
+
+	    /* All receivers done;  pop a component if n is its root */
+	    fp--;
+	    if (fp > 0) {
+		m = frame[fp - 1];
+		if (low[n] < low[m]) low[m] = low[n];
+	    }
+	    if (low[n] == index[n]) {
+		compstart[numcomps++] = c;
+		do {
+		    m = stack[--sp];
+		    onstack[m] = 0;
+		    comp[c++] = m;
+		    low[m] = numcomps - 1;	/* Now the component number */
+		} while (m != n);
+	    }
+	}
+    }
+    compstart[numcomps] = c;
+
+    /* Mark the connections entered from outside of their loop */
+
+    entry = stack;		/* Reuse as scratch */
+    memset(entry, 0, numnodes * sizeof(int));
+    for (n = 0; n < numnodes; n++) {
+	if (nodes[n] == NULL) continue;
+	loadnet = conn_load_net(nodes[n]);
+	for (i = 0; loadnet && (i < loadnet->fanout); i++) {
+	    m = loadnet->receivers[i]->index;
+	    if ((m >= 0) && (nodes[m] != NULL) && (low[m] != low[n])) entry[m] = 1;
+	}
+    }
+
+    /* Number the components in topological order.  Within a	*/
+    /* loop, use the reverse postorder of a depth-first search	*/
+    /* from the lowest-numbered connection entered from outside	*/
+    /* of the loop (or if there is none, the lowest-numbered).	*/
+
+    post = index;		/* Reuse as scratch */
+    numloops = 0;
+    pos = 0;
+    for (k = numcomps - 1; k >= 0; k--) {
+	if (compstart[k + 1] - compstart[k] == 1) {
+	    n = comp[compstart[k]];
+	    loadnet = conn_load_net(nodes[n]);
+	    for (i = 0; loadnet && (i < loadnet->fanout); i++)
+		if (loadnet->receivers[i] == nodes[n]) break;
+	    if (!loadnet || (i == loadnet->fanout) || !conn_is_through(nodes[n])) {
+		connorder[n] = pos++;
+		continue;
+	    }
+	}
+	numloops++;
+
+	r = -1;
+	for (i = compstart[k]; i < compstart[k + 1]; i++) {
+	    m = comp[i];
+	    if ((r < 0) || (entry[m] > entry[r]) || ((entry[m] == entry[r]) && (m < r)))
+		r = m;
+	}
+
+	fp = c = 0;
+	frame[fp++] = r;
+	edge[r] = 0;
+	onstack[r] = 1;		/* Marks connections visited */
+	while (fp > 0) {
+	    n = frame[fp - 1];
+	    loadnet = conn_load_net(nodes[n]);
+	    if (loadnet && (edge[n] < loadnet->fanout)) {
+		rcvr = loadnet->receivers[edge[n]++];
+		m = rcvr->index;
+		if ((m < 0) || (nodes[m] == NULL) || onstack[m] || (low[m] != k))
+		    continue;
+		onstack[m] = 1;
+		frame[fp++] = m;
+		edge[m] = 0;
+		continue;
+	    }
+	    fp--;
+	    post[c++] = n;
+	}
+	for (i = c - 1; i >= 0; i--) {
+	    connorder[post[i]] = pos++;
+	    onstack[post[i]] = 0;
+	}
+
+	if (verbose > 0)
+	    fprintf(stdout, "Logic loop through %d pin%s, broken at %s/%s\n", c,
+			(c == 1) ? "" : "s", nodes[r]->refinst->name,
+			nodes[r]->refpin->name);
+    }
+
+    if (numloops > 0)
+	fprintf(stderr, "Warning:  Netlist has %d logic loop%s;  "
+		"paths are truncated at the loop.\n", numloops,
+		(numloops == 1) ? "" : "s");
+
+    free(nodes);
+    free(index);
+    free(low);
+    free(onstack);
+    free(stack);
+    free(frame);
+    free(edge);
+    free(comp);
+    free(compstart);
+    return numloops;
+}
+
+/*--------------------------------------------------------------*/
+/* Allocate the per-analysis arrays of timing graph "graph".	*/
+/*--------------------------------------------------------------*/
+
+void
+alloc_graph_arrays(tgraphptr graph)
+{
+    int numnodes = graph->numnodes;
+
+    graph->arrival = (double *)malloc(2 * numnodes * sizeof(double));
+    graph->trans = (double *)malloc(2 * numnodes * sizeof(double));
+    graph->pred = (int *)malloc(2 * numnodes * sizeof(int));
+    graph->outdelay = (double *)malloc(2 * numnodes * sizeof(double));
+    graph->outtrans = (double *)malloc(2 * numnodes * sizeof(double));
+    graph->outedge = (int *)malloc(2 * numnodes * sizeof(int));
+    graph->captured = (double *)malloc(2 * numnodes * sizeof(double));
+    graph->captrans = (double *)malloc(2 * numnodes * sizeof(double));
+    graph->cappred = (int *)malloc(2 * numnodes * sizeof(int));
+    graph->launch = (double *)calloc(numnodes, sizeof(double));
+    graph->clocks = NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Build the levelized timing graph.  Every connection that can	*/
+/* receive or launch a signal is given a node number, and the	*/
+/* fanout and fanin of each node are stored in compressed	*/
+/* arrays.  Edges follow the same rules as find_path_delay():	*/
+/* a node propagates to the receivers of the net driven by its	*/
+/* instance (module inputs propagate to their own net), and	*/
+/* register inputs and module outputs terminate a path.  Flop	*/
+/* clocks both terminate a path and launch new ones.		*/
+/*								*/
+/* Propagating nodes are then sorted into topological order.	*/
+/* If the sort stalls on a combinational loop, the loop is	*/
+/* broken at the lowest-numbered node remaining, which has the	*/
+/* same effect as the loop truncation in find_path_delay().	*/
+/*--------------------------------------------------------------*/
+
+tgraphptr
+build_timing_graph(instptr instlist, connptr inputlist, connptr outputlist)
+{
+    tgraphptr graph;
+    instptr testinst;
+    connptr testconn, rcvr;
+    netptr loadnet;
+    pinptr testpin;
+    int numnodes, n, i, k, m;
+    int *fill;
+
+    graph = (tgraphptr)malloc(sizeof(tgraph));
+
+    numnodes = number_connections(instlist, inputlist, outputlist);
+
+    graph->numnodes = numnodes;
+    graph->skewed = 0;
+    graph->unclocked = NULL;
+    graph->nodes = (connptr *)malloc(numnodes * sizeof(connptr));
+    graph->role = (unsigned char *)calloc(numnodes, sizeof(unsigned char));
+
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    graph->nodes[testconn->index] = testconn;
+	    testpin = testconn->refpin;
+	    if (testpin == NULL) continue;
+	    if (testpin->type & REGISTER_IN) {
+		graph->role[testconn->index] = GRAPH_SINK;
+		if (testpin->type & DFFCLK)
+		    graph->role[testconn->index] |= GRAPH_SOURCE;
+	    }
+	    else
+		graph->role[testconn->index] = GRAPH_THROUGH;
+	}
+    for (testconn = inputlist; testconn; testconn = testconn->next) {
+	graph->nodes[testconn->index] = testconn;
+	graph->role[testconn->index] = GRAPH_SOURCE;
+    }
+    for (testconn = outputlist; testconn; testconn = testconn->next) {
+	graph->nodes[testconn->index] = testconn;
+	graph->role[testconn->index] = GRAPH_SINK;
+    }
+
+    /* Count fanout of each node, then fill in the fanout array */
+
+    graph->fanoutidx = (int *)calloc(numnodes + 1, sizeof(int));
+    graph->faninidx = (int *)calloc(numnodes + 1, sizeof(int));
+
+    for (k = 0; k < 2; k++) {
+	m = 0;
+	for (n = 0; n < numnodes; n++) {
+	    if (k == 0)
+		graph->fanoutidx[n] = m;
+	    if ((graph->role[n] & (GRAPH_SOURCE | GRAPH_THROUGH)) == 0) continue;
+	    testconn = graph->nodes[n];
+	    testinst = testconn->refinst;
+	    if (testinst && (testinst->out_connects == NULL)) continue;
+	    loadnet = (testinst) ? testinst->out_connects->refnet : testconn->refnet;
+	    for (i = 0; i < loadnet->fanout; i++) {
+		rcvr = loadnet->receivers[i];
+		if (rcvr->index < 0) continue;
+		if (k == 1) {
+		    graph->fanout[m] = rcvr->index;
+		    graph->faninidx[rcvr->index + 1]++;
+		}
+		m++;
+	    }
+	}
+	if (k == 0) {
+	    graph->fanoutidx[numnodes] = m;
+	    graph->fanout = (int *)malloc((m + 1) * sizeof(int));
+	}
+    }
+
+    /* Transpose to get the fanin array */
+
+    for (n = 0; n < numnodes; n++)
+	graph->faninidx[n + 1] += graph->faninidx[n];
+    graph->fanin = (int *)malloc((graph->faninidx[numnodes] + 1) * sizeof(int));
+    fill = (int *)malloc(numnodes * sizeof(int));
+    memcpy(fill, graph->faninidx, numnodes * sizeof(int));
+    for (n = 0; n < numnodes; n++)
+	for (i = graph->fanoutidx[n]; i < graph->fanoutidx[n + 1]; i++)
+	    graph->fanin[fill[graph->fanout[i]]++] = n;
+    free(fill);
+
+    /* Topological order of the propagating nodes, with logic loops	*/
+    /* broken as found by find_logic_loops().				*/
+
+    graph->order = (int *)malloc((numnodes + 1) * sizeof(int));
+    graph->orderpos = (int *)malloc(numnodes * sizeof(int));
+    m = 0;
+    for (n = 0; n < numnodes; n++) {
+	graph->orderpos[n] = connorder[n];
+	if (connorder[n] >= 0) {
+	    graph->order[connorder[n]] = n;
+	    m++;
+	}
+    }
+    graph->numorder = m;
+
+    alloc_graph_arrays(graph);
+
+    if (verbose > 0) {
+	fprintf(stdout, "Timing graph:  %d nodes, %d edges.\n", numnodes,
+		graph->fanoutidx[numnodes]);
+	fflush(stdout);
+    }
+    return graph;
+}
+
+/*--------------------------------------------------------------*/
+/* Make a second timing graph that shares the nodes, edges and	*/
+/* ordering of "graph" but has its own per-analysis arrays, so	*/
+/* that maximum and minimum delay analyses can be run side by	*/
+/* side (see find_graph_paths_minmax()).			*/
+/*--------------------------------------------------------------*/
+
+tgraphptr
+clone_timing_graph(tgraphptr graph)
+{
+    tgraphptr newgraph;
+
+    newgraph = (tgraphptr)malloc(sizeof(tgraph));
+    *newgraph = *graph;
+    newgraph->unclocked = NULL;
+    alloc_graph_arrays(newgraph);
+    return newgraph;
+}
+
+/*--------------------------------------------------------------*/
+/* Cone of influence (options -T and -F):  the analysis may be	*/
+/* restricted to the paths into or out of a set of instances,	*/
+/* pins or nets.  The connections that such paths can pass	*/
+/* through are marked in "conemask" (indexed by connection	*/
+/* number, or NULL if the analysis is not restricted), and the	*/
+/* path searches do not go through any other connection.	*/
+/*--------------------------------------------------------------*/
+
+/*--------------------------------------------------------------*/
+/* Return 1 if "name" matches "pattern".  Names are also	*/
+/* compared literally, as bus bits such as "out[1]" would be	*/
+/* taken as a pattern by fnmatch().				*/
+/*--------------------------------------------------------------*/
+
+int
+cone_match(char *pattern, char *name)
+{
+    return (!strcmp(pattern, name) || !fnmatch(pattern, name, 0)) ? 1 : 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Mark the receivers of net "testnet" in "seed"		*/
+/*--------------------------------------------------------------*/
+
+void
+cone_seed_net(netptr testnet, unsigned char *seed)
+{
+    int i;
+
+    for (i = 0; i < testnet->fanout; i++)
+	if (testnet->receivers[i]->index >= 0)
+	    seed[testnet->receivers[i]->index] = 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Mark in "seed" the connections named by "pattern", which	*/
+/* may contain the wildcards of fnmatch(3), and is matched	*/
+/* against:							*/
+/*								*/
+/*   <instance>/<pin>	the input pin, or for an output pin,	*/
+/*			the receivers of the net it drives	*/
+/*   <instance>		the inputs of the instance;  for a	*/
+/*			register, its clock pin if "from" is	*/
+/*			set, and otherwise its other inputs	*/
+/*   <net>		the receivers of the net (including	*/
+/*			an output of the module)		*/
+/*								*/
+/* Return the number of instances, pins and nets matched.	*/
+/*--------------------------------------------------------------*/
+
+int
+cone_targets(instptr instlist, netptr netlist, char *pattern, char from,
+		unsigned char *seed)
+{
+    instptr testinst;
+    netptr testnet;
+    connptr testconn, clkconn;
+    char *pinpat;
+    int found = 0;
+
+    pinpat = strrchr(pattern, '/');
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	if (pinpat != NULL) {
+	    *pinpat = '\0';
+	    if (cone_match(pattern, testinst->name)) {
+		for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+		    if (testconn->index < 0) continue;
+		    if (!cone_match(pinpat + 1, testconn->refpin->name)) continue;
+		    seed[testconn->index] = 1;
+		    found++;
+		}
+		for (testconn = testinst->out_connects; testconn; testconn = testconn->next) {
+		    if (testconn->refnet == NULL) continue;
+		    if (!cone_match(pinpat + 1, testconn->refpin->name)) continue;
+		    cone_seed_net(testconn->refnet, seed);
+		    found++;
+		}
+	    }
+	    *pinpat = '/';
+	}
+	else if (cone_match(pattern, testinst->name)) {
+	    clkconn = find_register_clock(testinst);
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+		if (testconn->index < 0) continue;
+		if ((clkconn != NULL) && ((testconn == clkconn) != (from != 0)))
+		    continue;
+		seed[testconn->index] = 1;
+	    }
+	    found++;
+	}
+    }
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	if (cone_match(pattern, testnet->name)) {
+	    cone_seed_net(testnet, seed);
+	    found++;
+	}
+    return found;
+}
+
+/*--------------------------------------------------------------*/
+/* Set bit "bit" of "mask" on the nodes of "graph" that lie on	*/
+/* a path through a node marked in "seed":  the seeds, the	*/
+/* nodes in their fanin back to the start points, and the	*/
+/* nodes in their fanout up to the endpoints.  "seed" is	*/
+/* cleared.							*/
+/*--------------------------------------------------------------*/
+
+void
+cone_mark(tgraphptr graph, unsigned char *seed, unsigned char *mask,
+		unsigned char bit)
+{
+    unsigned char *visited;
+    int *stack;
+    int dir, n, m, i, sp;
+
+    visited = (unsigned char *)malloc(graph->numnodes * sizeof(unsigned char));
+    stack = (int *)malloc(graph->numnodes * sizeof(int));
+
+    /* dir = 0:  backward through the fanin;  dir = 1:  forward */
+
+    for (dir = 0; dir < 2; dir++) {
+	sp = 0;
+	for (n = 0; n < graph->numnodes; n++) {
+	    visited[n] = seed[n];
+	    if (seed[n]) stack[sp++] = n;
+	}
+	while (sp > 0) {
+	    n = stack[--sp];
+	    mask[n] |= bit;
+
+	    /* Paths start at a source and end at a sink */
+	    if ((dir == 0) && (graph->role[n] & GRAPH_SOURCE)) continue;
+	    if ((dir == 1) && !seed[n] && !(graph->role[n] & GRAPH_THROUGH)) continue;
+
+	    if (dir == 0) {
+		for (i = graph->faninidx[n]; i < graph->faninidx[n + 1]; i++) {
+		    m = graph->fanin[i];
+		    if (visited[m]) continue;
+		    visited[m] = 1;
+		    stack[sp++] = m;
+		}
+	    }
+	    else {
+		for (i = graph->fanoutidx[n]; i < graph->fanoutidx[n + 1]; i++) {
+		    m = graph->fanout[i];
+		    if (visited[m]) continue;
+		    visited[m] = 1;
+		    stack[sp++] = m;
+		}
+	    }
+	}
+    }
+    memset(seed, 0, graph->numnodes * sizeof(unsigned char));
+    free(visited);
+    free(stack);
+}
+
+/*--------------------------------------------------------------*/
+/* Make "conemask" from the patterns of options -T ("tolist")	*/
+/* and -F ("fromlist").  With both, a connection must be in	*/
+/* the cones of both.  Then remove the start points outside of	*/
+/* the cone from "clocklist" and "inputlist".  Return the	*/
+/* number of connections in the cone.				*/
+/*--------------------------------------------------------------*/
+
+int
+cone_restrict(tgraphptr graph, instptr instlist, netptr netlist,
+		char **tolist, int numto, char **fromlist, int numfrom,
+		connlistptr *clocklist, connlistptr *inputlist)
+{
+    unsigned char *seed, want;
+    connlistptr *link, freelink;
+    int i, k, n, count, num;
+    char **list;
+
+    seed = (unsigned char *)calloc(graph->numnodes, sizeof(unsigned char));
+    conemask = (unsigned char *)calloc(graph->numnodes, sizeof(unsigned char));
+
+    want = 0;
+    for (k = 0; k < 2; k++) {
+	list = (k == 0) ? tolist : fromlist;
+	num = (k == 0) ? numto : numfrom;
+	if (num == 0) continue;
+	for (i = 0; i < num; i++)
+	    if (cone_targets(instlist, netlist, list[i], (char)k, seed) == 0)
+		fprintf(stderr, "Warning:  Nothing matches \"%s\" (option %s).\n",
+			list[i], (k == 0) ? "-T" : "-F");
+	cone_mark(graph, seed, conemask, (unsigned char)(1 << k));
+	want |= (1 << k);
+    }
+    free(seed);
+
+    count = 0;
+    for (n = 0; n < graph->numnodes; n++) {
+	conemask[n] = (conemask[n] == want) ? 1 : 0;
+	count += conemask[n];
+    }
+
+    for (k = 0; k < 2; k++) {
+	link = (k == 0) ? clocklist : inputlist;
+	while (*link != NULL) {
+	    n = (*link)->connection->index;
+	    if ((n >= 0) && conemask[n]) {
+		link = &(*link)->next;
+		continue;
+	    }
+	    freelink = *link;
+	    *link = freelink->next;
+	    free(freelink);
+	}
+    }
+    return count;
+}
+
+/*--------------------------------------------------------------*/
+/* Pull the arrival times at the input of node "n" from the	*/
+/* gate outputs of all nodes in its fanin that come before	*/
+/* position "before" in the topological order.  The result is	*/
+/* placed in the arrays "arrival", "trans" and "pred", which	*/
+/* are either the propagation or the capture arrays of the	*/
+/* graph.  During the sweep, "before" is the position of "n",	*/
+/* so that edges back into a broken logic loop are ignored.	*/
+/*--------------------------------------------------------------*/
+
+void
+graph_pull(tgraphptr graph, int n, double *arrival, double *trans, int *pred,
+		char minmax, int before)
+{
+    int i, e, u, ue;
+    double delay;
+
+    /* Nothing arrives outside of the cone of influence */
+    if (conemask && !conemask[n]) {
+	pred[2 * n] = pred[2 * n + 1] = NOPRED;
+	return;
+    }
+
+    for (e = 0; e < 2; e++) {
+	pred[2 * n + e] = NOPRED;
+	for (i = graph->faninidx[n]; i < graph->faninidx[n + 1]; i++) {
+	    u = graph->fanin[i];
+	    if (graph->orderpos[u] >= before) continue;
+	    ue = 2 * u + e;
+	    if (graph->outedge[ue] == NOPRED) continue;
+	    delay = graph->outdelay[ue];
+	    if ((pred[2 * n + e] == NOPRED) ||
+			((minmax == MAXIMUM_TIME) && (delay > arrival[2 * n + e])) ||
+			((minmax != MAXIMUM_TIME) && (delay < arrival[2 * n + e]))) {
+		arrival[2 * n + e] = delay;
+		trans[2 * n + e] = graph->outtrans[ue];
+		pred[2 * n + e] = 2 * u + graph->outedge[ue];
+	    }
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Compute the arrival and transition times at the output of	*/
+/* the gate driven by node "n" from the arrival times at its	*/
+/* input, for each output edge.  This is the same computation	*/
+/* done at each step of find_path_delay().			*/
+/*--------------------------------------------------------------*/
+
+void
+graph_push(tgraphptr graph, int n, char minmax)
+{
+    connptr testconn;
+    short dir, outdir;
+    int e, oe, ne;
+    double delay, trans;
+
+    profcount.visits++;
+    testconn = graph->nodes[n];
+    graph->outedge[2 * n] = graph->outedge[2 * n + 1] = NOPRED;
+
+    for (e = 0; e < 2; e++) {
+	ne = 2 * n + e;
+	if (graph->pred[ne] == NOPRED) continue;
+	dir = (e == 0) ? RISING : FALLING;
+
+	/* Module inputs launch both edges */
+	if ((graph->pred[ne] == -1) && (testconn->refpin == NULL)) dir = EITHER;
+
+	outdir = calc_dir(testconn->refpin, dir);
+	for (oe = 0; oe < 2; oe++) {
+	    if (!(outdir & ((oe == 0) ? RISING : FALLING))) continue;
+	    delay = graph->arrival[ne] + calc_prop_delay(graph->trans[ne],
+			testconn, (oe == 0) ? RISING : FALLING, minmax);
+	    trans = calc_transition(graph->trans[ne], testconn,
+			(oe == 0) ? RISING : FALLING, minmax);
+	    if ((graph->outedge[2 * n + oe] == NOPRED) ||
+			((minmax == MAXIMUM_TIME) &&
+			(delay > graph->outdelay[2 * n + oe])) ||
+			((minmax != MAXIMUM_TIME) &&
+			(delay < graph->outdelay[2 * n + oe]))) {
+		graph->outdelay[2 * n + oe] = delay;
+		graph->outtrans[2 * n + oe] = trans;
+		graph->outedge[2 * n + oe] = e;
+	    }
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Create the backtrace for the arrival at node "n", edge "e"	*/
+/* by following the predecessor records back to the source.	*/
+/* Backtrace records are shared between paths through "memo",	*/
+/* which caches the record made for each node and edge.		*/
+/* Records are allocated from "pool".				*/
+/*								*/
+/* Arrivals in the graph include the launch clock arrival at	*/
+/* the start point, "launch", which is subtracted so that the	*/
+/* delays recorded are relative to the start point, as they	*/
+/* are in find_path_delay().  Every node and edge on the path	*/
+/* has the same start point, so records can be shared.		*/
+/*--------------------------------------------------------------*/
+
+btptr
+graph_backtrace(tgraphptr graph, int n, int e, double delay, double trans,
+		int pred, double launch, btptr *memo, pathpool *pool)
+{
+    workstack *ws = &workmem;
+    btptr newbtdata, nextbt;
+    connptr testconn;
+    size_t base;
+    double d, t;
+    int q, m, k, r;
+
+    /* Walk back to the start point or to the first node and	*/
+    /* edge that already has a record, keeping each node and	*/
+    /* edge on the work stack, as the path may be very long.	*/
+
+    base = ws->top;
+    for (q = pred; (q >= 0) && (memo[q] == NULL); q = graph->pred[q])
+	*(int *)work_push(ws, sizeof(int)) = q;
+    nextbt = (q >= 0) ? memo[q] : NULL;
+
+    /* Make the records from the start point forward */
+
+    while (1) {
+	if (ws->top > base) {
+	    q = *(int *)work_top(ws, sizeof(int));
+	    work_pop(ws, sizeof(int));
+	    m = q >> 1;
+	    k = q & 1;
+	    d = graph->arrival[q];
+	    t = graph->trans[q];
+	    r = graph->pred[q];
+	}
+	else {
+	    q = -1;
+	    m = n;
+	    k = e;
+	    d = delay;
+	    t = trans;
+	    r = pred;
+	}
+
+	testconn = graph->nodes[m];
+	newbtdata = create_btdata(pool);
+	newbtdata->receiver = testconn;
+	newbtdata->delay = d - launch + testconn->icDelay;
+	newbtdata->trans = t;
+	if ((r == -1) && (testconn->refpin == NULL))
+	    newbtdata->dir = EITHER;
+	else
+	    newbtdata->dir = (k == 0) ? RISING : FALLING;
+	newbtdata->refcnt = 0;
+	newbtdata->next = nextbt;
+	if (nextbt) nextbt->refcnt++;
+	if (q < 0) break;
+	memo[q] = newbtdata;
+	nextbt = newbtdata;
+    }
+    return newbtdata;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the launch clock arrival at start point "testconn".	*/
+/* Where the register clock is a simple chain in the clock	*/
+/* cache "clocks", this is the arrival from the clock root, as	*/
+/* used by find_clock_skews().  Module inputs, and registers	*/
+/* whose clock is not a simple chain, launch at zero.		*/
+/*								*/
+/* The graph keeps only the worst arrival at each endpoint, so	*/
+/* the launch clock must be included in the arrival for the	*/
+/* worst path to be the one that is worst after clock skew is	*/
+/* applied.							*/
+/*--------------------------------------------------------------*/
+
+chainptr get_clock_chain(clockcacheptr clocks, connptr clkconn);
+double *chain_launch_delays(chainptr chain, char minmax);
+
+double
+graph_launch(connptr testconn, char minmax, clockcacheptr clocks)
+{
+    chainptr chain;
+    double launch;
+
+    if ((clocks == NULL) || (testconn->refpin == NULL)) return 0.0;
+    chain = get_clock_chain(clocks, testconn);
+    if (chain == NULL) return 0.0;
+    launch = chain_launch_delays(chain, minmax)[chain->length - 1];
+    return (launch == INITVAL) ? 0.0 : launch;
+}
+
+/*--------------------------------------------------------------*/
+/* Set the arrival times at the start points in "startlist" to	*/
+/* their launch clock arrivals (see graph_launch()), and clear	*/
+/* all other arrivals.						*/
+/*								*/
+/* Return value is 1 if any start point has a non-zero launch	*/
+/* clock arrival, and 0 otherwise.				*/
+/*--------------------------------------------------------------*/
+
+int
+graph_seed(tgraphptr graph, connlistptr startlist, char minmax,
+		clockcacheptr clocks)
+{
+    connlistptr testlink;
+    connptr     testconn;
+    cellptr     testcell;
+    short       srcdir;
+    int         n, e, ne, skewed;
+
+    for (ne = 0; ne < 2 * graph->numnodes; ne++)
+	graph->pred[ne] = NOPRED;
+
+    skewed = 0;
+    for (testlink = startlist; testlink; testlink = testlink->next) {
+	testconn = testlink->connection;
+	n = testconn->index;
+	if (n < 0) continue;
+	if (testconn->refpin) {
+	    testcell = testconn->refpin->refcell;
+	    srcdir = (testcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
+	}
+	else
+	    srcdir = EITHER;
+	graph->launch[n] = graph_launch(testconn, minmax, clocks);
+	if (graph->launch[n] != 0.0) skewed = 1;
+	for (e = 0; e < 2; e++) {
+	    if (!(srcdir & ((e == 0) ? RISING : FALLING))) continue;
+	    graph->arrival[2 * n + e] = graph->launch[n];
+	    graph->trans[2 * n + e] = 0.0;
+	    graph->pred[2 * n + e] = -1;
+	}
+    }
+    graph->skewed = skewed;
+    graph->clocks = clocks;
+    return skewed;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the companion of "graph" that is timed without launch	*/
+/* clock arrivals, making it if necessary.			*/
+/*--------------------------------------------------------------*/
+
+tgraphptr
+graph_unclocked(tgraphptr graph)
+{
+    if (graph->unclocked == NULL)
+	graph->unclocked = clone_timing_graph(graph);
+    return graph->unclocked;
+}
+
+/*--------------------------------------------------------------*/
+/* Sweep the arrivals of "graph" forward in topological order	*/
+/* from the start points set by graph_seed().			*/
+/*--------------------------------------------------------------*/
+
+void
+graph_sweep(tgraphptr graph, char minmax)
+{
+    int         i, n;
+
+    for (i = 0; i < graph->numorder; i++) {
+	n = graph->order[i];
+	if (graph->role[n] & GRAPH_THROUGH)
+	    graph_pull(graph, n, graph->arrival, graph->trans, graph->pred, minmax, i);
+	graph_push(graph, n, minmax);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Same as graph_sweep(), but sweeping the maximum delay graph	*/
+/* "maxgraph" and the minimum delay graph "mingraph" side by	*/
+/* side (see find_graph_paths_minmax()).			*/
+/*--------------------------------------------------------------*/
+
+void
+graph_sweep_minmax(tgraphptr maxgraph, tgraphptr mingraph)
+{
+    int         i, n;
+
+    for (i = 0; i < maxgraph->numorder; i++) {
+	n = maxgraph->order[i];
+	if (maxgraph->role[n] & GRAPH_THROUGH) {
+	    graph_pull(maxgraph, n, maxgraph->arrival, maxgraph->trans,
+			maxgraph->pred, MAXIMUM_TIME, i);
+	    graph_pull(mingraph, n, mingraph->arrival, mingraph->trans,
+			mingraph->pred, MINIMUM_TIME, i);
+	}
+	graph_push(maxgraph, n, MAXIMUM_TIME);
+	graph_push(mingraph, n, MINIMUM_TIME);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Return 1 if sink "testconn" is a register input, where	*/
+/* find_clock_skews() adds the clock skew to the path delay	*/
+/* (see CAPTURE_CLOCKED), and 0 otherwise.			*/
+/*--------------------------------------------------------------*/
+
+int
+graph_sink_clocked(connptr testconn)
+{
+    return (testconn->refinst != NULL) &&
+		(find_register_clock(testconn->refinst) != NULL);
+}
+
+/*--------------------------------------------------------------*/
+/* Find the Pareto frontier of the arrivals (see frontier_add())	*/
+/* at each node of "graph" from all of the start points set by	*/
+/* graph_seed() (or etm_seed()) at once.  This is the search	*/
+/* made from a single start point by find_path_frontier(), but	*/
+/* with every start point seeded at its arrival and transition	*/
+/* in the graph, and the nodes visited in one sweep in		*/
+/* topological order.  Each point holds a reference to the	*/
+/* backtrace of its path, in which delays are relative to the	*/
+/* launch clock arrival of the start point.			*/
+/*								*/
+/* Unlike the arrival kept at each node by graph_sweep(), the	*/
+/* frontier keeps every arrival that is not dominated, so that	*/
+/* a path arriving earlier with a slower transition, which can	*/
+/* be the worse one downstream, is not lost.  As in the graph,	*/
+/* arrivals from different start points are compared with their	*/
+/* launch clock arrivals, and not with the clock skew to each	*/
+/* endpoint, which depends on the common clock point.		*/
+/*--------------------------------------------------------------*/
+
+void
+graph_frontier(tgraphptr graph, frontptr front, char minmax)
+{
+    connptr  testconn, rcvr;
+    btptr    backtrace, newbtdata;
+    paretopoint *pt;
+    double   delay, trans, launch, newdelay, newtrans;
+    short    dir, outdir, odir;
+    int      i, j, n, m, p, q, e;
+
+    /* Start points */
+
+    for (i = 0; i < graph->numorder; i++) {
+	n = graph->order[i];
+	if (graph->pred[2 * n] == -1)
+	    dir = (graph->pred[2 * n + 1] == -1) ? EITHER : RISING;
+	else if (graph->pred[2 * n + 1] == -1)
+	    dir = FALLING;
+	else
+	    continue;
+	testconn = graph->nodes[n];
+	e = (dir == FALLING) ? 1 : 0;
+	p = frontier_add(front, n, dir, graph->arrival[2 * n + e],
+		graph->trans[2 * n + e], minmax);
+	newbtdata = create_btdata(front->pool);
+	newbtdata->receiver = testconn;
+	newbtdata->delay = graph->arrival[2 * n + e] - graph->launch[n] +
+		testconn->icDelay;
+	newbtdata->trans = graph->trans[2 * n + e];
+	newbtdata->dir = dir;
+	newbtdata->refcnt = 1;
+	newbtdata->next = NULL;
+	front->points[p].backtrace = newbtdata;
+    }
+
+    for (i = 0; i < graph->numorder; i++) {
+	n = graph->order[i];
+	if (front->stamp[n] != front->current) continue;
+	testconn = graph->nodes[n];
+
+	/* Points are addressed by index, as adding to the frontier	*/
+	/* downstream may move the storage.				*/
+
+	for (p = front->head[n]; p >= 0; p = front->points[p].next) {
+	    pt = &front->points[p];
+	    backtrace = pt->backtrace;
+
+	    /* Register inputs terminate the path, except at the start */
+	    if (!(graph->role[n] & GRAPH_THROUGH) && (backtrace->next != NULL))
+		continue;
+
+	    delay = pt->delay;
+	    trans = pt->trans;
+	    dir = pt->dir;
+	    launch = delay - backtrace->delay + testconn->icDelay;
+
+	    outdir = calc_dir(testconn->refpin, dir);
+	    for (odir = RISING; odir <= FALLING; odir++) {
+		if (!(outdir & odir)) continue;
+		newdelay = delay + calc_prop_delay(trans, testconn, odir, minmax);
+		newtrans = calc_transition(trans, testconn, odir, minmax);
+
+		for (j = graph->fanoutidx[n]; j < graph->fanoutidx[n + 1]; j++) {
+		    m = graph->fanout[j];
+
+		    /* Ignore edges back into a broken logic loop */
+		    if ((graph->role[m] & GRAPH_THROUGH) && (graph->orderpos[m] <= i))
+			continue;
+		    if (conemask && !conemask[m]) continue;
+
+		    q = frontier_add(front, m, odir, newdelay, newtrans, minmax);
+		    if (q < 0) continue;
+
+		    rcvr = graph->nodes[m];
+		    newbtdata = create_btdata(front->pool);
+		    newbtdata->receiver = rcvr;
+		    newbtdata->delay = newdelay - launch + rcvr->icDelay;
+		    newbtdata->trans = newtrans;
+		    newbtdata->dir = odir;
+		    newbtdata->refcnt = 1;
+		    newbtdata->next = backtrace;
+		    backtrace->refcnt++;
+		    front->points[q].backtrace = newbtdata;
+		}
+	    }
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Return the index of the point in frontier "front" at sink	*/
+/* node "n" of "graph" (see graph_frontier()) whose path has	*/
+/* the worst (minmax) delay as reported, or -1 if no path	*/
+/* reaches the sink.  At a register input, each path is timed	*/
+/* by find_clock_skews(), which adds the clock skew and the	*/
+/* setup or hold time for its start point.			*/
+/*--------------------------------------------------------------*/
+
+void find_clock_skews(ddataptr pathlist, char minmax, clockcacheptr clocks);
+
+int
+graph_worst_point(tgraphptr graph, frontptr front, int n, char minmax)
+{
+    paretopoint *pt;
+    connptr sinkconn;
+    delaydata trial;
+    double delay, worst;
+    unsigned char clocked, saveverbose;
+    int p, best;
+
+    if (front->stamp[n] != front->current) return -1;
+
+    sinkconn = graph->nodes[n];
+    clocked = (sinkconn->refinst != NULL) &&
+		(find_register_clock(sinkconn->refinst) != NULL);
+
+    /* find_clock_skews() reports each path it times when verbose */
+    saveverbose = verbose;
+    verbose = 0;
+
+    /* Points are listed newest first;  of equal delays, take the	*/
+    /* one found first, as find_path_frontier() does.			*/
+
+    best = -1;
+    worst = 0.0;
+    for (p = front->head[n]; p >= 0; p = pt->next) {
+	pt = &front->points[p];
+	if (pt->backtrace->next == NULL) continue;	/* Start point */
+	if (clocked) {
+	    trial.backtrace = pt->backtrace;
+	    trial.skew = trial.setup = 0.0;
+	    trial.next = NULL;
+	    find_clock_skews(&trial, minmax, graph->clocks);
+	    delay = trial.delay;
+	}
+	else
+	    delay = pt->backtrace->delay;
+	if ((best < 0) || ((minmax == MAXIMUM_TIME) ? (delay >= worst) :
+			(delay <= worst))) {
+	    best = p;
+	    worst = delay;
+	}
+    }
+    verbose = saveverbose;
+    return best;
+}
+
+/*--------------------------------------------------------------*/
+/* Capture the arrivals at the sinks of "graph" after a sweep,	*/
+/* and record the worst (minmax) path into each endpoint in	*/
+/* "masterlist", with records allocated from "pool".  "select"	*/
+/* is one of CAPTURE_ALL, CAPTURE_CLOCKED (register inputs,	*/
+/* where find_clock_skews() adds the clock skew to the path	*/
+/* delay) or CAPTURE_UNCLOCKED (all other sinks).		*/
+/*								*/
+/* The path recorded is the worst of the frontier at the sink	*/
+/* (see graph_worst_point()).  With option -K, the worst	*/
+/* "pathsperend" paths into each endpoint are recorded instead.	*/
+/* Both are done by graph_kpaths().				*/
+/*								*/
+/* Return value is the number of paths recorded.		*/
+/*--------------------------------------------------------------*/
+
+int graph_kpaths(tgraphptr graph, ddataptr *masterlist, char minmax,
+		pathpool *pool, char select, int k, int endpoint);
+
+int
+graph_capture(tgraphptr graph, ddataptr *masterlist, char minmax,
+		pathpool *pool, char select)
+{
+    return graph_kpaths(graph, masterlist, minmax, pool, select, pathsperend, -1);
+}
+
+/*--------------------------------------------------------------*/
+/* Advance the arrival time "*delay" and transition time	*/
+/* "*trans" at node edge "q" of "graph" through the gate driven	*/
+/* by the node, to output edge "oe", as graph_push() does.	*/
+/*								*/
+/* Return value is 1 if the gate output can make transition	*/
+/* "oe" from the transition at "q", and 0 otherwise.		*/
+/*--------------------------------------------------------------*/
+
+int
+graph_step(tgraphptr graph, int q, int oe, char minmax, double *delay,
+		double *trans)
+{
+    connptr testconn;
+    short dir, outdir;
+    double intrans;
+
+    testconn = graph->nodes[q >> 1];
+    dir = (q & 1) ? FALLING : RISING;
+
+    /* Module inputs launch both edges */
+    if ((graph->pred[q] == -1) && (testconn->refpin == NULL)) dir = EITHER;
+
+    outdir = calc_dir(testconn->refpin, dir);
+    if (!(outdir & ((oe == 0) ? RISING : FALLING))) return 0;
+
+    intrans = *trans;
+    *delay += calc_prop_delay(intrans, testconn, (oe == 0) ? RISING : FALLING,
+		minmax);
+    *trans = calc_transition(intrans, testconn, (oe == 0) ? RISING : FALLING,
+		minmax);
+    return 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Heap of paths for graph_kpaths(), worst (minmax) at the	*/
+/* root.  kpath_heap_add() adds path "p" to the "*count" paths	*/
+/* in "*heap", which has room for "*size" and is grown as	*/
+/* needed.  kpath_heap_pop() removes and returns the root.	*/
+/*--------------------------------------------------------------*/
+
+#define KPATH_WORSE(a, b) ((minmax == MAXIMUM_TIME) ? \
+		((a)->delay > (b)->delay) : ((a)->delay < (b)->delay))
+
+void
+kpath_heap_add(kpathptr **heap, int *count, int *size, kpathptr p, char minmax)
+{
+    int i, c;
+
+    if (*count == *size) {
+	*size = (*size == 0) ? 256 : 2 * *size;
+	*heap = (kpathptr *)realloc(*heap, *size * sizeof(kpathptr));
+    }
+    i = (*count)++;
+    while (i > 0) {
+	c = (i - 1) / 2;
+	if (!KPATH_WORSE(p, (*heap)[c])) break;
+	(*heap)[i] = (*heap)[c];
+	i = c;
+    }
+    (*heap)[i] = p;
+}
+
+kpathptr
+kpath_heap_pop(kpathptr *heap, int *count, char minmax)
+{
+    kpathptr top, p;
+    int i, c;
+
+    top = heap[0];
+    p = heap[--(*count)];
+    i = 0;
+    while ((c = 2 * i + 1) < *count) {
+	if ((c + 1 < *count) && KPATH_WORSE(heap[c + 1], heap[c])) c++;
+	if (!KPATH_WORSE(heap[c], p)) break;
+	heap[i] = heap[c];
+	i = c;
+    }
+    heap[i] = p;
+    return top;
+}
+
+#undef KPATH_WORSE
+
+/*--------------------------------------------------------------*/
+/* Find the node edges of path "kp" into sink "n" of "graph"	*/
+/* (see graph_kpaths()) from the sink back to the deviation	*/
+/* furthest upstream, and put them in "segment", sink first.	*/
+/* From predecessor "*tail" of the last of them, the path	*/
+/* follows the worst predecessors recorded in the graph.	*/
+/* "devs" has room for an entry for every node.			*/
+/*								*/
+/* Return value is the number of node edges in "segment".	*/
+/*--------------------------------------------------------------*/
+
+int
+kpath_segment(tgraphptr graph, int n, kpathptr kp, int *segment, kpathptr *devs,
+		int *tail)
+{
+    kpathptr chain;
+    int numdev, numseg, x, q;
+
+    /* Deviations, the one nearest the sink last */
+    numdev = 0;
+    for (chain = kp; chain->parent; chain = chain->parent)
+	devs[numdev++] = chain;
+
+    x = chain->node;
+    numseg = 0;
+    while (1) {
+	segment[numseg++] = x;
+	if ((numdev > 0) && (devs[numdev - 1]->node == x))
+	    q = devs[--numdev]->pred;
+	else
+	    q = ((x >> 1) == n) ? graph->cappred[x] : graph->pred[x];
+	if (numdev == 0) break;
+	x = q;
+    }
+    *tail = q;
+    return numseg;
+}
+
+/*--------------------------------------------------------------*/
+/* Return a hash of the nodes (but not the edges) of the path	*/
+/* with node edges "segment" and then the worst predecessors	*/
+/* from "q" (see kpath_segment()).  Zero is not returned.	*/
+/*--------------------------------------------------------------*/
+
+uint64_t
+kpath_signature(tgraphptr graph, int *segment, int numseg, int q)
+{
+    uint64_t hash = 14695981039346656037ULL;	/* FNV-1a */
+    int i;
+
+    for (i = 0; i < numseg; i++)
+	hash = (hash ^ (uint64_t)(segment[i] >> 1)) * 1099511628211ULL;
+    for (; q >= 0; q = graph->pred[q])
+	hash = (hash ^ (uint64_t)(q >> 1)) * 1099511628211ULL;
+    return (hash == 0) ? 1 : hash;
+}
+
+/*--------------------------------------------------------------*/
+/* Same as kpath_signature(), for the path with backtrace "bt".	*/
+/*--------------------------------------------------------------*/
+
+uint64_t
+backtrace_signature(btptr bt)
+{
+    uint64_t hash = 14695981039346656037ULL;	/* FNV-1a */
+
+    for (; bt; bt = bt->next)
+	hash = (hash ^ (uint64_t)bt->receiver->index) * 1099511628211ULL;
+    return (hash == 0) ? 1 : hash;
+}
+
+/*--------------------------------------------------------------*/
+/* Make the backtrace of the path with node edges "segment"	*/
+/* and then the worst predecessors from "q" (see		*/
+/* kpath_segment()), with records from "pool".  The part from	*/
+/* "q" back to the start point is made by graph_backtrace() and	*/
+/* shared through "memo".  The arrivals along "segment" are	*/
+/* found again with the transition times of this path.		*/
+/*--------------------------------------------------------------*/
+
+btptr
+kpath_backtrace(tgraphptr graph, int *segment, int numseg, int q, char minmax,
+		btptr *memo, pathpool *pool)
+{
+    btptr newbtdata, nextbt;
+    double delay, trans, launch;
+    int x, p;
+
+    /* Start point, for its launch clock arrival */
+    for (p = q; graph->pred[p] >= 0; p = graph->pred[p]);
+    launch = graph->launch[p >> 1];
+
+    nextbt = memo[q];
+    if (nextbt == NULL) {
+	nextbt = graph_backtrace(graph, q >> 1, q & 1, graph->arrival[q],
+		graph->trans[q], graph->pred[q], launch, memo, pool);
+	memo[q] = nextbt;
+    }
+    delay = graph->arrival[q];
+    trans = graph->trans[q];
+
+    while (numseg > 0) {
+	x = segment[--numseg];
+	graph_step(graph, q, x & 1, minmax, &delay, &trans);
+	newbtdata = create_btdata(pool);
+	newbtdata->receiver = graph->nodes[x >> 1];
+	newbtdata->delay = delay - launch + newbtdata->receiver->icDelay;
+	newbtdata->trans = trans;
+	newbtdata->dir = (x & 1) ? FALLING : RISING;
+	newbtdata->refcnt = 0;
+	newbtdata->next = nextbt;
+	nextbt->refcnt++;
+	nextbt = newbtdata;
+	q = x;
+    }
+    return nextbt;
+}
+
+/*--------------------------------------------------------------*/
+/* Record up to "k" paths into each sink of "graph", worst	*/
+/* (minmax) first, for graph_capture().  If "endpoint" is not	*/
+/* negative, only paths into that node are recorded.		*/
+/*								*/
+/* The first path into each sink is the worst path of the	*/
+/* frontier (see graph_frontier() and graph_worst_point()),	*/
+/* timed with its clock skew and setup or hold time, and so	*/
+/* does not depend on "k".  The other paths are enumerated	*/
+/* from the arrival times already in the graph,			*/
+/* without a search.  Arriving at a node edge from another	*/
+/* node than the worst predecessor makes the arrival at the	*/
+/* endpoint worse by the difference between the gate output	*/
+/* time of that node (see graph_push()) and the arrival		*/
+/* recorded at the node edge.  Starting from the worst path	*/
+/* into each edge of the sink, the next worst path is taken	*/
+/* from a heap, and the paths that deviate from it at one node	*/
+/* edge upstream of its own deviation are added to the heap,	*/
+/* so that each path is found once, and only the paths		*/
+/* reported are expanded.					*/
+/*								*/
+/* Each path takes the transition at each node that is worst	*/
+/* for the transition at the next node, as in the graph, so	*/
+/* paths are sequences of pins;  if both edges of the sink are	*/
+/* reached through the same pins, only the worse is recorded.	*/
+/* Arrivals used for the ordering come from the transition	*/
+/* times recorded in the graph, which are those of the worst	*/
+/* path through each node, and the arrivals of each path are	*/
+/* then found again with its own transition times (see		*/
+/* kpath_backtrace()).  The paths after the first are therefore	*/
+/* in order of delay to within the effect of transition time;	*/
+/* the path of the frontier is skipped when it comes up.  The	*/
+/* frontier compares start points by launch clock arrival (see	*/
+/* graph_frontier()), so where the clock skew to the sink	*/
+/* differs from that, a larger "k" can still find a worse path.	*/
+/*								*/
+/* Return value is the number of paths recorded.		*/
+/*--------------------------------------------------------------*/
+
+int
+graph_kpaths(tgraphptr graph, ddataptr *masterlist, char minmax,
+		pathpool *pool, char select, int k, int endpoint)
+{
+    ddataptr    newddata;
+    btptr       *memo;
+    kpathptr    *heap, *devs, kp, newkp;
+    frontier    front;
+    arena       kmem;
+    arenablockptr block;
+    uint64_t    *sigs, sig;
+    int         *segment;
+    int         numpaths, numends, count, size, found, numseg, sigmask;
+    int         i, n, e, u, ue, x, p, q, best, before, atsink;
+    double      arrival;
+    char        clocked;
+
+    frontier_init(&front, graph, pool);
+    graph_frontier(graph, &front, minmax);
+
+    memo = (btptr *)calloc(2 * graph->numnodes, sizeof(btptr));
+    segment = (int *)malloc(graph->numnodes * sizeof(int));
+    devs = (kpathptr *)malloc(graph->numnodes * sizeof(kpathptr));
+    heap = NULL;
+    size = 0;
+    kmem.blocks = kmem.spare = NULL;
+    numpaths = numends = 0;
+
+    /* Hash table of the paths recorded into the current sink */
+    for (sigmask = 15; sigmask < 2 * k; sigmask = 2 * sigmask + 1);
+    sigs = (uint64_t *)malloc((sigmask + 1) * sizeof(uint64_t));
+
+    for (n = graph->numnodes - 1; n >= 0; n--) {
+	if (!(graph->role[n] & GRAPH_SINK)) continue;
+	if ((endpoint >= 0) && (n != endpoint)) continue;
+	if (select != CAPTURE_ALL) {
+	    clocked = graph_sink_clocked(graph->nodes[n]);
+	    if (clocked != (select == CAPTURE_CLOCKED)) continue;
+	}
+	graph_pull(graph, n, graph->captured, graph->captrans, graph->cappred, minmax,
+			graph->numorder);
+
+	/* The worst path into each edge of the sink */
+	count = 0;
+	for (e = 0; e < 2; e++) {
+	    if (graph->cappred[2 * n + e] == NOPRED) continue;
+	    newkp = (kpathptr)arena_alloc(&kmem, sizeof(kpath));
+	    newkp->delay = graph->captured[2 * n + e];
+	    newkp->node = 2 * n + e;
+	    newkp->pred = graph->cappred[2 * n + e];
+	    newkp->parent = NULL;
+	    kpath_heap_add(&heap, &count, &size, newkp, minmax);
+	}
+	memset(sigs, 0, (sigmask + 1) * sizeof(uint64_t));
+
+	/* The worst path of the frontier */
+	found = 0;
+	p = graph_worst_point(graph, &front, n, minmax);
+	if (p >= 0) {
+	    newddata = create_delaydata(pool);
+	    newddata->delay = 0.0;
+	    newddata->setup = 0.0;
+	    newddata->skew = 0.0;
+	    newddata->trans = 0.0;
+	    newddata->backtrace = front.points[p].backtrace;
+	    newddata->backtrace->refcnt++;
+	    newddata->next = *masterlist;
+	    *masterlist = newddata;
+	    numpaths++;
+	    found++;
+	    sig = backtrace_signature(newddata->backtrace);
+	    sigs[sig & sigmask] = sig;
+	}
+	if ((count > 0) || (found > 0)) numends++;
+
+	while ((found < k) && (count > 0)) {
+	    kp = kpath_heap_pop(heap, &count, minmax);
+
+	    /* Record the path unless it was found with other edges */
+	    numseg = kpath_segment(graph, n, kp, segment, devs, &q);
+	    sig = kpath_signature(graph, segment, numseg, q);
+	    for (i = sig & sigmask; (sigs[i] != 0) && (sigs[i] != sig);
+			i = (i + 1) & sigmask);
+	    if (sigs[i] == 0) {
+		sigs[i] = sig;
+		newddata = create_delaydata(pool);
+		newddata->delay = 0.0;
+		newddata->setup = 0.0;
+		newddata->skew = 0.0;
+		newddata->trans = 0.0;
+		newddata->backtrace = kpath_backtrace(graph, segment, numseg, q,
+			minmax, memo, pool);
+		newddata->backtrace->refcnt++;
+		newddata->next = *masterlist;
+		*masterlist = newddata;
+		numpaths++;
+		if (++found == k) break;
+	    }
+
+	    /* Add the paths deviating from this one upstream of its	*/
+	    /* own deviation (at the sink itself, for a worst path)	*/
+
+	    atsink = (kp->parent == NULL);
+	    x = (atsink) ? kp->node : kp->pred;
+	    while (1) {
+		if (atsink) {
+		    arrival = graph->captured[x];
+		    best = graph->cappred[x];
+		    before = graph->numorder;
+		}
+		else {
+		    if (graph->pred[x] < 0) break;	/* Start point */
+		    arrival = graph->arrival[x];
+		    best = graph->pred[x];
+		    before = graph->orderpos[x >> 1];
+		}
+		for (i = graph->faninidx[x >> 1]; i < graph->faninidx[(x >> 1) + 1]; i++) {
+		    u = graph->fanin[i];
+		    if ((graph->orderpos[u] >= before) || (u == (best >> 1))) continue;
+		    ue = 2 * u + (x & 1);
+		    if (graph->outedge[ue] == NOPRED) continue;
+		    newkp = (kpathptr)arena_alloc(&kmem, sizeof(kpath));
+		    newkp->delay = kp->delay + graph->outdelay[ue] - arrival;
+		    newkp->node = x;
+		    newkp->pred = 2 * u + graph->outedge[ue];
+		    newkp->parent = kp;
+		    kpath_heap_add(&heap, &count, &size, newkp, minmax);
+		}
+		atsink = 0;
+		x = best;
+	    }
+	}
+	arena_reset(&kmem);
+    }
+
+    while (kmem.spare != NULL) {
+	block = kmem.spare;
+	kmem.spare = block->next;
+	free(block);
+    }
+    free(sigs);
+    free(heap);
+    free(devs);
+    free(segment);
+    free(memo);
+    frontier_reset(&front, graph->numnodes);
+    frontier_free(&front);
+
+    if (verbose > 1)
+	fprintf(stdout, "%d endpoints reached.\n\n", numends);
+
+    return numpaths;
+}
+
+/*--------------------------------------------------------------*/
+/* Levelized (block-based) alternative to			*/
+/* find_clock_to_term_paths().  Arrival times are propagated	*/
+/* from all start points in "startlist" together in a single	*/
+/* sweep over the timing graph in topological order, keeping	*/
+/* the worst (minmax) arrival for each node and edge.  One path	*/
+/* is recorded for each endpoint reached, being the worst path	*/
+/* into that endpoint over all start points.  Backtraces are	*/
+/* only generated for the endpoints, and are shared where paths	*/
+/* overlap.							*/
+/*								*/
+/* The delay of a path ending on a register input has the	*/
+/* clock skew added to it (see find_clock_skews()), so the	*/
+/* arrivals for those endpoints include the launch clock	*/
+/* arrival at the start point, taken from the clock cache	*/
+/* "clocks" (see graph_launch()).  Other endpoints are timed	*/
+/* from zero, as in find_clock_to_term_paths(), in a second	*/
+/* sweep over the companion graph (see graph_unclocked()),	*/
+/* which is only needed if some start point has a non-zero	*/
+/* launch clock arrival.					*/
+/*								*/
+/* Return value is the number of paths recorded in masterlist.	*/
+/*--------------------------------------------------------------*/
+
+int
+find_graph_paths(tgraphptr graph, connlistptr startlist, ddataptr *masterlist,
+		char minmax, clockcacheptr clocks)
+{
+    tgraphptr   rawgraph;
+    int         numpaths;
+
+    if (graph_seed(graph, startlist, minmax, clocks) == 0) {
+	graph_sweep(graph, minmax);
+	return graph_capture(graph, masterlist, minmax, &pathmem, CAPTURE_ALL);
+    }
+    graph_sweep(graph, minmax);
+    numpaths = graph_capture(graph, masterlist, minmax, &pathmem, CAPTURE_CLOCKED);
+
+    rawgraph = graph_unclocked(graph);
+    graph_seed(rawgraph, startlist, minmax, NULL);
+    graph_sweep(rawgraph, minmax);
+    numpaths += graph_capture(rawgraph, masterlist, minmax, &pathmem,
+		CAPTURE_UNCLOCKED);
+    return numpaths;
+}
+
+/*--------------------------------------------------------------*/
+/* Same as find_graph_paths(), but finding both the maximum	*/
+/* and minimum delay paths in one sweep over the timing graph.	*/
+/* "maxgraph" and "mingraph" share their structure (see		*/
+/* clone_timing_graph()), so each node's fanin is read once for	*/
+/* both analyses.  Maximum delay paths are recorded in		*/
+/* "maxlist" in the pass storage.  Minimum delay paths are	*/
+/* recorded in "minlist" with records from "minpool", so that	*/
+/* they can be kept until the minimum delay pass.  The number	*/
+/* of minimum delay paths is returned in "numminpaths".  Launch	*/
+/* clock arrivals are handled as in find_graph_paths().		*/
+/*								*/
+/* Return value is the number of paths recorded in maxlist.	*/
+/*--------------------------------------------------------------*/
+
+int
+find_graph_paths_minmax(tgraphptr maxgraph, tgraphptr mingraph,
+		connlistptr startlist, ddataptr *maxlist, ddataptr *minlist,
+		int *numminpaths, pathpool *minpool, clockcacheptr clocks)
+{
+    tgraphptr   rawmax, rawmin;
+    int         n, skewed;
+
+    skewed = graph_seed(maxgraph, startlist, MAXIMUM_TIME, clocks);
+    skewed |= graph_seed(mingraph, startlist, MINIMUM_TIME, clocks);
+    maxgraph->skewed = mingraph->skewed = skewed;
+    graph_sweep_minmax(maxgraph, mingraph);
+
+    if (skewed == 0) {
+	n = graph_capture(maxgraph, maxlist, MAXIMUM_TIME, &pathmem, CAPTURE_ALL);
+	*numminpaths = graph_capture(mingraph, minlist, MINIMUM_TIME, minpool,
+			CAPTURE_ALL);
+	return n;
+    }
+    n = graph_capture(maxgraph, maxlist, MAXIMUM_TIME, &pathmem, CAPTURE_CLOCKED);
+    *numminpaths = graph_capture(mingraph, minlist, MINIMUM_TIME, minpool,
+		CAPTURE_CLOCKED);
+
+    rawmax = graph_unclocked(maxgraph);
+    rawmin = graph_unclocked(mingraph);
+    graph_seed(rawmax, startlist, MAXIMUM_TIME, NULL);
+    graph_seed(rawmin, startlist, MINIMUM_TIME, NULL);
+    graph_sweep_minmax(rawmax, rawmin);
+
+    n += graph_capture(rawmax, maxlist, MAXIMUM_TIME, &pathmem, CAPTURE_UNCLOCKED);
+    *numminpaths += graph_capture(rawmin, minlist, MINIMUM_TIME, minpool,
+		CAPTURE_UNCLOCKED);
+    return n;
+}
+
+/*--------------------------------------------------------------*/
+/* Re-time the arrivals of "graph", which holds the result of	*/
+/* an earlier sweep from the same start points with the same	*/
+/* "minmax".  Only the nodes marked in "dirty" (indexed by node	*/
+/* number) are re-timed, followed by those nodes downstream	*/
+/* whose gate output times change as a result.  Nodes to	*/
+/* re-time are taken in topological order from a heap keyed on	*/
+/* position in the order, so the work is limited to the		*/
+/* affected fanout cone.  Start points whose launch clock	*/
+/* arrival has changed are re-timed likewise.			*/
+/*								*/
+/* Return value is 1 if any start point has a non-zero launch	*/
+/* clock arrival, and 0 otherwise (see graph_seed()).		*/
+/*--------------------------------------------------------------*/
+
+int
+graph_update(tgraphptr graph, connlistptr startlist, char minmax,
+		unsigned char *dirty, clockcacheptr clocks)
+{
+    unsigned char *queued;
+    connlistptr testlink;
+    int         *heap;
+    int         i, j, c, n, m, p, e, count, numretimed, skewed;
+    double      olddelay[2], oldtrans[2], launch;
+    int         oldedge[2];
+
+    queued = (unsigned char *)calloc(graph->numnodes, sizeof(unsigned char));
+    heap = (int *)malloc((graph->numorder + 1) * sizeof(int));
+    count = 0;
+    numretimed = 0;
+
+    /* Heap of order positions, smallest first */
+
+#define HEAP_PUSH(pos) { \
+	c = count++; \
+	while ((c > 0) && (heap[(c - 1) / 2] > (pos))) { \
+	    heap[c] = heap[(c - 1) / 2]; \
+	    c = (c - 1) / 2; \
+	} \
+	heap[c] = (pos); \
+    }
+
+    for (n = 0; n < graph->numnodes; n++) {
+	if (!dirty[n] || (graph->orderpos[n] < 0)) continue;
+	queued[n] = 1;
+	HEAP_PUSH(graph->orderpos[n]);
+    }
+
+    skewed = 0;
+    for (testlink = startlist; testlink; testlink = testlink->next) {
+	n = testlink->connection->index;
+	if ((n < 0) || (graph->orderpos[n] < 0)) continue;
+	launch = graph_launch(testlink->connection, minmax, clocks);
+	if (launch != 0.0) skewed = 1;
+	if (launch == graph->launch[n]) continue;
+	graph->launch[n] = launch;
+	for (e = 0; e < 2; e++)
+	    if (graph->pred[2 * n + e] == -1)
+		graph->arrival[2 * n + e] = launch;
+	if (queued[n]) continue;
+	queued[n] = 1;
+	HEAP_PUSH(graph->orderpos[n]);
+    }
+
+    while (count > 0) {
+	i = heap[0];
+	p = heap[--count];
+	j = 0;
+	while ((c = 2 * j + 1) < count) {
+	    if ((c + 1 < count) && (heap[c + 1] < heap[c])) c++;
+	    if (p <= heap[c]) break;
+	    heap[j] = heap[c];
+	    j = c;
+	}
+	heap[j] = p;
+
+	n = graph->order[i];
+	numretimed++;
+	for (e = 0; e < 2; e++) {
+	    olddelay[e] = graph->outdelay[2 * n + e];
+	    oldtrans[e] = graph->outtrans[2 * n + e];
+	    oldedge[e] = graph->outedge[2 * n + e];
+	}
+	if (graph->role[n] & GRAPH_THROUGH)
+	    graph_pull(graph, n, graph->arrival, graph->trans, graph->pred, minmax, i);
+	graph_push(graph, n, minmax);
+
+	for (e = 0; e < 2; e++) {
+	    if (graph->outedge[2 * n + e] != oldedge[e]) break;
+	    if (oldedge[e] == NOPRED) continue;
+	    if (graph->outdelay[2 * n + e] != olddelay[e]) break;
+	    if (graph->outtrans[2 * n + e] != oldtrans[e]) break;
+	}
+	if (e == 2) continue;		/* No change at the gate output */
+
+	for (j = graph->fanoutidx[n]; j < graph->fanoutidx[n + 1]; j++) {
+	    m = graph->fanout[j];
+	    if (!(graph->role[m] & GRAPH_THROUGH) || queued[m]) continue;
+	    queued[m] = 1;
+	    HEAP_PUSH(graph->orderpos[m]);
+	}
+    }
+#undef HEAP_PUSH
+
+    free(queued);
+    free(heap);
+
+    if (verbose > 0)
+	fprintf(stdout, "Re-timed %d of %d nodes.\n", numretimed, graph->numorder);
+
+    graph->skewed = skewed;
+    graph->clocks = clocks;
+    return skewed;
+}
+
+/*--------------------------------------------------------------*/
+/* Incremental version of find_graph_paths() (see eco_read()).	*/
+/* "graph" holds the result of an earlier call with the same	*/
+/* start points and "minmax".  The nodes marked in "dirty" are	*/
+/* re-timed by graph_update(), in the companion graph without	*/
+/* launch clock arrivals as well if it is in use, and paths to	*/
+/* all endpoints are then recorded as in find_graph_paths().	*/
+/*								*/
+/* If "dirty" is NULL, a full sweep is made.			*/
+/*								*/
+/* Return value is the number of paths recorded in masterlist.	*/
+/*--------------------------------------------------------------*/
+
+int
+update_graph_paths(tgraphptr graph, connlistptr startlist, ddataptr *masterlist,
+		char minmax, unsigned char *dirty, clockcacheptr clocks)
+{
+    tgraphptr   rawgraph;
+    int         numpaths, skewed;
+
+    if (dirty == NULL)
+	return find_graph_paths(graph, startlist, masterlist, minmax, clocks);
+
+    skewed = graph_update(graph, startlist, minmax, dirty, clocks);
+    rawgraph = graph->unclocked;
+    if (rawgraph != NULL)
+	graph_update(rawgraph, startlist, minmax, dirty, NULL);
+
+    if (skewed == 0)
+	return graph_capture(graph, masterlist, minmax, &pathmem, CAPTURE_ALL);
+    numpaths = graph_capture(graph, masterlist, minmax, &pathmem, CAPTURE_CLOCKED);
+
+    if (rawgraph == NULL) {
+	rawgraph = graph_unclocked(graph);
+	graph_seed(rawgraph, startlist, minmax, NULL);
+	graph_sweep(rawgraph, minmax);
+    }
+    numpaths += graph_capture(rawgraph, masterlist, minmax, &pathmem,
+		CAPTURE_UNCLOCKED);
+    return numpaths;
+}
+
+/*--------------------------------------------------------------*/
+/* Propagate required times back through "graph" from the	*/
+/* sinks whose endpoint slack is given in "endslack" (indexed	*/
+/* by node number, NOSLACK if there is no path), and record the	*/
+/* worst slack at each node in "slack".  "select" chooses the	*/
+/* sinks as in graph_capture().					*/
+/*								*/
+/* The required time at a sink is its captured arrival plus	*/
+/* the endpoint slack (less, for minimum delay), so that the	*/
+/* clock skew and setup or hold time already applied to the	*/
+/* endpoint are accounted for.  Nodes are then taken in reverse	*/
+/* topological order:  the required time at a gate output is	*/
+/* the worst required time over its fanout, and the required	*/
+/* time at a gate input is the worst over its output edges of	*/
+/* the output required time less the gate delay, computed as	*/
+/* in graph_push().  Edges back into a broken logic loop are	*/
+/* ignored, as in graph_pull().  The slack of a node edge is	*/
+/* the difference between its required and arrival times.	*/
+/*--------------------------------------------------------------*/
+
+void
+graph_required(tgraphptr graph, double *endslack, char minmax, char select,
+		double *slack)
+{
+    connptr testconn;
+    double *required, *sinkreq;
+    double rout[2], delay, req, worst;
+    short dir, outdir;
+    int i, j, n, m, e, oe, ne;
+
+    required = (double *)malloc(2 * graph->numnodes * sizeof(double));
+    sinkreq = (double *)malloc(2 * graph->numnodes * sizeof(double));
+    worst = (minmax == MAXIMUM_TIME) ? NOSLACK : -NOSLACK;
+    for (ne = 0; ne < 2 * graph->numnodes; ne++)
+	required[ne] = sinkreq[ne] = worst;
+
+#define WORSE(a, b) ((minmax == MAXIMUM_TIME) ? ((a) < (b)) : ((a) > (b)))
+
+    /* Required times at the sinks, from the worse of the two edges	*/
+    /* (as chosen by graph_capture())					*/
+
+    for (n = 0; n < graph->numnodes; n++) {
+	if (!(graph->role[n] & GRAPH_SINK) || (endslack[n] == NOSLACK)) continue;
+	if ((select != CAPTURE_ALL) && (graph_sink_clocked(graph->nodes[n]) !=
+			(select == CAPTURE_CLOCKED)))
+	    continue;
+	if (graph->cappred[2 * n] == NOPRED)
+	    e = 1;
+	else if (graph->cappred[2 * n + 1] == NOPRED)
+	    e = 0;
+	else
+	    e = WORSE(graph->captured[2 * n], graph->captured[2 * n + 1]) ? 1 : 0;
+	if (graph->cappred[2 * n + e] == NOPRED) continue;
+	req = (minmax == MAXIMUM_TIME) ? graph->captured[2 * n + e] + endslack[n] :
+			graph->captured[2 * n + e] - endslack[n];
+	sinkreq[2 * n] = sinkreq[2 * n + 1] = req;
+	if (endslack[n] < slack[n]) slack[n] = endslack[n];
+    }
+
+    /* Back through the propagating nodes */
+
+    for (i = graph->numorder - 1; i >= 0; i--) {
+	n = graph->order[i];
+	testconn = graph->nodes[n];
+
+	for (oe = 0; oe < 2; oe++) {
+	    rout[oe] = worst;
+	    for (j = graph->fanoutidx[n]; j < graph->fanoutidx[n + 1]; j++) {
+		m = graph->fanout[j];
+		if (graph->role[m] & GRAPH_THROUGH) {
+		    if (graph->orderpos[m] <= i) continue;
+		    req = required[2 * m + oe];
+		}
+		else
+		    req = sinkreq[2 * m + oe];
+		if (WORSE(req, rout[oe])) rout[oe] = req;
+	    }
+	}
+
+	for (e = 0; e < 2; e++) {
+	    ne = 2 * n + e;
+	    if (graph->pred[ne] == NOPRED) continue;
+	    dir = (e == 0) ? RISING : FALLING;
+	    if ((graph->pred[ne] == -1) && (testconn->refpin == NULL)) dir = EITHER;
+
+	    outdir = calc_dir(testconn->refpin, dir);
+	    for (oe = 0; oe < 2; oe++) {
+		if (!(outdir & ((oe == 0) ? RISING : FALLING))) continue;
+		if (rout[oe] == worst) continue;
+		delay = calc_prop_delay(graph->trans[ne], testconn,
+			(oe == 0) ? RISING : FALLING, minmax);
+		if (WORSE(rout[oe] - delay, required[ne]))
+		    required[ne] = rout[oe] - delay;
+	    }
+	    if (required[ne] == worst) continue;
+	    req = (minmax == MAXIMUM_TIME) ? required[ne] - graph->arrival[ne] :
+			graph->arrival[ne] - required[ne];
+	    if (req < slack[n]) slack[n] = req;
+	}
+    }
+#undef WORSE
+
+    free(required);
+    free(sinkreq);
+}
+
+/*--------------------------------------------------------------*/
+/* Clear the slack database "db" before a new analysis.		*/
+/*--------------------------------------------------------------*/
+
+void
+slack_reset(slackptr db)
+{
+    int i, k;
+
+    for (k = 0; k < 2; k++)
+	for (i = 0; i < db->numconns; i++)
+	    db->slack[k][i] = db->endslack[k][i] = NOSLACK;
+}
+
+/*--------------------------------------------------------------*/
+/* Add the slacks of one analysis pass to the slack database	*/
+/* "db" (see graph_required()).  "pathlist" holds the worst	*/
+/* path into each endpoint, found from "graph" and after clock	*/
+/* skew and setup or hold times have been added by		*/
+/* find_clock_skews().  Setup slack is the clock period less	*/
+/* the path delay, and hold slack is the path delay.  For the	*/
+/* register-to-register maximum delay pass, the clock period is	*/
+/* set to "period", or if none was given, to the largest path	*/
+/* delay (the period of the computed maximum clock frequency);	*/
+/* other passes use the same period.				*/
+/*								*/
+/* Paths to register inputs of a graph with launch clock	*/
+/* arrivals came from "graph", and the others from its		*/
+/* companion graph (see find_graph_paths()).  Paths whose	*/
+/* clock skew could not be found (the skew is then computed	*/
+/* from INITVAL) are left unconstrained.			*/
+/*--------------------------------------------------------------*/
+
+void
+slack_record(slackptr db, tgraphptr graph, ddataptr pathlist, int section,
+		double period)
+{
+    ddataptr testddata;
+    double *endslack, value;
+    char minmax;
+    int n;
+
+    minmax = ((section == REG_MAX) || (section == PIN_MAX)) ?
+		MAXIMUM_TIME : MINIMUM_TIME;
+
+    if (section == REG_MAX) {
+	db->period = period;
+	if (period <= 0.0) {
+	    db->period = 0.0;
+	    for (testddata = pathlist; testddata; testddata = testddata->next)
+		if ((testddata->delay > db->period) &&
+			(fabs(testddata->skew) < -INITVAL / 2))
+		    db->period = testddata->delay;
+	}
+    }
+
+    endslack = (double *)malloc(graph->numnodes * sizeof(double));
+    for (n = 0; n < graph->numnodes; n++) endslack[n] = NOSLACK;
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	n = testddata->backtrace->receiver->index;
+	if ((n < 0) || (fabs(testddata->skew) >= -INITVAL / 2)) continue;
+	value = (minmax == MAXIMUM_TIME) ? db->period - testddata->delay :
+			testddata->delay;
+	if (value < endslack[n]) endslack[n] = value;
+    }
+    for (n = 0; n < graph->numnodes; n++)
+	if (endslack[n] < db->endslack[minmax][n])
+	    db->endslack[minmax][n] = endslack[n];
+
+    if (graph->skewed && (graph->unclocked != NULL)) {
+	graph_required(graph, endslack, minmax, CAPTURE_CLOCKED, db->slack[minmax]);
+	graph_required(graph->unclocked, endslack, minmax, CAPTURE_UNCLOCKED,
+			db->slack[minmax]);
+    }
+    else
+	graph_required(graph, endslack, minmax, CAPTURE_ALL, db->slack[minmax]);
+
+    free(endslack);
+}
+
+/*--------------------------------------------------------------*/
+/* A version of strcasecmp() with a built-in check for		*/
+/* surrounding quotes (which are ignored).  Quotes are only	*/
+/* checked in str1.						*/
+/*--------------------------------------------------------------*/
+
+int
+tokencasecmp(char *str1, char *str2)
+{
+    char *ss1, *sf1;
+    int result;
+
+    ss1 = str1;
+    sf1 = NULL;
+    while (*ss1 == '\"') ss1++;
+    if (ss1 != str1) {
+        sf1 = ss1 + 1;
+	while (*sf1 && (*sf1 != '\"')) sf1++;
+	if (*sf1 == '\"')
+	    *sf1 = '\0';
+	else
+	    sf1 = NULL;
+    }
+
+    result = strcasecmp(ss1, str2);
+
+    if (sf1 != NULL) *sf1 = '\"';
+
+    return result;
+}
+
+/*--------------------------------------------------------------*/
+/* Parse a table variable type from a liberty format file       */
+/*--------------------------------------------------------------*/
+
+int get_table_type(char *token) {
+    if (!tokencasecmp(token, "input_net_transition"))
+        return TRANSITION_TIME;
+    else if (!tokencasecmp(token, "total_output_net_capacitance"))
+        return OUTPUT_CAP;
+    else if (!tokencasecmp(token, "related_pin_transition"))
+        return RELATED_TIME;
+    else if (!tokencasecmp(token, "constrained_pin_transition"))
+        return CONSTRAINED_TIME;
+    else
+        return UNKNOWN;
+}
+
+/*--------------------------------------------------------------*/
+/* Expand a bus into individual pins.				*/
+/*--------------------------------------------------------------*/
+
+void
+expand_buses(pin *curpin, bus *curbus, char *busformat)
+{
+    pin *newpin;
+    char *rootname;
+    int low, high, i;
+    char busbit[1024];
+
+    rootname = curpin->name;
+
+    if (curbus == NULL) {
+	fprintf(stderr, "Error:  Pin %s is a bus, but no bus definition exists!\n",
+			curpin->name);
+	return;
+    }
+    if (curbus->from > curbus->to) {
+	low = curbus->to;
+	high = curbus->from;
+    }
+    else {
+	low = curbus->from;
+	high = curbus->to;
+    }
+
+    for (i = low; i <= high; i++) {
+	sprintf(busbit, busformat, rootname, i);
+
+	if (i == low)
+	    newpin = curpin;
+	else
+	    newpin = (pin *)malloc(sizeof(pin));
+	newpin->name = tokendup(busbit);
+	newpin->next = NULL;
+	if (i != low) {
+	    curpin->next = newpin;
+
+	    /* Copy all pin properties from the old pin to the new pin */
+	    newpin->type = curpin->type;
+	    newpin->capr = curpin->capr;
+	    newpin->capf = curpin->capf;
+	    newpin->sense = curpin->sense;
+	    newpin->transr = curpin->transr;
+	    newpin->transf = curpin->transf;
+	    newpin->propdelr = curpin->propdelr;
+	    newpin->propdelf = curpin->propdelf;
+	    newpin->pairidx = curpin->pairidx;
+	    newpin->refcell = curpin->refcell;
+
+	    curpin = newpin;
+	}
+    }
+    free(rootname);
+}
+
+/*--------------------------------------------------------------*/
+/* Read a liberty format file and collect information about     */
+/* the timing properties of each standard cell.                 */
+/*--------------------------------------------------------------*/
+
+void
+libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
+{
+    char *token;
+    char *libname = NULL;
+    int section = INIT;
+
+    double time_unit = 1.0;     // Time unit multiplier, to get ps
+    double cap_unit = 1.0;      // Capacitive unit multiplier, to get fF
+
+    pinptr testpin;
+    lutable *tableptr;
+
+    pin proxypin;
+    int i, j;
+    double gval;
+    char *iptr;
+    char *busformat;
+    short timing_type;
+
+    lutable *newtable, *reftable;
+    cell *newcell, *lastcell;
+    pin *newpin;
+    bus *buses = NULL, *newbus, *curbus = NULL;
+
+    lastcell = NULL;
+    timing_type = UNKNOWN;
+
+    /* Set up pin placeholder */
+    proxypin.name = NULL;
+    proxypin.type = GATE;
+    proxypin.capr = 0.0;
+    proxypin.capf = 0.0;
+    proxypin.sense = SENSE_NONE;
+    proxypin.propdelr = NULL;
+    proxypin.propdelf = NULL;
+    proxypin.transr = NULL;
+    proxypin.transf = NULL;
+    proxypin.refcell = NULL;
+    proxypin.next = NULL;
+
+    /* Set default bus format (verilog style) */
+    busformat = strdup("%s[%d]");
+
+    /* Read tokens off of the line */
+    token = advancetoken(flib, 0);
+
+    while (token != NULL) {
+
+        switch (section) {
+            case INIT:
+		if (debug == 2) fprintf(stdout, "INIT: %s\n", token);
+                if (!tokencasecmp(token, "library")) {
+                    token = advancetoken(flib, 0);
+                    if (strcmp(token, "("))
+                        fprintf(stderr, "Library not followed by name\n");
+                    else
+                        token = advancetoken(flib, ')');
+		    /* Diagnostic */
+                    fprintf(stdout, "Parsing library \"%s\"\n", token);
+                    libname = tokendup(token);
+                    token = advancetoken(flib, 0);
+                    if (strcmp(token, "{")) {
+                        fprintf(stderr, "Did not find opening brace "
+                                        "on library block\n");
+                        exit(1);
+                    }
+                    section = LIBBLOCK;
+                }
+                else
+                    fprintf(stderr, "Unknown input \"%s\", looking for "
+                                        "\"library\"\n", token);
+                break;
+
+            case LIBBLOCK:
+                // Here we check for the main blocks, again not rigorously. . .
+
+		if (debug == 2) fprintf(stdout, "LIBBLOCK: %s\n", token);
+                if (!strcasecmp(token, "}")) {
+                    fprintf(stdout, "End of library at line %d\n", fileCurrentLine);
+                    section = INIT;                     // End of library block
+                }
+                else if (!tokencasecmp(token, "delay_model")) {
+                    token = advancetoken(flib, 0);
+                    if (strcmp(token, ":"))
+                        fprintf(stderr, "Input missing colon\n");
+                    token = advancetoken(flib, ';');
+                    if (tokencasecmp(token, "table_lookup")) {
+                        fprintf(stderr, "Sorry, only know how to "
+                                        "handle table lookup!\n");
+                        exit(1);
+                    }
+                }
+                else if (!tokencasecmp(token, "lu_table_template") ||
+                         !tokencasecmp(token, "power_lut_template")) {
+                    // Read in template information;
+                    newtable = (lutable *)malloc(sizeof(lutable));
+                    newtable->name = NULL;
+                    newtable->invert = 0;
+                    newtable->var1 = UNKNOWN;
+                    newtable->var2 = UNKNOWN;
+                    newtable->size1 = 0;
+                    newtable->size2 = 0;
+                    newtable->idx1.times = NULL;
+                    newtable->idx2.caps = NULL;
+                    newtable->values = NULL;
+                    newtable->next = *tablelist;
+                    *tablelist = newtable;
+
+                    token = advancetoken(flib, 0);
+                    if (strcmp(token, "("))
+                        fprintf(stderr, "Input missing open parens\n");
+                    else
+                        token = advancetoken(flib, ')');
+                    newtable->name = tokendup(token);
+                    while (*token != '}') {
+                        token = advancetoken(flib, 0);
+                        if (!tokencasecmp(token, "variable_1")) {
+                            token = advancetoken(flib, 0);
+                            token = advancetoken(flib, ';');
+                            newtable->var1 = get_table_type(token);
+                            if (newtable->var1 == OUTPUT_CAP || newtable->var1 == CONSTRAINED_TIME)
+                                newtable->invert = 1;
+                        }
+                        else if (!tokencasecmp(token, "variable_2")) {
+                            token = advancetoken(flib, 0);
+                            token = advancetoken(flib, ';');
+                            newtable->var2 = get_table_type(token);
+                            if (newtable->var2 == TRANSITION_TIME || newtable->var2 == RELATED_TIME)
+                                newtable->invert = 1;
+                        }
+                        else if (!tokencasecmp(token, "index_1")) {
+			    char dnum = ',';
+
+                            token = advancetoken(flib, 0);      // Open parens
+                            token = advancetoken(flib, 0);      // Quote
+                            if (!strcmp(token, "\""))
+                                token = advancetoken(flib, '\"');
+
+                            iptr = token;
+
+			    // Check if table is space or comma separated
+			    if (strchr(iptr, dnum) == NULL)
+				if (strchr(iptr, ' ') != NULL)
+				    dnum = ' ';
+
+                            if (newtable->invert == 1) {
+                                // Count entries
+                                newtable->size2 = 1;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size2++;
+                                }
+                                newtable->idx2.caps = (double *)malloc(newtable->size2 *
+                                        sizeof(double));
+                                newtable->size2 = 0;
+                                iptr = token;
+                                sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
+                                if (newtable->var2 == OUTPUT_CAP)
+                                    newtable->idx2.caps[0] *= cap_unit;
+                                else
+                                    newtable->idx2.caps[0] *= time_unit;
+
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size2++;
+                                    sscanf(iptr, "%lg",
+                                                &newtable->idx2.caps[newtable->size2]);
+                                    if (newtable->var2 == OUTPUT_CAP)
+                                        newtable->idx2.caps[newtable->size2] *= cap_unit;
+                                    else
+                                        newtable->idx2.cons[newtable->size2] *= time_unit;
+                                }
+                                newtable->size2++;
+                            }
+                            else {      // newtable->invert = 0
+                                // Count entries
+                                newtable->size1 = 1;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size1++;
+                                }
+                                newtable->idx1.times = (double *)malloc(newtable->size1 *
+                                        sizeof(double));
+                                newtable->size1 = 0;
+                                iptr = token;
+                                sscanf(iptr, "%lg", &newtable->idx1.times[0]);
+                                newtable->idx1.times[0] *= time_unit;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size1++;
+                                    sscanf(iptr, "%lg",
+                                                &newtable->idx1.times[newtable->size1]);
+                                    newtable->idx1.times[newtable->size1] *= time_unit;
+                                }
+                                newtable->size1++;
+                            }
+
+                            token = advancetoken(flib, ';'); // EOL semicolon
+                        }
+                        else if (!tokencasecmp(token, "index_2")) {
+			    char dnum = ',';
+
+                            token = advancetoken(flib, 0);      // Open parens
+                            token = advancetoken(flib, 0);      // Quote
+                            if (!strcmp(token, "\""))
+                                token = advancetoken(flib, '\"');
+
+                            iptr = token;
+
+			    // Check if table is space or comma separated
+			    if (strchr(iptr, dnum) == NULL)
+				if (strchr(iptr, ' ') != NULL)
+				    dnum = ' ';
+
+                            if (newtable->invert == 0) {
+                                // Count entries
+                                newtable->size2 = 1;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size2++;
+                                }
+                                newtable->idx2.caps = (double *)malloc(newtable->size2 *
+                                        sizeof(double));
+                                newtable->size2 = 0;
+                                iptr = token;
+                                sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
+                                if (newtable->var2 == OUTPUT_CAP)
+                                    newtable->idx2.caps[0] *= cap_unit;
+                                else
+                                    newtable->idx2.cons[0] *= time_unit;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size2++;
+                                    sscanf(iptr, "%lg",
+                                                &newtable->idx2.caps[newtable->size2]);
+                                    if (newtable->var2 == OUTPUT_CAP)
                                         newtable->idx2.caps[newtable->size2] *= cap_unit;
                                     else
-                                        newtable->idx2.cons[newtable->size2] *= time_unit;
+                                        newtable->idx2.cons[newtable->size2] *= time_unit;
+                                }
+                                newtable->size2++;
+                            }
+                            else {      // newtable->invert == 1
+                                // Count entries
+                                newtable->size1 = 1;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size1++;
+                                }
+                                newtable->idx1.times = (double *)malloc(newtable->size1 *
+                                        sizeof(double));
+                                newtable->size1 = 0;
+                                iptr = token;
+                                sscanf(iptr, "%lg", &newtable->idx1.times[0]);
+                                newtable->idx1.times[0] *= time_unit;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    newtable->size1++;
+                                    sscanf(iptr, "%lg",
+                                                &newtable->idx1.times[newtable->size1]);
+                                    newtable->idx1.times[newtable->size1] *= time_unit;
+                                }
+                                newtable->size1++;
+                            }
+
+                            token = advancetoken(flib, ';'); // EOL semicolon
+                        }
+                    }
+                }
+                else if (!strcasecmp(token, "cell")) {
+                    newcell = (cell *)malloc(sizeof(cell));
+                    newcell->next = NULL;
+                    if (lastcell != NULL)
+                        lastcell->next = newcell;
+                    else
+                        *celllist = newcell;
+                    lastcell = newcell;
+                    token = advancetoken(flib, 0);      // Open parens
+                    if (!strcmp(token, "("))
+                        token = advancetoken(flib, ')');        // Cellname
+		    if (debug == 2) fprintf(stdout, "   cell = %s\n", token);
+                    newcell->name = tokendup(token);
+                    token = advancetoken(flib, 0);      // Find start of block
+                    if (strcmp(token, "{"))
+                        fprintf(stderr, "Error: failed to find start of block\n");
+                    newcell->type = GATE;               // Default type
+                    newcell->function = NULL;
+                    newcell->pins = NULL;
+                    newcell->area = 1.0;
+                    newcell->maxtrans = 0.0;
+                    newcell->maxcap = 0.0;
+                    section = CELLDEF;
+                }
+                else if (!strcasecmp(token, "time_unit")) {
+                   char *metric;
+
+                   token = advancetoken(flib, 0);
+                   if (token == NULL) break;
+                   if (!strcmp(token, ":")) {
+                      token = advancetoken(flib, 0);
+                      if (token == NULL) break;
+                   }
+                   if (!strcmp(token, "\"")) {
+                      token = advancetoken(flib, '\"');
+                      if (token == NULL) break;
+                   }
+                   time_unit = strtod(token, &metric);
+                   if (*metric != '\0') {
+                      if (!strcmp(metric, "ns"))
+                         time_unit *= 1E3;
+                      else if (!strcmp(metric, "us"))
+                         time_unit *= 1E6;
+                      else if (!strcmp(metric, "fs"))
+                         time_unit *= 1E-3;
+                      else if (strcmp(metric, "ps"))
+                         fprintf(stderr, "Don't understand time units \"%s\"\n",
+                                token);
+                   }
+                   else {
+                      token = advancetoken(flib, 0);
+                      if (token == NULL) break;
+                      if (!strcmp(token, "ns"))
+                         time_unit *= 1E3;
+                      else if (!strcmp(token, "us"))
+                         time_unit *= 1E6;
+                      else if (!strcmp(token, "fs"))
+                         time_unit *= 1E-3;
+                      else if (strcmp(token, "ps"))
+                         fprintf(stderr, "Don't understand time units \"%s\"\n",
+                                token);
+                   }
+                   token = advancetoken(flib, ';');
+                }
+                else if (!strcasecmp(token, "capacitive_load_unit")) {
+                   char *metric;
+
+                   token = advancetoken(flib, 0);
+                   if (token == NULL) break;
+                   if (!strcmp(token, "(")) {
+                      token = advancetoken(flib, ')');
+                      if (token == NULL) break;
+                   }
+                   cap_unit = strtod(token, &metric);
+                   if (*metric != '\0') {
+                      while (isblank(*metric)) metric++;
+                      if (*metric == ',') metric++;
+                      while ((*metric != '\0') && isblank(*metric)) metric++;
+		      if (*metric == '\"') {
+			 char *qptr;
+			 metric++;
+			 qptr = metric;
+			 while ((*qptr != '\"') && (*qptr != '\0')) qptr++;
+			 *qptr = '\0';
+		      }
+                      if (!tokencasecmp(metric, "af"))
+                         cap_unit *= 1E-3;
+                      else if (!tokencasecmp(metric, "pf"))
+                         cap_unit *= 1000;
+                      else if (!tokencasecmp(metric, "nf"))
+                         cap_unit *= 1E6;
+                      else if (!tokencasecmp(metric, "uf"))
+                         cap_unit *= 1E9;
+                      else if (tokencasecmp(metric, "ff"))
+                         fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
+                                token);
+                   }
+                   else {
+                      token = advancetoken(flib, 0);
+                      if (token == NULL) break;
+                      if (!tokencasecmp(token, "af"))
+                         cap_unit *= 1E-3;
+                      else if (!tokencasecmp(token, "pf"))
+                         cap_unit *= 1000;
+                      else if (!tokencasecmp(token, "nf"))
+                         cap_unit *= 1E6;
+                      else if (!tokencasecmp(token, "uf"))
+                         cap_unit *= 1E9;
+                      else if (tokencasecmp(token, "ff"))
+                         fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
+                                token);
+                   }
+                   token = advancetoken(flib, ';');
+                }
+		else if (!strcasecmp(token, "bus_naming_style")) {
+		    token = advancetoken(flib, 0);
+		    if (token == NULL) break;
+		    if (!strcmp(token, ":")) {
+			token = advancetoken(flib, 0);
+			if (token == NULL) break;
+		    }
+		    if (!strcmp(token, "\"")) {
+			token = advancetoken(flib, '\"');
+			if (token == NULL) break;
+		    }
+		    free(busformat);
+		    busformat = tokendup(token);
+                    token = advancetoken(flib, ';');
+		}
+		else if (!strcasecmp(token, "type")) {
+		    newbus = (bus *)malloc(sizeof(bus));
+		    newbus->from = 0;
+		    newbus->to = 0;
+		    newbus->next = buses;
+		    buses = newbus;
+
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "("))
+			fprintf(stderr, "Input missing open parenthesis.\n");
+		    else
+			token = advancetoken(flib, ')');
+		    newbus->name = tokendup(token);
+		    while (*token != '}') {
+			token = advancetoken(flib, 0);
+			if (!strcasecmp(token, "bit_from")) {
+			    token = advancetoken(flib, 0);
+			    token = advancetoken(flib, ';');
+			    sscanf(token, "%d", &newbus->from);
+			}
+			else if (!strcasecmp(token, "bit_to")) {
+			    token = advancetoken(flib, 0);
+			    token = advancetoken(flib, ';');
+			    sscanf(token, "%d", &newbus->to);
+			}
+			else if (!strcasecmp(token, "{")) {
+			    /* All entries are <name> : <value> */
+			    /* Ignore unhandled tokens.		*/
+			    token = advancetoken(flib, 0);
+			    token = advancetoken(flib, ';');
+			}
+		    }
+		}
+                else {
+                    // For unhandled tokens, read in tokens.  If it is
+                    // a definition or function, read to end-of-line.  If
+                    // it is a block definition, read to end-of-block.
+                    while (1) {
+                        token = advancetoken(flib, 0);
+                        if (token == NULL) break;
+                        if (!strcmp(token, ";")) break;
+                        if (!strcmp(token, "\""))
+                            token = advancetoken(flib, '\"');
+                        if (!strcmp(token, "{")) {
+                            token = advancetoken(flib, '}');
+                            break;
+                        }
+                    }
+                }
+                break;
+
+            case CELLDEF:
+
+		if (debug == 2) fprintf(stdout, "CELLDEF: %s\n", token);
+                if (!strcmp(token, "}")) {
+                    section = LIBBLOCK;                 // End of cell def
+                }
+                else if (!strcasecmp(token, "pin") ||
+			 !strcasecmp(token, "bus")) {
+                    token = advancetoken(flib, 0);      // Open parens
+                    if (!strcmp(token, "("))
+                        token = advancetoken(flib, ')');        // Close parens
+
+                    newpin = parse_pin(newcell, token);
+		    if (debug == 2) fprintf(stdout, "   pin = %s\n", token);
+
+                    token = advancetoken(flib, 0);      // Find start of block
+                    if (strcmp(token, "{"))
+                        fprintf(stderr, "Error: failed to find start of block\n");
+                    section = PINDEF;
+                }
+                else if (!strcasecmp(token, "area")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    sscanf(token, "%lg", &newcell->area);
+                }
+                else if (!strcasecmp(token, "ff")) {
+                    newcell->type |= DFF;
+                    token = advancetoken(flib, '{');
+                    section = FLOPDEF;
+                }
+                else if (!strcasecmp(token, "latch")) {
+                    newcell->type |= LATCH;
+                    token = advancetoken(flib, '{');
+                    section = LATCHDEF;
+                }
+                else {
+                    // For unhandled tokens, read in tokens.  If it is
+                    // a definition or function, read to end-of-line.  If
+                    // it is a block definition, read to end-of-block.
+                    while (1) {
+                        token = advancetoken(flib, 0);
+                        if (token == NULL) break;
+                        if (!strcmp(token, ";")) break;
+                        if (!strcmp(token, "\""))
+                            token = advancetoken(flib, '\"');
+                        if (!strcmp(token, "("))
+                            token = advancetoken(flib, ')');
+                        if (!strcmp(token, "{")) {
+                            token = advancetoken(flib, '}');
+                            break;
+                        }
+                    }
+                }
+                break;
+
+            case FLOPDEF:
+
+		if (debug == 2) fprintf(stdout, "FLOPDEF: %s\n", token);
+                if (!strcmp(token, "}")) {
+                    section = CELLDEF;                  // End of flop def
+                }
+                else if (!strcasecmp(token, "next_state")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    newpin = parse_pin(newcell, token);
+                    newpin->type |= DFFIN;
+                }
+                else if (!strcasecmp(token, "clocked_on")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    if (strchr(token, '\'') != NULL)
+                        newcell->type |= CLK_SENSE_MASK;
+                    else if (strchr(token, '!') != NULL)
+                        newcell->type |= CLK_SENSE_MASK;
+                    newpin = parse_pin(newcell, token);
+                    newpin->type |= DFFCLK;
+                }
+                else if (!strcasecmp(token, "clear")) {
+                    newcell->type |= RST_MASK;
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    if (strchr(token, '\'') != NULL)
+                        newcell->type |= RST_SENSE_MASK;
+                    else if (strchr(token, '!') != NULL)
+                        newcell->type |= RST_SENSE_MASK;
+                    newpin = parse_pin(newcell, token);
+                    newpin->type |= DFFRST;
+                }
+                else if (!strcasecmp(token, "preset")) {
+                    newcell->type |= SET_MASK;
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    if (strchr(token, '\'') != NULL)
+                        newcell->type |= SET_SENSE_MASK;
+                    else if (strchr(token, '!') != NULL)
+                        newcell->type |= SET_SENSE_MASK;
+                    newpin = parse_pin(newcell, token);
+                    newpin->type |= DFFSET;
+                }
+                else
+                    token = advancetoken(flib, ';');    // Read to end-of-statement
+
+                break;
+
+            case LATCHDEF:
+
+		if (debug == 2) fprintf(stdout, "LATCHDEF: %s\n", token);
+                if (!strcmp(token, "}")) {
+                    section = CELLDEF;                  // End of flop def
+                }
+                else if (!strcasecmp(token, "data_in")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    newpin = parse_pin(newcell, token);
+                    newpin->type |= LATCHIN;
+                }
+                else if (!strcasecmp(token, "enable")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    if (strchr(token, '\'') != NULL)
+                        newcell->type |= EN_SENSE_MASK;
+                    else if (strchr(token, '!') != NULL)
+                        newcell->type |= EN_SENSE_MASK;
+                    newpin = parse_pin(newcell, token);
+                    newpin->type |= LATCHEN;
+                }
+                else
+                    token = advancetoken(flib, ';');    // Read to end-of-statement
+
+                break;
+
+            case PINDEF:
+
+		if (debug == 2) fprintf(stdout, "PINDEF: %s\n", token);
+                if (!strcmp(token, "}")) {
+		    if (curbus != NULL)
+			expand_buses(newpin, curbus, busformat);
+		    curbus = NULL;
+                    section = CELLDEF;                  // End of pin def
+                }
+                else if (!strcasecmp(token, "capacitance")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    sscanf(token, "%lg", &newpin->capr);
+                    newpin->capr *= cap_unit;
+                }
+                else if (!strcasecmp(token, "rise_capacitance")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    sscanf(token, "%lg", &newpin->capr);
+                    newpin->capr *= cap_unit;
+                }
+                else if (!strcasecmp(token, "fall_capacitance")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    sscanf(token, "%lg", &newpin->capf);
+                    newpin->capf *= cap_unit;
+                }
+                else if (!strcasecmp(token, "function")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, 0);      // Open quote
+                    if (!strcmp(token, "\""))
+                        token = advancetoken(flib, '\"');       // Find function string
+                    if (newpin->type & OUTPUT) {
+                        newcell->function = tokendup(token);
+                    }
+                    token = advancetoken(flib, 0);
+                    if (strcmp(token, ";")) {
+                        if (!strcmp(token, "}"))
+                            section = CELLDEF;          // End of pin def
+                        else
+                            fprintf(stderr, "Expected end-of-statement.\n");
+                    }
+                }
+		else if (!strcasecmp(token, "bus_type")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');
+		    /* Find the bus definition */
+		    for (curbus = buses; curbus; curbus = curbus->next)
+			if (!tokencasecmp(token, curbus->name))
+			    break;
+		    if (curbus == NULL)
+			fprintf(stderr, "Failed to find a valid bus type \"%s\"\n",
+				token);
+		}
+                else if (!strcasecmp(token, "direction")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');
+                    if (!tokencasecmp(token, "input")) {
+                        newpin->type |= INPUT;
+                    }
+                    else if (!tokencasecmp(token, "output")) {
+                        newpin->type |= OUTPUT;
+                        if (newcell->type & DFF) newpin->type |= DFFOUT;
+                        if (newcell->type & LATCH) newpin->type |= LATCHOUT;
+                    }
+                }
+                else if (!strcasecmp(token, "max_transition")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    sscanf(token, "%lg", &newcell->maxtrans);
+                    newcell->maxtrans *= time_unit;
+                }
+                else if (!strcasecmp(token, "max_capacitance")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // To end-of-statement
+                    sscanf(token, "%lg", &newcell->maxcap);
+                    newcell->maxcap *= cap_unit;
+                }
+                else if (!strcasecmp(token, "timing")) {
+                    token = advancetoken(flib, 0);      // Arguments, if any
+                    if (strcmp(token, "("))
+                        fprintf(stderr, "Error: failed to find start of block\n");
+                    else
+                       token = advancetoken(flib, ')'); // Arguments, if any
+                    token = advancetoken(flib, 0);      // Find start of block
+                    if (strcmp(token, "{"))
+                        fprintf(stderr, "Error: failed to find start of block\n");
+                    testpin = &proxypin;    /* Placeholder */
+                    section = TIMING;
+                }
+                else {
+                    // For unhandled tokens, read in tokens.  If it is
+                    // a definition or function, read to end-of-line.  If
+                    // it is a block definition, read to end-of-block.
+                    while (1) {
+                        token = advancetoken(flib, 0);
+                        if (token == NULL) break;
+                        if (!strcmp(token, ";")) break;
+                        if (!strcmp(token, "\""))
+                            token = advancetoken(flib, '\"');
+                        if (!strcmp(token, "{")) {
+                            token = advancetoken(flib, '}');
+                            break;
+                        }
+                    }
+                }
+                break;
+
+            case TIMING:
+
+		if (debug == 2) fprintf(stdout, "TIMING: %s\n", token);
+                if (!strcmp(token, "}")) {
+                    section = PINDEF;                   // End of timing def
+                }
+                else if (!strcasecmp(token, "related_pin")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // Read to end of statement
+		    if (testpin != &proxypin) {
+			fprintf(stderr, "Error:  Record already created"
+				" for related_pin");
+			free(testpin);
+		    }
+                    // Create the related pin
+                    testpin = parse_pin(newcell, token);
+		    // Copy any records from the placeholder
+		    testpin->sense = proxypin.sense;
+                    testpin->propdelr = proxypin.propdelr;
+                    testpin->propdelf = proxypin.propdelf;
+                    testpin->transr = proxypin.transr;
+                    testpin->transf = proxypin.transf;
+		    // Reset the placeholder records
+		    proxypin.sense = SENSE_NONE;
+		    proxypin.propdelr = NULL;
+		    proxypin.propdelf = NULL;
+		    proxypin.transr = NULL;
+		    proxypin.transf = NULL;
+                }
+                else if (!strcasecmp(token, "timing_sense")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // Read to end of statement
+                    if (!tokencasecmp(token, "positive_unate"))
+                        testpin->sense = SENSE_POSITIVE;
+                    else if (!tokencasecmp(token, "negative_unate"))
+                        testpin->sense = SENSE_NEGATIVE;
+                    else if (!tokencasecmp(token, "non_unate"))
+                        testpin->sense = SENSE_NONE;
+                }
+                else if (!strcasecmp(token, "timing_type")) {
+                    token = advancetoken(flib, 0);      // Colon
+                    token = advancetoken(flib, ';');    // Read to end of statement
+
+                    // Note:  Timing type is apparently redundant information;
+                    // e.g., "falling_edge" can be determined by "clocked_on : !CLK"
+                    // in the ff {} block.  How reliable is this?
+
+                    if (!tokencasecmp(token, "rising_edge"))
+                        timing_type = TIMING_PROP_TRANS;
+                    else if (!tokencasecmp(token, "falling_edge"))
+                        timing_type = TIMING_PROP_TRANS;
+                    else if (!tokencasecmp(token, "hold_rising"))
+                        timing_type = TIMING_HOLD;
+                    else if (!tokencasecmp(token, "hold_falling"))
+                        timing_type = TIMING_HOLD;
+                    else if (!tokencasecmp(token, "setup_rising"))
+                        timing_type = TIMING_SETUP;
+                    else if (!tokencasecmp(token, "setup_falling"))
+                        timing_type = TIMING_SETUP;
+                    else if (!tokencasecmp(token, "clear"))
+                        timing_type = TIMING_SET_RESET;
+                    else if (!tokencasecmp(token, "preset"))
+                        timing_type = TIMING_SET_RESET;
+                    else if (!tokencasecmp(token, "recovery_rising"))
+                        timing_type = TIMING_RECOVERY;
+                    else if (!tokencasecmp(token, "recovery_falling"))
+                        timing_type = TIMING_RECOVERY;
+                    else if (!tokencasecmp(token, "removal_rising"))
+                        timing_type = TIMING_REMOVAL;
+                    else if (!tokencasecmp(token, "removal_falling"))
+                        timing_type = TIMING_REMOVAL;
+                    else if (!tokencasecmp(token, "three_state_enable"))
+                        timing_type = TIMING_TRISTATE;
+                    else if (!tokencasecmp(token, "three_state_disable"))
+                        timing_type = TIMING_TRISTATE;
+                }
+                else if ((!strcasecmp(token, "cell_rise")) ||
+                        (!strcasecmp(token, "cell_fall")) ||
+                        (!strcasecmp(token, "rise_transition")) ||
+                        (!strcasecmp(token, "fall_transition")) ||
+                        (!strcasecmp(token, "rise_constraint")) ||
+                        (!strcasecmp(token, "fall_constraint"))) {
+
+                    tableptr = (lutable *)malloc(sizeof(lutable));
+                    tableptr->name = NULL;      // Not used
+                    tableptr->invert = 0;
+                    tableptr->var1 = UNKNOWN;
+                    tableptr->var2 = UNKNOWN;
+                    tableptr->size1 = 0;
+                    tableptr->size2 = 0;
+                    tableptr->idx1.times = NULL;
+                    tableptr->idx2.caps = NULL;
+                    tableptr->values = NULL;
+                    tableptr->next = NULL;      // Not used
+
+                    // Note that propagation delays (cell rise, cell fall) and
+                    // transition times (rise transition, fall transition) have
+                    // their lookup tables stored in the "related pin" pin record.
+                    // Setup and hold times (rise constraint, fall constraint)
+                    // have their lookup tables stored in the original pin record.
+                    // These should not overlap.
+
+                    // Recovery and removal tables are not yet handled. . .
+
+                    if (!strcasecmp(token, "cell_rise"))
+                        testpin->propdelr = tableptr;
+                    else if (!strcasecmp(token, "cell_fall"))
+                        testpin->propdelf = tableptr;
+                    else if (!strcasecmp(token, "rise_transition"))
+                        testpin->transr = tableptr;
+                    else if (!strcasecmp(token, "fall_transition"))
+                        testpin->transf = tableptr;
+                    else if (!strcasecmp(token, "rise_constraint")) {
+                        if (timing_type == TIMING_SETUP)
+                            newpin->propdelr = tableptr;
+                        else if (timing_type == TIMING_HOLD)
+                            newpin->transr = tableptr;
+                    }
+                    else if (!strcasecmp(token, "fall_constraint")) {
+                        if (timing_type == TIMING_SETUP)
+                            newpin->propdelf = tableptr;
+                        else if (timing_type == TIMING_HOLD)
+                            newpin->transf = tableptr;
+                    }
+
+                    token = advancetoken(flib, 0);      // Open parens
+                    if (!strcmp(token, "("))
+                        token = advancetoken(flib, ')');
+
+                    for (reftable = *tablelist; reftable; reftable = reftable->next)
+                        if (!tokencasecmp(token, reftable->name))
+                            break;
+                    if (reftable == NULL)
+                        fprintf(stderr, "Failed to find a valid table \"%s\"\n",
+                                token);
+                    else {
+                        // Fill in default values from template reftable
+                        tableptr->invert = reftable->invert;
+                        if (reftable->size1 > 0) {
+                            tableptr->var1 = reftable->var1;
+                            tableptr->size1 = reftable->size1;
+                            tableptr->idx1.times = (double *)malloc(tableptr->size1 * sizeof(double));
+                            memcpy(tableptr->idx1.times, reftable->idx1.times,
+                                                tableptr->size1 * sizeof(double));
+                        }
+                        if (reftable->size2 > 0) {
+                            tableptr->var2 = reftable->var2;
+                            tableptr->size2 = reftable->size2;
+                            tableptr->idx2.caps = (double *)malloc(tableptr->size2 * sizeof(double));
+                            memcpy(tableptr->idx2.caps, reftable->idx2.caps,
+                                                tableptr->size2 * sizeof(double));
+                        }
+                    }
+
+                    token = advancetoken(flib, 0);
+                    if (strcmp(token, "{"))
+                        fprintf(stderr, "Failed to find start of timing block\n");
+
+                    while (*token != '}') {
+                        token = advancetoken(flib, 0);
+                        if (!tokencasecmp(token, "index_1")) {
+			    char dnum = ',';
+
+                            // Local index values override those in the template
+
+                            token = advancetoken(flib, 0);      // Open parens
+                            token = advancetoken(flib, 0);      // Quote
+                            if (!strcmp(token, "\""))
+                                token = advancetoken(flib, '\"');
+
+                            iptr = token;
+
+			    // Check if table is space or comma separated
+			    if (strchr(iptr, dnum) == NULL)
+				if (strchr(iptr, ' ') != NULL)
+				    dnum = ' ';
+
+                            //-------------------------
+
+                            if (reftable && (reftable->invert == 1)) {
+                                // Entries had better match the ref table
+                                i = 0;
+                                sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
+                                if (tableptr->var2 == OUTPUT_CAP)
+                                    tableptr->idx2.caps[0] *= cap_unit;
+                                else
+                                    tableptr->idx2.cons[0] *= time_unit;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    i++;
+                                    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
+                                    if (tableptr->var2 == OUTPUT_CAP)
+                                        tableptr->idx2.caps[i] *= cap_unit;
+                                    else
+                                        tableptr->idx2.cons[i] *= time_unit;
                                 }
-                                newtable->size2++;
                             }
-                            else {      // newtable->invert = 0
-                                // Count entries
-                                newtable->size1 = 1;
+                            else if (reftable && (reftable->invert == 0)) {
+                                iptr = token;
+                                i = 0;
+                                sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
+                                tableptr->idx1.times[0] *= time_unit;
+                                while ((iptr = strchr(iptr, dnum)) != NULL) {
+                                    iptr++;
+                                    i++;
+                                    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
+                                    tableptr->idx1.times[i] *= time_unit;
+                                }
+                            }
+
+                            token = advancetoken(flib, ')');    // Close paren
+                            token = advancetoken(flib, ';');    // EOL semicolon
+                        }
+                        else if (!tokencasecmp(token, "index_2")) {
+			    char dnum = ',';
+
+                            // Local index values override those in the template
+
+                            token = advancetoken(flib, 0);      // Open parens
+                            token = advancetoken(flib, 0);      // Quote
+                            if (!strcmp(token, "\""))
+                                token = advancetoken(flib, '\"');
+
+                            iptr = token;
+
+			    // Check if table is space or comma separated
+			    if (strchr(iptr, dnum) == NULL)
+				if (strchr(iptr, ' ') != NULL)
+				    dnum = ' ';
+
+                            //-------------------------
+
+                            if (reftable && (reftable->invert == 1)) {
+                                // Entries had better match the ref table
+                                i = 0;
+                                sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
+                                tableptr->idx1.times[0] *= time_unit;
                                 while ((iptr = strchr(iptr, dnum)) != NULL) {
                                     iptr++;
-                                    newtable->size1++;
+                                    i++;
+                                    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
+                                    tableptr->idx1.times[i] *= time_unit;
                                 }
-                                newtable->idx1.times = (double *)malloc(newtable->size1 *
-                                        sizeof(double));
-                                newtable->size1 = 0;
+                            }
+                            else if (reftable && (reftable->invert == 0)) {
                                 iptr = token;
-                                sscanf(iptr, "%lg", &newtable->idx1.times[0]);
-                                newtable->idx1.times[0] *= time_unit;
+                                i = 0;
+                                sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
+                                tableptr->idx2.caps[0] *= cap_unit;
                                 while ((iptr = strchr(iptr, dnum)) != NULL) {
                                     iptr++;
-                                    newtable->size1++;
-                                    sscanf(iptr, "%lg",
-                                                &newtable->idx1.times[newtable->size1]);
-                                    newtable->idx1.times[newtable->size1] *= time_unit;
+                                    i++;
+                                    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
+                                    tableptr->idx2.caps[i] *= cap_unit;
+                                }
+                            }
+
+                            token = advancetoken(flib, ')');    // Close paren
+                            token = advancetoken(flib, ';');    // EOL semicolon
+                        }
+                        else if (!tokencasecmp(token, "values")) {
+                            token = advancetoken(flib, 0);
+                            if (strcmp(token, "("))
+                                fprintf(stderr, "Failed to find start of"
+                                                " value table\n");
+                            token = advancetoken(flib, ')');
+
+                            // Parse the string of values and enter it into the
+                            // table "values", which is size size2 x size1
+
+                            if (reftable && reftable->size1 > 0) {
+                                int locsize2;
+                                locsize2 = (reftable->size2 > 0) ? reftable->size2 : 1;
+                                if (reftable->invert) {
+                                    tableptr->values = (double *)malloc(locsize2 *
+                                                reftable->size1 * sizeof(double));
+                                    iptr = token;
+                                    for (i = 0; i < reftable->size1; i++) {
+                                        for (j = 0; j < locsize2; j++) {
+                                            while (*iptr == ' ' || *iptr == '\"' ||
+                                                        *iptr == ',' || *iptr == '\\')
+                                                iptr++;
+                                            sscanf(iptr, "%lg", &gval);
+                                            *(tableptr->values + j * reftable->size1
+                                                        + i) = gval * time_unit;
+                                            while (*iptr != ' ' && *iptr != '\"' &&
+                                                        *iptr != ',' || *iptr == '\\')
+                                                iptr++;
+                                        }
+                                    }
+                                }
+                                else {
+                                    tableptr->values = (double *)malloc(locsize2 *
+                                                reftable->size1 * sizeof(double));
+                                    iptr = token;
+                                    for (j = 0; j < locsize2; j++) {
+                                        for (i = 0; i < reftable->size1; i++) {
+                                            while (*iptr == ' ' || *iptr == '\"' ||
+                                                        *iptr == ',' || *iptr == '\\')
+                                                iptr++;
+                                            sscanf(iptr, "%lg", &gval);
+                                            *(tableptr->values + j * reftable->size1
+                                                        + i) = gval * time_unit;
+                                            while (*iptr != ' ' && *iptr != '\"' &&
+                                                        *iptr != ',' || *iptr == '\\')
+                                                iptr++;
+                                        }
+                                    }
                                 }
-                                newtable->size1++;
                             }
 
-                            token = advancetoken(flib, ';'); // EOL semicolon
-                        }
-                        else if (!tokencasecmp(token, "index_2")) {
-			    char dnum = ',';
+                            token = advancetoken(flib, 0);
+                            if (strcmp(token, ";"))
+                                fprintf(stderr, "Failed to find end of value table\n");
+			}
+                        else if (!tokencasecmp(token, "ecsm_waveform")) {
+			    /* Not handled:  this takes the form of index_1 */
+			    /* key : value or index_2 key : value and	    */
+			    /* values key : value.			    */
+			    token = advancetoken(flib, 0);	// Open parens
+			    token = advancetoken(flib, ')');	// Close parens
+			    token = advancetoken(flib, '{');	// Open brace
+			    token = advancetoken(flib, '}');	// Close brace
+			}
+                        else if (!tokencasecmp(token, "ecsm_capacitance")) {
+			    /* Not handled:  this takes the form of index_1 */
+			    /* key : value or index_2 key : value and	    */
+			    /* values key : value.			    */
+			    token = advancetoken(flib, 0);	// Open parens
+			    token = advancetoken(flib, ')');	// Close parens
+			    token = advancetoken(flib, '{');	// Open brace
+			    token = advancetoken(flib, '}');	// Close brace
+			}
+                        else if (strcmp(token, "{") && strcmp(token, "}")) {
+			    fprintf(stderr, "Unhandled feature %s at line %d\n",
+					token, fileCurrentLine);
+                            token = advancetoken(flib, 0);
+			    if (!strcmp(token, "(")) {		 // Open parens
+				token = advancetoken(flib, ')'); // Close parens
+				token = advancetoken(flib, 0);
+			    }
+			    if (!strcmp(token, "{"))		 // Open brace
+				token = advancetoken(flib, '}'); // Close brace
+			}
+                    }
+                }
+                else {
+                    // For unhandled tokens, read in tokens.  If it is
+                    // a definition or function, read to end-of-line.  If
+                    // it is a block definition, read to end-of-block.
+                    while (1) {
+                        token = advancetoken(flib, 0);
+                        if (token == NULL) break;
+                        if (!strcmp(token, ";")) break;
+                        if (!strcmp(token, "\""))
+                            token = advancetoken(flib, '\"');
+                        if (!strcmp(token, "{")) {
+                            token = advancetoken(flib, '}');
+                            break;
+                        }
+                    }
+                }
+                break;
+        }
+        token = advancetoken(flib, 0);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Liberty cache (option -C).  The database built by		*/
+/* libertyRead() from each liberty file is saved in binary form	*/
+/* in the cache directory, in a file named by a hash of the	*/
+/* contents of the liberty file (and of all liberty files read	*/
+/* before it, as templates may be shared between files).  If	*/
+/* the file exists on a later run, it is mapped into memory and	*/
+/* used in place of parsing the liberty file.  Index and value	*/
+/* arrays and names are used in place in the mapped file.	*/
+/*								*/
+/* Cache file layout:  header, tables, cells, pins, names,	*/
+/* values.  Names are offsets into the name block and arrays	*/
+/* are offsets into the value block (-1 for none).  Tables are	*/
+/* the new templates, in list order, followed by the pin	*/
+/* tables.  Pins of each cell are consecutive.  The header	*/
+/* holds a checksum of everything that follows it.		*/
+/*--------------------------------------------------------------*/
+
+#define LIBCACHE_MAGIC		"VESTALC"
+#define LIBCACHE_VERSION	2
+#define LIBCACHE_BYTEORDER	0x01020304
+
+typedef struct _libcachehdr {
+   char     magic[8];
+   uint32_t version;
+   uint32_t byteorder;
+   uint64_t key;		/* Hash of the liberty file(s) */
+   uint32_t numlines;		/* Lines in the liberty file */
+   uint32_t numtemplates;
+   uint32_t numtables;		/* Including templates */
+   uint32_t numcells;
+   uint32_t numpins;
+   uint32_t pad;
+   uint64_t namesize;		/* Bytes in the name block */
+   uint64_t numvalues;		/* Doubles in the value block */
+   uint64_t checksum;		/* Hash of the blocks after the header */
+} libcachehdr;
+
+typedef struct _libcachetable {
+   int64_t  idx1;
+   int64_t  idx2;
+   int64_t  values;
+   int32_t  name;
+   int32_t  var1;
+   int32_t  var2;
+   int32_t  size1;
+   int32_t  size2;
+   int32_t  invert;
+} libcachetable;
+
+typedef struct _libcachecell {
+   double   area;
+   double   maxtrans;
+   double   maxcap;
+   int32_t  name;
+   int32_t  function;
+   int32_t  firstpin;
+   int32_t  numpins;
+   int32_t  type;
+   int32_t  pad;
+} libcachecell;
+
+typedef struct _libcachepin {
+   double   capr;
+   double   capf;
+   int32_t  name;
+   int32_t  type;
+   int32_t  sense;
+   int32_t  pairidx;
+   int32_t  tables[4];		/* propdelr, propdelf, transr, transf */
+} libcachepin;
+
+/* Growable block used while writing the cache */
+
+typedef struct _libcachebuf {
+   char     *data;
+   size_t   used;
+   size_t   size;
+} libcachebuf;
+
+/*--------------------------------------------------------------*/
+/* Add "size" bytes at "data" to the hash "key" (64-bit		*/
+/* FNV-1a).							*/
+/*--------------------------------------------------------------*/
+
+uint64_t
+libcache_hash(uint64_t key, void *data, size_t size)
+{
+    unsigned char *bytes = (unsigned char *)data;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+	key ^= bytes[i];
+	key *= 0x100000001b3ULL;
+    }
+    return key;
+}
+
+/*--------------------------------------------------------------*/
+/* Hash the contents of "flib" into "key".  The file is rewound	*/
+/* afterward.							*/
+/*--------------------------------------------------------------*/
+
+uint64_t
+libcache_key(FILE *flib, uint64_t key)
+{
+    unsigned char buf[65536];
+    size_t n;
+
+    if (key == 0) key = 0xcbf29ce484222325ULL;
+    key ^= LIBCACHE_VERSION;
+    while ((n = fread(buf, 1, sizeof(buf), flib)) > 0)
+	key = libcache_hash(key, buf, n);
+    rewind(flib);
+    return key;
+}
+
+/*--------------------------------------------------------------*/
+/* Return 1 if the liberty cache file "path" was written by	*/
+/* this run, and 0 if not.  If "add" is 1, record that it was.	*/
+/*--------------------------------------------------------------*/
+
+int
+libcache_written(char *path, int add)
+{
+    static char **written = NULL;
+    static int numwritten = 0;
+    int i;
+
+    for (i = 0; i < numwritten; i++)
+	if (!strcmp(written[i], path)) return 1;
+    if (add) {
+	written = (char **)realloc(written, (numwritten + 1) * sizeof(char *));
+	written[numwritten++] = strdup(path);
+    }
+    return 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Append "size" bytes to a cache block, returning the offset	*/
+/* of the data in the block, in units of "unit" bytes.		*/
+/*--------------------------------------------------------------*/
+
+int64_t
+libcache_append(libcachebuf *buf, void *data, size_t size, size_t unit)
+{
+    size_t offset = buf->used;
+
+    if (buf->used + size > buf->size) {
+	buf->size = (buf->size == 0) ? 65536 : buf->size;
+	while (buf->used + size > buf->size) buf->size *= 2;
+	buf->data = (char *)realloc(buf->data, buf->size);
+    }
+    memcpy(buf->data + buf->used, data, size);
+    buf->used += size;
+    return (int64_t)(offset / unit);
+}
+
+int32_t
+libcache_name(libcachebuf *names, char *name)
+{
+    if (name == NULL) return -1;
+    return (int32_t)libcache_append(names, name, strlen(name) + 1, 1);
+}
+
+int64_t
+libcache_values(libcachebuf *values, double *array, int count)
+{
+    if ((array == NULL) || (count <= 0)) return -1;
+    return libcache_append(values, array, count * sizeof(double), sizeof(double));
+}
+
+/*--------------------------------------------------------------*/
+/* Add a table record to the cache blocks, and return its	*/
+/* table number, or -1 if "table" is NULL.			*/
+/*--------------------------------------------------------------*/
+
+int32_t
+libcache_table(libcachebuf *tables, libcachebuf *names, libcachebuf *values,
+		lutableptr table)
+{
+    libcachetable rec;
+    int nvalues;
+
+    if (table == NULL) return -1;
+    memset(&rec, 0, sizeof(rec));
+    rec.name = libcache_name(names, table->name);
+    rec.invert = table->invert;
+    rec.var1 = table->var1;
+    rec.var2 = table->var2;
+    rec.size1 = table->size1;
+    rec.size2 = table->size2;
+    rec.idx1 = libcache_values(values, table->idx1.times, table->size1);
+    rec.idx2 = libcache_values(values, table->idx2.caps, table->size2);
+    nvalues = (table->size1 > 0) ? table->size1 : 1;
+    if (table->size2 > 0) nvalues *= table->size2;
+    rec.values = libcache_values(values, table->values, nvalues);
+    return (int32_t)libcache_append(tables, &rec, sizeof(rec), sizeof(rec));
+}
+
+/*--------------------------------------------------------------*/
+/* Write the liberty cache file "path" with the templates added	*/
+/* to the list "tables" before "oldtables", and the cells in	*/
+/* list "cells".  The file is written under a temporary name	*/
+/* and renamed, so that a concurrent run never reads a partial	*/
+/* file.							*/
+/*--------------------------------------------------------------*/
+
+void
+libcache_write(char *path, uint64_t key, int numlines, lutableptr tables,
+		lutableptr oldtables, cellptr cells)
+{
+    libcachehdr hdr;
+    libcachebuf tablebuf, cellbuf, pinbuf, namebuf, valuebuf;
+    libcachecell crec;
+    libcachepin prec;
+    lutableptr table;
+    cellptr testcell;
+    pinptr testpin;
+    char *tmppath;
+    FILE *fcache;
+    int numpins;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memset(&tablebuf, 0, sizeof(libcachebuf));
+    memset(&cellbuf, 0, sizeof(libcachebuf));
+    memset(&pinbuf, 0, sizeof(libcachebuf));
+    memset(&namebuf, 0, sizeof(libcachebuf));
+    memset(&valuebuf, 0, sizeof(libcachebuf));
+
+    for (table = tables; table != oldtables; table = table->next) {
+	libcache_table(&tablebuf, &namebuf, &valuebuf, table);
+	hdr.numtemplates++;
+    }
+
+    for (testcell = cells; testcell; testcell = testcell->next) {
+	memset(&crec, 0, sizeof(crec));
+	crec.name = libcache_name(&namebuf, testcell->name);
+	crec.function = libcache_name(&namebuf, testcell->function);
+	crec.type = testcell->type;
+	crec.area = testcell->area;
+	crec.maxtrans = testcell->maxtrans;
+	crec.maxcap = testcell->maxcap;
+	crec.firstpin = hdr.numpins;
+	numpins = 0;
+	for (testpin = testcell->pins; testpin; testpin = testpin->next) {
+	    memset(&prec, 0, sizeof(prec));
+	    prec.name = libcache_name(&namebuf, testpin->name);
+	    prec.type = testpin->type;
+	    prec.capr = testpin->capr;
+	    prec.capf = testpin->capf;
+	    prec.sense = testpin->sense;
+	    prec.pairidx = testpin->pairidx;
+	    prec.tables[0] = libcache_table(&tablebuf, &namebuf, &valuebuf,
+			testpin->propdelr);
+	    prec.tables[1] = libcache_table(&tablebuf, &namebuf, &valuebuf,
+			testpin->propdelf);
+	    prec.tables[2] = libcache_table(&tablebuf, &namebuf, &valuebuf,
+			testpin->transr);
+	    prec.tables[3] = libcache_table(&tablebuf, &namebuf, &valuebuf,
+			testpin->transf);
+	    libcache_append(&pinbuf, &prec, sizeof(prec), 1);
+	    numpins++;
+	}
+	crec.numpins = numpins;
+	hdr.numpins += numpins;
+	libcache_append(&cellbuf, &crec, sizeof(crec), 1);
+	hdr.numcells++;
+    }
+
+    memcpy(hdr.magic, LIBCACHE_MAGIC, sizeof(hdr.magic));
+    hdr.version = LIBCACHE_VERSION;
+    hdr.byteorder = LIBCACHE_BYTEORDER;
+    hdr.key = key;
+    hdr.numlines = numlines;
+    hdr.numtables = tablebuf.used / sizeof(libcachetable);
+    hdr.namesize = (namebuf.used + 7) & ~(size_t)7;	/* Keep values aligned */
+    hdr.numvalues = valuebuf.used / sizeof(double);
+
+    /* Pad the name block, and take the checksum of the blocks */
+
+    while (namebuf.used < hdr.namesize)
+	libcache_append(&namebuf, "", 1, 1);
+    hdr.checksum = 0xcbf29ce484222325ULL;
+    hdr.checksum = libcache_hash(hdr.checksum, tablebuf.data, tablebuf.used);
+    hdr.checksum = libcache_hash(hdr.checksum, cellbuf.data, cellbuf.used);
+    hdr.checksum = libcache_hash(hdr.checksum, pinbuf.data, pinbuf.used);
+    hdr.checksum = libcache_hash(hdr.checksum, namebuf.data, namebuf.used);
+    hdr.checksum = libcache_hash(hdr.checksum, valuebuf.data, valuebuf.used);
+
+    tmppath = (char *)malloc(strlen(path) + 24);
+    sprintf(tmppath, "%s.%d.tmp", path, (int)getpid());
+    fcache = fopen(tmppath, "w");
+    if (fcache == NULL) {
+	fprintf(stderr, "Cannot write liberty cache %s\n", tmppath);
+    }
+    else {
+	fwrite(&hdr, sizeof(hdr), 1, fcache);
+	if (tablebuf.used) fwrite(tablebuf.data, tablebuf.used, 1, fcache);
+	if (cellbuf.used) fwrite(cellbuf.data, cellbuf.used, 1, fcache);
+	if (pinbuf.used) fwrite(pinbuf.data, pinbuf.used, 1, fcache);
+	if (namebuf.used) fwrite(namebuf.data, namebuf.used, 1, fcache);
+	if (valuebuf.used) fwrite(valuebuf.data, valuebuf.used, 1, fcache);
+	if ((fclose(fcache) != 0) || (rename(tmppath, path) != 0)) {
+	    fprintf(stderr, "Cannot write liberty cache %s\n", path);
+	    unlink(tmppath);
+	}
+	else
+	    libcache_written(path, 1);
+    }
+    free(tmppath);
+    free(tablebuf.data);
+    free(cellbuf.data);
+    free(pinbuf.data);
+    free(namebuf.data);
+    free(valuebuf.data);
+}
+
+/*--------------------------------------------------------------*/
+/* Check that name offset "name" of a liberty cache record is	*/
+/* -1 or a null-terminated string in the name block "names" of	*/
+/* "namesize" bytes.						*/
+/*--------------------------------------------------------------*/
+
+int
+libcache_check_name(int32_t name, char *names, uint64_t namesize)
+{
+    if (name == -1) return 1;
+    if ((name < 0) || ((uint64_t)name >= namesize)) return 0;
+    return (memchr(names + name, '\0', namesize - name) != NULL);
+}
+
+/*--------------------------------------------------------------*/
+/* Check that value offset "offset" of a liberty cache record	*/
+/* is -1 or the start of "count" values within the value block	*/
+/* of "numvalues" doubles.					*/
+/*--------------------------------------------------------------*/
+
+int
+libcache_check_values(int64_t offset, int64_t count, uint64_t numvalues)
+{
+    if (offset == -1) return 1;
+    if ((offset < 0) || (count < 0)) return 0;
+    return ((uint64_t)offset <= numvalues) &&
+		((uint64_t)count <= numvalues - (uint64_t)offset);
+}
+
+/*--------------------------------------------------------------*/
+/* Check every offset and count in the records of a liberty	*/
+/* cache file against the sizes in its header "hdr", so that	*/
+/* a damaged file is never followed out of the mapped region.	*/
+/* Return 1 if the records are consistent, 0 if not.		*/
+/*--------------------------------------------------------------*/
+
+int
+libcache_check(libcachehdr *hdr, libcachetable *trec, libcachecell *crec,
+		libcachepin *prec, char *names)
+{
+    uint32_t i, j;
+    int64_t nvalues;
+
+    if (hdr->numtemplates > hdr->numtables) return 0;
+
+    for (i = 0; i < hdr->numtables; i++) {
+	if ((trec[i].size1 < 0) || (trec[i].size2 < 0)) return 0;
+	if (!libcache_check_name(trec[i].name, names, hdr->namesize)) return 0;
+	if (!libcache_check_values(trec[i].idx1, trec[i].size1, hdr->numvalues))
+	    return 0;
+	if (!libcache_check_values(trec[i].idx2, trec[i].size2, hdr->numvalues))
+	    return 0;
+	nvalues = (trec[i].size1 > 0) ? trec[i].size1 : 1;
+	if (trec[i].size2 > 0) nvalues *= trec[i].size2;
+	if (!libcache_check_values(trec[i].values, nvalues, hdr->numvalues))
+	    return 0;
+    }
+
+    for (i = 0; i < hdr->numcells; i++) {
+	if (!libcache_check_name(crec[i].name, names, hdr->namesize)) return 0;
+	if (!libcache_check_name(crec[i].function, names, hdr->namesize)) return 0;
+	if ((crec[i].firstpin < 0) || (crec[i].numpins < 0)) return 0;
+	if ((uint32_t)crec[i].firstpin > hdr->numpins) return 0;
+	if ((uint32_t)crec[i].numpins > hdr->numpins - (uint32_t)crec[i].firstpin)
+	    return 0;
+    }
+
+    for (i = 0; i < hdr->numpins; i++) {
+	if (!libcache_check_name(prec[i].name, names, hdr->namesize)) return 0;
+	for (j = 0; j < 4; j++) {
+	    if (prec[i].tables[j] == -1) continue;
+	    if ((prec[i].tables[j] < 0) ||
+			((uint32_t)prec[i].tables[j] >= hdr->numtables))
+		return 0;
+	}
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the liberty cache file "path", if it exists and matches	*/
+/* "key", and add its templates to "tablelist" and its cells to	*/
+/* "celllist" in the same way as libertyRead().  The number of	*/
+/* lines of the original liberty file is returned in		*/
+/* "numlines".  Return 1 on success, 0 if the file cannot be	*/
+/* used (in which case nothing is changed, and the caller	*/
+/* parses the liberty file instead).				*/
+/*--------------------------------------------------------------*/
+
+int
+libcache_read(char *path, uint64_t key, lutable **tablelist, cell **celllist,
+		int *numlines)
+{
+    struct stat statbuf;
+    libcachehdr *hdr;
+    libcachetable *trec;
+    libcachecell *crec;
+    libcachepin *prec;
+    lutableptr tables;
+    cellptr cells;
+    pinptr pins;
+    char *base, *names;
+    double *values;
+    size_t size, mapsize;
+    uint32_t i, j;
+    int fd, ok;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    if ((fstat(fd, &statbuf) < 0) ||
+		((size_t)statbuf.st_size < sizeof(libcachehdr))) {
+	close(fd);
+	return 0;
+    }
+    mapsize = (size_t)statbuf.st_size;
+    base = (char *)mmap(NULL, mapsize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == (char *)MAP_FAILED) return 0;
+
+    hdr = (libcachehdr *)base;
+    if (memcmp(hdr->magic, LIBCACHE_MAGIC, sizeof(hdr->magic)) ||
+		(hdr->version != LIBCACHE_VERSION) ||
+		(hdr->byteorder != LIBCACHE_BYTEORDER) ||
+		(hdr->key != key)) {
+	munmap(base, mapsize);
+	return 0;
+    }
+
+    /* Block sizes are checked one at a time against the space	*/
+    /* left in the file, so that the sum cannot overflow.	*/
+
+    size = sizeof(libcachehdr);
+    ok = (hdr->numtables <= (mapsize - size) / sizeof(libcachetable));
+    if (ok) {
+	size += hdr->numtables * sizeof(libcachetable);
+	ok = (hdr->numcells <= (mapsize - size) / sizeof(libcachecell));
+    }
+    if (ok) {
+	size += hdr->numcells * sizeof(libcachecell);
+	ok = (hdr->numpins <= (mapsize - size) / sizeof(libcachepin));
+    }
+    if (ok) {
+	size += hdr->numpins * sizeof(libcachepin);
+	ok = (hdr->namesize <= mapsize - size) && !(hdr->namesize & 7);
+    }
+    if (ok) {
+	size += hdr->namesize;
+	ok = (hdr->numvalues == (mapsize - size) / sizeof(double)) &&
+		((mapsize - size) % sizeof(double) == 0);
+    }
+    if (ok)
+	ok = (libcache_hash(0xcbf29ce484222325ULL, hdr + 1,
+		mapsize - sizeof(libcachehdr)) == hdr->checksum);
+    if (!ok) {
+	fprintf(stderr, "Liberty cache %s is damaged;  ignoring it.\n", path);
+	munmap(base, mapsize);
+	return 0;
+    }
+
+    trec = (libcachetable *)(hdr + 1);
+    crec = (libcachecell *)(trec + hdr->numtables);
+    prec = (libcachepin *)(crec + hdr->numcells);
+    names = (char *)(prec + hdr->numpins);
+    values = (double *)(names + hdr->namesize);
+
+    if (!libcache_check(hdr, trec, crec, prec, names)) {
+	fprintf(stderr, "Liberty cache %s is damaged;  ignoring it.\n", path);
+	munmap(base, mapsize);
+	return 0;
+    }
+
+    tables = (lutableptr)calloc(hdr->numtables + 1, sizeof(lutable));
+    for (i = 0; i < hdr->numtables; i++) {
+	tables[i].name = (trec[i].name < 0) ? NULL : names + trec[i].name;
+	tables[i].invert = trec[i].invert;
+	tables[i].var1 = trec[i].var1;
+	tables[i].var2 = trec[i].var2;
+	tables[i].size1 = trec[i].size1;
+	tables[i].size2 = trec[i].size2;
+	tables[i].idx1.times = (trec[i].idx1 < 0) ? NULL : values + trec[i].idx1;
+	tables[i].idx2.caps = (trec[i].idx2 < 0) ? NULL : values + trec[i].idx2;
+	tables[i].values = (trec[i].values < 0) ? NULL : values + trec[i].values;
+	tables[i].next = NULL;
+    }
+
+    /* Templates were prepended to the list as they were read */
+    for (i = hdr->numtemplates; i > 0; i--) {
+	tables[i - 1].next = *tablelist;
+	*tablelist = &tables[i - 1];
+    }
+
+    cells = (cellptr)calloc(hdr->numcells + 1, sizeof(cell));
+    pins = (pinptr)calloc(hdr->numpins + 1, sizeof(pin));
+    for (i = 0; i < hdr->numcells; i++) {
+	cells[i].name = (crec[i].name < 0) ? NULL : names + crec[i].name;
+	cells[i].function = (crec[i].function < 0) ? NULL : names + crec[i].function;
+	cells[i].type = crec[i].type;
+	cells[i].area = crec[i].area;
+	cells[i].maxtrans = crec[i].maxtrans;
+	cells[i].maxcap = crec[i].maxcap;
+	cells[i].pins = (crec[i].numpins > 0) ? &pins[crec[i].firstpin] : NULL;
+	cells[i].next = (i < hdr->numcells - 1) ? &cells[i + 1] : NULL;
+	for (j = crec[i].firstpin; j < (uint32_t)(crec[i].firstpin + crec[i].numpins);
+			j++) {
+	    pins[j].name = (prec[j].name < 0) ? NULL : names + prec[j].name;
+	    pins[j].type = prec[j].type;
+	    pins[j].capr = prec[j].capr;
+	    pins[j].capf = prec[j].capf;
+	    pins[j].sense = prec[j].sense;
+	    pins[j].pairidx = prec[j].pairidx;
+	    pins[j].propdelr = (prec[j].tables[0] < 0) ? NULL : &tables[prec[j].tables[0]];
+	    pins[j].propdelf = (prec[j].tables[1] < 0) ? NULL : &tables[prec[j].tables[1]];
+	    pins[j].transr = (prec[j].tables[2] < 0) ? NULL : &tables[prec[j].tables[2]];
+	    pins[j].transf = (prec[j].tables[3] < 0) ? NULL : &tables[prec[j].tables[3]];
+	    pins[j].refcell = &cells[i];
+	    pins[j].next = (j + 1 < (uint32_t)(crec[i].firstpin + crec[i].numpins)) ?
+			&pins[j + 1] : NULL;
+	}
+    }
+
+    /* As in libertyRead(), the cells replace the cell list */
+    if (hdr->numcells > 0) *celllist = &cells[0];
+
+    *numlines = hdr->numlines;
+    return 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the liberty file "libname" into the lists "tables" and	*/
+/* "cells".  If "cachedir" is not NULL, use the cached database	*/
+/* for the file in that directory if there is one, or else	*/
+/* write one.  "key" is the cache key of the files read before	*/
+/* into the same lists, and is updated.				*/
+/*								*/
+/* Return 1 on success, 0 if the file cannot be opened.		*/
+/*--------------------------------------------------------------*/
+
+int
+liberty_read_file(char *libname, char *cachedir, uint64_t *key,
+		lutable **tables, cell **cells)
+{
+    FILE *flib;
+    char *cachefile = NULL;
+    lutable *oldtables;
+    cell *oldcells;
+    int numlines;
+
+    flib = fopen(libname, "r");
+    if (flib == NULL) {
+	fprintf(stderr, "Cannot open %s for reading\n", libname);
+	return 0;
+    }
+
+    /*------------------------------------------------------------------*/
+    /* Use the cached database for this file, if there is one.          */
+    /*------------------------------------------------------------------*/
+
+    if (cachedir != NULL) {
+	*key = libcache_key(flib, *key);
+	cachefile = (char *)malloc(strlen(cachedir) + 24);
+	sprintf(cachefile, "%s/%016llx.vlc", cachedir, (unsigned long long)*key);
+	if (libcache_read(cachefile, *key, tables, cells, &numlines)) {
+	    /* A cache written earlier in this run holds what was parsed */
+	    if (libcache_written(cachefile, 0))
+		fprintf(stdout, "Lib read %s:  Processed %d lines.\n",
+			libname, numlines);
+	    else
+		fprintf(stdout, "Lib read %s:  Processed %d lines (from cache).\n",
+			libname, numlines);
+	    free(cachefile);
+	    fclose(flib);
+	    return 1;
+	}
+    }
+
+    /*------------------------------------------------------------------*/
+    /* Read the liberty format file.  This is not a rigorous parser!    */
+    /*------------------------------------------------------------------*/
+
+    oldtables = *tables;
+    oldcells = *cells;
+    fileCurrentLine = 0;
+    libertyRead(flib, tables, cells);
+    fflush(stdout);
+    fprintf(stdout, "Lib read %s:  Processed %d lines.\n", libname,
+		fileCurrentLine);
+    fclose(flib);
+
+    if (cachedir != NULL) {
+	libcache_write(cachefile, *key, fileCurrentLine, *tables, oldtables,
+		(*cells != oldcells) ? *cells : NULL);
+	free(cachefile);
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Read a verilog netlist and collect information about the     */
+/* cells instantiated and the network structure                 */
+/*--------------------------------------------------------------*/
+
+void
+verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
+                connect **inputlist, connect **outputlist, struct hashtable *Nethash)
+{
+    struct portrec  *port;
+    struct instance *inst;
+    struct cellrec  *topcell;
+    struct netrec   *net;
+
+    connptr newconn, testconn;
+    instptr newinst;
+    pinptr testpin;
+    netptr newnet, testnet;
+    cellptr testcell;
+
+    int vstart, vtarget;
+
+    /* Get verilog netlist structure using routines in readverilog.c */
+    topcell = ReadVerilog(filename);
+    if (topcell && topcell->name) {
+	fprintf(stdout, "Parsing module \"%s\"\n", topcell->name);
+	modulename = strdup(topcell->name);
+    }
+
+    /* Build local connection lists from returned netlist structure */
+
+    for (port = topcell->portlist; port; port = port->next) {
+	testconn = NULL;
+
+	// Create a net entry for the input or output, add to the list of nets
+
+	net = HashLookup(port->name, &topcell->nets);
+	if (net->start == 0 && net->end == 0) {
+	    newnet = create_net(netlist);
+	    newnet->name = tokendup(port->name);
+	    HashPtrInstall(newnet->name, newnet, Nethash);
+
+	    testconn = (connptr)arena_alloc(&netarena, sizeof(connect));
+	    testconn->refnet = newnet;
+	    testconn->refpin = NULL;        // No associated pin
+	    testconn->refinst = NULL;       // No associated instance
+	    testconn->tag = NULL;
+	    testconn->metric = -1.0;
+	    testconn->icDelay = 0.0;
+	    testconn->visited = (unsigned char)0;
+	    testconn->index = -1;
+	    testconn->vectors = NULL;
+
+            if (port->direction == PORT_INPUT) {    // driver (input)
+		testconn->next = *inputlist;
+		*inputlist = testconn;
+            }
+            else {				    // receiver (output)
+		testconn->next = *outputlist;
+		*outputlist = testconn;
+            }
+	}
+	else {
+	    vtarget = net->end + ((net->start < net->end) ? 1 : -1);
+	    vstart = net->start;
+	    while (vstart != vtarget) {
+		newnet = create_net(netlist);
+		newnet->name = (char *)malloc(strlen(port->name) + 6);
+		sprintf(newnet->name, "%s[%d]", port->name, vstart);
+		HashPtrInstall(newnet->name, newnet, Nethash);
+
+		vstart += (vtarget > net->end) ? 1 : -1;
+
+		testconn = (connptr)arena_alloc(&netarena, sizeof(connect));
+		testconn->refnet = newnet;
+		testconn->refpin = NULL;    // No associated pin
+		testconn->refinst = NULL;   // No associated instance
+		testconn->tag = NULL;
+		testconn->metric = -1.0;
+		testconn->icDelay = 0.0;
+		testconn->visited = (unsigned char)0;
+		testconn->index = -1;
+		testconn->vectors = NULL;
+
+		if (port->direction == PORT_INPUT) {    // driver (input)
+		    testconn->next = *inputlist;
+		    *inputlist = testconn;
+		}
+		else {                      // receiver (output)
+		    testconn->next = *outputlist;
+		    *outputlist = testconn;
+		}
+	    }
+	}
+    }
+
+    for (inst = topcell->instlist; inst; inst = inst->next) {
+        for (testcell = cells; testcell; testcell = testcell->next)
+            if (!strcasecmp(testcell->name, inst->cellname))
+                break;
+
+	// NOTE:  testcell may be NULL for non-functional cells like
+	// filler cells which have no I/O and so have no timing.  Only
+	// report cells that are relevant to timing and do not show up
+	// in the liberty database (portlist is non-NULL).
+
+        if ((testcell == NULL) && (inst->portlist != NULL)) {
+	    fprintf(stderr, "Cell \"%s\" was not in the liberty database!\n",
+		    inst->cellname);
+	    continue;
+	}
+
+        newinst = (instptr)arena_alloc(&netarena, sizeof(instance));
+        newinst->next = *instlist;
+        *instlist = newinst;
+        newinst->refcell = testcell;
+        newinst->in_connects = NULL;
+        newinst->out_connects = NULL;
+        newinst->name = tokendup(inst->instname);
+
+	for (port = inst->portlist; port; port = port->next) {
+            newconn = (connptr)arena_alloc(&netarena, sizeof(connect));
+            for (testpin = testcell->pins; testpin; testpin = testpin->next) {
+                if (!strcmp(testpin->name, port->name))
+                    break;
+            }
+            // Sanity check
+            if (testpin == NULL) {
+                fprintf(stderr, "No such pin \"%s\" in cell \"%s\"!\n",
+                        port->name, testcell->name);
+            }
+            else {
+                if (testpin->type & OUTPUT) {
+                    newconn->next = newinst->out_connects;
+                    newinst->out_connects = newconn;
+                }
+                else {
+                    newconn->next = newinst->in_connects;
+                    newinst->in_connects = newconn;
+                }
+            }
+            newconn->refinst = newinst;
+            newconn->refpin = testpin;
+            newconn->refnet = NULL;
+            newconn->tag = NULL;
+            newconn->metric = -1.0;
+	    newconn->icDelay = 0.0;
+	    newconn->visited = (unsigned char)0;
+	    newconn->index = -1;
+            newconn->vectors = NULL;
+
+            testnet = (netptr)HashLookup(port->net, Nethash);
+            if (testnet == NULL) {
+                // This is a new net, and we need to record it
+                newnet = create_net(netlist);
+                newnet->name = tokendup(port->net);
+                HashPtrInstall(newnet->name, newnet, Nethash);
+                newconn->refnet = newnet;
+            }
+            else
+                newconn->refnet = testnet;
+	}
+    }
+    FreeVerilog(topcell);   // All structures transferred
+}
+
+/*--------------------------------------------------------------*/
+/* Add the contributions of each receiver of net "testnet" to	*/
+/* the total load.  This is either the input pin capacitance,	*/
+/* if the receiver is a pin, or the designated output load	*/
+/* (given on the command line), if the receiver is an output	*/
+/* pin.								*/
+/*--------------------------------------------------------------*/
+
+void
+add_pin_loads(netptr testnet, double out_load)
+{
+    pinptr testpin;
+    connptr testconn;
+    int i;
+
+    for (i = 0; i < testnet->fanout; i++) {
+        testconn = testnet->receivers[i];
+        testpin = testconn->refpin;
+        if (testpin == NULL) {
+            testnet->loadr += out_load;
+            testnet->loadf += out_load;
+        }
+        else {
+            testnet->loadr += testpin->capr;
+            testnet->loadf += testpin->capf;
+        }
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* For each input pin of instance "testinst", forget the pin's	*/
+/* collapsed lookup tables, so that they are collapsed again	*/
+/* at the load on the instance output when next used (see	*/
+/* connection_vectors()).					*/
+/*--------------------------------------------------------------*/
+
+void
+collapse_instance_tables(instptr testinst)
+{
+    connptr testconn;
+
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	testconn->vectors = NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* For each net, go through the list of receivers and add the   */
+/* contributions of each to the total load (see add_pin_loads). */
+/* The lookup tables of the instance input pins are collapsed	*/
+/* at the new loads when the path search first reaches them.	*/
+/*--------------------------------------------------------------*/
+
+void
+computeLoads(netptr netlist, instptr instlist, double out_load)
+{
+    instptr testinst;
+    netptr testnet;
+
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	add_pin_loads(testnet, out_load);
+
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	collapse_instance_tables(testinst);
+}
+
+/*--------------------------------------------------------------*/
+/* Assign types to each net.  This identifies which nets are    */
+/* clock inputs, which are latch enable inputs, and which are   */
+/* asynchronous set/reset inputs,.                              */
+/*                                                              */
+/* Whenever a clock input to a flop is found, add the           */
+/* connection record to clockedlist                             */
+/*                                                              */
+/* For diagnostics, return the number of entries in clockedlist */
+/*--------------------------------------------------------------*/
+
+int assign_net_types(netptr netlist, connlistptr *clockedlist)
+{
+    int i, numterms;
+    netptr testnet;
+    connptr testrcvr;
+    pinptr testpin;
+    connlistptr newclocked;
+
+    numterms = 0;
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	/* Nets with no fanout are by definition module outputs */
+	if (testnet->fanout == 0) testnet->type |= OUTTERM;
+        for (i = 0; i < testnet->fanout; i++) {
+            testrcvr = testnet->receivers[i];
+            testpin = testrcvr->refpin;
+            if (testpin == NULL)
+                testnet->type |= OUTTERM;
+            else {
+                switch (testpin->type & (DFFMASK | LATCHMASK)) {
+                    case DFFCLK:
+                        testnet->type |= CLOCK;
+                        newclocked = (connlistptr)malloc(sizeof(connlist));
+                        newclocked->connection = testrcvr;
+                        newclocked->next = *clockedlist;
+                        *clockedlist = newclocked;
+                        numterms++;
+                        break;
+                    case DFFIN:
+                        testnet->type |= TERMINAL;
+                        break;
+                    case DFFSET:
+                    case DFFRST:
+                        testnet->type |= ASYNC;
+                        break;
+                    case LATCHIN:
+                        testnet->type |= LATCHTERM;
+                        break;
+                    case LATCHEN:
+                        testnet->type |= ENABLE;
+                        break;
+                }
+            }
+        }
+    }
+    return numterms;
+}
+
+/*--------------------------------------------------------------*/
+/* Create the links representing the netlist connections.       */
+/*                                                              */
+/* The verilogRead() routine added all nets and instances, and  */
+/* for each instance, generated a list of net connections to    */
+/* each pin.  To make the netlist easily traversible, this      */
+/* routine does the following:                                  */
+/*                                                              */
+/* For each instance, work through the list of pin              */
+/*      connections.  If the pin is an output, then add the     */
+/*      connection as the net's driver entry.  If the pin is    */
+/*      an input, then add the connection to the list of the    */
+/*      net's receivers, and increment the net's fanout.        */
+/*                                                              */
+/* For each module input, add the input connection as the       */
+/*      net's driver (flag an error if the net already has a    */
+/*      driver).                                                */
+/*                                                              */
+/* For each module output, add the output connection as one of  */
+/*      the net's receivers (it may be the only one).           */
+/*                                                              */
+/*--------------------------------------------------------------*/
+
+void
+createLinks(netptr netlist, instptr instlist, connptr inputlist, connptr outputlist)
+{
+    netptr testnet;
+    instptr testinst;
+    connptr testconn, *rcvrpool;
+    int numrcvrs;
+
+    // Count the receivers of each net, and allocate the receiver
+    // arrays of all nets as consecutive blocks of a single array.
+
+    numrcvrs = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+        for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+            testconn->refnet->fanout++;
+            numrcvrs++;
+        }
+    }
+    for (testconn = outputlist; testconn; testconn = testconn->next) {
+        testconn->refnet->fanout++;
+        numrcvrs++;
+    }
+    if (numrcvrs == 0) numrcvrs = 1;
+    rcvrpool = (connptr *)malloc(numrcvrs * sizeof(connptr));
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+        if (testnet->fanout > 0) {
+            testnet->receivers = rcvrpool;
+            rcvrpool += testnet->fanout;
+        }
+        testnet->fanout = 0;    // Recounted below
+    }
+
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+        for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+            testnet = testconn->refnet;
+            testnet->receivers[testnet->fanout++] = testconn;
+        }
+
+        for (testconn = testinst->out_connects; testconn; testconn = testconn->next) {
+            testnet = testconn->refnet;
+            testnet->driver = testconn;
+        }
+    }
+
+    for (testconn = inputlist; testconn; testconn = testconn->next) {
+        testnet = testconn->refnet;
+        if (testnet->driver != NULL)
+            fprintf(stderr, "Error:  Input pin \"%s\" has an internal driver!\n",
+                        testnet->name);
+        // else
+        //    testnet->driver = testconn;       // Don't do this, makes connectivity circular
+    }
+
+    for (testconn = outputlist; testconn; testconn = testconn->next) {
+        testnet = testconn->refnet;
+        testnet->receivers[testnet->fanout++] = testconn;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Path order for reporting.  Return 1 if path "a", at position	*/
+/* "apos" in the path list, is reported before path "b", at	*/
+/* position "bpos".  Maximum delay paths are reported longest	*/
+/* first, and minimum delay paths shortest first.  Ties are	*/
+/* broken by list position, giving the same order as a stable	*/
+/* sort of the whole list from longest to shortest delay.	*/
+/*--------------------------------------------------------------*/
+
+int
+path_before(ddataptr a, int apos, ddataptr b, int bpos, char minmax)
+{
+    if (minmax == MAXIMUM_TIME) {
+	if (a->delay != b->delay) return (a->delay > b->delay) ? 1 : 0;
+	return (apos < bpos) ? 1 : 0;
+    }
+    else {
+	if (a->delay != b->delay) return (a->delay < b->delay) ? 1 : 0;
+	return (apos > bpos) ? 1 : 0;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Bounded heap of paths used by select_paths().  The root of	*/
+/* the heap is the path that would be reported last.  Paths are	*/
+/* in "heap", with their list positions in "hpos".		*/
+/*								*/
+/* path_heap_down() replaces the root of the heap of "count"	*/
+/* entries with path "p" at list position "pos".		*/
+/*--------------------------------------------------------------*/
+
+void
+path_heap_down(ddataptr *heap, int *hpos, int count, ddataptr p, int pos,
+		char minmax)
+{
+    int i, c;
+
+    i = 0;
+    while ((c = 2 * i + 1) < count) {
+	if ((c + 1 < count) && path_before(heap[c], hpos[c],
+			heap[c + 1], hpos[c + 1], minmax))
+	    c++;
+	if (!path_before(p, pos, heap[c], hpos[c], minmax)) break;
+	heap[i] = heap[c];
+	hpos[i] = hpos[c];
+	i = c;
+    }
+    heap[i] = p;
+    hpos[i] = pos;
+}
+
+/*--------------------------------------------------------------*/
+/* Add path "p" at list position "pos" to the heap, which holds	*/
+/* "*count" entries out of a maximum of "k".  If the heap is	*/
+/* full, "p" displaces the root if it would be reported before	*/
+/* it, and is otherwise dropped.				*/
+/*--------------------------------------------------------------*/
+
+void
+path_heap_add(ddataptr *heap, int *hpos, int *count, int k, ddataptr p,
+		int pos, char minmax)
+{
+    int i, c;
+
+    if (*count < k) {
+	/* Sift up */
+	i = (*count)++;
+	while (i > 0) {
+	    c = (i - 1) / 2;
+	    if (!path_before(heap[c], hpos[c], p, pos, minmax)) break;
+	    heap[i] = heap[c];
+	    hpos[i] = hpos[c];
+	    i = c;
+	}
+	heap[i] = p;
+	hpos[i] = pos;
+    }
+    else if ((k > 0) && path_before(p, pos, heap[0], hpos[0], minmax))
+	path_heap_down(heap, hpos, *count, p, pos, minmax);
+}
+
+/*--------------------------------------------------------------*/
+/* Select the first "k" paths of "pathlist" in report order	*/
+/* (see path_before()) without sorting the whole list.  The	*/
+/* paths are placed in "selected" in report order, and the	*/
+/* number placed is returned in "numselected".			*/
+/*								*/
+/* If "perendpoint" is non-zero, only the first path in report	*/
+/* order to each endpoint is a candidate.			*/
+/*								*/
+/* Return value is the number of candidate paths.		*/
+/*--------------------------------------------------------------*/
+
+int
+select_paths(ddataptr pathlist, char minmax, int k, unsigned char perendpoint,
+		ddataptr *selected, int *numselected)
+{
+    ddataptr testddata, *bestpath, *heap;
+    int *bestpos, *hpos;
+    int pos, n, count, numcands;
+
+    heap = (ddataptr *)malloc((k + 1) * sizeof(ddataptr));
+    hpos = (int *)malloc((k + 1) * sizeof(int));
+    count = 0;
+    numcands = 0;
+
+    if (perendpoint) {
+	bestpath = (ddataptr *)calloc(numconnects, sizeof(ddataptr));
+	bestpos = (int *)malloc(numconnects * sizeof(int));
+	pos = 0;
+	for (testddata = pathlist; testddata; testddata = testddata->next, pos++) {
+	    n = testddata->backtrace->receiver->index;
+	    if ((n < 0) || (n >= numconnects)) {
+		numcands++;
+		path_heap_add(heap, hpos, &count, k, testddata, pos, minmax);
+	    }
+	    else if ((bestpath[n] == NULL) || path_before(testddata, pos,
+			bestpath[n], bestpos[n], minmax)) {
+		bestpath[n] = testddata;
+		bestpos[n] = pos;
+	    }
+	}
+	for (n = 0; n < numconnects; n++) {
+	    if (bestpath[n] == NULL) continue;
+	    numcands++;
+	    path_heap_add(heap, hpos, &count, k, bestpath[n], bestpos[n], minmax);
+	}
+	free(bestpath);
+	free(bestpos);
+    }
+    else {
+	pos = 0;
+	for (testddata = pathlist; testddata; testddata = testddata->next, pos++) {
+	    numcands++;
+	    path_heap_add(heap, hpos, &count, k, testddata, pos, minmax);
+	}
+    }
+
+    /* Remove paths from the heap, last reported first */
+
+    *numselected = count;
+    while (count > 0) {
+	selected[count - 1] = heap[0];
+	count--;
+	if (count > 0)
+	    path_heap_down(heap, hpos, count, heap[count], hpos[count], minmax);
+    }
+    free(heap);
+    free(hpos);
+    return numcands;
+}
+
+/*--------------------------------------------------------------*/
+/* Read a line of any length from "f" into *line, which has	*/
+/* *size bytes allocated and is grown as needed.  Return *line,	*/
+/* or NULL at end-of-file.					*/
+/*--------------------------------------------------------------*/
+
+char *
+delay_getline(FILE *f, char **line, int *size)
+{
+    int len;
+
+    if (*line == NULL) {
+	*size = 256;
+	*line = (char *)malloc(*size);
+    }
+    if (fgets(*line, *size, f) == NULL) return NULL;
+    len = strlen(*line);
+    while ((len == *size - 1) && ((*line)[len - 1] != '\n')) {
+	*size <<= 1;
+	*line = (char *)realloc(*line, *size);
+	if (fgets(*line + len, *size - len, f) == NULL) break;
+	len += strlen(*line + len);
+    }
+    return *line;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the net "token" in Nethash.  If not found and option -c	*/
+/* was given, try the net name syntax of other netlist formats.	*/
+/* "token" may be modified.  Return NULL if the net is not	*/
+/* found.							*/
+/*--------------------------------------------------------------*/
+
+netptr
+delay_net_lookup(char *token, struct hashtable *Nethash)
+{
+    netptr testnet;
+    char *tokencopy, *mchr, *dchr;
+
+    testnet = (netptr)HashLookup(token, Nethash);
+    if ((testnet != NULL) || !cleanup) return testnet;
+
+    /* Handle the insane backslash-escape names in verilog.
+     * To make these compatible with SPICE, qflow opts to
+     * replace the ending space character with another
+     * backslash.  The 2nd backslash has to be replaced by
+     * the original space character to match the original
+     * verilog net name.
+     */
+
+    if (*token == '\\') {
+	if ((mchr = strchr(token + 1, '\\')) != NULL) {
+	    dchr = strchr(token + 1, ' ');
+	    if ((dchr == NULL) || (dchr > mchr)) *mchr = ' ';
+	}
+    }
+    testnet = (netptr)HashLookup(token, Nethash);
+    if (testnet != NULL) return testnet;
+
+    /* Other, legacy stuff. */
+    tokencopy = strdup(token);
+    if ((mchr = strrchr(tokencopy, '<')) != NULL) {
+	if ((dchr = strrchr(tokencopy, '>')) != NULL) {
+	    if (mchr < dchr) {
+		*mchr = '[';
+		*dchr = ']';
+	    }
+	}
+    }
+    testnet = (netptr)HashLookup(tokencopy, Nethash);
+
+    if (testnet == NULL) {
+	for (mchr = tokencopy; *mchr != '\0'; mchr++) {
+	    if ((*mchr == ':') || (*mchr == '.') || (*mchr == '$')
+			|| (*mchr == '<') || (*mchr == '>'))
+		*mchr = '_';
+	}
+	testnet = (netptr)HashLookup(tokencopy, Nethash);
+    }
+
+    if (testnet == NULL) {
+	for (mchr = tokencopy; *mchr != '\0'; mchr++) {
+	    if ((*mchr == '[') || (*mchr == ']'))
+		*mchr = '_';
+	}
+	testnet = (netptr)HashLookup(tokencopy, Nethash);
+    }
+    free(tokencopy);
+    return testnet;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the connection of net "testnet" to pin "pinname" of	*/
+/* instance "instname", which is looked up in Insthash.  This	*/
+/* may be the driver of the net.  If "pinname" is NULL or no	*/
+/* pin has that name, the first pin of the instance on the net	*/
+/* is returned.  Return NULL if the instance is not found or	*/
+/* is not on the net.						*/
+/*--------------------------------------------------------------*/
+
+connptr
+delay_inst_conn(netptr testnet, char *instname, char *pinname,
+	struct hashtable *Insthash)
+{
+    instptr testinst;
+    connptr testconn, firstconn;
+
+    testinst = (instptr)HashLookup(instname, Insthash);
+    if (testinst == NULL) return NULL;
+
+    if ((testnet->driver != NULL) && (testnet->driver->refinst == testinst)) {
+	testconn = testnet->driver;
+	if ((pinname != NULL) && (testconn->refpin != NULL) &&
+		!strcmp(testconn->refpin->name, pinname))
+	    return testconn;
+    }
+
+    firstconn = NULL;
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	if (testconn->refnet != testnet) continue;
+	if (firstconn == NULL) firstconn = testconn;
+	if ((pinname != NULL) && (testconn->refpin != NULL) &&
+		!strcmp(testconn->refpin->name, pinname))
+	    return testconn;
+    }
+    if ((firstconn == NULL) && (testnet->driver != NULL) &&
+		(testnet->driver->refinst == testinst))
+	firstconn = testnet->driver;
+    return firstconn;
+}
+
+/*--------------------------------------------------------------*/
+/* Set the interconnect delay of the receivers of "testnet"	*/
+/* that are design outputs.  Return the number of receivers	*/
+/* set.								*/
+/*--------------------------------------------------------------*/
+
+int
+delay_set_ports(netptr testnet, double delay)
+{
+    connptr testconn;
+    int i, numset = 0;
+
+    for (i = 0; i < testnet->fanout; i++) {
+	testconn = testnet->receivers[i];
+	if (testconn->refinst == NULL) {
+	    testconn->icDelay = delay;
+	    numset++;
+	}
+    }
+    return numset;
+}
+
+/*--------------------------------------------------------------*/
+/* Report a net whose receivers in the parasitics file do not	*/
+/* match its fanout.						*/
+/*--------------------------------------------------------------*/
+
+void
+delay_check_fanout(netptr testnet, int numRxers)
+{
+    if (numRxers != testnet->fanout) {
+	if (numRxers != 1 || testnet->fanout > 0 || testnet->type != OUTTERM)
+	    fprintf(stderr, "ERROR: Net %s had %d receiver%s in delay file, "
+			" but expected a fanout of %d\n", testnet->name,
+			numRxers, (numRxers == 1) ? "" : "s",
+			testnet->fanout);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Read the wiring delay file (see the top of this file).  Net	*/
+/* loads are set to the wiring capacitance, and the interconnect	*/
+/* delay of each receiver is recorded.  If "updated" is not	*/
+/* NULL, each net read is also entered in hash table "updated".	*/
+/*--------------------------------------------------------------*/
+
+void
+delayRead(FILE *fdly, struct hashtable *Nethash, struct hashtable *Insthash,
+	struct hashtable *updated)
+{
+    char *c = NULL;
+    int csize = 0;
+    char *token;
+    char *result;
+    char *pinname;
+
+    netptr testnet;
+    connptr testconn;
+    int numRxers;
+    double delay;
+
+    if (debug == 1)
+	fprintf(stdout, "delayRead\n");
+
+    /* NOTE:  Do not use 0 for delimiter, or else ':' is considered to	*/
+    /* be a standard delimiter, breaking up certain yosys-generated	*/
+    /* net names.							*/
+    
+    token = advancetokennocont(fdly, '\n');
+    result = token;
+
+    while (token != NULL) {
+
+        char *saveptr;
+
+        numRxers = 0;
+	testnet = delay_net_lookup(token, Nethash);
+
+	if (testnet == NULL) {
+	    fprintf(stderr, "ERROR: Net %s not found in hash table\n", token);
+	    exit(-1);
+	}
+
+        // Read driver of interconnect and total interconnect capacitance
+        result = delay_getline(fdly, &c, &csize);
+	if (result == NULL) break;
 
-                            token = advancetoken(flib, 0);      // Open parens
-                            token = advancetoken(flib, 0);      // Quote
-                            if (!strcmp(token, "\""))
-                                token = advancetoken(flib, '\"');
+        strtok_r(c, "/", &saveptr);
+        if (debug == 1)
+            fprintf(stdout, "\tDriver Inst: %s\n", saveptr);
+        strtok_r(NULL, " ", &saveptr);
+        if (debug == 1) {
+            fprintf(stdout, "\tDriver Pin: %s\n", saveptr);
+            fprintf(stdout, "\tTotC: %f\n", strtof(saveptr, NULL));
+	}
 
-                            iptr = token;
+	if (c[1] == '\0') {
+	    fprintf(stderr, "ERROR: Driver not found for net %s\n", testnet->name);
+	}
 
-			    // Check if table is space or comma separated
-			    if (strchr(iptr, dnum) == NULL)
-				if (strchr(iptr, ' ') != NULL)
-				    dnum = ' ';
+        /* Load in .dly file is in pF, but we keep fF in loadr/loadf */
+        testnet->loadr = (strtod(saveptr, NULL)) * 1e3;
+        testnet->loadf = testnet->loadr;
+	if (updated != NULL) HashPtrInstall(testnet->name, testnet, updated);
 
-                            if (newtable->invert == 0) {
-                                // Count entries
-                                newtable->size2 = 1;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    newtable->size2++;
-                                }
-                                newtable->idx2.caps = (double *)malloc(newtable->size2 *
-                                        sizeof(double));
-                                newtable->size2 = 0;
-                                iptr = token;
-                                sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
-                                if (newtable->var2 == OUTPUT_CAP)
-                                    newtable->idx2.caps[0] *= cap_unit;
-                                else
-                                    newtable->idx2.cons[0] *= time_unit;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    newtable->size2++;
-                                    sscanf(iptr, "%lg",
-                                                &newtable->idx2.caps[newtable->size2]);
-                                    if (newtable->var2 == OUTPUT_CAP)
-                                        newtable->idx2.caps[newtable->size2] *= cap_unit;
-                                    else
-                                        newtable->idx2.cons[newtable->size2] *= time_unit;
-                                }
-                                newtable->size2++;
-                            }
-                            else {      // newtable->invert == 1
-                                // Count entries
-                                newtable->size1 = 1;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    newtable->size1++;
-                                }
-                                newtable->idx1.times = (double *)malloc(newtable->size1 *
-                                        sizeof(double));
-                                newtable->size1 = 0;
-                                iptr = token;
-                                sscanf(iptr, "%lg", &newtable->idx1.times[0]);
-                                newtable->idx1.times[0] *= time_unit;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    newtable->size1++;
-                                    sscanf(iptr, "%lg",
-                                                &newtable->idx1.times[newtable->size1]);
-                                    newtable->idx1.times[newtable->size1] *= time_unit;
-                                }
-                                newtable->size1++;
-                            }
+        result = delay_getline(fdly, &c, &csize);
+	if (result == NULL) break;
 
-                            token = advancetoken(flib, ';'); // EOL semicolon
-                        }
-                    }
-                }
-                else if (!strcasecmp(token, "cell")) {
-                    newcell = (cell *)malloc(sizeof(cell));
-                    newcell->next = NULL;
-                    if (lastcell != NULL)
-                        lastcell->next = newcell;
-                    else
-                        *celllist = newcell;
-                    lastcell = newcell;
-                    token = advancetoken(flib, 0);      // Open parens
-                    if (!strcmp(token, "("))
-                        token = advancetoken(flib, ')');        // Cellname
-		    if (debug == 2) fprintf(stdout, "   cell = %s\n", token);
-                    newcell->name = tokendup(token);
-                    token = advancetoken(flib, 0);      // Find start of block
-                    if (strcmp(token, "{"))
-                        fprintf(stderr, "Error: failed to find start of block\n");
-                    newcell->type = GATE;               // Default type
-                    newcell->function = NULL;
-                    newcell->pins = NULL;
-                    newcell->area = 1.0;
-                    newcell->maxtrans = 0.0;
-                    newcell->maxcap = 0.0;
-                    section = CELLDEF;
-                }
-                else if (!strcasecmp(token, "time_unit")) {
-                   char *metric;
+        while (c[0] != '\n') {
+            if (debug == 1) fprintf(stdout, "\t%s\n", c);
 
-                   token = advancetoken(flib, 0);
-                   if (token == NULL) break;
-                   if (!strcmp(token, ":")) {
-                      token = advancetoken(flib, 0);
-                      if (token == NULL) break;
-                   }
-                   if (!strcmp(token, "\"")) {
-                      token = advancetoken(flib, '\"');
-                      if (token == NULL) break;
-                   }
-                   time_unit = strtod(token, &metric);
-                   if (*metric != '\0') {
-                      if (!strcmp(metric, "ns"))
-                         time_unit *= 1E3;
-                      else if (!strcmp(metric, "us"))
-                         time_unit *= 1E6;
-                      else if (!strcmp(metric, "fs"))
-                         time_unit *= 1E-3;
-                      else if (strcmp(metric, "ps"))
-                         fprintf(stderr, "Don't understand time units \"%s\"\n",
-                                token);
-                   }
-                   else {
-                      token = advancetoken(flib, 0);
-                      if (token == NULL) break;
-                      if (!strcmp(token, "ns"))
-                         time_unit *= 1E3;
-                      else if (!strcmp(token, "us"))
-                         time_unit *= 1E6;
-                      else if (!strcmp(token, "fs"))
-                         time_unit *= 1E-3;
-                      else if (strcmp(token, "ps"))
-                         fprintf(stderr, "Don't understand time units \"%s\"\n",
-                                token);
-                   }
-                   token = advancetoken(flib, ';');
-                }
-                else if (!strcasecmp(token, "capacitive_load_unit")) {
-                   char *metric;
+            // Separate receiver name and delay value, and the
+	    // receiver name into instance and pin names
+            strtok_r(c, " ", &saveptr);
+	    delay = strtod(saveptr, NULL);
+	    pinname = strrchr(c, '/');
+	    if (pinname != NULL) *pinname++ = '\0';
+	    if (debug == 1) {
+                fprintf(stdout, "\tRxer Name: %s\n", c);
+                fprintf(stdout, "\tRxer Pin: %s\n", (pinname) ? pinname : "");
+                fprintf(stdout, "\tDelay: %f\n", delay);
+	    }
+
+	    // Receivers are found by instance name.  A design output
+	    // has no receiving instance pin.
+
+	    testconn = NULL;
+	    if (strcmp(c, "PIN"))
+		testconn = delay_inst_conn(testnet, c, pinname, Insthash);
+	    if (testconn != NULL)
+		testconn->icDelay = delay;
+	    else if (testnet->type == OUTTERM) {
+		if (debug == 1)
+		    fprintf(stdout, "\tNet connects to output and has no "
+				"receiving instance pin\n");
+		delay_set_ports(testnet, delay);
+	    }
+
+            result = delay_getline(fdly, &c, &csize);
+	    if (result == NULL) break;
+            numRxers += 1;
+        }
+	if (result == NULL) break;
+
+	delay_check_fanout(testnet, numRxers);
+
+        token = advancetokennocont(fdly, '\n');
+    }
+    if (result == NULL) {
+	fprintf(stderr, "ERROR: Unexpected end-of-file while reading delay file.\n");
+    }
+    free(c);
+}
+
+/*--------------------------------------------------------------*/
+/* Start an empty RC tree.					*/
+/*--------------------------------------------------------------*/
+
+void
+rctree_init(rctree *tree)
+{
+    tree->mem.blocks = NULL;
+    tree->mem.spare = NULL;
+    InitializeHashTable(&tree->names, SMALLHASHSIZE);
+    tree->nodes = NULL;
+    tree->numnodes = 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Remove all nodes from an RC tree, to read the next net.	*/
+/*--------------------------------------------------------------*/
+
+void
+rctree_clear(rctree *tree)
+{
+    rcnodeptr node;
+
+    for (node = tree->nodes; node; node = node->next)
+	if (node->name != NULL)
+	    HashDelete(node->name, &tree->names);
+    arena_reset(&tree->mem);
+    tree->nodes = NULL;
+    tree->numnodes = 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Free an RC tree.						*/
+/*--------------------------------------------------------------*/
+
+void
+rctree_free(rctree *tree)
+{
+    arenablockptr block;
+
+    rctree_clear(tree);
+    HashKill(&tree->names);
+    while (tree->mem.spare != NULL) {
+	block = tree->mem.spare;
+	tree->mem.spare = block->next;
+	free(block);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Return the node of "tree" named "name", creating it if it	*/
+/* does not exist.  If "name" is NULL, always create an unnamed	*/
+/* node.							*/
+/*--------------------------------------------------------------*/
+
+rcnodeptr
+rctree_node(rctree *tree, char *name)
+{
+    rcnodeptr node;
+    struct hashlist *entry = NULL;
+
+    if (name != NULL) {
+	node = (rcnodeptr)HashLookup(name, &tree->names);
+	if (node != NULL) return node;
+    }
+
+    node = (rcnodeptr)arena_alloc(&tree->mem, sizeof(rcnode));
+    if (name != NULL) entry = HashPtrInstall(name, node, &tree->names);
+    node->name = (entry != NULL) ? entry->name : NULL;
+    node->conn = NULL;
+    node->port = 0;
+    node->visited = 0;
+    node->cap = 0.0;
+    node->pincap = 0.0;
+    node->down = 0.0;
+    node->delay = 0.0;
+    node->res = 0.0;
+    node->parent = NULL;
+    node->edges = NULL;
+    node->next = tree->nodes;
+    tree->nodes = node;
+    tree->numnodes++;
+    return node;
+}
+
+/*--------------------------------------------------------------*/
+/* Add a resistor of "res" ohms between two nodes of "tree".	*/
+/*--------------------------------------------------------------*/
+
+void
+rctree_res(rctree *tree, rcnodeptr node1, rcnodeptr node2, double res)
+{
+    rcedgeptr edge;
+
+    edge = (rcedgeptr)arena_alloc(&tree->mem, sizeof(rcedge));
+    edge->node = node2;
+    edge->res = res;
+    edge->next = node1->edges;
+    node1->edges = edge;
+
+    edge = (rcedgeptr)arena_alloc(&tree->mem, sizeof(rcedge));
+    edge->node = node1;
+    edge->res = res;
+    edge->next = node2->edges;
+    node2->edges = edge;
+}
+
+/*--------------------------------------------------------------*/
+/* Compute the Elmore delay from node "root" (the driver) to	*/
+/* each node of "tree", and annotate net "testnet":  the net	*/
+/* load is set to the wiring capacitance, and the interconnect	*/
+/* delay of each receiver is recorded.  The driver is modeled	*/
+/* as a resistance of DRIVER_RES, as rc2dly does.  Resistor	*/
+/* loops are broken arbitrarily.  Return the number of		*/
+/* receivers annotated.						*/
+/*--------------------------------------------------------------*/
+
+int
+rctree_annotate(rctree *tree, rcnodeptr root, netptr testnet)
+{
+    rcnodeptr *order, node;
+    rcedgeptr edge;
+    double wirecap = 0.0;
+    int i, numorder, numRxers = 0;
+
+    // List the nodes breadth-first from the driver, so that each
+    // node is listed after its parent.
+
+    order = (rcnodeptr *)arena_alloc(&tree->mem, tree->numnodes *
+		sizeof(rcnodeptr));
+    order[0] = root;
+    root->visited = 1;
+    numorder = 1;
+    for (i = 0; i < numorder; i++) {
+	node = order[i];
+	for (edge = node->edges; edge; edge = edge->next) {
+	    if (edge->node->visited) continue;
+	    edge->node->visited = 1;
+	    edge->node->parent = node;
+	    edge->node->res = edge->res;
+	    order[numorder++] = edge->node;
+	}
+    }
+
+    for (i = numorder - 1; i >= 0; i--) {
+	node = order[i];
+	node->down += node->cap + node->pincap;
+	if (node->parent != NULL) node->parent->down += node->down;
+    }
+
+    // Ohms times fF is 1e-3 ps
+
+    for (i = 0; i < numorder; i++) {
+	node = order[i];
+	if (node->parent == NULL)
+	    node->delay = DRIVER_RES * node->down * 1e-3;
+	else
+	    node->delay = node->parent->delay + node->res * node->down * 1e-3;
+    }
+
+    for (node = tree->nodes; node; node = node->next) {
+	wirecap += node->cap;
+	if (!node->visited) {
+	    if ((node->conn != NULL) || node->port)
+		fprintf(stderr, "ERROR: Net %s pin %s is not connected "
+			"to the driver\n", testnet->name,
+			(node->name) ? node->name : "(unnamed)");
+	    continue;
+	}
+	if (node == root) continue;
+	if (node->port)
+	    numRxers += delay_set_ports(testnet, node->delay);
+	else if ((node->conn != NULL) && (node->conn != testnet->driver)) {
+	    node->conn->icDelay = node->delay;
+	    numRxers++;
+	}
+    }
+
+    testnet->loadr = wirecap;
+    testnet->loadf = wirecap;
+    return numRxers;
+}
+
+/*--------------------------------------------------------------*/
+/* Set the connection and pin capacitance of RC tree node	*/
+/* "node" for pin "name" of net "testnet".  "name" is		*/
+/* "<instance><delim><pin>", "PIN<delim><port>", or the name of	*/
+/* a design port if "portdir" is not PORT_NONE.  "pincap" is	*/
+/* the pin capacitance in fF, or negative to take it from the	*/
+/* liberty file (or "out_load" for an output).  Return 1 if	*/
+/* the node is the driver of the net.				*/
+/*--------------------------------------------------------------*/
+
+int
+rctree_pin(rcnodeptr node, char *name, char delim, int portdir,
+	double pincap, netptr testnet, struct hashtable *Insthash,
+	double out_load)
+{
+    char *pinname;
+    int isdriver = 0;
+
+    pinname = strrchr(name, delim);
+    if ((portdir == PORT_NONE) && (pinname == name + 3) &&
+		!strncmp(name, "PIN", 3))
+	portdir = PORT_INOUT;
+
+    // A design port is the driver if the net has no driver in
+    // the netlist, which is a design input (the port direction
+    // in SPEF from rc2dly is not reliable)
+
+    if (portdir != PORT_NONE) {
+	if ((portdir != PORT_OUTPUT) && (testnet->driver == NULL))
+	    isdriver = 1;
+	else
+	    node->port = 1;
+	if (pincap < 0.0) pincap = (isdriver) ? 0.0 : out_load;
+    }
+    else {
+	if (pinname != NULL) *pinname = '\0';
+	node->conn = delay_inst_conn(testnet, name, (pinname) ? pinname + 1 :
+		NULL, Insthash);
+	if (pinname != NULL) *pinname = delim;
+	if (node->conn == NULL)
+	    fprintf(stderr, "ERROR: Pin %s of net %s not found in netlist\n",
+			name, testnet->name);
+	else if (node->conn == testnet->driver)
+	    isdriver = 1;
+	if (pincap < 0.0) {
+	    if ((node->conn == NULL) || isdriver || (node->conn->refpin == NULL))
+		pincap = 0.0;
+	    else
+		pincap = node->conn->refpin->capr;
+	}
+    }
+    node->pincap = pincap;
+    return isdriver;
+}
+
+/*--------------------------------------------------------------*/
+/* Read a qrouter RC file.  Each line describes one net:	*/
+/*								*/
+/*   <net> <ndrivers> <driver>... <nreceivers> <tree>		*/
+/*								*/
+/* where each node of <tree> is "( <R> <C> <items> )" (ohms,	*/
+/* pF) joined to the node enclosing it, and <items> are		*/
+/* receiver pins at the node and nodes below it, separated by	*/
+/* commas.  Pins are "<instance>/<pin>" or "PIN/<port>".	*/
+/* Delays are computed as by rc2dly.  If "updated" is not	*/
+/* NULL, each net read is also entered in hash table "updated".	*/
+/*--------------------------------------------------------------*/
+
+void
+rcRead(FILE *frc, struct hashtable *Nethash, struct hashtable *Insthash,
+	double out_load, struct hashtable *updated)
+{
+    char *line = NULL;
+    int linesize = 0;
+    char *token, *saveptr;
+    netptr testnet;
+    rctree tree;
+    rcnodeptr root, node, *stack = NULL;
+    int stacksize = 0, depth, ndrivers, numRxers;
+    double res;
 
-                   token = advancetoken(flib, 0);
-                   if (token == NULL) break;
-                   if (!strcmp(token, "(")) {
-                      token = advancetoken(flib, ')');
-                      if (token == NULL) break;
-                   }
-                   cap_unit = strtod(token, &metric);
-                   if (*metric != '\0') {
-                      while (isblank(*metric)) metric++;
-                      if (*metric == ',') metric++;
-                      while ((*metric != '\0') && isblank(*metric)) metric++;
-		      if (*metric == '\"') {
-			 char *qptr;
-			 metric++;
-			 qptr = metric;
-			 while ((*qptr != '\"') && (*qptr != '\0')) qptr++;
-			 *qptr = '\0';
-		      }
-                      if (!tokencasecmp(metric, "af"))
-                         cap_unit *= 1E-3;
-                      else if (!tokencasecmp(metric, "pf"))
-                         cap_unit *= 1000;
-                      else if (!tokencasecmp(metric, "nf"))
-                         cap_unit *= 1E6;
-                      else if (!tokencasecmp(metric, "uf"))
-                         cap_unit *= 1E9;
-                      else if (tokencasecmp(metric, "ff"))
-                         fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
-                                token);
-                   }
-                   else {
-                      token = advancetoken(flib, 0);
-                      if (token == NULL) break;
-                      if (!tokencasecmp(token, "af"))
-                         cap_unit *= 1E-3;
-                      else if (!tokencasecmp(token, "pf"))
-                         cap_unit *= 1000;
-                      else if (!tokencasecmp(token, "nf"))
-                         cap_unit *= 1E6;
-                      else if (!tokencasecmp(token, "uf"))
-                         cap_unit *= 1E9;
-                      else if (tokencasecmp(token, "ff"))
-                         fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
-                                token);
-                   }
-                   token = advancetoken(flib, ';');
-                }
-		else if (!strcasecmp(token, "bus_naming_style")) {
-		    token = advancetoken(flib, 0);
-		    if (token == NULL) break;
-		    if (!strcmp(token, ":")) {
-			token = advancetoken(flib, 0);
-			if (token == NULL) break;
-		    }
-		    if (!strcmp(token, "\"")) {
-			token = advancetoken(flib, '\"');
-			if (token == NULL) break;
+    rctree_init(&tree);
+
+    while (delay_getline(frc, &line, &linesize) != NULL) {
+	token = strtok_r(line, " \t\n", &saveptr);
+	if (token == NULL) continue;
+
+	testnet = delay_net_lookup(token, Nethash);
+	if (testnet == NULL) {
+	    fprintf(stderr, "ERROR: Net %s not found in hash table\n", token);
+	    continue;
+	}
+
+	// Only the first driver is used, as in rc2dly
+	token = strtok_r(NULL, " \t\n", &saveptr);
+	ndrivers = (token) ? atoi(token) : 0;
+	token = strtok_r(NULL, " \t\n", &saveptr);
+	if ((ndrivers < 1) || (token == NULL)) {
+	    fprintf(stderr, "ERROR: Driver not found for net %s\n", testnet->name);
+	    continue;
+	}
+	root = rctree_node(&tree, NULL);
+	rctree_pin(root, token, '/', PORT_NONE, 0.0, testnet, Insthash,
+		out_load);
+	while ((--ndrivers > 0) && (strtok_r(NULL, " \t\n", &saveptr) != NULL));
+	strtok_r(NULL, " \t\n", &saveptr);	/* Number of receivers */
+
+	depth = 0;
+	node = root;
+	while (1) {
+	    if (depth >= stacksize) {
+		stacksize = (stacksize == 0) ? 32 : (stacksize << 1);
+		stack = (rcnodeptr *)realloc(stack, stacksize * sizeof(rcnodeptr));
+	    }
+	    stack[depth] = node;
+
+	    token = strtok_r(NULL, " \t\n", &saveptr);
+	    if (token == NULL) break;
+
+	    if (!strcmp(token, "(")) {
+		token = strtok_r(NULL, " \t\n", &saveptr);
+		res = (token) ? strtod(token, NULL) : 0.0;
+		token = strtok_r(NULL, " \t\n", &saveptr);
+		node = rctree_node(&tree, NULL);
+		/* RC file capacitance is in pF */
+		node->cap = (token) ? strtod(token, NULL) * 1e3 : 0.0;
+		rctree_res(&tree, stack[depth], node, res);
+		depth++;
+	    }
+	    else if (!strcmp(token, ")")) {
+		if (depth == 0) break;
+		node = stack[--depth];
+	    }
+	    else if (strcmp(token, ",")) {
+		rcnodeptr rxnode = rctree_node(&tree, NULL);
+		if (!strncmp(token, "PIN/", 4))
+		    rctree_pin(rxnode, token, '/', PORT_OUTPUT, -1.0, testnet,
+				Insthash, out_load);
+		else if (rctree_pin(rxnode, token, '/', PORT_NONE, -1.0,
+				testnet, Insthash, out_load))
+		    rxnode->conn = NULL;
+		rctree_res(&tree, node, rxnode, 0.0);
+	    }
+	}
+	if ((depth != 0) || (token != NULL))
+	    fprintf(stderr, "ERROR: Net %s had unbalanced parentheses\n",
+			testnet->name);
+
+	numRxers = rctree_annotate(&tree, root, testnet);
+	delay_check_fanout(testnet, numRxers);
+	if (updated != NULL) HashPtrInstall(testnet->name, testnet, updated);
+	rctree_clear(&tree);
+    }
+    rctree_free(&tree);
+    free(stack);
+    free(line);
+}
+
+/*--------------------------------------------------------------*/
+/* Return the name "token" from a SPEF file with any name map	*/
+/* index ("*<n>") at its start replaced by the name it maps to,	*/
+/* and escape backslashes removed.  The result is in static	*/
+/* storage, valid until the next call.				*/
+/*--------------------------------------------------------------*/
+
+char *
+spef_name(char *token, struct hashtable *namemap, char delim)
+{
+    static char *name = NULL;
+    static int namesize = 0;
+    char *mapped, *rest, *sptr, *dptr;
+    int len;
+
+    mapped = NULL;
+    rest = token;
+    if (*token == '*') {
+	rest = strchr(token, delim);
+	if (rest != NULL) *rest = '\0';
+	mapped = (char *)HashLookup(token, namemap);
+	if (rest != NULL) *rest = delim;
+	if (mapped == NULL)
+	    rest = token;
+	else if (rest == NULL)
+	    rest = "";
+    }
+
+    len = strlen(rest) + ((mapped) ? strlen(mapped) : 0) + 1;
+    if (len > namesize) {
+	namesize = len;
+	name = (char *)realloc(name, namesize);
+    }
+    dptr = name;
+    if (mapped != NULL)
+	for (sptr = mapped; *sptr != '\0'; sptr++) {
+	    if ((*sptr == '\\') && (*(sptr + 1) != '\0')) sptr++;
+	    *dptr++ = *sptr;
+	}
+    for (sptr = rest; *sptr != '\0'; sptr++) {
+	if ((*sptr == '\\') && (*(sptr + 1) != '\0')) sptr++;
+	*dptr++ = *sptr;
+    }
+    *dptr = '\0';
+    return name;
+}
+
+/*--------------------------------------------------------------*/
+/* Read a SPEF file.  The RC network of each net (*D_NET) is	*/
+/* read, and the Elmore delay to each receiver computed from	*/
+/* it.  Pin capacitances are taken from "*L" if given, or else	*/
+/* from the liberty file.  Coupling capacitance is treated as	*/
+/* capacitance to ground.  Reduced nets (*R_NET) are skipped.	*/
+/* If "updated" is not NULL, each net read is also entered in	*/
+/* hash table "updated".					*/
+/*--------------------------------------------------------------*/
+
+#define SPEF_NONE	0	// Header or between nets
+#define SPEF_NAME_MAP	1	// *NAME_MAP
+#define SPEF_CONN	2	// *CONN of a net
+#define SPEF_CAP	3	// *CAP of a net
+#define SPEF_RES	4	// *RES of a net
+#define SPEF_SKIP	5	// Section or net to skip
+
+void
+spefRead(FILE *fspef, struct hashtable *Nethash, struct hashtable *Insthash,
+	double out_load, struct hashtable *updated)
+{
+    char *line = NULL;
+    int linesize = 0;
+    char *token, *saveptr, *tok[4];
+    struct hashtable namemap;
+    netptr testnet = NULL;
+    rctree tree;
+    rcnodeptr root = NULL, node;
+    char delim = ':';
+    double cunit = 1.0, runit = 1.0;
+    int section = SPEF_NONE;
+    int ntok, numRxers;
+    char *mapped;
+
+    InitializeHashTable(&namemap, LARGEHASHSIZE);
+    rctree_init(&tree);
+
+    while (delay_getline(fspef, &line, &linesize) != NULL) {
+	token = strtok_r(line, " \t\n", &saveptr);
+	if ((token == NULL) || !strncmp(token, "//", 2)) continue;
+
+	if ((*token == '*') && !isdigit(*(token + 1)) &&
+		!((section == SPEF_CONN) && (!strcmp(token, "*P") ||
+		!strcmp(token, "*I")))) {
+
+	    // Keywords
+
+	    if (!strcmp(token, "*NAME_MAP"))
+		section = SPEF_NAME_MAP;
+	    else if (!strcmp(token, "*DELIMITER")) {
+		token = strtok_r(NULL, " \t\n", &saveptr);
+		if (token != NULL) delim = *token;
+	    }
+	    else if (!strcmp(token, "*C_UNIT") || !strcmp(token, "*R_UNIT")) {
+		double scale;
+		char *units;
+
+		tok[0] = token;
+		token = strtok_r(NULL, " \t\n", &saveptr);
+		units = strtok_r(NULL, " \t\n", &saveptr);
+		if ((token == NULL) || (units == NULL)) continue;
+		scale = strtod(token, NULL);
+		if (!strcasecmp(units, "PF") || !strcasecmp(units, "KOHM"))
+		    scale *= 1e3;
+		else if (!strcasecmp(units, "NF"))
+		    scale *= 1e6;
+		else if (!strcasecmp(units, "UF"))
+		    scale *= 1e9;
+		else if (strcasecmp(units, "FF") && strcasecmp(units, "OHM"))
+		    fprintf(stderr, "ERROR: Unknown SPEF unit %s\n", units);
+		if (!strcmp(tok[0], "*C_UNIT"))
+		    cunit = scale;
+		else
+		    runit = scale;
+	    }
+	    else if (!strcmp(token, "*D_NET")) {
+		token = strtok_r(NULL, " \t\n", &saveptr);
+		if (token == NULL) continue;
+		testnet = delay_net_lookup(spef_name(token, &namemap, delim),
+				Nethash);
+		if (testnet == NULL) {
+		    fprintf(stderr, "ERROR: Net %s not found in hash table\n",
+				spef_name(token, &namemap, delim));
+		    section = SPEF_SKIP;
+		    continue;
+		}
+		root = NULL;
+		section = SPEF_NONE;
+	    }
+	    else if (!strcmp(token, "*CONN"))
+		section = (testnet) ? SPEF_CONN : SPEF_SKIP;
+	    else if (!strcmp(token, "*CAP"))
+		section = (testnet) ? SPEF_CAP : SPEF_SKIP;
+	    else if (!strcmp(token, "*RES"))
+		section = (testnet) ? SPEF_RES : SPEF_SKIP;
+	    else if (!strcmp(token, "*END")) {
+		if (testnet != NULL) {
+		    if (root == NULL)
+			fprintf(stderr, "ERROR: Driver not found for net %s\n",
+				testnet->name);
+		    else {
+			numRxers = rctree_annotate(&tree, root, testnet);
+			delay_check_fanout(testnet, numRxers);
+			if (updated != NULL)
+			    HashPtrInstall(testnet->name, testnet, updated);
 		    }
-		    free(busformat);
-		    busformat = tokendup(token);
-                    token = advancetoken(flib, ';');
 		}
-		else if (!strcasecmp(token, "type")) {
-		    newbus = (bus *)malloc(sizeof(bus));
-		    newbus->from = 0;
-		    newbus->to = 0;
-		    newbus->next = buses;
-		    buses = newbus;
+		rctree_clear(&tree);
+		testnet = NULL;
+		section = SPEF_NONE;
+	    }
+	    else if ((section == SPEF_NAME_MAP) || (testnet != NULL))
+		section = SPEF_SKIP;	/* *PORTS, *INDUC, etc. */
+	    else if (!strcmp(token, "*R_NET") || !strcmp(token, "*D_PNET") ||
+			!strcmp(token, "*R_PNET"))
+		section = SPEF_SKIP;
+	    continue;
+	}
 
-		    token = advancetoken(flib, 0);
-		    if (strcmp(token, "("))
-			fprintf(stderr, "Input missing open parenthesis.\n");
-		    else
-			token = advancetoken(flib, ')');
-		    newbus->name = tokendup(token);
-		    while (*token != '}') {
-			token = advancetoken(flib, 0);
-			if (!strcasecmp(token, "bit_from")) {
-			    token = advancetoken(flib, 0);
-			    token = advancetoken(flib, ';');
-			    sscanf(token, "%d", &newbus->from);
-			}
-			else if (!strcasecmp(token, "bit_to")) {
-			    token = advancetoken(flib, 0);
-			    token = advancetoken(flib, ';');
-			    sscanf(token, "%d", &newbus->to);
-			}
-			else if (!strcasecmp(token, "{")) {
-			    /* All entries are <name> : <value> */
-			    /* Ignore unhandled tokens.		*/
-			    token = advancetoken(flib, 0);
-			    token = advancetoken(flib, ';');
+	for (ntok = 0; (ntok < 4) && (token != NULL); ntok++) {
+	    tok[ntok] = token;
+	    token = strtok_r(NULL, " \t\n", &saveptr);
+	}
+
+	switch (section) {
+	    case SPEF_NAME_MAP:
+		if (ntok < 2) break;
+		mapped = (char *)HashLookup(tok[0], &namemap);
+		if (mapped != NULL) free(mapped);
+		HashPtrInstall(tok[0], strdup(tok[1]), &namemap);
+		break;
+
+	    case SPEF_CONN:
+		// *P <port> <dir> or *I <inst><delim><pin> <dir>,
+		// followed by optional *C, *L, *S, and *D values
+		if (ntok < 3) break;
+		{
+		    double pincap = -1.0;
+
+		    while (token != NULL) {
+			if (!strcmp(token, "*L")) {
+			    token = strtok_r(NULL, " \t\n", &saveptr);
+			    if (token != NULL)
+				pincap = strtod(token, NULL) * cunit;
 			}
+			if (token != NULL)
+			    token = strtok_r(NULL, " \t\n", &saveptr);
 		    }
+		    node = rctree_node(&tree, tok[1]);
+		    if (rctree_pin(node, spef_name(tok[1], &namemap, delim),
+				delim, (strcmp(tok[0], "*P")) ? PORT_NONE :
+				PORT_INOUT, pincap, testnet, Insthash, out_load))
+			root = node;
 		}
-                else {
-                    // For unhandled tokens, read in tokens.  If it is
-                    // a definition or function, read to end-of-line.  If
-                    // it is a block definition, read to end-of-block.
-                    while (1) {
-                        token = advancetoken(flib, 0);
-                        if (token == NULL) break;
-                        if (!strcmp(token, ";")) break;
-                        if (!strcmp(token, "\""))
-                            token = advancetoken(flib, '\"');
-                        if (!strcmp(token, "{")) {
-                            token = advancetoken(flib, '}');
-                            break;
-                        }
-                    }
-                }
-                break;
+		break;
+
+	    case SPEF_CAP:
+		// <id> <node> <cap> or <id> <node> <node2> <cap>
+		if (ntok < 3) break;
+		node = rctree_node(&tree, tok[1]);
+		node->cap += strtod(tok[ntok - 1], NULL) * cunit;
+		break;
+
+	    case SPEF_RES:
+		// <id> <node1> <node2> <res>
+		if (ntok < 4) break;
+		node = rctree_node(&tree, tok[1]);
+		rctree_res(&tree, node, rctree_node(&tree, tok[2]),
+				strtod(tok[3], NULL) * runit);
+		break;
+	}
+    }
+    if (testnet != NULL)
+	fprintf(stderr, "ERROR: Unexpected end-of-file while reading SPEF file.\n");
+
+    rctree_free(&tree);
+    mapped = (char *)HashFirst(&namemap);
+    while (mapped != NULL) {
+	free(mapped);
+	mapped = (char *)HashNext(&namemap);
+    }
+    HashKill(&namemap);
+    free(line);
+}
 
-            case CELLDEF:
+/*--------------------------------------------------------------*/
+/* Return the format of parasitics file "filename", by its	*/
+/* extension:  ".spef" for SPEF, ".rc" for a qrouter RC file,	*/
+/* otherwise a delay file.					*/
+/*--------------------------------------------------------------*/
 
-		if (debug == 2) fprintf(stdout, "CELLDEF: %s\n", token);
-                if (!strcmp(token, "}")) {
-                    section = LIBBLOCK;                 // End of cell def
-                }
-                else if (!strcasecmp(token, "pin") ||
-			 !strcasecmp(token, "bus")) {
-                    token = advancetoken(flib, 0);      // Open parens
-                    if (!strcmp(token, "("))
-                        token = advancetoken(flib, ')');        // Close parens
+int
+delay_file_format(char *filename)
+{
+    char *dotptr;
+
+    dotptr = strrchr(filename, '.');
+    if (dotptr != NULL) {
+	if (!strcasecmp(dotptr, ".spef")) return SPEF_FILE;
+	if (!strcmp(dotptr, ".rc")) return RC_FILE;
+    }
+    return DELAY_FILE;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the parasitics file "filename" (open as "fdly") in the	*/
+/* format given by its extension.				*/
+/*--------------------------------------------------------------*/
+
+void
+parasiticsRead(FILE *fdly, char *filename, struct hashtable *Nethash,
+	struct hashtable *Insthash, double out_load, struct hashtable *updated)
+{
+    switch (delay_file_format(filename)) {
+	case SPEF_FILE:
+	    spefRead(fdly, Nethash, Insthash, out_load, updated);
+	    break;
+	case RC_FILE:
+	    rcRead(fdly, Nethash, Insthash, out_load, updated);
+	    break;
+	default:
+	    delayRead(fdly, Nethash, Insthash, updated);
+	    break;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Print a path component                                       */
+/* (code contributed by Karl-Filip Faxen)			*/
+/*--------------------------------------------------------------*/
+
+void
+print_path_component(int netFWidth, int instFWidth, int pinFWidth, int recvFWidth, 
+                     btptr backtrace, FILE *file)
+{
+    // Return immediately if we have niether a driver or a receiver instance
+    if (backtrace->receiver->refnet->driver == NULL &&
+		backtrace->receiver->refinst == NULL) return;
+
+    fprintf(file, " %8.1f ps", backtrace->delay);
+    if (backtrace->receiver->refnet != NULL) {
+        netptr net = backtrace->receiver->refnet;
+        fprintf(file, "  %*s: ", netFWidth, net->name);
+        if (net->driver != NULL) {   // If the driver exists, it has a refinst
+            fprintf(file, "%*s/%*s",
+                    instFWidth, net->driver->refinst->name,
+                    -pinFWidth, net->driver->refpin->name);
+        }
+        else {
+            fprintf(file, "%*s", instFWidth + pinFWidth + 1, "");
+        }
+    }
+    fprintf(file, " -> ");
+    if (backtrace->receiver->refinst != NULL) {
+        fprintf(file, "%*s/%s",
+                recvFWidth, backtrace->receiver->refinst->name,
+                              backtrace->receiver->refpin->name);
+    }
+    else if (backtrace->receiver->refnet)
+        fprintf(file, "%s", backtrace->receiver->refnet->name);
+
+    fprintf(file, "\n");
+}
+
+/*--------------------------------------------------------------*/
+/* Print a path                                                 */
+/* (code contributed by Karl-Filip Faxen)			*/
+/*--------------------------------------------------------------*/
+
+void
+print_path(btptr backtrace, FILE *file)
+{
+    int netFWidth = 0;
+    int instFWidth = 0;
+    int pinFWidth = 0;
+    int recvFWidth = 0;
+    btptr curr = backtrace, prev = NULL;
+
+    // The back trace is last entry first, so we do one pointer reversal to
+    // get it in first entry first order, then we reverse it back again.
+
+    while (curr != NULL) {
+        // Find max length of net name, inst name and pin name
+        netptr net = curr->receiver->refnet;
+        if (net != NULL) {
+            int namelen = strlen(net->name);
+            if (namelen > netFWidth) netFWidth = namelen;
+            if (net->driver != NULL) { // If driver exists, it has an instance
+                int instlen = strlen(net->driver->refinst->name);
+                if (instlen > instFWidth) instFWidth = instlen;
+                int pinlen = strlen(net->driver->refpin->name);
+                if (pinlen > pinFWidth) pinFWidth = pinlen;
+            }
+        }
+        // Find max length of receiving inst name
+        if (curr->receiver->refinst != NULL) {
+            int instlen = strlen(curr->receiver->refinst->name);
+            if (instlen > recvFWidth) recvFWidth = instlen;
+        }
+        // Do the first pointer reversal
+        btptr tmp = curr->next;
+        curr->next = prev;
+        prev = curr;
+        curr = tmp;
+    }
 
-                    newpin = parse_pin(newcell, token);
-		    if (debug == 2) fprintf(stdout, "   pin = %s\n", token);
+    curr = prev;
+    prev = NULL;
 
-                    token = advancetoken(flib, 0);      // Find start of block
-                    if (strcmp(token, "{"))
-                        fprintf(stderr, "Error: failed to find start of block\n");
-                    section = PINDEF;
-                }
-                else if (!strcasecmp(token, "area")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    sscanf(token, "%lg", &newcell->area);
-                }
-                else if (!strcasecmp(token, "ff")) {
-                    newcell->type |= DFF;
-                    token = advancetoken(flib, '{');
-                    section = FLOPDEF;
-                }
-                else if (!strcasecmp(token, "latch")) {
-                    newcell->type |= LATCH;
-                    token = advancetoken(flib, '{');
-                    section = LATCHDEF;
-                }
-                else {
-                    // For unhandled tokens, read in tokens.  If it is
-                    // a definition or function, read to end-of-line.  If
-                    // it is a block definition, read to end-of-block.
-                    while (1) {
-                        token = advancetoken(flib, 0);
-                        if (token == NULL) break;
-                        if (!strcmp(token, ";")) break;
-                        if (!strcmp(token, "\""))
-                            token = advancetoken(flib, '\"');
-                        if (!strcmp(token, "("))
-                            token = advancetoken(flib, ')');
-                        if (!strcmp(token, "{")) {
-                            token = advancetoken(flib, '}');
-                            break;
-                        }
-                    }
-                }
-                break;
+    while (curr != NULL) {
+        print_path_component(netFWidth, instFWidth, pinFWidth, recvFWidth, curr, file);
+        // Do the second pointer reversal
+        btptr tmp = curr->next;
+        curr->next = prev;
+        prev = curr;
+        curr = tmp;
+    }
+    fprintf(file, "\n");
+}
 
-            case FLOPDEF:
+/*--------------------------------------------------------------*/
+/* Print the paths of report section "section" to "file".  The	*/
+/* "numpaths" paths in "orderedpaths" are in order of delay, and	*/
+/* at most "numreport" of them are printed.  Path details, skew,	*/
+/* and setup or hold are printed if "longform" is set.  Return	*/
+/* 1 if a path printed fails timing (negative slack against	*/
+/* clock period "period", or a negative minimum delay).		*/
+/*--------------------------------------------------------------*/
 
-		if (debug == 2) fprintf(stdout, "FLOPDEF: %s\n", token);
-                if (!strcmp(token, "}")) {
-                    section = CELLDEF;                  // End of flop def
-                }
-                else if (!strcasecmp(token, "next_state")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    newpin = parse_pin(newcell, token);
-                    newpin->type |= DFFIN;
-                }
-                else if (!strcasecmp(token, "clocked_on")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    if (strchr(token, '\'') != NULL)
-                        newcell->type |= CLK_SENSE_MASK;
-                    else if (strchr(token, '!') != NULL)
-                        newcell->type |= CLK_SENSE_MASK;
-                    newpin = parse_pin(newcell, token);
-                    newpin->type |= DFFCLK;
-                }
-                else if (!strcasecmp(token, "clear")) {
-                    newcell->type |= RST_MASK;
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    if (strchr(token, '\'') != NULL)
-                        newcell->type |= RST_SENSE_MASK;
-                    else if (strchr(token, '!') != NULL)
-                        newcell->type |= RST_SENSE_MASK;
-                    newpin = parse_pin(newcell, token);
-                    newpin->type |= DFFRST;
-                }
-                else if (!strcasecmp(token, "preset")) {
-                    newcell->type |= SET_MASK;
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    if (strchr(token, '\'') != NULL)
-                        newcell->type |= SET_SENSE_MASK;
-                    else if (strchr(token, '!') != NULL)
-                        newcell->type |= SET_SENSE_MASK;
-                    newpin = parse_pin(newcell, token);
-                    newpin->type |= DFFSET;
-                }
-                else
-                    token = advancetoken(flib, ';');    // Read to end-of-statement
+char
+print_paths(FILE *file, int section, ddataptr *orderedpaths, int numpaths,
+	int numreport, double period, int longform)
+{
+    ddataptr testddata;
+    btptr testbt;
+    connptr startconn, endconn;
+    double slack;
+    char badtiming = 0;
+    int i;
 
-                break;
+    fprintf(file, "\nTop %d %s delay paths:\n", (numpaths >= numreport) ?
+		numreport : numpaths, ((section == REG_MAX) ||
+		(section == PIN_MAX)) ? "maximum" : "minimum");
 
-            case LATCHDEF:
+    for (i = 0; ((i < numreport) && (i < numpaths)); i++) {
+        testddata = orderedpaths[i];
+        for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
+	startconn = testbt->receiver;
+	endconn = testddata->backtrace->receiver;
 
-		if (debug == 2) fprintf(stdout, "LATCHDEF: %s\n", token);
-                if (!strcmp(token, "}")) {
-                    section = CELLDEF;                  // End of flop def
-                }
-                else if (!strcasecmp(token, "data_in")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    newpin = parse_pin(newcell, token);
-                    newpin->type |= LATCHIN;
-                }
-                else if (!strcasecmp(token, "enable")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    if (strchr(token, '\'') != NULL)
-                        newcell->type |= EN_SENSE_MASK;
-                    else if (strchr(token, '!') != NULL)
-                        newcell->type |= EN_SENSE_MASK;
-                    newpin = parse_pin(newcell, token);
-                    newpin->type |= LATCHEN;
-                }
-                else
-                    token = advancetoken(flib, ';');    // Read to end-of-statement
+	if (startconn->refinst != NULL)
+	    fprintf(file, "Path %s/%s", startconn->refinst->name,
+			startconn->refpin->name);
+	else
+	    fprintf(file, "Path input pin %s", startconn->refnet->name);
+	if (endconn->refinst != NULL)
+	    fprintf(file, " to %s/%s", endconn->refinst->name,
+			endconn->refpin->name);
+	else
+	    fprintf(file, " to output pin %s", endconn->refnet->name);
+	fprintf(file, " delay %g ps", testddata->delay);
 
-                break;
+        if ((section == REG_MAX) && (period > 0.0)) {
+            slack = period - testddata->delay;
+            fprintf(file, "   Slack = %g ps", slack);
+            if (slack < 0.0) badtiming = 1;
+        }
+        fprintf(file, "\n");
+        if (longform) print_path(testddata->backtrace, file);
+
+	/* Print skew and setup or hold unless destination is a pin */
+        if (longform && (endconn->refinst != NULL)) {
+	    if ((section == REG_MAX) || (section == REG_MIN))
+		fprintf(file, "   clock skew at destination = %g\n", testddata->skew);
+	    fprintf(file, "   %s at destination = %g\n", ((section == REG_MAX) ||
+			(section == PIN_MAX)) ? "setup" : "hold", testddata->setup);
+	    fprintf(file, "\n");
+	}
 
-            case PINDEF:
+        if ((section == REG_MIN) && (testddata->delay < 0.0)) badtiming = 1;
+    }
+    return badtiming;
+}
 
-		if (debug == 2) fprintf(stdout, "PINDEF: %s\n", token);
-                if (!strcmp(token, "}")) {
-		    if (curbus != NULL)
-			expand_buses(newpin, curbus, busformat);
-		    curbus = NULL;
-                    section = CELLDEF;                  // End of pin def
-                }
-                else if (!strcasecmp(token, "capacitance")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    sscanf(token, "%lg", &newpin->capr);
-                    newpin->capr *= cap_unit;
-                }
-                else if (!strcasecmp(token, "rise_capacitance")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    sscanf(token, "%lg", &newpin->capr);
-                    newpin->capr *= cap_unit;
-                }
-                else if (!strcasecmp(token, "fall_capacitance")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    sscanf(token, "%lg", &newpin->capf);
-                    newpin->capf *= cap_unit;
-                }
-                else if (!strcasecmp(token, "function")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, 0);      // Open quote
-                    if (!strcmp(token, "\""))
-                        token = advancetoken(flib, '\"');       // Find function string
-                    if (newpin->type & OUTPUT) {
-                        newcell->function = tokendup(token);
-                    }
-                    token = advancetoken(flib, 0);
-                    if (strcmp(token, ";")) {
-                        if (!strcmp(token, "}"))
-                            section = CELLDEF;          // End of pin def
-                        else
-                            fprintf(stderr, "Expected end-of-statement.\n");
-                    }
-                }
-		else if (!strcasecmp(token, "bus_type")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');
-		    /* Find the bus definition */
-		    for (curbus = buses; curbus; curbus = curbus->next)
-			if (!tokencasecmp(token, curbus->name))
-			    break;
-		    if (curbus == NULL)
-			fprintf(stderr, "Failed to find a valid bus type \"%s\"\n",
-				token);
-		}
-                else if (!strcasecmp(token, "direction")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');
-                    if (!tokencasecmp(token, "input")) {
-                        newpin->type |= INPUT;
-                    }
-                    else if (!tokencasecmp(token, "output")) {
-                        newpin->type |= OUTPUT;
-                        if (newcell->type & DFF) newpin->type |= DFFOUT;
-                        if (newcell->type & LATCH) newpin->type |= LATCHOUT;
-                    }
-                }
-                else if (!strcasecmp(token, "max_transition")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    sscanf(token, "%lg", &newcell->maxtrans);
-                    newcell->maxtrans *= time_unit;
-                }
-                else if (!strcasecmp(token, "max_capacitance")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // To end-of-statement
-                    sscanf(token, "%lg", &newcell->maxcap);
-                    newcell->maxcap *= cap_unit;
-                }
-                else if (!strcasecmp(token, "timing")) {
-                    token = advancetoken(flib, 0);      // Arguments, if any
-                    if (strcmp(token, "("))
-                        fprintf(stderr, "Error: failed to find start of block\n");
-                    else
-                       token = advancetoken(flib, ')'); // Arguments, if any
-                    token = advancetoken(flib, 0);      // Find start of block
-                    if (strcmp(token, "{"))
-                        fprintf(stderr, "Error: failed to find start of block\n");
-                    testpin = &proxypin;    /* Placeholder */
-                    section = TIMING;
-                }
-                else {
-                    // For unhandled tokens, read in tokens.  If it is
-                    // a definition or function, read to end-of-line.  If
-                    // it is a block definition, read to end-of-block.
-                    while (1) {
-                        token = advancetoken(flib, 0);
-                        if (token == NULL) break;
-                        if (!strcmp(token, ";")) break;
-                        if (!strcmp(token, "\""))
-                            token = advancetoken(flib, '\"');
-                        if (!strcmp(token, "{")) {
-                            token = advancetoken(flib, '}');
-                            break;
-                        }
-                    }
-                }
-                break;
+/*--------------------------------------------------------------*/
+/* Print the result of report section "section" to "file",	*/
+/* after its paths.  "badtiming" is the result of print_paths(),	*/
+/* and "worstpath" the path of largest delay (or NULL).		*/
+/*--------------------------------------------------------------*/
+
+void
+print_paths_result(FILE *file, int section, char badtiming,
+	ddataptr worstpath, double period)
+{
+    if (section == REG_MAX) {
+	if (period > 0.0) {
+	    if (badtiming)
+		fprintf(file, "ERROR:  Design fails timing requirements.\n");
+	    else
+		fprintf(file, "Design meets timing requirements.\n");
+	}
+	else if (worstpath != NULL)
+	    fprintf(file, "Computed maximum clock frequency (zero margin) = %g MHz\n",
+			(1.0E6 / worstpath->delay));
+    }
+    else if (section == REG_MIN) {
+	if (badtiming)
+	    fprintf(file, "ERROR:  Design fails minimum hold timing.\n");
+	else
+	    fprintf(file, "Design meets minimum hold timing.\n");
+    }
+    fprintf(file, "-----------------------------------------\n\n");
+}
 
-            case TIMING:
+/*--------------------------------------------------------------*/
+/* Machine-readable report (option -r).  Each record is one	*/
+/* line, either a JSON object (JSON Lines) or a CSV row with	*/
+/* the columns of report_open().  Records are:			*/
+/*								*/
+/*   section	One per report section (JSON only), with the	*/
+/*		number of paths and the result			*/
+/*   path	One per reported path, in order of delay, with	*/
+/*		the path details if option -L is given (JSON	*/
+/*		only)						*/
+/*   endpoint	The worst path into each endpoint (option -a)	*/
+/*								*/
+/* "section" is "reg_to_reg" or "pin_to_reg" and "type" is	*/
+/* "max" or "min", as in the summary file names.  Delays are in	*/
+/* ps.  Slack is the clock period less the delay for maximum	*/
+/* delay (empty if no period was given), or the delay itself	*/
+/* for minimum delay.  "setup" is the setup time for maximum	*/
+/* delay and the hold time for minimum delay.  Each analysis	*/
+/* (see -u) is numbered, from 1.				*/
+/*--------------------------------------------------------------*/
 
-		if (debug == 2) fprintf(stdout, "TIMING: %s\n", token);
-                if (!strcmp(token, "}")) {
-                    section = PINDEF;                   // End of timing def
-                }
-                else if (!strcasecmp(token, "related_pin")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // Read to end of statement
-		    if (testpin != &proxypin) {
-			fprintf(stderr, "Error:  Record already created"
-				" for related_pin");
-			free(testpin);
-		    }
-                    // Create the related pin
-                    testpin = parse_pin(newcell, token);
-		    // Copy any records from the placeholder
-		    testpin->sense = proxypin.sense;
-                    testpin->propdelr = proxypin.propdelr;
-                    testpin->propdelf = proxypin.propdelf;
-                    testpin->transr = proxypin.transr;
-                    testpin->transf = proxypin.transf;
-		    // Reset the placeholder records
-		    proxypin.sense = SENSE_NONE;
-		    proxypin.propdelr = NULL;
-		    proxypin.propdelf = NULL;
-		    proxypin.transr = NULL;
-		    proxypin.transf = NULL;
-                }
-                else if (!strcasecmp(token, "timing_sense")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // Read to end of statement
-                    if (!tokencasecmp(token, "positive_unate"))
-                        testpin->sense = SENSE_POSITIVE;
-                    else if (!tokencasecmp(token, "negative_unate"))
-                        testpin->sense = SENSE_NEGATIVE;
-                    else if (!tokencasecmp(token, "non_unate"))
-                        testpin->sense = SENSE_NONE;
-                }
-                else if (!strcasecmp(token, "timing_type")) {
-                    token = advancetoken(flib, 0);      // Colon
-                    token = advancetoken(flib, ';');    // Read to end of statement
+/*--------------------------------------------------------------*/
+/* Open the report file "filename", in CSV format if it ends in	*/
+/* ".csv" and otherwise JSON Lines.  The format is returned in	*/
+/* "format".  Return NULL if the file cannot be opened.		*/
+/*--------------------------------------------------------------*/
 
-                    // Note:  Timing type is apparently redundant information;
-                    // e.g., "falling_edge" can be determined by "clocked_on : !CLK"
-                    // in the ff {} block.  How reliable is this?
+FILE *
+report_open(char *filename, int *format)
+{
+    FILE *freport;
+    char *dotptr;
 
-                    if (!tokencasecmp(token, "rising_edge"))
-                        timing_type = TIMING_PROP_TRANS;
-                    else if (!tokencasecmp(token, "falling_edge"))
-                        timing_type = TIMING_PROP_TRANS;
-                    else if (!tokencasecmp(token, "hold_rising"))
-                        timing_type = TIMING_HOLD;
-                    else if (!tokencasecmp(token, "hold_falling"))
-                        timing_type = TIMING_HOLD;
-                    else if (!tokencasecmp(token, "setup_rising"))
-                        timing_type = TIMING_SETUP;
-                    else if (!tokencasecmp(token, "setup_falling"))
-                        timing_type = TIMING_SETUP;
-                    else if (!tokencasecmp(token, "clear"))
-                        timing_type = TIMING_SET_RESET;
-                    else if (!tokencasecmp(token, "preset"))
-                        timing_type = TIMING_SET_RESET;
-                    else if (!tokencasecmp(token, "recovery_rising"))
-                        timing_type = TIMING_RECOVERY;
-                    else if (!tokencasecmp(token, "recovery_falling"))
-                        timing_type = TIMING_RECOVERY;
-                    else if (!tokencasecmp(token, "removal_rising"))
-                        timing_type = TIMING_REMOVAL;
-                    else if (!tokencasecmp(token, "removal_falling"))
-                        timing_type = TIMING_REMOVAL;
-                    else if (!tokencasecmp(token, "three_state_enable"))
-                        timing_type = TIMING_TRISTATE;
-                    else if (!tokencasecmp(token, "three_state_disable"))
-                        timing_type = TIMING_TRISTATE;
-                }
-                else if ((!strcasecmp(token, "cell_rise")) ||
-                        (!strcasecmp(token, "cell_fall")) ||
-                        (!strcasecmp(token, "rise_transition")) ||
-                        (!strcasecmp(token, "fall_transition")) ||
-                        (!strcasecmp(token, "rise_constraint")) ||
-                        (!strcasecmp(token, "fall_constraint"))) {
+    freport = fopen(filename, "w");
+    if (freport == NULL) return NULL;
 
-                    tableptr = (lutable *)malloc(sizeof(lutable));
-                    tableptr->name = NULL;      // Not used
-                    tableptr->invert = 0;
-                    tableptr->var1 = UNKNOWN;
-                    tableptr->var2 = UNKNOWN;
-                    tableptr->size1 = 0;
-                    tableptr->size2 = 0;
-                    tableptr->idx1.times = NULL;
-                    tableptr->idx2.caps = NULL;
-                    tableptr->values = NULL;
-                    tableptr->next = NULL;      // Not used
+    /* Reports of large designs are long;  write in large blocks */
+    setvbuf(freport, NULL, _IOFBF, 1 << 20);
 
-                    // Note that propagation delays (cell rise, cell fall) and
-                    // transition times (rise transition, fall transition) have
-                    // their lookup tables stored in the "related pin" pin record.
-                    // Setup and hold times (rise constraint, fall constraint)
-                    // have their lookup tables stored in the original pin record.
-                    // These should not overlap.
+    dotptr = strrchr(filename, '.');
+    if ((dotptr != NULL) && !strcasecmp(dotptr, ".csv")) {
+	*format = REPORT_CSV;
+	fprintf(freport, "analysis,record,section,type,rank,start,end,"
+		"delay,skew,setup,slack\n");
+    }
+    else
+	*format = REPORT_JSON;
+    return freport;
+}
 
-                    // Recovery and removal tables are not yet handled. . .
+/*--------------------------------------------------------------*/
+/* Write the string "name" (followed by "/" and "pinname" if	*/
+/* "pinname" is not NULL) to the report, quoted for the format.	*/
+/*--------------------------------------------------------------*/
 
-                    if (!strcasecmp(token, "cell_rise"))
-                        testpin->propdelr = tableptr;
-                    else if (!strcasecmp(token, "cell_fall"))
-                        testpin->propdelf = tableptr;
-                    else if (!strcasecmp(token, "rise_transition"))
-                        testpin->transr = tableptr;
-                    else if (!strcasecmp(token, "fall_transition"))
-                        testpin->transf = tableptr;
-                    else if (!strcasecmp(token, "rise_constraint")) {
-                        if (timing_type == TIMING_SETUP)
-                            newpin->propdelr = tableptr;
-                        else if (timing_type == TIMING_HOLD)
-                            newpin->transr = tableptr;
-                    }
-                    else if (!strcasecmp(token, "fall_constraint")) {
-                        if (timing_type == TIMING_SETUP)
-                            newpin->propdelf = tableptr;
-                        else if (timing_type == TIMING_HOLD)
-                            newpin->transf = tableptr;
-                    }
+void
+report_name(FILE *freport, int format, char *name, char *pinname)
+{
+    char *cptr;
+
+    fputc('\"', freport);
+    for (cptr = name; ; cptr++) {
+	if (*cptr == '\0') {
+	    if (pinname == NULL) break;
+	    fputc('/', freport);
+	    cptr = pinname;
+	    pinname = NULL;
+	    if (*cptr == '\0') break;
+	}
+	if (format == REPORT_CSV) {
+	    if (*cptr == '\"') fputc('\"', freport);
+	    fputc(*cptr, freport);
+	}
+	else if ((*cptr == '\"') || (*cptr == '\\'))
+	    fprintf(freport, "\\%c", *cptr);
+	else if ((unsigned char)*cptr < 0x20)
+	    fprintf(freport, "\\u%04x", (unsigned char)*cptr);
+	else
+	    fputc(*cptr, freport);
+    }
+    fputc('\"', freport);
+}
 
-                    token = advancetoken(flib, 0);      // Open parens
-                    if (!strcmp(token, "("))
-                        token = advancetoken(flib, ')');
+/*--------------------------------------------------------------*/
+/* Write the name of pin "conn" to the report:  <instance>/<pin>	*/
+/* or the name of a module input or output.			*/
+/*--------------------------------------------------------------*/
+
+void
+report_pin(FILE *freport, int format, connptr conn)
+{
+    if ((conn->refinst != NULL) && (conn->refpin != NULL))
+	report_name(freport, format, conn->refinst->name, conn->refpin->name);
+    else
+	report_name(freport, format, conn->refnet->name, NULL);
+}
+
+/*--------------------------------------------------------------*/
+/* Write a "path" or "endpoint" record for path "testddata".	*/
+/* "rank" is the position of the path in the report (from 1),	*/
+/* or 0 for an endpoint.  If "longform" is set, the JSON record	*/
+/* includes each point of the path.				*/
+/*--------------------------------------------------------------*/
+
+void
+report_path(FILE *freport, int format, int analysis, int section, int rank,
+	ddataptr testddata, double period, int longform)
+{
+    char *sectname, *type;
+    btptr testbt, *points;
+    int maxdelay, numpoints, i;
+
+    maxdelay = ((section == REG_MAX) || (section == PIN_MAX));
+    sectname = ((section == REG_MAX) || (section == REG_MIN)) ?
+		"reg_to_reg" : "pin_to_reg";
+    type = (maxdelay) ? "max" : "min";
+    for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
+
+    if (format == REPORT_CSV) {
+	fprintf(freport, "%d,%s,%s,%s,", analysis, (rank > 0) ? "path" :
+		"endpoint", sectname, type);
+	if (rank > 0) fprintf(freport, "%d", rank);
+	fputc(',', freport);
+	report_pin(freport, format, testbt->receiver);
+	fputc(',', freport);
+	report_pin(freport, format, testddata->backtrace->receiver);
+	fprintf(freport, ",%.9g,%.9g,%.9g,", testddata->delay, testddata->skew,
+		testddata->setup);
+	if (!maxdelay)
+	    fprintf(freport, "%.9g", testddata->delay);
+	else if (period > 0.0)
+	    fprintf(freport, "%.9g", period - testddata->delay);
+	fputc('\n', freport);
+	return;
+    }
+
+    fprintf(freport, "{\"analysis\":%d,\"record\":\"%s\",\"section\":\"%s\","
+		"\"type\":\"%s\",", analysis, (rank > 0) ? "path" : "endpoint",
+		sectname, type);
+    if (rank > 0) fprintf(freport, "\"rank\":%d,", rank);
+    fprintf(freport, "\"start\":");
+    report_pin(freport, format, testbt->receiver);
+    fprintf(freport, ",\"end\":");
+    report_pin(freport, format, testddata->backtrace->receiver);
+    fprintf(freport, ",\"delay\":%.9g,\"skew\":%.9g,\"%s\":%.9g",
+		testddata->delay, testddata->skew, (maxdelay) ? "setup" : "hold",
+		testddata->setup);
+    if (!maxdelay)
+	fprintf(freport, ",\"slack\":%.9g", testddata->delay);
+    else if (period > 0.0)
+	fprintf(freport, ",\"slack\":%.9g", period - testddata->delay);
+
+    if (longform && (rank > 0)) {
+	/* The backtrace is last point first */
+	numpoints = 0;
+	for (testbt = testddata->backtrace; testbt; testbt = testbt->next)
+	    numpoints++;
+	points = (btptr *)malloc(numpoints * sizeof(btptr));
+	i = numpoints;
+	for (testbt = testddata->backtrace; testbt; testbt = testbt->next)
+	    points[--i] = testbt;
+
+	fprintf(freport, ",\"points\":[");
+	for (i = 0; i < numpoints; i++) {
+	    testbt = points[i];
+	    fprintf(freport, "%s{\"pin\":", (i > 0) ? "," : "");
+	    report_pin(freport, format, testbt->receiver);
+	    if (testbt->receiver->refnet != NULL) {
+		fprintf(freport, ",\"net\":");
+		report_name(freport, format, testbt->receiver->refnet->name, NULL);
+	    }
+	    fprintf(freport, ",\"delay\":%.9g,\"trans\":%.9g,\"edge\":\"%s\"}",
+			testbt->delay, testbt->trans, (testbt->dir == FALLING) ?
+			"fall" : "rise");
+	}
+	fputc(']', freport);
+	free(points);
+    }
+    fprintf(freport, "}\n");
+}
+
+/*--------------------------------------------------------------*/
+/* Write the records of report section "section":  the section	*/
+/* record (JSON only), the first "numreport" of the "numpaths"	*/
+/* paths in "orderedpaths", and if "pathlist" is not NULL, the	*/
+/* worst path of "pathlist" into each endpoint.  "badtiming"	*/
+/* is the result of print_paths().				*/
+/*--------------------------------------------------------------*/
+
+void
+report_section(FILE *freport, int format, int analysis, int section,
+	ddataptr *orderedpaths, int numpaths, int numreport, ddataptr pathlist,
+	double period, int longform, char badtiming)
+{
+    ddataptr testddata, *worst;
+    int maxdelay, i, n;
+
+    maxdelay = ((section == REG_MAX) || (section == PIN_MAX));
+
+    if (format == REPORT_JSON) {
+	fprintf(freport, "{\"analysis\":%d,\"record\":\"section\","
+		"\"section\":\"%s\",\"type\":\"%s\",\"paths\":%d",
+		analysis, ((section == REG_MAX) || (section == REG_MIN)) ?
+		"reg_to_reg" : "pin_to_reg", (maxdelay) ? "max" : "min", numpaths);
+	if (((section == REG_MAX) && (period > 0.0)) || (section == REG_MIN))
+	    fprintf(freport, ",\"met\":%s", (badtiming) ? "false" : "true");
+	else if ((section == REG_MAX) && (numpaths > 0) && (orderedpaths[0] != NULL))
+	    fprintf(freport, ",\"fmax\":%.9g", 1.0E6 / orderedpaths[0]->delay);
+	fprintf(freport, "}\n");
+    }
+
+    for (i = 0; ((i < numreport) && (i < numpaths)); i++)
+	report_path(freport, format, analysis, section, i + 1, orderedpaths[i],
+		period, longform);
+
+    if (pathlist == NULL) return;
+
+    worst = (ddataptr *)calloc(numconnects, sizeof(ddataptr));
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	n = testddata->backtrace->receiver->index;
+	if (n < 0) continue;
+	if ((worst[n] == NULL) ||
+		(maxdelay && (testddata->delay > worst[n]->delay)) ||
+		(!maxdelay && (testddata->delay < worst[n]->delay)))
+	    worst[n] = testddata;
+    }
+    for (n = 0; n < numconnects; n++)
+	if (worst[n] != NULL)
+	    report_path(freport, format, analysis, section, 0, worst[n],
+			period, 0);
+    free(worst);
+}
+
+/*--------------------------------------------------------------*/
+/* Create the cache of clock chains used by find_clock_skews().	*/
+/* Connections must have been numbered.				*/
+/*--------------------------------------------------------------*/
+
+clockcacheptr
+create_clock_cache()
+{
+    clockcacheptr clocks;
+    int i;
+
+    clocks = (clockcacheptr)malloc(sizeof(clockcache));
+    clocks->chains = (chainptr *)calloc(numconnects, sizeof(chainptr));
+    clocks->checked = (unsigned char *)calloc(numconnects, sizeof(unsigned char));
+    clocks->markowner = (int *)malloc(numconnects * sizeof(int));
+    clocks->markpos = (int *)malloc(numconnects * sizeof(int));
+    for (i = 0; i < numconnects; i++) clocks->markowner[i] = -1;
+    return clocks;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the clock chain for the register clock pin "clkconn".	*/
+/* The chain is found by tracing back from the clock pin in the	*/
+/* same way as find_clock_source().  If the trace branches (a	*/
+/* gate with more than one input), or passes through a flop or	*/
+/* latch, then there is no chain and NULL is returned, and the	*/
+/* caller should use find_clock_source().			*/
+/*--------------------------------------------------------------*/
+
+chainptr
+get_clock_chain(clockcacheptr clocks, connptr clkconn)
+{
+    chainptr chain;
+    connptr testconn, driver;
+    instptr iupstream;
+    int n, i, k;
+
+    n = clkconn->index;
+    if (n < 0) return NULL;
+    if (clocks->checked[n]) return clocks->chains[n];
+    clocks->checked[n] = 1;
+
+    /* Count the length of the chain */
+
+    k = 1;
+    for (testconn = clkconn; ; k++) {
+	driver = testconn->refnet->driver;
+	if ((driver == NULL) || (driver->refinst == NULL)) break;
+	if (driver->refpin->type & (DFFOUT | LATCHOUT)) return NULL;
+	iupstream = driver->refinst;
+	if ((iupstream->in_connects == NULL) ||
+		(iupstream->in_connects->next != NULL))
+	    return NULL;
+	testconn = iupstream->in_connects;
+	if (testconn->index < 0) return NULL;
+	if (k > numconnects) return NULL;	/* Loop in the clock tree */
+    }
+
+    chain = (chainptr)malloc(sizeof(clockchain));
+    chain->length = k;
+    chain->conns = (connptr *)malloc(k * sizeof(connptr));
+    for (i = 0; i < 2; i++) {
+	chain->launch[i] = NULL;
+	chain->capture[i] = NULL;
+	chain->captrans[i] = NULL;
+	chain->capdone[i] = NULL;
+    }
+
+    testconn = clkconn;
+    for (i = k - 1; i >= 0; i--) {
+	chain->conns[i] = testconn;
+	if (i > 0) testconn = testconn->refnet->driver->refinst->in_connects;
+    }
+
+    clocks->chains[n] = chain;
+    return chain;
+}
+
+/*--------------------------------------------------------------*/
+/* Compute the clock arrival at each connection of "chain",	*/
+/* starting from connection "start" with zero delay and zero	*/
+/* transition time.  This builds the same backtrace that	*/
+/* find_clock_source() would, and runs find_clock_delay() on	*/
+/* it, so the results are identical.  Delay and transition	*/
+/* times are returned in "delays" and "trans" (either may be	*/
+/* NULL), indexed by position in the chain.			*/
+/*--------------------------------------------------------------*/
+
+void
+chain_clock_delay(chainptr chain, int start, char minmax, unsigned char mode,
+		double *delays, double *trans)
+{
+    btptr records;
+    int i;
+
+    records = (btptr)malloc(chain->length * sizeof(btdata));
+    for (i = start; i < chain->length; i++) {
+	records[i].delay = INITVAL;
+	records[i].trans = 0.0;
+	records[i].dir = RISING;
+	records[i].refcnt = 1;
+	records[i].receiver = chain->conns[i];
+	records[i].next = (i < chain->length - 1) ? &records[i + 1] : NULL;
+    }
+
+    find_clock_delay(RISING, 0.0, 0.0, &records[start],
+		chain->conns[chain->length - 1], minmax, mode);
+    find_clock_delay(FALLING, 0.0, 0.0, &records[start],
+		chain->conns[chain->length - 1], minmax, mode);
+
+    for (i = start; i < chain->length; i++) {
+	if (delays) delays[i] = records[i].delay;
+	if (trans) trans[i] = records[i].trans;
+    }
+    free(records);
+}
+
+/*--------------------------------------------------------------*/
+/* Return the launch clock arrival times along "chain", which	*/
+/* are computed on first use.					*/
+/*--------------------------------------------------------------*/
+
+double *
+chain_launch_delays(chainptr chain, char minmax)
+{
+    int mm = (minmax == MAXIMUM_TIME) ? 1 : 0;
+
+    if (chain->launch[mm] == NULL) {
+	chain->launch[mm] = (double *)malloc(chain->length * sizeof(double));
+	chain_clock_delay(chain, 0, minmax, (unsigned char)1, chain->launch[mm], NULL);
+    }
+    return chain->launch[mm];
+}
+
+/*--------------------------------------------------------------*/
+/* Return the capture clock arrival at the clock pin of "chain"	*/
+/* relative to the common clock point at position "pos" of the	*/
+/* chain, and the transition time in "trans".  Computed on	*/
+/* first use.  As in find_clock_skews(), the capture side is	*/
+/* computed with the sense of "minmax" inverted.		*/
+/*--------------------------------------------------------------*/
+
+double
+chain_capture_delay(chainptr chain, int pos, char minmax, double *trans)
+{
+    int mm = (minmax == MAXIMUM_TIME) ? 1 : 0;
+    double *delays, *transes;
+
+    if (chain->capture[mm] == NULL) {
+	chain->capture[mm] = (double *)malloc(chain->length * sizeof(double));
+	chain->captrans[mm] = (double *)malloc(chain->length * sizeof(double));
+	chain->capdone[mm] = (unsigned char *)calloc(chain->length,
+			sizeof(unsigned char));
+    }
+    if (!chain->capdone[mm][pos]) {
+	delays = (double *)malloc(chain->length * sizeof(double));
+	transes = (double *)malloc(chain->length * sizeof(double));
+	chain_clock_delay(chain, pos, ~minmax, (unsigned char)2, delays, transes);
+	chain->capture[mm][pos] = delays[chain->length - 1];
+	chain->captrans[mm][pos] = transes[chain->length - 1];
+	chain->capdone[mm][pos] = 1;
+	free(delays);
+	free(transes);
+    }
+    *trans = chain->captrans[mm][pos];
+    return chain->capture[mm][pos];
+}
+
+/*--------------------------------------------------------------*/
+/* Mark the connections of the launch clock chain "chain" so	*/
+/* that the common point with a capture chain can be found.	*/
+/* Marks from any other chain are overwritten, so only the	*/
+/* most recently marked chain is valid.				*/
+/*--------------------------------------------------------------*/
+
+void
+mark_clock_chain(clockcacheptr clocks, chainptr chain)
+{
+    int i, owner;
+
+    owner = chain->conns[chain->length - 1]->index;
+    for (i = 0; i < chain->length; i++) {
+	clocks->markowner[chain->conns[i]->index] = owner;
+	clocks->markpos[chain->conns[i]->index] = i;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Discard the cached clock arrivals of every clock chain that	*/
+/* passes through a connection marked in "dirty" (indexed by	*/
+/* connection number), so that they are recomputed on next use.	*/
+/*--------------------------------------------------------------*/
+
+void
+invalidate_clock_chains(clockcacheptr clocks, unsigned char *dirty)
+{
+    chainptr chain;
+    int n, i;
+
+    for (n = 0; n < numconnects; n++) {
+	chain = clocks->chains[n];
+	if (chain == NULL) continue;
+	for (i = 0; i < chain->length; i++)
+	    if (dirty[chain->conns[i]->index]) break;
+	if (i == chain->length) continue;
+	for (i = 0; i < 2; i++) {
+	    if (chain->launch[i]) free(chain->launch[i]);
+	    if (chain->capture[i]) free(chain->capture[i]);
+	    if (chain->captrans[i]) free(chain->captrans[i]);
+	    if (chain->capdone[i]) free(chain->capdone[i]);
+	    chain->launch[i] = NULL;
+	    chain->capture[i] = NULL;
+	    chain->captrans[i] = NULL;
+	    chain->capdone[i] = NULL;
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Given a list of paths, find the clock at the source and the	*/
+/* destination (if neither is a pin), and compute the clock	*/
+/* skew between them.  Also compute the setup or hold at the	*/
+/* destination.	 Save these values in the path record.		*/
+/*								*/
+/* If "clocks" is non-NULL, then clocks that are simple chains	*/
+/* are taken from the cache instead of being traced again for	*/
+/* each path.							*/
+/*--------------------------------------------------------------*/
+
+void
+find_clock_skews(ddataptr pathlist, char minmax, clockcacheptr clocks)
+{
+    connptr testconn, thisconn;
+    instptr  testinst;
 
-                    for (reftable = *tablelist; reftable; reftable = reftable->next)
-                        if (!tokencasecmp(token, reftable->name))
-                            break;
-                    if (reftable == NULL)
-                        fprintf(stderr, "Failed to find a valid table \"%s\"\n",
-                                token);
-                    else {
-                        // Fill in default values from template reftable
-                        tableptr->invert = reftable->invert;
-                        if (reftable->size1 > 0) {
-                            tableptr->var1 = reftable->var1;
-                            tableptr->size1 = reftable->size1;
-                            tableptr->idx1.times = (double *)malloc(tableptr->size1 * sizeof(double));
-                            memcpy(tableptr->idx1.times, reftable->idx1.times,
-                                                tableptr->size1 * sizeof(double));
-                        }
-                        if (reftable->size2 > 0) {
-                            tableptr->var2 = reftable->var2;
-                            tableptr->size2 = reftable->size2;
-                            tableptr->idx2.caps = (double *)malloc(tableptr->size2 * sizeof(double));
-                            memcpy(tableptr->idx2.caps, reftable->idx2.caps,
-                                                tableptr->size2 * sizeof(double));
-                        }
-                    }
+    ddataptr testddata, srcddata, freeddata;
+    ddataptr clocklist, clock2list;
+    btptr    backtrace, freebt, pathbt, btcommon;
+    btptr    selectedsource, selecteddest;
+    btdata   srcrec, destrec, commonrec;
+    chainptr srcchain, destchain, lastmarked;
+    double   *launch;
 
-                    token = advancetoken(flib, 0);
-                    if (strcmp(token, "{"))
-                        fprintf(stderr, "Failed to find start of timing block\n");
+    short srcdir, destdir;		// Signal direction in/out
+    double setupdelay, holddelay;
+    unsigned char result, usecache;
+    char	clk_invert, clk_sense_inv;
+    int      pos, common, owner;
 
-                    while (*token != '}') {
-                        token = advancetoken(flib, 0);
-                        if (!tokencasecmp(token, "index_1")) {
-			    char dnum = ',';
+    clocklist = NULL;
+    clock2list = NULL;
+    lastmarked = NULL;
+    
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
 
-                            // Local index values override those in the template
+        // Find the end of the linked list, which is the path start.
+        for (pathbt = testddata->backtrace; pathbt->next; pathbt = pathbt->next);
+	thisconn = pathbt->receiver;
 
-                            token = advancetoken(flib, 0);      // Open parens
-                            token = advancetoken(flib, 0);      // Quote
-                            if (!strcmp(token, "\""))
-                                token = advancetoken(flib, '\"');
+	// Use the clock chain cache if both clocks are simple chains.
+	// Registers with no clock pin are left to the code below.
+
+	usecache = 0;
+	srcchain = destchain = NULL;
+	if (clocks && (clocklist == NULL) && (clock2list == NULL)) {
+	    testinst = testddata->backtrace->receiver->refinst;
+	    testconn = (testinst) ? find_register_clock(testinst) : NULL;
+	    if (thisconn && thisconn->refpin)
+		srcchain = get_clock_chain(clocks, thisconn);
+	    if (testconn)
+		destchain = get_clock_chain(clocks, testconn);
+	    if ((srcchain != NULL) || !(thisconn && thisconn->refpin)) {
+		if (testinst == NULL)
+		    usecache = 1;
+		else if (destchain != NULL)
+		    usecache = 1;
+	    }
+	}
 
-                            iptr = token;
+        if (!usecache && thisconn && thisconn->refpin) {
+            // Find the sources of the clock at the path start.  Create
+	    // a tree of backtraces from thisconn to all clock sources,
+	    // and return clocklist, which is a list of the sources.
 
-			    // Check if table is space or comma separated
-			    if (strchr(iptr, dnum) == NULL)
-				if (strchr(iptr, ' ') != NULL)
-				    dnum = ' ';
+            find_clock_source(thisconn, &clocklist, NULL, srcdir, (unsigned char)1);
 
-                            //-------------------------
+            // Calculate the worst-case transition times to testlink on
+	    // each clocklist backtrace.
 
-                            if (reftable && (reftable->invert == 1)) {
-                                // Entries had better match the ref table
-                                i = 0;
-                                sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
-                                if (tableptr->var2 == OUTPUT_CAP)
-                                    tableptr->idx2.caps[0] *= cap_unit;
-                                else
-                                    tableptr->idx2.cons[0] *= time_unit;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    i++;
-                                    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
-                                    if (tableptr->var2 == OUTPUT_CAP)
-                                        tableptr->idx2.caps[i] *= cap_unit;
-                                    else
-                                        tableptr->idx2.cons[i] *= time_unit;
-                                }
-                            }
-                            else if (reftable && (reftable->invert == 0)) {
-                                iptr = token;
-                                i = 0;
-                                sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
-                                tableptr->idx1.times[0] *= time_unit;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    i++;
-                                    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
-                                    tableptr->idx1.times[i] *= time_unit;
-                                }
-                            }
+            find_clock_transition(clocklist, thisconn, srcdir, minmax,
+			(unsigned char)1);
+	}
 
-                            token = advancetoken(flib, ')');    // Close paren
-                            token = advancetoken(flib, ';');    // EOL semicolon
-                        }
-                        else if (!tokencasecmp(token, "index_2")) {
-			    char dnum = ',';
+        // Copy last backtrace delay to testddata.
+        testddata->delay = testddata->backtrace->delay;
+        testddata->trans = testddata->backtrace->trans;
+        testinst = testddata->backtrace->receiver->refinst;
+        selecteddest = selectedsource = NULL;
 
-                            // Local index values override those in the template
+        if (testinst != NULL) {
+            // Find the sources of the clock at the path end
+            destdir = (testinst->refcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
+            testconn = find_register_clock(testinst);
+            // If testconn is NULL, this is not a register (latch, maybe?)
+            if (testconn == NULL) continue;
 
-                            token = advancetoken(flib, 0);      // Open parens
-                            token = advancetoken(flib, 0);      // Quote
-                            if (!strcmp(token, "\""))
-                                token = advancetoken(flib, '\"');
+	    if (usecache) {
+		if (srcchain) {
+		    // Find the common point by walking back from the
+		    // destination clock to the first connection on the
+		    // source clock chain.
 
-                            iptr = token;
+		    launch = chain_launch_delays(srcchain, minmax);
+		    if (srcchain != lastmarked) {
+			mark_clock_chain(clocks, srcchain);
+			lastmarked = srcchain;
+		    }
+		    owner = thisconn->index;
+		    for (pos = destchain->length - 1; pos >= 0; pos--)
+			if (clocks->markowner[destchain->conns[pos]->index] == owner)
+			    break;
+		    if (pos >= 0)
+			common = clocks->markpos[destchain->conns[pos]->index];
+		    else {
+			pos = 0;
+			common = -1;
+			if (srcchain->conns[0]->refnet != destchain->conns[0]->refnet) {
+			    if (verbose > 1) {
+				fflush(stdout);
+				fprintf(stderr, "Independent clock nets \"%s\" and \"%s\""
+					" drive related gates!\n",
+					testconn->refnet->name,
+					thisconn->refnet->name);
+			    }
+			    clk_invert = -1;
+			}
+		    }
 
-			    // Check if table is space or comma separated
-			    if (strchr(iptr, dnum) == NULL)
-				if (strchr(iptr, ' ') != NULL)
-				    dnum = ' ';
+		    srcrec.receiver = thisconn;
+		    srcrec.delay = launch[srcchain->length - 1];
+		    destrec.receiver = testconn;
+		    destrec.delay = chain_capture_delay(destchain, pos, minmax,
+				&destrec.trans);
+		    if (common >= 0) {
+			commonrec.receiver = srcchain->conns[common];
+			commonrec.delay = launch[common];
+			btcommon = &commonrec;
+		    }
+		    else
+			btcommon = NULL;
 
-                            //-------------------------
+		    selectedsource = &srcrec;
+		    selecteddest = &destrec;
+		    testddata->skew = selectedsource->delay - selecteddest->delay -
+					((btcommon) ? btcommon->delay : 0.0);
+		    testddata->delay += testddata->skew;
+		}
+		else {
+		    // Path starts at an input;  only the destination clock
+		    // is needed, and its transition time is not computed.
+		    destrec.receiver = testconn;
+		    destrec.delay = INITVAL;
+		    destrec.trans = 0.0;
+		    selecteddest = &destrec;
+		    testddata->skew = 0.0;
+		}
+	    }
+	    else {
+		// Find the connection that is common to both clocks
+		result = find_clock_source(testconn, &clock2list, NULL, destdir,
+			    (unsigned char)2);
+
+		if ((result == (unsigned char)0) && (clocklist != NULL)) {
+		    // If both paths end on the same input net, then there
+		    // is no connection pointer, so deal with that separately.
+
+		    if (clocklist->backtrace->receiver->refnet !=
+				    clock2list->backtrace->receiver->refnet) {
+
+			// Warn about asynchronous clock sources
+			if (verbose > 1) {
+			    fflush(stdout);
+			    fprintf(stderr, "Independent clock nets \"%s\" and \"%s\""
+					    " drive related gates!\n",
+					    testconn->refnet->name,
+					    thisconn->refnet->name);
+			}
+			clk_invert = -1;
+		    }
+		}
 
-                            if (reftable && (reftable->invert == 1)) {
-                                // Entries had better match the ref table
-                                i = 0;
-                                sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
-                                tableptr->idx1.times[0] *= time_unit;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    i++;
-                                    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
-                                    tableptr->idx1.times[i] *= time_unit;
-                                }
-                            }
-                            else if (reftable && (reftable->invert == 0)) {
-                                iptr = token;
-                                i = 0;
-                                sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
-                                tableptr->idx2.caps[0] *= cap_unit;
-                                while ((iptr = strchr(iptr, dnum)) != NULL) {
-                                    iptr++;
-                                    i++;
-                                    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
-                                    tableptr->idx2.caps[i] *= cap_unit;
-                                }
-                            }
+		// If clocklist is NULL then this is an input and there is
+		// no way to compute relative to a common clock, because
+		// there is no common clock.
+
+		if (clocklist != NULL) {
+		    // Find clock arrival times from common clock point.  Note that
+		    // the check is opposite to what is computed for the source;  if
+		    // maximum time was used to find clock-to-source, then minimum
+		    // time is used to find clock-to-destination.
+
+		    btcommon = find_common_clock(clock2list, clocklist);
+		    find_clock_transition(clock2list, testconn,
+				    (btcommon) ? btcommon->dir : RISING,
+				    ~minmax, (unsigned char)2);
+
+		    // selectedsource is the end of the btcommon backtrace
+		    for (selectedsource = (btcommon) ? btcommon : clocklist->backtrace;
+				    selectedsource->next;
+				    selectedsource = selectedsource->next);
+		    // selecteddest is the end of the clock2list backtrace
+		    for (selecteddest = clock2list->backtrace; selecteddest->next;
+				    selecteddest = selecteddest->next);
+
+		    // Add or subtract difference in arrival times between source and
+		    // destination clocks
+
+		    testddata->skew = selectedsource->delay - selecteddest->delay -
+					    ((btcommon) ? btcommon->delay : 0.0);
+		    testddata->delay += testddata->skew;
+		}
+		else if (clock2list) {
+		    // Still need to know destination's clock source to
+		    // calculate setup or hold time.
+		    for (selecteddest = clock2list->backtrace; selecteddest->next;
+				    selecteddest = selecteddest->next);
+		    testddata->skew = 0.0;
+		}
+	    }
 
-                            token = advancetoken(flib, ')');    // Close paren
-                            token = advancetoken(flib, ';');    // EOL semicolon
-                        }
-                        else if (!tokencasecmp(token, "values")) {
-                            token = advancetoken(flib, 0);
-                            if (strcmp(token, "("))
-                                fprintf(stderr, "Failed to find start of"
-                                                " value table\n");
-                            token = advancetoken(flib, ')');
+            if (minmax == MAXIMUM_TIME) {
+                // Add setup time for destination clocks
+                setupdelay = calc_setup_time(testddata->trans,
+                                        testddata->backtrace->receiver->refpin,
+                                        selecteddest->trans,
+                                        testddata->backtrace->dir, minmax);
+                testddata->setup = setupdelay;
+            }
+            else {
+                // Subtract hold time for destination clocks (note that hold times
+		// are defined as typically negative values in the liberty format)
+                holddelay = calc_hold_time(testddata->trans,
+                                        testddata->backtrace->receiver->refpin,
+                                        selecteddest->trans,
+                                        testddata->backtrace->dir, minmax);
+                testddata->setup = holddelay;
+            }
+            testddata->delay += testddata->setup;
 
-                            // Parse the string of values and enter it into the
-                            // table "values", which is size size2 x size1
+            if (verbose > 1)
+                fprintf(stdout, "Path terminated on flop \"%s\" input with max delay %g ps\n",
+                                testconn->refinst->name, testddata->delay);
 
-                            if (reftable && reftable->size1 > 0) {
-                                int locsize2;
-                                locsize2 = (reftable->size2 > 0) ? reftable->size2 : 1;
-                                if (reftable->invert) {
-                                    tableptr->values = (double *)malloc(locsize2 *
-                                                reftable->size1 * sizeof(double));
-                                    iptr = token;
-                                    for (i = 0; i < reftable->size1; i++) {
-                                        for (j = 0; j < locsize2; j++) {
-                                            while (*iptr == ' ' || *iptr == '\"' ||
-                                                        *iptr == ',' || *iptr == '\\')
-                                                iptr++;
-                                            sscanf(iptr, "%lg", &gval);
-                                            *(tableptr->values + j * reftable->size1
-                                                        + i) = gval * time_unit;
-                                            while (*iptr != ' ' && *iptr != '\"' &&
-                                                        *iptr != ',' || *iptr == '\\')
-                                                iptr++;
-                                        }
-                                    }
-                                }
-                                else {
-                                    tableptr->values = (double *)malloc(locsize2 *
-                                                reftable->size1 * sizeof(double));
-                                    iptr = token;
-                                    for (j = 0; j < locsize2; j++) {
-                                        for (i = 0; i < reftable->size1; i++) {
-                                            while (*iptr == ' ' || *iptr == '\"' ||
-                                                        *iptr == ',' || *iptr == '\\')
-                                                iptr++;
-                                            sscanf(iptr, "%lg", &gval);
-                                            *(tableptr->values + j * reftable->size1
-                                                        + i) = gval * time_unit;
-                                            while (*iptr != ' ' && *iptr != '\"' &&
-                                                        *iptr != ',' || *iptr == '\\')
-                                                iptr++;
-                                        }
-                                    }
-                                }
-                            }
+            for (backtrace = testddata->backtrace; backtrace->next;
+                                backtrace = backtrace->next) {
+                if (verbose > 1)
+                    fprintf(stdout, "   %g (%s) %s/%s -> %s/%s\n",
+                                backtrace->delay,
+                                backtrace->receiver->refnet->name,
+                                backtrace->receiver->refnet->driver->refinst->name,
+                                backtrace->receiver->refnet->driver->refpin->name,
+                                backtrace->receiver->refinst->name,
+                                backtrace->receiver->refpin->name);
+            }
+            if (verbose > 1)
+                fprintf(stdout, "   000.000 (%s) %s/%s -> %s/%s\n",
+                                backtrace->receiver->refnet->name,
+                                backtrace->receiver->refinst->name,
+                                backtrace->receiver->refpin->name,
+                                backtrace->receiver->refinst->name,
+                                backtrace->receiver->refinst->out_connects->refpin->name);
 
-                            token = advancetoken(flib, 0);
-                            if (strcmp(token, ";"))
-                                fprintf(stderr, "Failed to find end of value table\n");
-			}
-                        else if (!tokencasecmp(token, "ecsm_waveform")) {
-			    /* Not handled:  this takes the form of index_1 */
-			    /* key : value or index_2 key : value and	    */
-			    /* values key : value.			    */
-			    token = advancetoken(flib, 0);	// Open parens
-			    token = advancetoken(flib, ')');	// Close parens
-			    token = advancetoken(flib, '{');	// Open brace
-			    token = advancetoken(flib, '}');	// Close brace
-			}
-                        else if (!tokencasecmp(token, "ecsm_capacitance")) {
-			    /* Not handled:  this takes the form of index_1 */
-			    /* key : value or index_2 key : value and	    */
-			    /* values key : value.			    */
-			    token = advancetoken(flib, 0);	// Open parens
-			    token = advancetoken(flib, ')');	// Close parens
-			    token = advancetoken(flib, '{');	// Open brace
-			    token = advancetoken(flib, '}');	// Close brace
-			}
-                        else if (strcmp(token, "{") && strcmp(token, "}")) {
-			    fprintf(stderr, "Unhandled feature %s at line %d\n",
-					token, fileCurrentLine);
-                            token = advancetoken(flib, 0);
-			    if (!strcmp(token, "(")) {		 // Open parens
-				token = advancetoken(flib, ')'); // Close parens
-				token = advancetoken(flib, 0);
-			    }
-			    if (!strcmp(token, "{"))		 // Open brace
-				token = advancetoken(flib, '}'); // Close brace
-			}
+            if (selecteddest != NULL && selectedsource != NULL) {
+                if (verbose > 1) {
+                    if (selectedsource->receiver->refnet != selecteddest->receiver->refnet) {
+                        fprintf(stdout, "   %g %s to %s clock skew\n",
+                                selecteddest->delay - selectedsource->delay
+				+ ((btcommon) ? btcommon->delay : 0.0),
+                                selectedsource->receiver->refnet->name,
+                                selecteddest->receiver->refnet->name);
                     }
                 }
-                else {
-                    // For unhandled tokens, read in tokens.  If it is
-                    // a definition or function, read to end-of-line.  If
-                    // it is a block definition, read to end-of-block.
-                    while (1) {
-                        token = advancetoken(flib, 0);
-                        if (token == NULL) break;
-                        if (!strcmp(token, ";")) break;
-                        if (!strcmp(token, "\""))
-                            token = advancetoken(flib, '\"');
-                        if (!strcmp(token, "{")) {
-                            token = advancetoken(flib, '}');
-                            break;
-                        }
-                    }
+
+                /* Check if the flops have the same clock sense */
+                /* (both are clock rising edge or both are clock falling edge type) */
+
+		if (backtrace->receiver->refinst == NULL)
+		    clk_sense_inv = 1;
+                else if ((testinst->refcell->type & CLK_SENSE_MASK) !=
+                                        (backtrace->receiver->refinst->refcell->type
+                                        & CLK_SENSE_MASK))
+                    clk_sense_inv = 1;
+                else
+                    clk_sense_inv = 0;
+
+                /* If the two flops don't clock at the same time, then issue a  */
+                /* warning that the slack time loses half a clock period.       */
+
+                if ((verbose > 1) && (clk_invert != -1) && (clk_sense_inv != clk_invert)) {
+                    fprintf(stdout, "   Clocks are inverted relative to one another,\n");
+                    fprintf(stdout, "   implying a maximum propagation delay of 1/2 period.\n");
                 }
-                break;
+            }
+            if (thisconn != NULL && testconn != NULL) {
+                if (verbose > 1) {
+                    if (minmax == MAXIMUM_TIME)
+                        fprintf(stdout, "   %g setup time at destination\n", setupdelay);
+                    else
+                        fprintf(stdout, "   %g hold time at destination\n", holddelay);
+                }
+            }
+
+            if (verbose > 1) fprintf(stdout, "\n");
+        }
+        else if (verbose > 1) {
+            fprintf(stdout, "Path terminated on output \"%s\" with max delay %g ps\n",
+                        testddata->backtrace->receiver->refnet->name, testddata->delay);
+
+            backtrace = testddata->backtrace;
+            fprintf(stdout, "   %g (%s) %s/%s -> [output pin]\n",
+                        backtrace->delay,
+                        backtrace->receiver->refnet->name,
+                        backtrace->receiver->refnet->driver->refinst->name,
+                        backtrace->receiver->refnet->driver->refpin->name);
+
+            for (backtrace = backtrace->next; backtrace->next; backtrace = backtrace->next) {
+                fprintf(stdout, "   %g (%s) %s/%s -> %s/%s\n",
+                        backtrace->delay,
+                        backtrace->receiver->refnet->name,
+                        backtrace->receiver->refnet->driver->refinst->name,
+                        backtrace->receiver->refnet->driver->refpin->name,
+                        backtrace->receiver->refinst->name,
+                        backtrace->receiver->refpin->name);
+            }
+            fprintf(stdout, "   000.000 (%s) %s/%s -> %s/%s\n\n",
+                        backtrace->receiver->refnet->name,
+                        backtrace->receiver->refinst->name,
+                        backtrace->receiver->refpin->name,
+                        backtrace->receiver->refinst->name,
+                        backtrace->receiver->refinst->out_connects->refpin->name);
+        }
+
+        // Clean up clock2list backtraces
+	for (freeddata = clock2list; freeddata; freeddata = freeddata->next) {
+	    while (freeddata->backtrace != NULL) {
+		freebt = freeddata->backtrace;
+		testconn = freebt->receiver;
+		freeddata->backtrace = freeddata->backtrace->next;
+                freebt->refcnt--;
+		if (freebt->refcnt == 0) release_btdata(&pathmem, freebt);
+		else break;
+		if (testconn->visited != (unsigned char)2)
+		    break;
+		testconn->visited = (unsigned char)0;
+	    }
+	}
+
+        // Clean up clock2list
+        while (clock2list != NULL) {
+            freeddata = clock2list;
+            clock2list = clock2list->next;
+            release_delaydata(&pathmem, freeddata);
+        }
+
+        // Free up clocklist backtraces
+	for (freeddata = clocklist; freeddata; freeddata = freeddata->next) {
+            while (freeddata->backtrace != NULL) {
+		freebt = freeddata->backtrace;
+		testconn = freebt->receiver;
+		freeddata->backtrace = freeddata->backtrace->next;
+                freebt->refcnt--;
+		if (freebt->refcnt == 0) release_btdata(&pathmem, freebt);
+		else break;
+		if (testconn->visited != (unsigned char)1)
+		    break;
+		testconn->visited = (unsigned char)0;
+	    }
+	}
+
+        // Free up clocklist
+        while (clocklist != NULL) {
+            freeddata = clocklist;
+            clocklist = clocklist->next;
+            release_delaydata(&pathmem, freeddata);
         }
-        token = advancetoken(flib, 0);
     }
 }
 
 /*--------------------------------------------------------------*/
-/* Read a verilog netlist and collect information about the     */
-/* cells instantiated and the network structure                 */
+/* Mark the connections affected by a change of load on net	*/
+/* "testnet" in "dirty".  The driving instance has its lookup	*/
+/* tables collapsed again at the new load.  The receivers are	*/
+/* marked as well, as their interconnect delay may have changed.	*/
 /*--------------------------------------------------------------*/
 
 void
-verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
-                connect **inputlist, connect **outputlist, struct hashtable *Nethash)
+eco_net_changed(netptr testnet, unsigned char *dirty)
 {
-    struct portrec  *port;
-    struct instance *inst;
-    struct cellrec  *topcell;
-    struct netrec   *net;
+    connptr testconn;
+    int i;
 
-    connptr newconn, testconn;
-    instptr newinst;
-    pinptr testpin;
-    netptr newnet, testnet;
-    cellptr testcell;
+    if ((testnet->driver != NULL) && (testnet->driver->refinst != NULL)) {
+	collapse_instance_tables(testnet->driver->refinst);
+	for (testconn = testnet->driver->refinst->in_connects; testconn;
+			testconn = testconn->next)
+	    if (testconn->index >= 0) dirty[testconn->index] = 1;
+    }
+    for (i = 0; i < testnet->fanout; i++) {
+	testconn = testnet->receivers[i];
+	if (testconn->index >= 0) dirty[testconn->index] = 1;
+    }
+}
 
-    int vstart, vtarget;
+/*--------------------------------------------------------------*/
+/* Replace the cell of instance "testinst" with "newcell".  The	*/
+/* new cell must have every connected pin of the old cell, with	*/
+/* the same pin type, and the same register type and clock	*/
+/* sense, so that the timing graph is unchanged.  Loads on the	*/
+/* input nets are adjusted for the new pin capacitances, but	*/
+/* the lookup tables are not collapsed again.  Error messages	*/
+/* begin with "who".						*/
+/*								*/
+/* Return 1 if the cell was replaced, 0 if not.			*/
+/*--------------------------------------------------------------*/
 
-    /* Get verilog netlist structure using routines in readverilog.c */
-    topcell = ReadVerilog(filename);
-    if (topcell && topcell->name) {
-	fprintf(stdout, "Parsing module \"%s\"\n", topcell->name);
+int
+replace_instance_cell(instptr testinst, cellptr newcell, char *who)
+{
+    cellptr oldcell;
+    connptr testconn;
+    pinptr  testpin, newpin;
+    int i;
+
+    oldcell = testinst->refcell;
+    if ((oldcell->type & (DFF | LATCH | CLK_SENSE_MASK | EN_SENSE_MASK)) !=
+		(newcell->type & (DFF | LATCH | CLK_SENSE_MASK | EN_SENSE_MASK))) {
+	fprintf(stderr, "%s:  Cell \"%s\" is not the same register type as "
+		"cell \"%s\" of instance \"%s\"\n", who, newcell->name,
+		oldcell->name, testinst->name);
+	return 0;
     }
 
-    /* Build local connection lists from returned netlist structure */
+    /* Check all pins before changing anything */
 
-    for (port = topcell->portlist; port; port = port->next) {
-	testconn = NULL;
+    for (i = 0; i < 2; i++) {
+	testconn = (i == 0) ? testinst->in_connects : testinst->out_connects;
+	for (; testconn; testconn = testconn->next) {
+	    testpin = testconn->refpin;
+	    for (newpin = newcell->pins; newpin; newpin = newpin->next)
+		if (!strcmp(newpin->name, testpin->name))
+		    break;
+	    if ((newpin == NULL) || (newpin->type != testpin->type)) {
+		fprintf(stderr, "%s:  Cell \"%s\" has no pin \"%s\" matching "
+			"instance \"%s\"\n", who, newcell->name, testpin->name,
+			testinst->name);
+		return 0;
+	    }
+	}
+    }
 
-	// Create a net entry for the input or output, add to the list of nets
+    for (i = 0; i < 2; i++) {
+	testconn = (i == 0) ? testinst->in_connects : testinst->out_connects;
+	for (; testconn; testconn = testconn->next) {
+	    testpin = testconn->refpin;
+	    for (newpin = newcell->pins; newpin; newpin = newpin->next)
+		if (!strcmp(newpin->name, testpin->name))
+		    break;
+	    if (i == 0) {
+		testconn->refnet->loadr += newpin->capr - testpin->capr;
+		testconn->refnet->loadf += newpin->capf - testpin->capf;
+	    }
+	    testconn->refpin = newpin;
+	}
+    }
+    testinst->refcell = newcell;
+    return 1;
+}
 
-	net = HashLookup(port->name, &topcell->nets);
-	if (net->start == 0 && net->end == 0) {
-	    newnet = create_net(netlist);
-	    newnet->name = tokendup(port->name);
-	    HashPtrInstall(newnet->name, newnet, Nethash);
+/*--------------------------------------------------------------*/
+/* ECO "swap" command:  replace the cell of instance "testinst"	*/
+/* with "newcell" (see replace_instance_cell()), and mark the	*/
+/* connections affected in "dirty".				*/
+/*								*/
+/* Return 1 if the cell was replaced, 0 if not.			*/
+/*--------------------------------------------------------------*/
 
-	    testconn = (connptr)malloc(sizeof(connect));
-	    testconn->refnet = newnet;
-	    testconn->refpin = NULL;        // No associated pin
-	    testconn->refinst = NULL;       // No associated instance
-	    testconn->tag = NULL;
-	    testconn->metric = -1.0;
-	    testconn->icDelay = 0.0;
-	    testconn->visited = (unsigned char)0;
-	    testconn->prvector = NULL;
-	    testconn->pfvector = NULL;
-	    testconn->trvector = NULL;
-	    testconn->tfvector = NULL;
+int
+eco_swap_cell(instptr testinst, cellptr newcell, unsigned char *dirty)
+{
+    connptr testconn;
 
-            if (port->direction == PORT_INPUT) {    // driver (input)
-		testconn->next = *inputlist;
-		*inputlist = testconn;
-            }
-            else {				    // receiver (output)
-		testconn->next = *outputlist;
-		*outputlist = testconn;
-            }
-	}
-	else {
-	    vtarget = net->end + ((net->start < net->end) ? 1 : -1);
-	    vstart = net->start;
-	    while (vstart != vtarget) {
-		newnet = create_net(netlist);
-		newnet->name = (char *)malloc(strlen(port->name) + 6);
-		sprintf(newnet->name, "%s[%d]", port->name, vstart);
-		HashPtrInstall(newnet->name, newnet, Nethash);
+    if (replace_instance_cell(testinst, newcell, "ECO") == 0) return 0;
 
-		vstart += (vtarget > net->end) ? 1 : -1;
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	eco_net_changed(testconn->refnet, dirty);
+    collapse_instance_tables(testinst);
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	if (testconn->index >= 0) dirty[testconn->index] = 1;
+
+    return 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Record the worst (minmax) path delay into each endpoint of	*/
+/* "pathlist" in "enddelay", indexed by connection number.	*/
+/*--------------------------------------------------------------*/
+
+void
+record_endpoint_delays(ddataptr pathlist, double *enddelay, char minmax)
+{
+    ddataptr testddata;
+    int n;
+
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	n = testddata->backtrace->receiver->index;
+	if (n < 0) continue;
+	if ((enddelay[n] == INITVAL) ||
+		((minmax == MAXIMUM_TIME) && (testddata->delay > enddelay[n])) ||
+		((minmax != MAXIMUM_TIME) && (testddata->delay < enddelay[n])))
+	    enddelay[n] = testddata->delay;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Return the connection of endpoint "name", which is either	*/
+/* <instance>/<pin> or the name of a module output, or NULL	*/
+/* (with an error message) if there is no such endpoint.	*/
+/*--------------------------------------------------------------*/
 
-		testconn = (connptr)malloc(sizeof(connect));
-		testconn->refnet = newnet;
-		testconn->refpin = NULL;    // No associated pin
-		testconn->refinst = NULL;   // No associated instance
-		testconn->tag = NULL;
-		testconn->metric = -1.0;
-		testconn->icDelay = 0.0;
-		testconn->visited = (unsigned char)0;
-		testconn->prvector = NULL;
-		testconn->pfvector = NULL;
-		testconn->trvector = NULL;
-		testconn->tfvector = NULL;
+connptr
+eco_find_endpoint(sessionptr sess, char *name)
+{
+    char *pinname;
+    instptr testinst;
+    netptr testnet;
+    connptr testconn;
+    int i;
 
-		if (port->direction == PORT_INPUT) {    // driver (input)
-		    testconn->next = *inputlist;
-		    *inputlist = testconn;
-		}
-		else {                      // receiver (output)
-		    testconn->next = *outputlist;
-		    *outputlist = testconn;
+    testconn = NULL;
+    pinname = strrchr(name, '/');
+    if (pinname != NULL) {
+	*pinname = '\0';
+	testinst = (instptr)HashLookup(name, sess->insthash);
+	*pinname++ = '/';
+	if (testinst != NULL)
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+		if (!strcmp(testconn->refpin->name, pinname))
+		    break;
+    }
+    else {
+	testnet = (netptr)HashLookup(name, sess->nethash);
+	if (testnet != NULL)
+	    for (i = 0; i < testnet->fanout; i++)
+		if (testnet->receivers[i]->refinst == NULL) {
+		    testconn = testnet->receivers[i];
+		    break;
 		}
-	    }
-	}
     }
+    if ((testconn == NULL) || (testconn->index < 0)) {
+	fprintf(stderr, "%s line %d:  No endpoint \"%s\"\n", sess->name,
+		sess->lineno, name);
+	return NULL;
+    }
+    return testconn;
+}
 
-    for (inst = topcell->instlist; inst; inst = inst->next) {
-        for (testcell = cells; testcell; testcell = testcell->next)
-            if (!strcasecmp(testcell->name, inst->cellname))
-                break;
+/*--------------------------------------------------------------*/
+/* Report the delays into endpoint "name" (see			*/
+/* eco_find_endpoint()) from the last analysis.			*/
+/*--------------------------------------------------------------*/
 
-	// NOTE:  testcell may be NULL for non-functional cells like
-	// filler cells which have no I/O and so have no timing.  Only
-	// report cells that are relevant to timing and do not show up
-	// in the liberty database (portlist is non-NULL).
+void
+eco_report_slack(sessionptr sess, char *name)
+{
+    connptr testconn;
 
-        if ((testcell == NULL) && (inst->portlist != NULL)) {
-	    fprintf(stderr, "Cell \"%s\" was not in the liberty database!\n",
-		    inst->cellname);
-	    continue;
+    testconn = eco_find_endpoint(sess, name);
+    if (testconn == NULL) return;
+
+    fprintf(stdout, "Endpoint %s:", name);
+    if (sess->endmax[testconn->index] == INITVAL)
+	fprintf(stdout, "  no paths\n");
+    else {
+	fprintf(stdout, "  maximum delay %g ps", sess->endmax[testconn->index]);
+	if (*sess->period > 0.0)
+	    fprintf(stdout, "   Slack = %g ps", *sess->period -
+			sess->endmax[testconn->index]);
+	fprintf(stdout, ",  minimum delay %g ps\n", sess->endmin[testconn->index]);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Report the "number" worst (minmax) paths into endpoint	*/
+/* "name" (see eco_find_endpoint()) from the last analysis,	*/
+/* from both register and module input start points.  The	*/
+/* paths are enumerated from the graph of each analysis pass	*/
+/* by graph_kpaths(), and reported in order of delay.		*/
+/*--------------------------------------------------------------*/
+
+void
+eco_report_paths(sessionptr sess, char *name, int number, char minmax)
+{
+    connptr testconn;
+    tgraphptr graph;
+    ddataptr pathlist, *orderedpaths;
+    pathpool pool;
+    arenablockptr block;
+    int i, n, numordered;
+
+    testconn = eco_find_endpoint(sess, name);
+    if (testconn == NULL) return;
+    if (number <= 0) number = 1;
+    n = testconn->index;
+
+    memset(&pool, 0, sizeof(pathpool));
+    pathlist = NULL;
+    for (i = (minmax == MAXIMUM_TIME) ? 0 : 1; i < 4; i += 2) {
+	graph = sess->views[i];
+	if (!(graph->role[n] & GRAPH_SINK)) continue;
+	if (graph->skewed == 0)
+	    graph_kpaths(graph, &pathlist, minmax, &pool, CAPTURE_ALL, number, n);
+	else {
+	    graph_kpaths(graph, &pathlist, minmax, &pool, CAPTURE_CLOCKED, number, n);
+	    if (graph->unclocked != NULL)
+		graph_kpaths(graph->unclocked, &pathlist, minmax, &pool,
+			CAPTURE_UNCLOCKED, number, n);
 	}
+    }
+    find_clock_skews(pathlist, minmax, sess->clocks);
 
-        newinst = (instptr)malloc(sizeof(instance));
-        newinst->next = *instlist;
-        *instlist = newinst;
-        newinst->refcell = testcell;
-        newinst->in_connects = NULL;
-        newinst->out_connects = NULL;
-        newinst->name = tokendup(inst->instname);
+    orderedpaths = (ddataptr *)malloc(number * sizeof(ddataptr));
+    select_paths(pathlist, minmax, number, 0, orderedpaths, &numordered);
+    fprintf(stdout, "Endpoint %s:\n", name);
+    print_paths(stdout, (minmax == MAXIMUM_TIME) ? REG_MAX : REG_MIN, orderedpaths,
+		numordered, number, *sess->period, 1);
+    free(orderedpaths);
 
-	for (port = inst->portlist; port; port = port->next) {
-            newconn = (connptr)malloc(sizeof(connect));
-            for (testpin = testcell->pins; testpin; testpin = testpin->next) {
-                if (!strcmp(testpin->name, port->name))
-                    break;
-            }
-            // Sanity check
-            if (testpin == NULL) {
-                fprintf(stderr, "No such pin \"%s\" in cell \"%s\"!\n",
-                        port->name, testcell->name);
-            }
-            else {
-                if (testpin->type & OUTPUT) {
-                    newconn->next = newinst->out_connects;
-                    newinst->out_connects = newconn;
-                }
-                else {
-                    newconn->next = newinst->in_connects;
-                    newinst->in_connects = newconn;
-                }
-            }
-            newconn->refinst = newinst;
-            newconn->refpin = testpin;
-            newconn->refnet = NULL;
-            newconn->tag = NULL;
-            newconn->metric = -1.0;
-	    newconn->icDelay = 0.0;
-	    newconn->visited = (unsigned char)0;
-            newconn->prvector = NULL;
-            newconn->pfvector = NULL;
-            newconn->trvector = NULL;
-            newconn->tfvector = NULL;
+    pathpool_reset(&pool);
+    while (pool.mem.spare != NULL) {
+	block = pool.mem.spare;
+	pool.mem.spare = block->next;
+	free(block);
+    }
+}
 
-            testnet = (netptr)HashLookup(port->net, Nethash);
-            if (testnet == NULL) {
-                // This is a new net, and we need to record it
-                newnet = create_net(netlist);
-                newnet->name = tokendup(port->net);
-                HashPtrInstall(newnet->name, newnet, Nethash);
-                newconn->refnet = newnet;
-            }
-            else
-                newconn->refnet = testnet;
+/*--------------------------------------------------------------*/
+/* Print the worst and total negative setup and hold slack of	*/
+/* the endpoints in the slack database "db" to "file", and the	*/
+/* number of pins with negative setup slack.			*/
+/*--------------------------------------------------------------*/
+
+void
+print_slack_summary(FILE *file, slackptr db)
+{
+    double wns, tns;
+    int numends, numfail, numpins, i, k;
+
+    for (k = MAXIMUM_TIME; k >= MINIMUM_TIME; k--) {
+	wns = NOSLACK;
+	tns = 0.0;
+	numends = numfail = 0;
+	for (i = 0; i < db->numconns; i++) {
+	    if (db->endslack[k][i] == NOSLACK) continue;
+	    numends++;
+	    if (db->endslack[k][i] < wns) wns = db->endslack[k][i];
+	    if (db->endslack[k][i] < 0.0) {
+		tns += db->endslack[k][i];
+		numfail++;
+	    }
 	}
+	if (numends == 0)
+	    fprintf(file, "No %s endpoints.\n", (k == MAXIMUM_TIME) ? "setup" : "hold");
+	else
+	    fprintf(file, "Worst %s slack = %g ps, total negative slack = %g ps"
+			" (%d of %d endpoints fail)\n", (k == MAXIMUM_TIME) ?
+			"setup" : "hold", wns, tns, numfail, numends);
     }
-    FreeVerilog(topcell);   // All structures transferred
+    numpins = 0;
+    for (i = 0; i < db->numconns; i++)
+	if (db->slack[MAXIMUM_TIME][i] < 0.0) numpins++;
+    fprintf(file, "Pins with negative setup slack = %d (clock period %g ps)\n",
+		numpins, db->period);
 }
 
 /*--------------------------------------------------------------*/
-/* For each net, go through the list of receivers and add the   */
-/* contributions of each to the total load.  This is either     */
-/* the input pin capacitance, if the receiver is a pin, or the  */
-/* designated output load (given on the command line), if the   */
-/* receiver is an output pin.                                   */
+/* Find the worst setup and hold slack of the pins on net	*/
+/* "testnet".  This is also the slack of the net's driver.	*/
 /*--------------------------------------------------------------*/
 
 void
-computeLoads(netptr netlist, instptr instlist, double out_load)
+net_worst_slack(slackptr db, netptr testnet, double *slack)
 {
-    instptr testinst;
-    pinptr testpin;
-    netptr testnet, driver, loadnet;
-    connptr testconn;
-    int i;
+    int i, k, n;
 
-    for (testnet = netlist; testnet; testnet = testnet->next) {
-        for (i = 0; i < testnet->fanout; i++) {
-            testconn = testnet->receivers[i];
-            testpin = testconn->refpin;
-            if (testpin == NULL) {
-                testnet->loadr += out_load;
-                testnet->loadf += out_load;
-            }
-            else {
-                testnet->loadr += testpin->capr;
-                testnet->loadf += testpin->capf;
-            }
-        }
+    for (i = 0; i < testnet->fanout; i++) {
+	n = testnet->receivers[i]->index;
+	if (n < 0) continue;
+	for (k = 0; k < 2; k++)
+	    if (db->slack[k][n] < slack[k]) slack[k] = db->slack[k][n];
     }
+    /* A module input is a numbered pin of its own net */
+    if (testnet->driver == NULL)
+	for (n = 0; n < db->numconns; n++)
+	    if ((db->conns[n]->refinst == NULL) && (db->conns[n]->refnet == testnet))
+		for (k = 0; k < 2; k++)
+		    if (db->slack[k][n] < slack[k]) slack[k] = db->slack[k][n];
+}
 
-    // For each instance input pin, collapse the pin's lookup table
-    // to a vector by interpolating/extrapolating the table at the
-    // calculated output load.  Save this vector in the connection
-    // record for the pin.
+/*--------------------------------------------------------------*/
+/* Report the setup and hold slack at pin "name" (either	*/
+/* <instance>/<pin> or a module input or output) or, if "name"	*/
+/* is a net, the worst slack of the pins on the net.  The slack	*/
+/* of a cell output is that of the net it drives.		*/
+/*--------------------------------------------------------------*/
 
-    for (testinst = instlist; testinst; testinst = testinst->next) {
-	double loadr, loadf;
-	if (testinst->out_connects != NULL) {
-	    loadnet = testinst->out_connects->refnet;
-	    loadr = loadnet->loadr;
-	    loadf = loadnet->loadf;
+void
+eco_report_pin_slack(sessionptr sess, char *name)
+{
+    slackptr db = sess->slacks;
+    char *pinname;
+    instptr testinst;
+    netptr testnet;
+    connptr testconn;
+    double slack[2];
+    char output;
+    int k;
+
+    slack[0] = slack[1] = NOSLACK;
+    testnet = (netptr)HashLookup(name, sess->nethash);
+    pinname = strrchr(name, '/');
+    if (testnet != NULL)
+	net_worst_slack(db, testnet, slack);
+    else if (pinname != NULL) {
+	*pinname = '\0';
+	testinst = (instptr)HashLookup(name, sess->insthash);
+	*pinname++ = '/';
+	testconn = NULL;
+	output = 0;
+	if (testinst != NULL) {
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+		if (!strcmp(testconn->refpin->name, pinname))
+		    break;
+	    if (testconn == NULL)
+		for (testconn = testinst->out_connects; testconn; testconn = testconn->next)
+		    if (!strcmp(testconn->refpin->name, pinname)) {
+			output = 1;
+			break;
+		    }
 	}
-	else {
-	    loadr = 0.0;
-	    loadf = 0.0;
+	if ((testconn == NULL) || (output ? (testconn->refnet == NULL) :
+			(testconn->index < 0))) {
+	    fprintf(stderr, "%s line %d:  No pin \"%s\"\n", sess->name,
+			sess->lineno, name);
+	    return;
 	}
-	     
-	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
-	    testpin = testconn->refpin;
-
-            if (testpin->propdelr)
-                testconn->prvector = table_collapse(testpin->propdelr, loadr);
-            if (testpin->propdelf)
-                testconn->pfvector = table_collapse(testpin->propdelf, loadf);
-            if (testpin->transr)
-                testconn->trvector = table_collapse(testpin->transr, loadr);
-            if (testpin->transf)
-                testconn->tfvector = table_collapse(testpin->transf, loadf);
-        }
+	if (output)
+	    net_worst_slack(db, testconn->refnet, slack);
+	else
+	    for (k = 0; k < 2; k++) slack[k] = db->slack[k][testconn->index];
+    }
+    else {
+	fprintf(stderr, "%s line %d:  No pin or net \"%s\"\n", sess->name,
+		sess->lineno, name);
+	return;
     }
+
+    fprintf(stdout, "%s %s:", (testnet != NULL) ? "Net" : "Pin", name);
+    if ((slack[MAXIMUM_TIME] == NOSLACK) && (slack[MINIMUM_TIME] == NOSLACK))
+	fprintf(stdout, "  no paths\n");
+    else
+	fprintf(stdout, "  setup slack %g ps,  hold slack %g ps\n",
+		slack[MAXIMUM_TIME], slack[MINIMUM_TIME]);
 }
 
 /*--------------------------------------------------------------*/
-/* Assign types to each net.  This identifies which nets are    */
-/* clock inputs, which are latch enable inputs, and which are   */
-/* asynchronous set/reset inputs,.                              */
-/*                                                              */
-/* Whenever a clock input to a flop is found, add the           */
-/* connection record to clockedlist                             */
-/*                                                              */
-/* For diagnostics, return the number of entries in clockedlist */
+/* Compare two pins by their setup slack, for qsort().		*/
 /*--------------------------------------------------------------*/
 
-int assign_net_types(netptr netlist, connlistptr *clockedlist)
+double *sortslack;	/* Setup slack of the pins being sorted */
+
+int
+compare_slack(const void *a, const void *b)
 {
-    int i, numterms;
-    netptr testnet;
-    connptr testrcvr;
-    pinptr testpin;
-    connlistptr newclocked;
+    double sa = sortslack[*(int *)a], sb = sortslack[*(int *)b];
 
-    numterms = 0;
+    return (sa < sb) ? -1 : (sa > sb) ? 1 : (*(int *)a - *(int *)b);
+}
 
-    for (testnet = netlist; testnet; testnet = testnet->next) {
-	/* Nets with no fanout are by definition module outputs */
-	if (testnet->fanout == 0) testnet->type |= OUTTERM;
-        for (i = 0; i < testnet->fanout; i++) {
-            testrcvr = testnet->receivers[i];
-            testpin = testrcvr->refpin;
-            if (testpin == NULL)
-                testnet->type |= OUTTERM;
-            else {
-                switch (testpin->type & (DFFMASK | LATCHMASK)) {
-                    case DFFCLK:
-                        testnet->type |= CLOCK;
-                        newclocked = (connlistptr)malloc(sizeof(connlist));
-                        newclocked->connection = testrcvr;
-                        newclocked->next = *clockedlist;
-                        *clockedlist = newclocked;
-                        numterms++;
-                        break;
-                    case DFFIN:
-                        testnet->type |= TERMINAL;
-                        break;
-                    case DFFSET:
-                    case DFFRST:
-                        testnet->type |= ASYNC;
-                        break;
-                    case LATCHIN:
-                        testnet->type |= LATCHTERM;
-                        break;
-                    case LATCHEN:
-                        testnet->type |= ENABLE;
-                        break;
-                }
-            }
-        }
+/*--------------------------------------------------------------*/
+/* Report the slack summary, and the "number" pins with the	*/
+/* worst setup slack below "limit", worst first.		*/
+/*--------------------------------------------------------------*/
+
+void
+eco_report_critical(sessionptr sess, double limit, int number)
+{
+    slackptr db = sess->slacks;
+    connptr testconn;
+    int *pins, numpins, i, n;
+
+    print_slack_summary(stdout, db);
+
+    pins = (int *)malloc((db->numconns + 1) * sizeof(int));
+    numpins = 0;
+    for (n = 0; n < db->numconns; n++)
+	if (db->slack[MAXIMUM_TIME][n] < limit)
+	    pins[numpins++] = n;
+    sortslack = db->slack[MAXIMUM_TIME];
+    qsort(pins, numpins, sizeof(int), (__compar_fn_t)compare_slack);
+
+    fprintf(stdout, "Pins with setup slack below %g ps:  %d\n", limit, numpins);
+    for (i = 0; (i < numpins) && (i < number); i++) {
+	testconn = db->conns[pins[i]];
+	if (testconn->refinst != NULL)
+	    fprintf(stdout, "   %s/%s", testconn->refinst->name,
+			testconn->refpin->name);
+	else
+	    fprintf(stdout, "   %s pin %s", (testconn->refnet->driver == NULL) ?
+			"input" : "output", testconn->refnet->name);
+	fprintf(stdout, "   Slack = %g ps\n", db->slack[MAXIMUM_TIME][pins[i]]);
     }
-    return numterms;
+    free(pins);
 }
 
 /*--------------------------------------------------------------*/
-/* Create the links representing the netlist connections.       */
-/*                                                              */
-/* The verilogRead() routine added all nets and instances, and  */
-/* for each instance, generated a list of net connections to    */
-/* each pin.  To make the netlist easily traversible, this      */
-/* routine does the following:                                  */
-/*                                                              */
-/* For each instance, work through the list of pin              */
-/*      connections.  If the pin is an output, then add the     */
-/*      connection as the net's driver entry.  If the pin is    */
-/*      an input, then add the connection to the list of the    */
-/*      net's receivers, and increment the net's fanout.        */
-/*                                                              */
-/* For each module input, add the input connection as the       */
-/*      net's driver (flag an error if the net already has a    */
-/*      driver).                                                */
-/*                                                              */
-/* For each module output, add the output connection as one of  */
-/*      the net's receivers (it may be the only one).           */
-/*                                                              */
+/* Read commands from the ECO file or server command stream	*/
+/* (see the top of this file) up to the next "update" or	*/
+/* "report" command or the end of the stream, and apply the	*/
+/* edits to the netlist.  Queries are answered as they are	*/
+/* read.  Connections whose timing may have changed are marked	*/
+/* in sess->dirty (indexed by connection number), which is	*/
+/* cleared first.						*/
+/*								*/
+/* Return 1 if the design should be re-timed, 0 if the end of	*/
+/* the stream or a "quit" command was reached with no further	*/
+/* edits.							*/
 /*--------------------------------------------------------------*/
 
-void
-createLinks(netptr netlist, instptr instlist, connptr inputlist, connptr outputlist)
+int
+eco_read(sessionptr sess)
 {
+    char line[1024], cmd[256], arg1[256], arg2[256];
+    int nargs, numedits;
+    FILE *fdly;
     netptr testnet;
     instptr testinst;
-    connptr testconn;
+    cellptr newcell;
+    struct hashtable updated;
 
-    for (testinst = instlist; testinst; testinst = testinst->next) {
-        for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
-            testnet = testconn->refnet;
-            testnet->fanout++;
-            if (testnet->receivers == NULL)
-                testnet->receivers = (connptr *)malloc(sizeof(connptr));
+    memset(sess->dirty, 0, numconnects * sizeof(unsigned char));
+    numedits = 0;
 
-            else
-                testnet->receivers = (connptr *)realloc(testnet->receivers,
-                                testnet->fanout * sizeof(connptr));
+    while (fgets(line, 1024, sess->fcmd) != NULL) {
+	sess->lineno++;
+	nargs = sscanf(line, "%255s %255s %255s", cmd, arg1, arg2);
+	if ((nargs <= 0) || (cmd[0] == '#')) continue;
 
-            testnet->receivers[testnet->fanout - 1] = testconn;
-        }
+	if (!strcmp(cmd, "update"))
+	    return 1;
+
+	else if (!strcmp(cmd, "report")) {
+	    if (nargs > 1) *sess->numpaths = atoi(arg1);
+	    return 1;
+	}
+
+	else if (!strcmp(cmd, "quit")) {
+	    sess->quit = 1;
+	    break;
+	}
+
+	else if (!strcmp(cmd, "slack") && (nargs == 2))
+	    eco_report_slack(sess, arg1);
+
+	else if ((!strcmp(cmd, "paths") || !strcmp(cmd, "minpaths")) && (nargs > 1))
+	    eco_report_paths(sess, arg1, (nargs > 2) ? atoi(arg2) : *sess->numpaths,
+			(cmd[0] == 'm') ? MINIMUM_TIME : MAXIMUM_TIME);
+
+	else if ((!strcmp(cmd, "pinslack") || !strcmp(cmd, "critical")) &&
+			(sess->slacks == NULL))
+	    fprintf(stderr, "%s line %d:  No pin slacks (use option -R)\n",
+			sess->name, sess->lineno);
+
+	else if (!strcmp(cmd, "pinslack") && (nargs == 2))
+	    eco_report_pin_slack(sess, arg1);
+
+	else if (!strcmp(cmd, "critical"))
+	    eco_report_critical(sess, (nargs > 1) ? strtod(arg1, NULL) : 0.0,
+			(nargs > 2) ? atoi(arg2) : *sess->numpaths);
+
+	else if (!strcmp(cmd, "period") && (nargs == 2)) {
+	    *sess->period = strtod(arg1, NULL);
+	    numedits++;
+	}
+
+	else if (!strcmp(cmd, "swap") && (nargs == 3)) {
+	    testinst = (instptr)HashLookup(arg1, sess->insthash);
+	    for (newcell = sess->cells; newcell; newcell = newcell->next)
+		if (!strcasecmp(newcell->name, arg2))
+		    break;
+	    if (testinst == NULL)
+		fprintf(stderr, "%s line %d:  No instance \"%s\"\n",
+			sess->name, sess->lineno, arg1);
+	    else if (newcell == NULL)
+		fprintf(stderr, "%s line %d:  Cell \"%s\" was not in the "
+			"liberty database!\n", sess->name, sess->lineno, arg2);
+	    else if (eco_swap_cell(testinst, newcell, sess->dirty))
+		numedits++;
+	}
+
+	else if (!strcmp(cmd, "load") && (nargs == 3)) {
+	    testnet = (netptr)HashLookup(arg1, sess->nethash);
+	    if (testnet == NULL)
+		fprintf(stderr, "%s line %d:  No net \"%s\"\n",
+			sess->name, sess->lineno, arg1);
+	    else {
+		testnet->loadr += strtod(arg2, NULL);
+		testnet->loadf += strtod(arg2, NULL);
+		eco_net_changed(testnet, sess->dirty);
+		numedits++;
+	    }
+	}
+
+	else if (!strcmp(cmd, "delays") && (nargs == 2)) {
+	    fdly = fopen(arg1, "r");
+	    if (fdly == NULL) {
+		fprintf(stderr, "%s line %d:  Cannot open %s for reading\n",
+			sess->name, sess->lineno, arg1);
+		continue;
+	    }
+	    InitializeHashTable(&updated, SMALLHASHSIZE);
+	    parasiticsRead(fdly, arg1, sess->nethash, sess->insthash,
+			sess->outload, &updated);
+	    fclose(fdly);
+
+	    /* Wiring loads replace the net loads, so add the pins again */
+	    testnet = (netptr)HashFirst(&updated);
+	    while (testnet != NULL) {
+		add_pin_loads(testnet, sess->outload);
+		eco_net_changed(testnet, sess->dirty);
+		testnet = (netptr)HashNext(&updated);
+	    }
+	    HashKill(&updated);
+	    numedits++;
+	}
 
-        for (testconn = testinst->out_connects; testconn; testconn = testconn->next) {
-            testnet = testconn->refnet;
-            testnet->driver = testconn;
-        }
+	else
+	    fprintf(stderr, "%s line %d:  Unrecognized command \"%s\"\n",
+			sess->name, sess->lineno, cmd);
+	fflush(stdout);
     }
+    return (numedits > 0) ? 1 : 0;
+}
 
-    for (testconn = inputlist; testconn; testconn = testconn->next) {
-        testnet = testconn->refnet;
-        if (testnet->driver != NULL)
-            fprintf(stderr, "Error:  Input pin \"%s\" has an internal driver!\n",
-                        testnet->name);
-        // else
-        //    testnet->driver = testconn;       // Don't do this, makes connectivity circular
+/*--------------------------------------------------------------*/
+/* Read the next set of edits for incremental analysis from	*/
+/* the command stream of "sess" (see eco_read()).  When the	*/
+/* stream ends, and "sockfd" is a server socket (>= 0), the	*/
+/* next client is accepted and read instead ("savefd" is as	*/
+/* for server_accept()).					*/
+/*								*/
+/* Return 1 if edits were read and the design should be	*/
+/* re-timed, 0 if there are no more commands.			*/
+/*--------------------------------------------------------------*/
+
+int
+eco_next(sessionptr sess, int sockfd, int *savefd)
+{
+    while ((sess->fcmd != NULL) || (sockfd >= 0)) {
+	if (sess->fcmd == NULL) {
+	    sess->fcmd = server_accept(sockfd, savefd);
+	    if (sess->fcmd == NULL) break;
+	    sess->lineno = 0;
+	}
+	if (eco_read(sess)) return 1;
+
+	/* End of the command stream */
+	if (sockfd >= 0)
+	    server_hangup(sess->fcmd, savefd);
+	else if (sess->fcmd != stdin)
+	    fclose(sess->fcmd);
+	sess->fcmd = NULL;
+	if (sess->quit) break;
     }
+    return 0;
+}
 
-    for (testconn = outputlist; testconn; testconn = testconn->next) {
-        testnet = testconn->refnet;
-        testnet->fanout++;
-        if (testnet->receivers == NULL)
-            testnet->receivers = (connptr *)malloc(sizeof(connptr));
+/*--------------------------------------------------------------*/
+/* Parse the argument of option -X, "<name>=<file>[,<file>...]",	*/
+/* into corner "newcorner".  Return 1 on success, 0 if the	*/
+/* argument is malformed.					*/
+/*--------------------------------------------------------------*/
 
-        else
-            testnet->receivers = (connptr *)realloc(testnet->receivers,
-                        testnet->fanout * sizeof(connptr));
+int
+corner_parse(char *arg, corner *newcorner)
+{
+    char *sep;
 
-        testnet->receivers[testnet->fanout - 1] = testconn;
+    sep = strchr(arg, '=');
+    if ((sep == NULL) || (sep == arg) || (*(sep + 1) == '\0')) {
+	fprintf(stderr, "Bad corner \"%s\" (should be <name>=<file>[,<file>...])\n",
+		arg);
+	return 0;
     }
+    memset(newcorner, 0, sizeof(corner));
+    newcorner->name = strdup(arg);
+    newcorner->name[sep - arg] = '\0';
+    newcorner->libs = newcorner->name + (sep - arg) + 1;
+    return 1;
 }
 
 /*--------------------------------------------------------------*/
-/* Delay comparison used by qsort() to sort paths in order from */
-/* longest to shortest propagation delay.                       */
+/* Read the liberty files of corner "thiscorner" (in order, as	*/
+/* for the files on the command line), starting from the table	*/
+/* template "scalar".  Return 1 on success, 0 if a file cannot	*/
+/* be read.							*/
 /*--------------------------------------------------------------*/
 
 int
-compdelay(ddataptr *a, ddataptr *b)
+corner_read(corner *thiscorner, lutable *scalar, char *cachedir)
 {
-    ddataptr p = *a;
-    ddataptr q = *b;
+    char *libs, *libname, *saveptr;
+    cell *testcell;
+    uint64_t key = 0;
+    int result = 1;
+
+    thiscorner->tables = scalar;
+    thiscorner->cells = NULL;
+
+    fprintf(stdout, "Corner %s:\n", thiscorner->name);
+    libs = strdup(thiscorner->libs);
+    for (libname = strtok_r(libs, ",", &saveptr); libname;
+		libname = strtok_r(NULL, ",", &saveptr)) {
+	if (liberty_read_file(libname, cachedir, &key, &thiscorner->tables,
+			&thiscorner->cells) == 0) {
+	    result = 0;
+	    break;
+	}
+    }
+    free(libs);
 
-    if (p->delay < q->delay)
-        return (1);
-    if (p->delay > q->delay)
-        return (-1);
-    return (0);
+    InitializeHashTable(&thiscorner->cellhash, SMALLHASHSIZE);
+    for (testcell = thiscorner->cells; testcell; testcell = testcell->next)
+	HashPtrInstall(testcell->name, testcell, &thiscorner->cellhash);
+    return result;
 }
 
-void
-delayRead(FILE *fdly, struct hashtable *Nethash)
-{
-    char c[128];
-    char d[128];
-    char *token;
-    char *result;
-    char *tokencopy = NULL;
+/*--------------------------------------------------------------*/
+/* Return the loads of the nets of "netlist" before the pin	*/
+/* loads are added (that is, the wiring loads from the delay	*/
+/* file, if any), rising and falling for each net in order.	*/
+/*--------------------------------------------------------------*/
 
-    netptr newnet, testnet;
-    connptr testconn;
-    pinptr testpin;
+double *
+corner_wire_loads(netptr netlist)
+{
+    netptr testnet;
+    double *loads;
     int i;
-    int numRxers;
 
-    if (debug == 1)
-	fprintf(stdout, "delayRead\n");
-
-    /* NOTE:  Do not use 0 for delimiter, or else ':' is considered to	*/
-    /* be a standard delimiter, breaking up certain yosys-generated	*/
-    /* net names.							*/
-    
-    token = advancetokennocont(fdly, '\n');
-    result = token;
-
-    while (token != NULL) {
+    i = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) i++;
+    loads = (double *)malloc((2 * i + 1) * sizeof(double));
 
-        char *saveptr;
-        char *saveptr2;
+    i = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	loads[i++] = testnet->loadr;
+	loads[i++] = testnet->loadf;
+    }
+    return loads;
+}
 
-        numRxers = 0;
-        testnet = (netptr)HashLookup(token, Nethash);
-
-	/* Syntax cleanup for net renaming between various	*/
-	/* netlist formats.					*/
-
-	if ((testnet == NULL) && cleanup) {
-	    char *mchr, *dchr;
-	    /* Handle the insane backslash-escape names in verilog.
-	     * To make these compatible with SPICE, qflow opts to
-	     * replace the ending space character with another
-	     * backslash.  The 2nd backslash has to be replaced by
-	     * the original space character to match the original
-	     * verilog net name.
-	     */
-	    
-	    if (*token == '\\') {
-	        if ((mchr = strchr(token + 1, '\\')) != NULL) {
-		    dchr = strchr(token + 1, ' ');
-		    if ((dchr == NULL) || (dchr > mchr)) *mchr = ' ';
-		}
-	    }
-	    testnet = (netptr)HashLookup(token, Nethash);
-
-	    /* Other, legacy stuff. */
-	    if (testnet == NULL) {
-		tokencopy = strdup(token);
-		if ((mchr = strrchr(tokencopy, '<')) != NULL) {
-		    if ((dchr = strrchr(tokencopy, '>')) != NULL) {
-			if (mchr < dchr) {
-			    *mchr = '[';
-			    *dchr = ']';
-			}
-		    }
-		}
-		testnet = (netptr)HashLookup(tokencopy, Nethash);
-	    }
+/*--------------------------------------------------------------*/
+/* Bind each instance of "instlist" to the cell of the same	*/
+/* name in corner "thiscorner", then compute the net loads	*/
+/* again from the wiring loads "wireloads" (see			*/
+/* corner_wire_loads()), and collapse the lookup tables at the	*/
+/* new loads.  Return 1 on success, 0 if an instance has no	*/
+/* matching cell in the corner.					*/
+/*--------------------------------------------------------------*/
 
-	    if (testnet == NULL) {
-		for (mchr = tokencopy; *mchr != '\0'; mchr++) {
-		    if ((*mchr == ':') || (*mchr == '.') || (*mchr == '$')
-				|| (*mchr == '<') || (*mchr == '>'))
-			*mchr = '_';
-		}
-		testnet = (netptr)HashLookup(tokencopy, Nethash);
-	    }
+int
+corner_bind(corner *thiscorner, instptr instlist, netptr netlist,
+		double *wireloads, double outload)
+{
+    instptr testinst;
+    netptr testnet;
+    cellptr newcell;
+    int i;
 
-	    if (testnet == NULL) {
-		for (mchr = tokencopy; *mchr != '\0'; mchr++) {
-		    if ((*mchr == '[') || (*mchr == ']'))
-			*mchr = '_';
-		}
-		testnet = (netptr)HashLookup(tokencopy, Nethash);
-	    }
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	newcell = (cellptr)HashLookup(testinst->refcell->name, &thiscorner->cellhash);
+	if (newcell == NULL) {
+	    fprintf(stderr, "Corner %s:  No cell \"%s\" for instance \"%s\"\n",
+			thiscorner->name, testinst->refcell->name, testinst->name);
+	    return 0;
 	}
-	if (tokencopy != NULL) free(tokencopy);
+	if (newcell == testinst->refcell) continue;
+	if (replace_instance_cell(testinst, newcell, thiscorner->name) == 0)
+	    return 0;
+    }
 
-	if (testnet == NULL) {
-	    fprintf(stderr, "ERROR: Net %s not found in hash table\n", token);
-	    exit(-1);
-	}
+    i = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	testnet->loadr = wireloads[i++];
+	testnet->loadf = wireloads[i++];
+    }
+    computeLoads(netlist, instlist, outload);
+    return 1;
+}
 
-        // Read driver of interconnect and total interconnect capacitance
-        result = fgets(c, 128, fdly);
-	if (result == NULL) break;
+/*--------------------------------------------------------------*/
+/* Record the worst delay into each endpoint of "pathlist",	*/
+/* the paths of report section "section" found at corner	*/
+/* number "numcorner", in "merged".  Paths between registers	*/
+/* with no common clock are not counted.			*/
+/*--------------------------------------------------------------*/
 
-        strtok_r(c, "/", &saveptr);
-        if (debug == 1)
-            fprintf(stdout, "\tDriver Inst: %s\n", saveptr);
-        strtok_r(NULL, " ", &saveptr);
-        if (debug == 1) {
-            fprintf(stdout, "\tDriver Pin: %s\n", saveptr);
-            fprintf(stdout, "\tTotC: %f\n", strtof(saveptr, NULL));
-	}
+void
+corner_merge(cornermerge *merged, int section, ddataptr pathlist, int numcorner)
+{
+    ddataptr testddata;
+    double *delay;
+    int n, maxdelay;
+
+    if (merged->conns == NULL)
+	merged->conns = (connptr *)calloc(numconnects, sizeof(connptr));
+    if (merged->delay[section] == NULL) {
+	merged->delay[section] = (double *)malloc(numconnects * sizeof(double));
+	merged->corner[section] = (int *)malloc(numconnects * sizeof(int));
+	for (n = 0; n < numconnects; n++)
+	    merged->delay[section][n] = INITVAL;
+    }
+    delay = merged->delay[section];
+    maxdelay = ((section == REG_MAX) || (section == PIN_MAX)) ? 1 : 0;
 
-	if (c[1] == '\0') {
-	    fprintf(stderr, "ERROR: Driver not found for net %s\n", testnet->name);
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	n = testddata->backtrace->receiver->index;
+	if ((n < 0) || (fabs(testddata->skew) >= -INITVAL / 2)) continue;
+	if ((delay[n] == INITVAL) ||
+		(maxdelay && (testddata->delay > delay[n])) ||
+		(!maxdelay && (testddata->delay < delay[n]))) {
+	    delay[n] = testddata->delay;
+	    merged->corner[section][n] = numcorner;
+	    merged->conns[n] = testddata->backtrace->receiver;
 	}
+    }
+}
 
-        /* Load in .dly file is in pF, but we keep fF in loadr/loadf */
-        testnet->loadr = (strtod(saveptr, NULL)) * 1e3;
-        testnet->loadf = testnet->loadr;
-
-        result = fgets(c, 128, fdly);
-	if (result == NULL) break;
-
-        while (c[0] != '\n') {
-            if (debug == 1) fprintf(stdout, "\t%s\n", c);
+/*--------------------------------------------------------------*/
+/* Compare two endpoints by their delay, for qsort():  largest	*/
+/* first for compare_delay_max(), smallest first for		*/
+/* compare_delay_min().						*/
+/*--------------------------------------------------------------*/
 
-            //separate receiver name and delay value
-            strtok_r(c, " ", &saveptr);
-	    if (debug == 1) {
-                fprintf(stdout, "\tDelay: %s\n", saveptr);
-                fprintf(stdout, "\tRxer Name: %s\n", c);
-	    }
-            strtok_r(c, "/", &saveptr2);
-	    if (debug == 1) {
-                fprintf(stdout, "\tRxer Name: %s\n", c);
-                fprintf(stdout, "\tRxer Name: %s\n", saveptr2);
-                fprintf(stdout, "\tDelay: %f\n", strtof(saveptr, NULL));
-	    }
+double *sortdelay;	/* Delay of the endpoints being sorted */
 
-            for (i = 0; i < testnet->fanout; i++) {
+int
+compare_delay_max(const void *a, const void *b)
+{
+    double da = sortdelay[*(int *)a], db = sortdelay[*(int *)b];
 
-                testconn = testnet->receivers[i];
+    return (da > db) ? -1 : (da < db) ? 1 : (*(int *)a - *(int *)b);
+}
 
-                if (testnet->type == OUTTERM) {
-		    if (debug == 1)
-                        fprintf(stdout, "\tNet connects to output and has no "
-				"receiving instance pin\n");
-                    testconn->icDelay = strtod(saveptr, NULL);
-                } else {
-		    if (debug == 1)
-                        fprintf(stdout, "\trefinstname: %s\n", testconn->refinst->name);
+int
+compare_delay_min(const void *a, const void *b)
+{
+    double da = sortdelay[*(int *)a], db = sortdelay[*(int *)b];
 
-                    if (!strcmp(testconn->refinst->name, c)) {
+    return (da < db) ? -1 : (da > db) ? 1 : (*(int *)a - *(int *)b);
+}
 
-                        testconn->icDelay = strtod(saveptr, NULL);
-                        break;
-                    }
-                }
-		if (debug == 1)
-                    fprintf(stdout, "\tName: %s\n", c);
-            }
+/*--------------------------------------------------------------*/
+/* Print the worst endpoints over all corners to "file":  for	*/
+/* each report section, the "numreport" endpoints of worst	*/
+/* delay, each with the corner where the delay is worst, and	*/
+/* the result of the section as in print_paths_result().	*/
+/*--------------------------------------------------------------*/
 
-            result = fgets(c, 128, fdly);
-	    if (result == NULL) break;
-            numRxers += 1;
-        }
-	if (result == NULL) break;
+void
+corner_report(FILE *file, corner *corners, int numcorners, cornermerge *merged,
+		int numreport, double period)
+{
+    connptr endconn;
+    double *delay;
+    int *ends, section, maxdelay, numends, n, i;
+    char badtiming;
+    static char *titles[4] = {"register-to-register maximum",
+		"register-to-register minimum",
+		"pin-to-register and register-to-pin maximum",
+		"pin-to-register and register-to-pin minimum"};
+
+    fprintf(file, "\nWorst over %d corners:", numcorners);
+    for (i = 0; i < numcorners; i++)
+	fprintf(file, " %s", corners[i].name);
+    fprintf(file, "\n");
 
-        if (numRxers != testnet->fanout) {
-	    if (numRxers != 1 || testnet->fanout > 0 || testnet->type != OUTTERM)
-		fprintf(stderr, "ERROR: Net %s had %d receiver%s in delay file, "
-			" but expected a fanout of %d\n", testnet->name,
-			numRxers, (numRxers == 1) ? "" : "s",
-			testnet->fanout);
-        }
+    ends = (int *)malloc((numconnects + 1) * sizeof(int));
+    for (section = REG_MAX; section <= PIN_MIN; section++) {
+	delay = merged->delay[section];
+	maxdelay = ((section == REG_MAX) || (section == PIN_MAX)) ? 1 : 0;
+	numends = 0;
+	for (n = 0; delay && (n < numconnects); n++)
+	    if (delay[n] != INITVAL)
+		ends[numends++] = n;
+	sortdelay = delay;
+	qsort(ends, numends, sizeof(int), (maxdelay) ?
+		(__compar_fn_t)compare_delay_max : (__compar_fn_t)compare_delay_min);
+
+	fprintf(file, "\nTop %d %s delay endpoints:\n",
+		(numends >= numreport) ? numreport : numends, titles[section]);
+	badtiming = 0;
+	for (i = 0; i < numends; i++) {
+	    n = ends[i];
+	    if ((section == REG_MAX) && (period > 0.0) && (period - delay[n] < 0.0))
+		badtiming = 1;
+	    if ((section == REG_MIN) && (delay[n] < 0.0)) badtiming = 1;
+	    if (i >= numreport) continue;
+	    endconn = merged->conns[n];
+	    if (endconn->refinst != NULL)
+		fprintf(file, "Endpoint %s/%s", endconn->refinst->name,
+			endconn->refpin->name);
+	    else
+		fprintf(file, "Endpoint output pin %s", endconn->refnet->name);
+	    fprintf(file, " delay %g ps (corner %s)", delay[n],
+			corners[merged->corner[section][n]].name);
+	    if ((section == REG_MAX) && (period > 0.0))
+		fprintf(file, "   Slack = %g ps", period - delay[n]);
+	    fprintf(file, "\n");
+	}
 
-        token = advancetokennocont(fdly, '\n');
-    }
-    if (result == NULL) {
-	fprintf(stderr, "ERROR: Unexpected end-of-file while reading delay file.\n");
+	if (section == REG_MAX) {
+	    if (period > 0.0) {
+		if (badtiming)
+		    fprintf(file, "ERROR:  Design fails timing requirements"
+				" at some corner.\n");
+		else
+		    fprintf(file, "Design meets timing requirements at all corners.\n");
+	    }
+	    else if (numends > 0)
+		fprintf(file, "Computed maximum clock frequency (zero margin) = %g MHz"
+			" (corner %s)\n", 1.0E6 / delay[ends[0]],
+			corners[merged->corner[section][ends[0]]].name);
+	}
+	else if (section == REG_MIN) {
+	    if (badtiming)
+		fprintf(file, "ERROR:  Design fails minimum hold timing at some corner.\n");
+	    else
+		fprintf(file, "Design meets minimum hold timing at all corners.\n");
+	}
+	fprintf(file, "-----------------------------------------\n");
     }
+    fprintf(file, "\n");
+    free(ends);
 }
 
 /*--------------------------------------------------------------*/
-/* Print a path component                                       */
-/* (code contributed by Karl-Filip Faxen)			*/
+/* Extracted timing model (option -A).  The module is written	*/
+/* as one liberty cell, with its arcs characterized by timing	*/
+/* the netlist over a sweep of input transitions and output	*/
+/* loads.							*/
+/*--------------------------------------------------------------*/
+
+typedef struct _etmclock {
+   connptr  port;		/* Clock input of the module */
+   int      numflops;
+   connptr  *flops;		/* Flop clock pins reached from the port */
+   int      *slot;		/* Position in flops[] by connection, or -1 */
+   double   *arrival;		/* Clock arrival at each flop, [flop][slew] */
+   double   *trans;		/* Clock transition at each flop, [flop][slew] */
+} etmclock;
+
+/*--------------------------------------------------------------*/
+/* Add connection "start" to the start points of the timing	*/
+/* graph "graph", with arrival time "arrival" and transition	*/
+/* "trans".  If "start" is NULL, clear all of the start points	*/
+/* instead.							*/
 /*--------------------------------------------------------------*/
 
 void
-print_path_component(int netFWidth, int instFWidth, int pinFWidth, int recvFWidth, 
-                     btptr backtrace, FILE *file)
+etm_seed(tgraphptr graph, connptr start, double arrival, double trans)
 {
-    // Return immediately if we have niether a driver or a receiver instance
-    if (backtrace->receiver->refnet->driver == NULL &&
-		backtrace->receiver->refinst == NULL) return;
+    short srcdir;
+    int n, e;
 
-    fprintf(file, " %8.1f ps", backtrace->delay);
-    if (backtrace->receiver->refnet != NULL) {
-        netptr net = backtrace->receiver->refnet;
-        fprintf(file, "  %*s: ", netFWidth, net->name);
-        if (net->driver != NULL) {   // If the driver exists, it has a refinst
-            fprintf(file, "%*s/%*s",
-                    instFWidth, net->driver->refinst->name,
-                    -pinFWidth, net->driver->refpin->name);
-        }
-        else {
-            fprintf(file, "%*s", instFWidth + pinFWidth + 1, "");
-        }
+    if (start == NULL) {
+	for (n = 0; n < 2 * graph->numnodes; n++)
+	    graph->pred[n] = NOPRED;
+	return;
     }
-    fprintf(file, " -> ");
-    if (backtrace->receiver->refinst != NULL) {
-        fprintf(file, "%*s/%s",
-                recvFWidth, backtrace->receiver->refinst->name,
-                              backtrace->receiver->refpin->name);
+    if (start->refpin)
+	srcdir = (start->refpin->refcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
+    else
+	srcdir = EITHER;
+    n = start->index;
+    graph->launch[n] = 0.0;
+    for (e = 0; e < 2; e++) {
+	if (!(srcdir & ((e == 0) ? RISING : FALLING))) continue;
+	graph->arrival[2 * n + e] = arrival;
+	graph->trans[2 * n + e] = trans;
+	graph->pred[2 * n + e] = -1;
     }
-    else if (backtrace->receiver->refnet)
-        fprintf(file, "%s", backtrace->receiver->refnet->name);
-
-    fprintf(file, "\n");
 }
 
 /*--------------------------------------------------------------*/
-/* Print a path                                                 */
-/* (code contributed by Karl-Filip Faxen)			*/
+/* Time all paths from the start points set by etm_seed().	*/
+/* Return the list of paths, one for each endpoint reached.	*/
+/* The records are in pathmem.					*/
 /*--------------------------------------------------------------*/
 
-void
-print_path(btptr backtrace, FILE *file)
+ddataptr
+etm_sweep(tgraphptr graph, char minmax)
 {
-    int netFWidth = 0;
-    int instFWidth = 0;
-    int pinFWidth = 0;
-    int recvFWidth = 0;
-    btptr curr = backtrace, prev = NULL;
+    ddataptr pathlist = NULL;
 
-    // The back trace is last entry first, so we do one pointer reversal to
-    // get it in first entry first order, then we reverse it back again.
+    graph_sweep(graph, minmax);
+    graph_capture(graph, &pathlist, minmax, &pathmem, CAPTURE_ALL);
+    return pathlist;
+}
 
-    while (curr != NULL) {
-        // Find max length of net name, inst name and pin name
-        netptr net = curr->receiver->refnet;
-        if (net != NULL) {
-            int namelen = strlen(net->name);
-            if (namelen > netFWidth) netFWidth = namelen;
-            if (net->driver != NULL) { // If driver exists, it has an instance
-                int instlen = strlen(net->driver->refinst->name);
-                if (instlen > instFWidth) instFWidth = instlen;
-                int pinlen = strlen(net->driver->refpin->name);
-                if (pinlen > pinFWidth) pinFWidth = pinlen;
-            }
-        }
-        // Find max length of receiving inst name
-        if (curr->receiver->refinst != NULL) {
-            int instlen = strlen(curr->receiver->refinst->name);
-            if (instlen > recvFWidth) recvFWidth = instlen;
-        }
-        // Do the first pointer reversal
-        btptr tmp = curr->next;
-        curr->next = prev;
-        prev = curr;
-        curr = tmp;
-    }
+/*--------------------------------------------------------------*/
+/* Time all paths from connection "start" alone, with		*/
+/* transition "trans" at the start.				*/
+/*--------------------------------------------------------------*/
 
-    curr = prev;
-    prev = NULL;
+ddataptr
+etm_search(tgraphptr graph, connptr start, double trans, char minmax)
+{
+    etm_seed(graph, NULL, 0.0, 0.0);
+    etm_seed(graph, start, 0.0, trans);
+    return etm_sweep(graph, minmax);
+}
 
-    while (curr != NULL) {
-        print_path_component(netFWidth, instFWidth, pinFWidth, recvFWidth, curr, file);
-        // Do the second pointer reversal
-        btptr tmp = curr->next;
-        curr->next = prev;
-        prev = curr;
-        curr = tmp;
+/*--------------------------------------------------------------*/
+/* Set the extra load on each module output to "load" (in	*/
+/* place of the load of option -L, "outload"), or restore the	*/
+/* loads saved in "saved" if "load" is negative.  The tables	*/
+/* of the gates driving the outputs are collapsed again at the	*/
+/* new load when next used.					*/
+/*--------------------------------------------------------------*/
+
+void
+etm_set_loads(connptr outputlist, double *saved, double load, double outload)
+{
+    connptr testconn;
+    netptr testnet;
+    int i = 0;
+
+    for (testconn = outputlist; testconn; testconn = testconn->next, i += 2) {
+	testnet = testconn->refnet;
+	if (load < 0.0) {
+	    testnet->loadr = saved[i];
+	    testnet->loadf = saved[i + 1];
+	}
+	else {
+	    testnet->loadr = saved[i] - outload + load;
+	    testnet->loadf = saved[i + 1] - outload + load;
+	}
+	if (testnet->driver && testnet->driver->refinst)
+	    collapse_instance_tables(testnet->driver->refinst);
     }
-    fprintf(file, "\n");
 }
 
 /*--------------------------------------------------------------*/
-/* Given a list of paths, find the clock at the source and the	*/
-/* destination (if neither is a pin), and compute the clock	*/
-/* skew between them.  Also compute the setup or hold at the	*/
-/* destination.	 Save these values in the path record.		*/
+/* Make lookup table "values" (size1 x size2, row major) non-	*/
+/* decreasing in both indices, by raising each value to the	*/
+/* largest of those at smaller index values.  The clock to	*/
+/* output delay of some flops falls again at the slowest clock	*/
+/* transitions in the liberty tables, which a timing model of	*/
+/* the module should not pass on:  keeping the worst value	*/
+/* leaves the model pessimistic.				*/
 /*--------------------------------------------------------------*/
 
 void
-find_clock_skews(ddataptr pathlist, char minmax)
+etm_monotone(double *values, int size1, int size2)
 {
-    connptr testconn, thisconn;
-    instptr  testinst;
-
-    ddataptr testddata, srcddata, freeddata;
-    ddataptr clocklist, clock2list;
-    btptr    backtrace, freebt, pathbt, btcommon;
-    btptr    selectedsource, selecteddest;
-
-    short srcdir, destdir;		// Signal direction in/out
-    double setupdelay, holddelay;
-    unsigned char result;
-    char	clk_invert, clk_sense_inv;
-
-    clocklist = NULL;
-    clock2list = NULL;
-    
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
+    int i, j, n;
+
+    for (i = 0; i < size1; i++)
+	for (j = 0; j < size2; j++) {
+	    n = i * size2 + j;
+	    if ((i > 0) && (values[n - size2] > values[n]))
+		values[n] = values[n - size2];
+	    if ((j > 0) && (values[n - 1] > values[n]))
+		values[n] = values[n - 1];
+	}
+}
 
-        // Find the end of the linked list, which is the path start.
-        for (pathbt = testddata->backtrace; pathbt->next; pathbt = pathbt->next);
-	thisconn = pathbt->receiver;
+/*--------------------------------------------------------------*/
+/* Write lookup table "values" (size1 x size2, row major) of	*/
+/* template "template" as liberty group "group".		*/
+/*--------------------------------------------------------------*/
 
-        if (thisconn && thisconn->refpin) {
-            // Find the sources of the clock at the path start.  Create
-	    // a tree of backtraces from thisconn to all clock sources,
-	    // and return clocklist, which is a list of the sources.
+void
+etm_write_table(FILE *flib, char *group, char *template, double *values,
+		int size1, int size2)
+{
+    int i, j;
 
-            find_clock_source(thisconn, &clocklist, NULL, srcdir, (unsigned char)1);
+    fprintf(flib, "        %s (%s) {\n", group, template);
+    fprintf(flib, "          values (");
+    for (i = 0; i < size1; i++) {
+	fprintf(flib, "%s\"", (i > 0) ? ", \\\n                  " : "");
+	for (j = 0; j < size2; j++)
+	    fprintf(flib, "%s%g", (j > 0) ? ", " : "", values[i * size2 + j]);
+	fprintf(flib, "\"");
+    }
+    fprintf(flib, ");\n        }\n");
+}
 
-            // Calculate the worst-case transition times to testlink on
-	    // each clocklist backtrace.
+/*--------------------------------------------------------------*/
+/* Write the liberty index "name" of "n" values "index".	*/
+/*--------------------------------------------------------------*/
 
-            find_clock_transition(clocklist, thisconn, srcdir, minmax,
-			(unsigned char)1);
-	}
+void
+etm_write_index(FILE *flib, char *name, double *index, int n)
+{
+    int i;
 
-        // Copy last backtrace delay to testddata.
-        testddata->delay = testddata->backtrace->delay;
-        testddata->trans = testddata->backtrace->trans;
-        testinst = testddata->backtrace->receiver->refinst;
-        selecteddest = selectedsource = NULL;
+    fprintf(flib, "    %s (\"", name);
+    for (i = 0; i < n; i++)
+	fprintf(flib, "%s%g", (i > 0) ? ", " : "", index[i]);
+    fprintf(flib, "\");\n");
+}
 
-        if (testinst != NULL) {
-            // Find the sources of the clock at the path end
-            destdir = (testinst->refcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
-            testconn = find_register_clock(testinst);
-            // If testconn is NULL, this is not a register (latch, maybe?)
-            if (testconn == NULL) continue;
+/*--------------------------------------------------------------*/
+/* Write an extracted timing model of the module to liberty	*/
+/* file "filename", as cell "cellname".  The module inputs and	*/
+/* outputs are the cell pins, and the arcs are:			*/
+/*								*/
+/*  - input to output:  combinational delay and output		*/
+/*    transition, from the maximum delay paths;			*/
+/*  - clock input to output:  clock to output delay and		*/
+/*    transition, through the flops clocked from the input;	*/
+/*  - input to clock input:  setup (from the maximum delay	*/
+/*    paths) and hold (from the minimum delay paths) of the	*/
+/*    flops that the input reaches, as seen at the clock input.	*/
+/*								*/
+/* Delay and transition tables are indexed by input transition	*/
+/* and output load, and the constraint tables by clock and	*/
+/* data transition.  The index values are those of the first	*/
+/* delay table found on the instances of the netlist.  The	*/
+/* load on the outputs replaces that of option -L ("outload").	*/
+/* Delay and transition tables do not decrease with either	*/
+/* index (see etm_monotone()).  The capacitance of an input is	*/
+/* that of the cell pins that it drives, without the wiring.	*/
+/* Module inputs are clocks if they reach a flop clock pin.	*/
+/* Rise and fall values are not told apart:  each table holds	*/
+/* the worst of both.  Latches are not modeled.			*/
+/*								*/
+/* Paths are timed by sweeps over the timing graph "graph",	*/
+/* whose arrivals are overwritten.  Return 1 on success, 0 if	*/
+/* the file cannot be written.					*/
+/*--------------------------------------------------------------*/
 
-            // Find the connection that is common to both clocks
-            result = find_clock_source(testconn, &clock2list, NULL, destdir,
-			(unsigned char)2);
+int
+etm_write(char *filename, char *cellname, tgraphptr graph, instptr instlist,
+		connptr inputlist, connptr outputlist, double outload)
+{
+    FILE *flib;
+    instptr testinst;
+    connptr testconn, inconn, outconn, clkconn, endconn;
+    ddataptr pathlist, testddata;
+    btptr bt;
+    etmclock *clocks;
+    lutableptr reftable = NULL;
+    pinptr dpin;
+    double *slews, *loads, *saved, *values, *delays, *trans;
+    double *setups, *holds, value, arrival, capr, capf;
+    double defslews[] = {10.0, 50.0, 200.0, 500.0, 1000.0};
+    double defloads[] = {1.0, 10.0, 50.0, 100.0, 200.0};
+    int *outslot, numslews, numloads, numins, numouts, numclocks;
+    int c, f, i, j, k, o, n, tsize, csize;
+    char isclock;
+
+    flib = fopen(filename, "w");
+    if (flib == NULL) {
+	fprintf(stderr, "Cannot open %s for writing\n", filename);
+	return 0;
+    }
 
-	    if ((result == (unsigned char)0) && (clocklist != NULL)) {
-		// If both paths end on the same input net, then there
-		// is no connection pointer, so deal with that separately.
+    // Use the index values of the first delay table in the netlist
 
-		if (clocklist->backtrace->receiver->refnet !=
-			    	clock2list->backtrace->receiver->refnet) {
+    for (testinst = instlist; testinst && !reftable; testinst = testinst->next)
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	    if (testconn->refpin && testconn->refpin->propdelr &&
+			(testconn->refpin->propdelr->size1 > 1) &&
+			(testconn->refpin->propdelr->size2 > 1)) {
+		reftable = testconn->refpin->propdelr;
+		break;
+	    }
+    if (reftable) {
+	slews = reftable->idx1.times;
+	numslews = reftable->size1;
+	loads = reftable->idx2.caps;
+	numloads = reftable->size2;
+    }
+    else {
+	slews = defslews;
+	numslews = sizeof(defslews) / sizeof(double);
+	loads = defloads;
+	numloads = sizeof(defloads) / sizeof(double);
+    }
+    tsize = numslews * numloads;
+    csize = numslews * numslews;
+
+    numins = numouts = 0;
+    for (testconn = inputlist; testconn; testconn = testconn->next) numins++;
+    for (testconn = outputlist; testconn; testconn = testconn->next) numouts++;
+    outslot = (int *)malloc(numconnects * sizeof(int));
+    for (n = 0; n < numconnects; n++) outslot[n] = -1;
+    o = 0;
+    for (testconn = outputlist; testconn; testconn = testconn->next)
+	outslot[testconn->index] = o++;
+
+    saved = (double *)malloc((2 * numouts + 1) * sizeof(double));
+    i = 0;
+    for (testconn = outputlist; testconn; testconn = testconn->next) {
+	saved[i++] = testconn->refnet->loadr;
+	saved[i++] = testconn->refnet->loadf;
+    }
 
-		    // Warn about asynchronous clock sources
-		    if (verbose > 1) {
-		 	fflush(stdout);
-			fprintf(stderr, "Independent clock nets \"%s\" and \"%s\""
-					" drive related gates!\n",
-					testconn->refnet->name,
-					thisconn->refnet->name);
+    // Find the clock inputs and the arrival of each clock at its flops
+
+    clocks = (etmclock *)malloc((numins + 1) * sizeof(etmclock));
+    numclocks = 0;
+    for (inconn = inputlist; inconn; inconn = inconn->next) {
+	for (j = 0; j < numslews; j++) {
+	    pathlist = etm_search(graph, inconn, slews[j], MAXIMUM_TIME);
+	    if (j == 0) {
+		for (f = 0, testddata = pathlist; testddata; testddata = testddata->next) {
+		    endconn = testddata->backtrace->receiver;
+		    if (endconn->refpin && (endconn->refpin->type & DFFCLK)) f++;
+		}
+		if (f == 0) {
+		    pathpool_reset(&pathmem);
+		    break;
+		}
+		clocks[numclocks].port = inconn;
+		clocks[numclocks].numflops = f;
+		clocks[numclocks].flops = (connptr *)malloc(f * sizeof(connptr));
+		clocks[numclocks].slot = (int *)malloc(numconnects * sizeof(int));
+		for (n = 0; n < numconnects; n++) clocks[numclocks].slot[n] = -1;
+		clocks[numclocks].arrival = (double *)malloc(f * numslews * sizeof(double));
+		clocks[numclocks].trans = (double *)malloc(f * numslews * sizeof(double));
+		for (f = 0, testddata = pathlist; testddata; testddata = testddata->next) {
+		    endconn = testddata->backtrace->receiver;
+		    if (endconn->refpin && (endconn->refpin->type & DFFCLK)) {
+			clocks[numclocks].flops[f] = endconn;
+			clocks[numclocks].slot[endconn->index] = f++;
 		    }
-		    clk_invert = -1;
 		}
-            }
-
-	    // If clocklist is NULL then this is an input and there is
-	    // no way to compute relative to a common clock, because
-	    // there is no common clock.
-
-	    if (clocklist != NULL) {
-		// Find clock arrival times from common clock point.  Note that
-		// the check is opposite to what is computed for the source;  if
-		// maximum time was used to find clock-to-source, then minimum
-		// time is used to find clock-to-destination.
-
-		btcommon = find_common_clock(clock2list, clocklist);
-                find_clock_transition(clock2list, testconn,
-				(btcommon) ? btcommon->dir : RISING,
-				~minmax, (unsigned char)2);
-
-		// selectedsource is the end of the btcommon backtrace
-		for (selectedsource = (btcommon) ? btcommon : clocklist->backtrace;
-				selectedsource->next;
-				selectedsource = selectedsource->next);
-		// selecteddest is the end of the clock2list backtrace
-		for (selecteddest = clock2list->backtrace; selecteddest->next;
-				selecteddest = selecteddest->next);
-
-                // Add or subtract difference in arrival times between source and
-                // destination clocks
-
-                testddata->skew = selectedsource->delay - selecteddest->delay -
-					((btcommon) ? btcommon->delay : 0.0);
-                testddata->delay += testddata->skew;
+		numclocks++;
 	    }
-	    else if (clock2list) {
-		// Still need to know destination's clock source to
-		// calculate setup or hold time.
-		for (selecteddest = clock2list->backtrace; selecteddest->next;
-				selecteddest = selecteddest->next);
-		testddata->skew = 0.0;
+	    c = numclocks - 1;
+	    for (testddata = pathlist; testddata; testddata = testddata->next) {
+		bt = testddata->backtrace;
+		f = clocks[c].slot[bt->receiver->index];
+		if (f < 0) continue;
+		clocks[c].arrival[f * numslews + j] = bt->delay;
+		clocks[c].trans[f * numslews + j] = bt->trans;
 	    }
+	    pathpool_reset(&pathmem);
+	}
+    }
 
-            if (minmax == MAXIMUM_TIME) {
-                // Add setup time for destination clocks
-                setupdelay = calc_setup_time(testddata->trans,
-                                        testddata->backtrace->receiver->refpin,
-                                        selecteddest->trans,
-                                        testddata->backtrace->dir, minmax);
-                testddata->setup = setupdelay;
-            }
-            else {
-                // Subtract hold time for destination clocks (note that hold times
-		// are defined as typically negative values in the liberty format)
-                holddelay = calc_hold_time(testddata->trans,
-                                        testddata->backtrace->receiver->refpin,
-                                        selecteddest->trans,
-                                        testddata->backtrace->dir, minmax);
-                testddata->setup = holddelay;
-            }
-            testddata->delay += testddata->setup;
-
-            if (verbose > 1)
-                fprintf(stdout, "Path terminated on flop \"%s\" input with max delay %g ps\n",
-                                testconn->refinst->name, testddata->delay);
-
-            for (backtrace = testddata->backtrace; backtrace->next;
-                                backtrace = backtrace->next) {
-                if (verbose > 1)
-                    fprintf(stdout, "   %g (%s) %s/%s -> %s/%s\n",
-                                backtrace->delay,
-                                backtrace->receiver->refnet->name,
-                                backtrace->receiver->refnet->driver->refinst->name,
-                                backtrace->receiver->refnet->driver->refpin->name,
-                                backtrace->receiver->refinst->name,
-                                backtrace->receiver->refpin->name);
-            }
-            if (verbose > 1)
-                fprintf(stdout, "   000.000 (%s) %s/%s -> %s/%s\n",
-                                backtrace->receiver->refnet->name,
-                                backtrace->receiver->refinst->name,
-                                backtrace->receiver->refpin->name,
-                                backtrace->receiver->refinst->name,
-                                backtrace->receiver->refinst->out_connects->refpin->name);
+    fprintf(flib, "/* Extracted timing model of module %s, written by vesta */\n\n",
+		cellname);
+    fprintf(flib, "library (%s_etm) {\n", cellname);
+    fprintf(flib, "  delay_model : table_lookup;\n");
+    fprintf(flib, "  time_unit : \"1ps\";\n");
+    fprintf(flib, "  capacitive_load_unit (1,ff);\n\n");
+    fprintf(flib, "  lu_table_template (etm_delay) {\n");
+    fprintf(flib, "    variable_1 : input_net_transition;\n");
+    fprintf(flib, "    variable_2 : total_output_net_capacitance;\n");
+    etm_write_index(flib, "index_1", slews, numslews);
+    etm_write_index(flib, "index_2", loads, numloads);
+    fprintf(flib, "  }\n");
+    fprintf(flib, "  lu_table_template (etm_constraint) {\n");
+    fprintf(flib, "    variable_1 : related_pin_transition;\n");
+    fprintf(flib, "    variable_2 : constrained_pin_transition;\n");
+    etm_write_index(flib, "index_1", slews, numslews);
+    etm_write_index(flib, "index_2", slews, numslews);
+    fprintf(flib, "  }\n\n");
+    fprintf(flib, "  cell (%s) {\n", cellname);
+
+    // Inputs, with their setup and hold arcs
+
+    setups = (double *)malloc(numclocks * csize * sizeof(double));
+    holds = (double *)malloc(numclocks * csize * sizeof(double));
+    for (inconn = inputlist; inconn; inconn = inconn->next) {
+	isclock = 0;
+	for (c = 0; c < numclocks; c++)
+	    if (clocks[c].port == inconn) isclock = 1;
+	for (n = 0; n < numclocks * csize; n++) {
+	    setups[n] = INITVAL;
+	    holds[n] = INITVAL;
+	}
 
-            if (selecteddest != NULL && selectedsource != NULL) {
-                if (verbose > 1) {
-                    if (selectedsource->receiver->refnet != selecteddest->receiver->refnet) {
-                        fprintf(stdout, "   %g %s to %s clock skew\n",
-                                selecteddest->delay - selectedsource->delay
-				+ ((btcommon) ? btcommon->delay : 0.0),
-                                selectedsource->receiver->refnet->name,
-                                selecteddest->receiver->refnet->name);
-                    }
-                }
+	for (k = 0; k < 2; k++) {
+	    values = (k == 0) ? setups : holds;
+	    for (j = 0; j < numslews; j++) {
+		pathlist = etm_search(graph, inconn, slews[j], (k == 0) ? MAXIMUM_TIME :
+			MINIMUM_TIME);
+		for (testddata = pathlist; testddata; testddata = testddata->next) {
+		    bt = testddata->backtrace;
+		    endconn = bt->receiver;
+		    dpin = endconn->refpin;
+		    if (!dpin || !(dpin->type & DFFIN)) continue;
+		    clkconn = find_register_clock(endconn->refinst);
+		    if (clkconn == NULL) continue;
+		    for (c = 0; c < numclocks; c++) {
+			f = clocks[c].slot[clkconn->index];
+			if (f < 0) continue;
+			for (i = 0; i < numslews; i++) {
+			    arrival = clocks[c].arrival[f * numslews + i];
+			    if (k == 0)
+				value = bt->delay + calc_setup_time(bt->trans, dpin,
+					clocks[c].trans[f * numslews + i], bt->dir,
+					MAXIMUM_TIME) - arrival;
+			    else
+				value = arrival + calc_hold_time(bt->trans, dpin,
+					clocks[c].trans[f * numslews + i], bt->dir,
+					MINIMUM_TIME) - bt->delay;
+			    n = c * csize + i * numslews + j;
+			    if ((values[n] == INITVAL) || (value > values[n]))
+				values[n] = value;
+			}
+		    }
+		}
+		pathpool_reset(&pathmem);
+	    }
+	}
 
-                /* Check if the flops have the same clock sense */
-                /* (both are clock rising edge or both are clock falling edge type) */
+	fprintf(flib, "    pin (%s) {\n", inconn->refnet->name);
+	fprintf(flib, "      direction : input;\n");
+	if (isclock) fprintf(flib, "      clock : true;\n");
+	capr = capf = 0.0;
+	for (n = 0; n < inconn->refnet->fanout; n++) {
+	    dpin = inconn->refnet->receivers[n]->refpin;
+	    if (dpin == NULL) continue;		/* Module output */
+	    capr += dpin->capr;
+	    capf += dpin->capf;
+	}
+	fprintf(flib, "      capacitance : %g;\n", (capr > capf) ? capr : capf);
+	for (c = 0; c < numclocks; c++) {
+	    if (setups[c * csize] == INITVAL) continue;
+	    for (k = 0; k < 2; k++) {
+		values = ((k == 0) ? setups : holds) + c * csize;
+		for (n = 0; n < csize; n++)
+		    if (values[n] == INITVAL) values[n] = 0.0;
+		fprintf(flib, "      timing () {\n");
+		fprintf(flib, "        related_pin : \"%s\";\n",
+			clocks[c].port->refnet->name);
+		fprintf(flib, "        timing_type : %s;\n", (k == 0) ? "setup_rising" :
+			"hold_rising");
+		etm_write_table(flib, "rise_constraint", "etm_constraint", values,
+			numslews, numslews);
+		etm_write_table(flib, "fall_constraint", "etm_constraint", values,
+			numslews, numslews);
+		fprintf(flib, "      }\n");
+	    }
+	}
+	fprintf(flib, "    }\n");
+    }
+    free(setups);
+    free(holds);
+
+    // Delay and transition into each output, from each input and clock,
+    // at each load (one table of each per input per output)
+
+    delays = (double *)malloc((numins + 1) * (numouts + 1) * tsize * sizeof(double));
+    trans = (double *)malloc((numins + 1) * (numouts + 1) * tsize * sizeof(double));
+    for (n = 0; n < (numins + 1) * (numouts + 1) * tsize; n++) delays[n] = INITVAL;
+
+    for (k = 0; k < numloads; k++) {
+	etm_set_loads(outputlist, saved, loads[k], outload);
+	for (i = 0, inconn = inputlist; inconn; inconn = inconn->next, i++) {
+	    for (c = 0; c < numclocks; c++)
+		if (clocks[c].port == inconn) break;
+	    for (j = 0; j < numslews; j++) {
+		if (c < numclocks) {
+		    // Clock to output, through all of the flops at once
+		    etm_seed(graph, NULL, 0.0, 0.0);
+		    for (f = 0; f < clocks[c].numflops; f++)
+			etm_seed(graph, clocks[c].flops[f],
+				clocks[c].arrival[f * numslews + j],
+				clocks[c].trans[f * numslews + j]);
+		    pathlist = etm_sweep(graph, MAXIMUM_TIME);
+		}
+		else
+		    pathlist = etm_search(graph, inconn, slews[j], MAXIMUM_TIME);
+		for (testddata = pathlist; testddata; testddata = testddata->next) {
+		    bt = testddata->backtrace;
+		    o = outslot[bt->receiver->index];
+		    if (o < 0) continue;
+		    n = (i * numouts + o) * tsize + j * numloads + k;
+		    if ((delays[n] == INITVAL) || (bt->delay > delays[n])) {
+			delays[n] = bt->delay;
+			trans[n] = bt->trans;
+		    }
+		}
+		pathpool_reset(&pathmem);
+	    }
+	}
+    }
+    etm_set_loads(outputlist, saved, -1.0, outload);
+
+    // Outputs, with their delay arcs
+
+    for (o = 0, outconn = outputlist; outconn; outconn = outconn->next, o++) {
+	fprintf(flib, "    pin (%s) {\n", outconn->refnet->name);
+	fprintf(flib, "      direction : output;\n");
+	for (i = 0, inconn = inputlist; inconn; inconn = inconn->next, i++) {
+	    n = (i * numouts + o) * tsize;
+	    if (delays[n] == INITVAL) continue;
+	    for (c = 0; c < numclocks; c++)
+		if (clocks[c].port == inconn) break;
+	    for (j = 0; j < tsize; j++)
+		if (delays[n + j] == INITVAL) {
+		    delays[n + j] = 0.0;
+		    trans[n + j] = 0.0;
+		}
+	    etm_monotone(delays + n, numslews, numloads);
+	    etm_monotone(trans + n, numslews, numloads);
+	    fprintf(flib, "      timing () {\n");
+	    fprintf(flib, "        related_pin : \"%s\";\n", inconn->refnet->name);
+	    if (c < numclocks)
+		fprintf(flib, "        timing_type : rising_edge;\n");
+	    else
+		fprintf(flib, "        timing_sense : non_unate;\n");
+	    etm_write_table(flib, "cell_rise", "etm_delay", delays + n, numslews, numloads);
+	    etm_write_table(flib, "cell_fall", "etm_delay", delays + n, numslews, numloads);
+	    etm_write_table(flib, "rise_transition", "etm_delay", trans + n, numslews,
+			numloads);
+	    etm_write_table(flib, "fall_transition", "etm_delay", trans + n, numslews,
+			numloads);
+	    fprintf(flib, "      }\n");
+	}
+	fprintf(flib, "    }\n");
+    }
+    fprintf(flib, "  }\n}\n");
+    fclose(flib);
 
-		if (backtrace->receiver->refinst == NULL)
-		    clk_sense_inv = 1;
-                else if ((testinst->refcell->type & CLK_SENSE_MASK) !=
-                                        (backtrace->receiver->refinst->refcell->type
-                                        & CLK_SENSE_MASK))
-                    clk_sense_inv = 1;
-                else
-                    clk_sense_inv = 0;
+    fprintf(stdout, "Timing model of %s written to %s:  %d inputs (%d clocks),"
+		" %d outputs.\n", cellname, filename, numins, numclocks, numouts);
 
-                /* If the two flops don't clock at the same time, then issue a  */
-                /* warning that the slack time loses half a clock period.       */
+    for (c = 0; c < numclocks; c++) {
+	free(clocks[c].flops);
+	free(clocks[c].slot);
+	free(clocks[c].arrival);
+	free(clocks[c].trans);
+    }
+    free(clocks);
+    free(delays);
+    free(trans);
+    free(saved);
+    free(outslot);
+    return 1;
+}
 
-                if ((verbose > 1) && (clk_invert != -1) && (clk_sense_inv != clk_invert)) {
-                    fprintf(stdout, "   Clocks are inverted relative to one another,\n");
-                    fprintf(stdout, "   implying a maximum propagation delay of 1/2 period.\n");
-                }
-            }
-            if (thisconn != NULL && testconn != NULL) {
-                if (verbose > 1) {
-                    if (minmax == MAXIMUM_TIME)
-                        fprintf(stdout, "   %g setup time at destination\n", setupdelay);
-                    else
-                        fprintf(stdout, "   %g hold time at destination\n", holddelay);
-                }
-            }
+/*--------------------------------------------------------------*/
+/* Run analysis pass "section" (REG_MAX, ...) of the timing	*/
+/* analysis "run":  find the paths from the register clocks	*/
+/* (REG_MAX, REG_MIN) or from the input pins (PIN_MAX,		*/
+/* PIN_MIN) with the engine selected, add the clock skews, and	*/
+/* report the worst paths.  The path records of the pass are	*/
+/* released before returning.					*/
+/*--------------------------------------------------------------*/
 
-            if (verbose > 1) fprintf(stdout, "\n");
-        }
-        else if (verbose > 1) {
-            fprintf(stdout, "Path terminated on output \"%s\" with max delay %g ps\n",
-                        testddata->backtrace->receiver->refnet->name, testddata->delay);
+void
+time_pass(timingrun *run, int section)
+{
+    static char *sumnames[4] = {"reg_to_reg_max", "reg_to_reg_min",
+		"pin_to_reg_max", "pin_to_reg_min"};
+    static char *sumtitles[4] = {"register-to-register maximum",
+		"register-to-register minimum",
+		"pin-to-register and register-to-pin maximum",
+		"pin-to-register and register-to-pin minimum"};
+    connlistptr startlist;
+    connptr     testconn;
+    tgraphptr   sgraph;
+    ddataptr    pathlist = NULL;
+    ddataptr    *orderedpaths;
+    char        *sumname, minmax, badtiming;
+    int         numpaths, numselect, numordered;
+    double      metric;
+
+    minmax = ((section == REG_MAX) || (section == PIN_MAX)) ?
+		MAXIMUM_TIME : MINIMUM_TIME;
+    startlist = ((section == REG_MAX) || (section == REG_MIN)) ?
+		run->clockconns : run->inputconns;
+    if (minmaxmode)
+	sgraph = (minmax == MAXIMUM_TIME) ? run->graph : run->mingraph;
+    else
+	sgraph = run->views[section];
 
-            backtrace = testddata->backtrace;
-            fprintf(stdout, "   %g (%s) %s/%s -> [output pin]\n",
-                        backtrace->delay,
-                        backtrace->receiver->refnet->name,
-                        backtrace->receiver->refnet->driver->refinst->name,
-                        backtrace->receiver->refnet->driver->refpin->name);
+    /* Clear the search state left by the last pass */
 
-            for (backtrace = backtrace->next; backtrace->next; backtrace = backtrace->next) {
-                fprintf(stdout, "   %g (%s) %s/%s -> %s/%s\n",
-                        backtrace->delay,
-                        backtrace->receiver->refnet->name,
-                        backtrace->receiver->refnet->driver->refinst->name,
-                        backtrace->receiver->refnet->driver->refpin->name,
-                        backtrace->receiver->refinst->name,
-                        backtrace->receiver->refpin->name);
-            }
-            fprintf(stdout, "   000.000 (%s) %s/%s -> %s/%s\n\n",
-                        backtrace->receiver->refnet->name,
-                        backtrace->receiver->refinst->name,
-                        backtrace->receiver->refpin->name,
-                        backtrace->receiver->refinst->name,
-                        backtrace->receiver->refinst->out_connects->refpin->name);
-        }
+    metric = (minmax == MAXIMUM_TIME) ? -1.0 : 1.0E50;
+    for (testconn = run->inputlist; testconn; testconn = testconn->next) {
+	testconn->tag = NULL;
+	testconn->metric = metric;
+    }
+    reset_all(run->netlist, minmax);
 
-        // Clean up clock2list backtraces
-	for (freeddata = clock2list; freeddata; freeddata = freeddata->next) {
-	    while (freeddata->backtrace != NULL) {
-		freebt = freeddata->backtrace;
-		testconn = freebt->receiver;
-		freeddata->backtrace = freeddata->backtrace->next;
-                freebt->refcnt--;
-		if (freebt->refcnt == 0) free(freebt);
-		else break;
-		if (testconn->visited != (unsigned char)2)
-		    break;
-		testconn->visited = (unsigned char)0;
-	    }
-	}
+    /* Number of paths kept for reporting (at least one, for the	*/
+    /* computed clock frequency)					*/
 
-        // Clean up clock2list
-        while (clock2list != NULL) {
-            freeddata = clock2list;
-            clock2list = clock2list->next;
-            free(freeddata);
-        }
+    numselect = (run->numpaths > 0) ? run->numpaths : 1;
 
-        // Free up clocklist backtraces
-	for (freeddata = clocklist; freeddata; freeddata = freeddata->next) {
-            while (freeddata->backtrace != NULL) {
-		freebt = freeddata->backtrace;
-		testconn = freebt->receiver;
-		freeddata->backtrace = freeddata->backtrace->next;
-                freebt->refcnt--;
-		if (freebt->refcnt == 0) free(freebt);
-		else break;
-		if (testconn->visited != (unsigned char)1)
-		    break;
-		testconn->visited = (unsigned char)0;
-	    }
+    profile_phase("path search");
+    if (minmaxmode) {
+	if (minmax == MAXIMUM_TIME)
+	    numpaths = find_graph_paths_minmax(run->graph, run->mingraph, startlist,
+			&pathlist, &run->minpathlist, &run->numminpaths,
+			run->minpathmem, run->clocks);
+	else {
+	    /* Already found with the maximum delay paths;  the records	*/
+	    /* become part of this pass.					*/
+	    pathlist = run->minpathlist;
+	    numpaths = run->numminpaths;
+	    run->minpathlist = NULL;
+	    arena_merge(&pathmem.mem, &run->minpathmem->mem);
 	}
+    }
+    else if (graphmode)
+	numpaths = update_graph_paths(sgraph, startlist, &pathlist, minmax,
+		run->dirty, run->clocks);
+    else
+	numpaths = find_clock_to_term_paths(startlist, &pathlist, run->netlist,
+		run->graph, minmax);
+    fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
+    fflush(stdout);
 
-        // Free up clocklist
-        while (clocklist != NULL) {
-            freeddata = clocklist;
-            clocklist = clocklist->next;
-            free(freeddata);
-        }
+    /* For each terminal path, find the source and destination clocks	*/
+    /* (where they exist) and compute clock skew.  Also compute setup	*/
+    /* or hold at the destination.					*/
+
+    profile_phase("clock skews");
+    find_clock_skews(pathlist, minmax, run->clocks);
+    if (run->sess)
+	record_endpoint_delays(pathlist, (minmax == MAXIMUM_TIME) ?
+		run->sess->endmax : run->sess->endmin, minmax);
+    if (run->slacks)
+	slack_record(run->slacks, sgraph, pathlist, section, run->period);
+    if (run->merged)
+	corner_merge(run->merged, section, pathlist, run->curcorner);
+
+    /* Select the paths to report, in order of delay */
+
+    profile_phase("path report");
+    orderedpaths = (ddataptr *)malloc(numselect * sizeof(ddataptr));
+    numpaths = select_paths(pathlist, minmax, numselect, run->endpointonly,
+		orderedpaths, &numordered);
+
+    /* Each pass has its own file in the summary directory, or all	*/
+    /* go to one summary file.						*/
+
+    if (run->summarydir != NULL) {
+	if (run->fsum != NULL) fclose(run->fsum);
+	sumname = (char *)malloc(strlen(run->summarydir) +
+		strlen(sumnames[section]) + 6);
+	sprintf(sumname, "%s/%s.log", run->summarydir, sumnames[section]);
+	run->fsum = fopen(sumname, "w");
+	if (run->fsum == NULL)
+	    fprintf(stderr, "Cannot open %s for writing\n", sumname);
+	free(sumname);
+    }
+    else if ((run->summaryfile != NULL) && (section == REG_MAX)) {
+	run->fsum = fopen(run->summaryfile, "w");
+	if (run->fsum == NULL)
+	    fprintf(stderr, "Cannot open %s for writing\n", run->summaryfile);
+    }
+    if (run->fsum)
+	fprintf(run->fsum, "Vesta static timing analysis, %s timing\n",
+		sumtitles[section]);
+
+    /* Report on the top <numpaths> paths */
+
+    badtiming = print_paths(stdout, section, orderedpaths, numpaths, run->numpaths,
+		run->period, run->longformat);
+    print_paths_result(stdout, section, badtiming, (numpaths > 0) ?
+		orderedpaths[0] : NULL, run->period);
+    if (run->fsum) {
+	print_paths(run->fsum, section, orderedpaths, numpaths, run->numpaths,
+		run->period, 1);
+	print_paths_result(run->fsum, section, badtiming, (numpaths > 0) ?
+		orderedpaths[0] : NULL, run->period);
     }
+    if (run->freport)
+	report_section(run->freport, run->reportformat, run->analysis, section,
+		orderedpaths, numpaths, run->numpaths, (run->allendpoints) ?
+		pathlist : NULL, run->period, run->longformat, badtiming);
+    fflush(stdout);
+
+    /* Clean up the path list (all path records of the pass are	*/
+    /* released together)						*/
+
+    pathpool_reset(&pathmem);
+    free(orderedpaths);
 }
 
 /*--------------------------------------------------------------*/
@@ -3779,10 +11633,8 @@ find_clock_skews(ddataptr pathlist, char minmax)
 int
 main(int objc, char *argv[])
 {
-    FILE *flib;
     FILE *fsrc;
     FILE *fdly;
-    FILE *fsum;
     double period = 0.0;
     double outLoad = 0.0;
     double inTrans = 0.0;
@@ -3792,6 +11644,7 @@ main(int objc, char *argv[])
     int ival, firstarg = 1;
     int longFormat = 0;    // Is the long format option present
     int numReportPaths = 20;
+    int endpointOnly = 0;  // Report only the worst path to each endpoint
 
     // Liberty database
 
@@ -3799,6 +11652,17 @@ main(int objc, char *argv[])
     cell *cells = NULL;
     lutable *scalar;
 
+    // Liberty cache
+    char *libcachedir = NULL;
+    uint64_t libkey = 0;
+
+    // Analysis corners (-X)
+    corner      *corners = NULL;
+    int         numcorners = 0, curcorner = 0;
+    cornermerge merged;
+    double      *wireloads = NULL;
+    unsigned char *alldirty = NULL;
+
     // Verilog netlist database
 
     instptr     instlist = NULL;
@@ -3807,14 +11671,40 @@ main(int objc, char *argv[])
     connlistptr newinputconn, inputconnlist = NULL;
     connptr     testconn, inputlist = NULL;
     connptr     outputlist = NULL;
+    tgraphptr   graph = NULL, mingraph = NULL;
+    tgraphptr   views[4];	// Graph of each analysis pass (see -u)
+    clockcacheptr clocks;
+
+    // Incremental analysis and server mode
+    char        *ecofile = NULL;
+    char        *socketname = NULL;
+    char        *etmfile = NULL;	// Timing model to write (-A)
+    char        *etmname;
+    char        *incopt = "-u";	// Option selecting incremental analysis
+    int         incremental = 0;
+    int         sockfd = -1, savefd[2];
+    unsigned char *dirty = NULL;	// Connections changed since last analysis
+    session     sess;
+    timingrun   run;
+    struct hashtable Insthash;
 
     // Timing path database
-    ddataptr    pathlist = NULL;
-    ddataptr    freeddata, testddata, *orderedpaths;
-    btptr       freebt, testbt;
-    int         numpaths, numterms, i;
-    char        badtiming;
-    double      slack;
+    pathpool    minpathmem;		// Minimum delay paths found early (-M)
+    int         numterms, i;
+
+    // Machine-readable report
+    char        *reportfile = NULL;
+    FILE        *freport = NULL;
+    int         reportformat = REPORT_JSON;
+    int         allEndpoints = 0;	// Report the worst path to every endpoint
+
+    // Required times and pin slacks
+    int         requiredmode = 0;
+    slackdb     slacks;
+
+    // Cone of influence (-T and -F)
+    char        **tolist = NULL, **fromlist = NULL;
+    int         numto = 0, numfrom = 0;
 
     // Net name hash table
     struct hashtable Nethash;
@@ -3822,6 +11712,15 @@ main(int objc, char *argv[])
     verbose = 0;
     exhaustive = 0;
     cleanup = 0;
+    graphmode = 0;
+    minmaxmode = 0;
+    numthreads = 0;
+    numparts = 0;
+    pathsperend = 1;
+    conemask = NULL;
+    memset(&minpathmem, 0, sizeof(pathpool));
+    memset(&sess, 0, sizeof(session));
+    memset(&merged, 0, sizeof(cornermerge));
 
     while ((firstarg < objc) && (*argv[firstarg] == '-')) {
        if (!strcmp(argv[firstarg], "-d") || !strcmp(argv[firstarg], "--delay")) {
@@ -3848,6 +11747,24 @@ main(int objc, char *argv[])
 	  numReportPaths = strtod(argv[firstarg + 1], NULL);
 	  firstarg += 2;
        }
+       else if (!strcmp(argv[firstarg], "-E") || !strcmp(argv[firstarg], "--endpoints")) {
+	  endpointOnly = 1;
+	  firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-K") || !strcmp(argv[firstarg], "--paths-per-endpoint")) {
+	  sscanf(argv[firstarg + 1], "%d", &ival);
+	  pathsperend = (ival > 1) ? ival : 1;
+	  graphmode = 1;
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-r") || !strcmp(argv[firstarg], "--report")) {
+          reportfile = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-a") || !strcmp(argv[firstarg], "--all-endpoints")) {
+	  allEndpoints = 1;
+	  firstarg++;
+       }
        else if (!strcmp(argv[firstarg], "-s") || !strcmp(argv[firstarg], "--summary")) {
           summaryfile = strdup(argv[firstarg + 1]);
           /* Rule:  If argument has a file extension, then treat it as a single	*/
@@ -3879,6 +11796,74 @@ main(int objc, char *argv[])
           cleanup = 1;
           firstarg++;
        }
+       else if (!strcmp(argv[firstarg], "-g") || !strcmp(argv[firstarg], "--graph")) {
+          graphmode = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-M") || !strcmp(argv[firstarg], "--minmax")) {
+          minmaxmode = 1;
+          graphmode = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-u") || !strcmp(argv[firstarg], "--eco")) {
+          ecofile = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-C") || !strcmp(argv[firstarg], "--lib-cache")) {
+          libcachedir = strdup(argv[firstarg + 1]);
+          /* Make directory if it doesn't exist */
+          mkdir(libcachedir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-S") || !strcmp(argv[firstarg], "--server")) {
+          ecofile = strdup("-");
+          incopt = "-S";
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-k") || !strcmp(argv[firstarg], "--socket")) {
+          socketname = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-j") || !strcmp(argv[firstarg], "--threads")) {
+          sscanf(argv[firstarg + 1], "%d", &ival);
+          numthreads = (ival > 0) ? ival : 0;
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-w") || !strcmp(argv[firstarg], "--partitions")) {
+          sscanf(argv[firstarg + 1], "%d", &ival);
+          numparts = (ival > 1) ? ival : 0;
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-R") || !strcmp(argv[firstarg], "--required")) {
+          requiredmode = 1;
+          graphmode = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-X") || !strcmp(argv[firstarg], "--corner")) {
+          corners = (corner *)realloc(corners, (numcorners + 1) * sizeof(corner));
+          if (corner_parse(argv[firstarg + 1], &corners[numcorners]) == 0)
+             exit(1);
+          numcorners++;
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-A") || !strcmp(argv[firstarg], "--abstract")) {
+          etmfile = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-T") || !strcmp(argv[firstarg], "--to")) {
+          tolist = (char **)realloc(tolist, (numto + 1) * sizeof(char *));
+          tolist[numto++] = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-F") || !strcmp(argv[firstarg], "--from")) {
+          fromlist = (char **)realloc(fromlist, (numfrom + 1) * sizeof(char *));
+          fromlist[numfrom++] = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-P") || !strcmp(argv[firstarg], "--profile")) {
+          profile = 1;
+          firstarg++;
+       }
        else if (!strcmp(argv[firstarg], "-V") || !strcmp(argv[firstarg], "--version")) {
           fprintf(stderr, "Vesta Static Timing Analyzer version 0.3\n");
           exit(0);
@@ -3889,17 +11874,35 @@ main(int objc, char *argv[])
        }
     }
 
-    if (objc - firstarg < 2) {
+    if (objc - firstarg < ((numcorners > 0) ? 1 : 2)) {
         fprintf(stderr, "Usage:  vesta [options] <name.v> <name.lib> [...]\n");
         fprintf(stderr, "Options:\n");
         fprintf(stderr, "--delay <delay_file>   or      -d <delay_file>\n");
         fprintf(stderr, "--period <period>      or      -p <period>\n");
         fprintf(stderr, "--load <load>          or      -l <load>\n");
 	fprintf(stderr, "--num-paths <numPaths>	or	-n <numPaths>\n");
+        fprintf(stderr, "--endpoints            or      -E\n");
+        fprintf(stderr, "--paths-per-endpoint <number> or -K <number>\n");
+        fprintf(stderr, "--report <file>        or      -r <file>\n");
+        fprintf(stderr, "--all-endpoints        or      -a\n");
         fprintf(stderr, "--long                 or      -L\n");
         fprintf(stderr, "--verbose <level>      or      -v <level>\n");
         fprintf(stderr, "--exhaustive           or      -e\n");
         fprintf(stderr, "--cleanup              or      -c\n");
+        fprintf(stderr, "--graph                or      -g\n");
+        fprintf(stderr, "--threads <number>     or      -j <number>\n");
+        fprintf(stderr, "--partitions <number>  or      -w <number>\n");
+        fprintf(stderr, "--minmax               or      -M\n");
+        fprintf(stderr, "--eco <eco_file>       or      -u <eco_file>\n");
+        fprintf(stderr, "--lib-cache <dir>      or      -C <dir>\n");
+        fprintf(stderr, "--server               or      -S\n");
+        fprintf(stderr, "--socket <name>        or      -k <name>\n");
+        fprintf(stderr, "--required             or      -R\n");
+        fprintf(stderr, "--corner <name>=<files> or     -X <name>=<files>\n");
+        fprintf(stderr, "--abstract <file>      or      -A <file>\n");
+        fprintf(stderr, "--to <pattern>         or      -T <pattern>\n");
+        fprintf(stderr, "--from <pattern>       or      -F <pattern>\n");
+        fprintf(stderr, "--profile              or      -P\n");
         fprintf(stderr, "--version              or      -V\n");
         exit (1);
     }
@@ -3920,6 +11923,56 @@ main(int objc, char *argv[])
     }
     fclose(fsrc);
 
+    if (reportfile != NULL) {
+	freport = report_open(reportfile, &reportformat);
+	if (freport == NULL) {
+	    fprintf(stderr, "Cannot open %s for writing\n", reportfile);
+	    exit (1);
+	}
+    }
+
+    if (ecofile != NULL) {
+	if (!strcmp(ecofile, "-")) {
+	    sess.fcmd = stdin;
+	    sess.name = "stdin";
+	}
+	else {
+	    sess.fcmd = fopen(ecofile, "r");
+	    sess.name = ecofile;
+	}
+        if (sess.fcmd == NULL) {
+            fprintf(stderr, "Cannot open %s for reading\n", ecofile);
+            exit (1);
+        }
+    }
+    else if (socketname != NULL) {
+	incopt = "-k";
+	sockfd = server_open(socketname);
+	if (sockfd < 0) exit (1);
+	sess.name = socketname;
+    }
+    if ((ecofile != NULL) || (socketname != NULL)) {
+	/* Each pass keeps its own graph (see below) */
+	if (!graphmode || minmaxmode) {
+	    fprintf(stderr, "Warning:  Incremental analysis (%s) uses the"
+			" levelized engine (-g)%s.\n", incopt,
+			(minmaxmode) ? ";  ignoring -M" : "");
+	}
+	incremental = 1;
+	graphmode = 1;
+	minmaxmode = 0;
+	if (numcorners > 0) {
+	    fprintf(stderr, "Incremental analysis (%s) cannot be used with"
+			" corners (-X).\n", incopt);
+	    exit (1);
+	}
+	if (etmfile != NULL) {
+	    fprintf(stderr, "Incremental analysis (%s) cannot be used with"
+			" a timing model (-A).\n", incopt);
+	    exit (1);
+	}
+    }
+
     /*------------------------------------------------------------------*/
     /* Generate one table template for the "scalar" case                */
     /*------------------------------------------------------------------*/
@@ -3942,29 +11995,29 @@ main(int objc, char *argv[])
     scalar->next = NULL;
     tables = scalar;
 
+    profile_phase("liberty read");
+
     /*------------------------------------------------------------------*/
     /* Read all liberty format files (everything on the command line	*/
     /* after the verilog source file).					*/
     /*------------------------------------------------------------------*/
 
-    for (i = 1; firstarg + i < objc; i++) {
-
-	flib = fopen(argv[firstarg + i], "r");
-	if (flib == NULL) {
-	    fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg + i]);
-	    exit (1);
-	}
-
-	/*------------------------------------------------------------------*/
-	/* Read the liberty format file.  This is not a rigorous parser!    */
-	/*------------------------------------------------------------------*/
-
-	fileCurrentLine = 0;
-	libertyRead(flib, &tables, &cells);
-	fflush(stdout);
-	fprintf(stdout, "Lib read %s:  Processed %d lines.\n", argv[firstarg + i],
-			fileCurrentLine);
-	if (flib != NULL) fclose(flib);
+    if (numcorners > 0) {
+	if (firstarg + 1 < objc)
+	    fprintf(stderr, "Warning:  Liberty files are given by corner (-X);"
+			"  ignoring %s%s.\n", argv[firstarg + 1],
+			(firstarg + 2 < objc) ? " ..." : "");
+	for (i = 0; i < numcorners; i++)
+	    if (corner_read(&corners[i], scalar, libcachedir) == 0)
+		exit (1);
+	tables = corners[0].tables;
+	cells = corners[0].cells;
+    }
+    else {
+	for (i = 1; firstarg + i < objc; i++)
+	    if (liberty_read_file(argv[firstarg + i], libcachedir, &libkey,
+			&tables, &cells) == 0)
+		exit (1);
     }
 
     /*--------------------------------------------------*/
@@ -4005,6 +12058,7 @@ main(int objc, char *argv[])
 
     fileCurrentLine = 0;
 
+    profile_phase("verilog read");
     verilogRead(argv[firstarg], cells, &netlist, &instlist, &inputlist, &outputlist,
 		&Nethash);
 
@@ -4052,6 +12106,7 @@ main(int objc, char *argv[])
     /* Generate internal links representing the network */
     /*--------------------------------------------------*/
 
+    profile_phase("netlist links");
     createLinks(netlist, instlist, inputlist, outputlist);
 
     /* Generate a connection list from inputlist */
@@ -4078,538 +12133,222 @@ main(int objc, char *argv[])
     /* To do:  Add wire models or computed wire delays  */
     /*--------------------------------------------------*/
 
+    profile_phase("parasitics read");
+    if ((fdly != NULL) || incremental) {
+	instptr testinst;
+	InitializeHashTable(&Insthash, LARGEHASHSIZE);
+	for (testinst = instlist; testinst; testinst = testinst->next)
+	    HashPtrInstall(testinst->name, testinst, &Insthash);
+    }
+
     if (fdly != NULL) {
-        delayRead(fdly, &Nethash);
+        parasiticsRead(fdly, delayfile, &Nethash, &Insthash, outLoad, NULL);
         fclose(fdly);
     }
 
-    /* Hash table no longer needed */
-    HashKill(&Nethash);
+    /* Hash tables no longer needed, unless edits are to be read */
+    if (!incremental) {
+	HashKill(&Nethash);
+	if (fdly != NULL) HashKill(&Insthash);
+    }
 
+    profile_phase("net loads");
+    if (numcorners > 0) wireloads = corner_wire_loads(netlist);
     computeLoads(netlist, instlist, outLoad);
 
     /*--------------------------------------------------*/
-    /* Identify all clock-to-terminal paths             */
+    /* Number connections for per-connection data, and  */
+    /* levelize the netlist for graph-based analysis    */
     /*--------------------------------------------------*/
 
-    if (verbose > 0) {
-	fprintf(stdout, "Starting timing analysis.\n");
-	fflush(stdout);
-    }
-    numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, MAXIMUM_TIME);
-    fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
-    fflush(stdout);
-
-    /* For each terminal path, find the source and destination clocks	*/
-    /* (where they exist) and compute clock skew.  Also compute setup	*/
-    /* or hold at the destination.					*/
-
-    find_clock_skews(pathlist, MAXIMUM_TIME);
+    profile_phase("timing graph");
+    numconnects = number_connections(instlist, inputlist, outputlist);
+    find_logic_loops(instlist, inputlist, outputlist);
+    clocks = create_clock_cache();
 
-    /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that    */
-    /* they can be sorted by delay time                 */
-    /*--------------------------------------------------*/
+    if (graphmode || exhaustive || (numto > 0) || (numfrom > 0))
+	graph = build_timing_graph(instlist, inputlist, outputlist);
+    if (minmaxmode)
+	mingraph = clone_timing_graph(graph);
 
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
+    /* Restrict the analysis to the cone of influence of -T and -F */
 
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
+    if ((numto > 0) || (numfrom > 0)) {
+	i = cone_restrict(graph, instlist, netlist, tolist, numto, fromlist,
+			numfrom, &clockconnlist, &inputconnlist);
+	fprintf(stdout, "Cone of influence:  %d of %d connections.\n", i,
+			numconnects);
+	fflush(stdout);
     }
 
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
-
-    /*----------------------------------------------------*/
-    /* Report on top <numReportPaths> maximum delay paths */
-    /*----------------------------------------------------*/
-
-    if (summarydir != NULL) {
-        summaryfile = (char *)malloc(256);
-	sprintf(summaryfile, "%s/reg_to_reg_max.log", summarydir);
-    }
-    if (summaryfile != NULL) {
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-            fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
-	    if (summarydir == NULL) {
- 		free(summaryfile);
-		summaryfile = NULL;
-	    }
-        }
-    }
-    else
-	fsum = NULL;
-    if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"register-to-register maximum timing\n");
-
-    fprintf(stdout, "\nTop %d maximum delay paths:\n", (numpaths >= numReportPaths)
-		? numReportPaths : numpaths);
-    if (fsum)
-	fprintf(fsum, "\nTop %d maximum delay paths:\n", (numpaths >= numReportPaths)
-		? numReportPaths : numpaths);
-    badtiming = 0;
-    for (i = 0; ((i < numReportPaths) && (i < numpaths)); i++) {
-        testddata = orderedpaths[i];
-        for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
+    /* For incremental analysis, each of the four passes keeps its	*/
+    /* arrival times in its own copy of the graph, so that the next	*/
+    /* analysis of that pass need only re-time what has changed.	*/
 
-        if (testddata->backtrace->receiver->refinst != NULL) {
-            fprintf(stdout, "Path %s/%s to %s/%s delay %g ps",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path %s/%s to %s/%s delay %g ps",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-        }
-        else {
-            fprintf(stdout, "Path %s/%s to output pin %s delay %g ps",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path %s/%s to output pin %s delay %g ps",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-        }
+    for (i = 0; i < 4; i++)
+	views[i] = (incremental && (i > 0)) ? clone_timing_graph(graph) : graph;
 
-        if (period > 0.0) {
-            slack = period - testddata->delay;
-            fprintf(stdout, "   Slack = %g ps", slack);
-            if (fsum) fprintf(fsum, "   Slack = %g ps", slack);
-            if (slack < 0.0) badtiming = 1;
-        }
-        fprintf(stdout, "\n");
-        if (fsum) fprintf(fsum, "\n");
-        if (longFormat) print_path(testddata->backtrace, stdout);
-        if (fsum) print_path(testddata->backtrace, fsum);
-
-        if (testddata->backtrace->receiver->refinst != NULL) {
-	    if (longFormat) {
-		fprintf(stdout, "   clock skew at destination = %g\n", testddata->skew);
-		fprintf(stdout, "   setup at destination = %g\n", testddata->setup);
-		fprintf(stdout, "\n");
-	    }
-	    if (fsum) {
-		fprintf(fsum, "   clock skew at destination = %g\n", testddata->skew);
-		fprintf(fsum, "   setup at destination = %g\n", testddata->setup);
-		fprintf(fsum, "\n");
-	    }
+    if (requiredmode) {
+	slacks.numconns = numconnects;
+	slacks.conns = graph->nodes;
+	for (i = 0; i < 2; i++) {
+	    slacks.slack[i] = (double *)malloc(numconnects * sizeof(double));
+	    slacks.endslack[i] = (double *)malloc(numconnects * sizeof(double));
 	}
+	slacks.period = period;
     }
 
-    if (period > 0.0) {
-        if (badtiming) {
-            fprintf(stdout, "ERROR:  Design fails timing requirements.\n");
-            if (fsum) fprintf(fsum, "ERROR:  Design fails timing requirements.\n");
-        }
-        else {
-            fprintf(stdout, "Design meets timing requirements.\n");
-            if (fsum) fprintf(fsum, "Design meets timing requirements.\n");
-        }
-    }
-    else if ((numpaths > 0) && (orderedpaths[0] != NULL)) {
-        fprintf(stdout, "Computed maximum clock frequency (zero margin) = %g MHz\n",
-                (1.0E6 / orderedpaths[0]->delay));
-        if (fsum) fprintf(fsum, "Computed maximum clock frequency "
-			"(zero margin) = %g MHz\n",
-                	(1.0E6 / orderedpaths[0]->delay));
-    }
-    fprintf(stdout, "-----------------------------------------\n\n");
-    if (fsum) fprintf(fsum, "-----------------------------------------\n\n");
-    fflush(stdout);
-
-    /*--------------------------------------------------*/
-    /* Clean up the path list                           */
-    /*--------------------------------------------------*/
-
-    while (pathlist != NULL) {
-        freeddata = pathlist;
-        pathlist = pathlist->next;
-        while (freeddata->backtrace != NULL) {
-            freebt = freeddata->backtrace;
-            freeddata->backtrace = freeddata->backtrace->next;
-            freebt->refcnt--;
-            if (freebt->refcnt == 0) free(freebt);
-	    else break;
-        }
-        free(freeddata);
+    if (incremental) {
+	sess.nethash = &Nethash;
+	sess.insthash = &Insthash;
+	sess.cells = cells;
+	sess.outload = outLoad;
+	sess.period = &period;
+	sess.numpaths = &numReportPaths;
+	sess.dirty = (unsigned char *)malloc(numconnects * sizeof(unsigned char));
+	sess.endmax = (double *)malloc(numconnects * sizeof(double));
+	sess.endmin = (double *)malloc(numconnects * sizeof(double));
+	sess.slacks = (requiredmode) ? &slacks : NULL;
+	sess.views = views;
+	sess.clocks = clocks;
     }
 
-    free(orderedpaths);
-
-    /*--------------------------------------------------*/
-    /* Now calculate minimum delay paths                */
-    /*--------------------------------------------------*/
-
-    reset_all(netlist, MINIMUM_TIME);
-    numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, MINIMUM_TIME);
-    fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
-    fflush(stdout);
-
-    find_clock_skews(pathlist, MINIMUM_TIME);
-
     /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that    */
-    /* they can be sorted by delay time                 */
+    /* Time the design.  Each analysis runs the four    */
+    /* passes (see time_pass()), and is repeated for    */
+    /* each corner and after each set of edits.         */
     /*--------------------------------------------------*/
 
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
-
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
-    }
-
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
-
-    /*----------------------------------------------------*/
-    /* Report on top <numReportPaths> minimum delay paths */
-    /*----------------------------------------------------*/
-
-    if (summarydir != NULL) {
-        if (fsum != NULL) fclose(fsum);
-	sprintf(summaryfile, "%s/reg_to_reg_min.log", summarydir);
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-	    fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
-	}
-    }
-    if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"register-to-register minimum timing\n");
-
-    fprintf(stdout, "\nTop %d minimum delay paths:\n", (numpaths >= numReportPaths) ?
-		numReportPaths : numpaths);
-    if (fsum) fprintf(fsum, "\nTop %d minimum delay paths:\n",
-		(numpaths >= numReportPaths) ?  numReportPaths : numpaths);
-    badtiming = 0;
-    for (i = numpaths; (i > (numpaths - numReportPaths)) && (i > 0); i--) {
-        testddata = orderedpaths[i - 1];
-        for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
-
-        if (testddata->backtrace->receiver->refinst != NULL) {
-            fprintf(stdout, "Path %s/%s to %s/%s delay %g ps\n",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path %s/%s to %s/%s delay %g ps\n",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-        }
-        else {
-            fprintf(stdout, "Path %s/%s to output pin %s delay %g ps\n",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path %s/%s to output pin %s delay %g ps\n",
-                        testbt->receiver->refinst->name,
-                        testbt->receiver->refpin->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-        }
-        if (longFormat) print_path(testddata->backtrace, stdout);
-        if (fsum) print_path(testddata->backtrace, fsum);
-
-	/* Print skew and hold unless destination is a pin */
-        if (testddata->backtrace->receiver->refinst != NULL) {
-	    if (longFormat) {
-		fprintf(stdout, "   clock skew at destination = %g\n", testddata->skew);
-		fprintf(stdout, "   hold at destination = %g\n", testddata->setup);
-		fprintf(stdout, "\n");
-	    }
-	    if (fsum) {
-		fprintf(fsum, "   clock skew at destination = %g\n", testddata->skew);
-		fprintf(fsum, "   hold at destination = %g\n", testddata->setup);
-		fprintf(fsum, "\n");
+    run.netlist = netlist;
+    run.inputlist = inputlist;
+    run.clockconns = clockconnlist;
+    run.inputconns = inputconnlist;
+    run.graph = graph;
+    run.mingraph = mingraph;
+    run.views = views;
+    run.clocks = clocks;
+    run.endpointonly = endpointOnly;
+    run.longformat = longFormat;
+    run.allendpoints = allEndpoints;
+    run.analysis = 0;
+    run.summarydir = summarydir;
+    run.summaryfile = summaryfile;
+    run.fsum = NULL;
+    run.freport = freport;
+    run.reportformat = reportformat;
+    run.slacks = (requiredmode) ? &slacks : NULL;
+    run.sess = (incremental) ? &sess : NULL;
+    run.merged = (numcorners > 0) ? &merged : NULL;
+    run.curcorner = curcorner;
+    run.minpathlist = NULL;
+    run.minpathmem = &minpathmem;
+    run.numminpaths = 0;
+
+    while (1) {
+	run.analysis++;
+	run.period = period;
+	run.numpaths = numReportPaths;
+	run.dirty = dirty;
+	if (requiredmode) slack_reset(&slacks);
+	if (incremental) {
+	    for (i = 0; i < numconnects; i++) {
+		sess.endmax[i] = INITVAL;
+		sess.endmin[i] = INITVAL;
 	    }
 	}
 
-        if (testddata->delay < 0.0) badtiming = 1;
-    }
-    if (badtiming) {
-        fprintf(stdout, "ERROR:  Design fails minimum hold timing.\n");
-        if (fsum) fprintf(fsum, "ERROR:  Design fails minimum hold timing.\n");
-    }
-    else {
-        fprintf(stdout, "Design meets minimum hold timing.\n");
-        if (fsum) fprintf(fsum, "Design meets minimum hold timing.\n");
-    }
-
-    fprintf(stdout, "-----------------------------------------\n\n");
-    if (fsum) fprintf(fsum, "-----------------------------------------\n\n");
-    fflush(stdout);
-
-    /*--------------------------------------------------*/
-    /* Clean up the path list                           */
-    /*--------------------------------------------------*/
-
-    while (pathlist != NULL) {
-        freeddata = pathlist;
-        pathlist = pathlist->next;
-        while (freeddata->backtrace != NULL) {
-            freebt = freeddata->backtrace;
-            freeddata->backtrace = freeddata->backtrace->next;
-            freebt->refcnt--;
-            if (freebt->refcnt == 0) free(freebt);
-	    else break;
-        }
-        free(freeddata);
-    }
-
-    free(orderedpaths);
-
-    for (testconn = inputlist; testconn; testconn = testconn->next) {
-        testconn->tag = NULL;
-        testconn->metric = -1;
-    }
-
-    /*--------------------------------------------------*/
-    /* Identify all input-to-terminal paths             */
-    /*--------------------------------------------------*/
-
-    reset_all(netlist, MAXIMUM_TIME);
-    numpaths = find_clock_to_term_paths(inputconnlist, &pathlist, netlist, MAXIMUM_TIME);
-    fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
-    fflush(stdout);
-
-    find_clock_skews(pathlist, MAXIMUM_TIME);
-
-    /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that    */
-    /* they can be sorted by delay time                 */
-    /*--------------------------------------------------*/
-
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
-
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
-    }
-
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
-
-    /*----------------------------------------------------*/
-    /* Report on top <numReportPaths> maximum delay paths */
-    /*----------------------------------------------------*/
-
-    if (summarydir != NULL) {
-        if (fsum != NULL) fclose(fsum);
-	sprintf(summaryfile, "%s/pin_to_reg_max.log", summarydir);
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-	    fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
+	if (numcorners > 0)
+	    fprintf(stdout, "\nCorner %s:\n", corners[curcorner].name);
+	if (verbose > 0) {
+	    fprintf(stdout, "Starting timing analysis.\n");
+	    fflush(stdout);
 	}
-    }
-    if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"pin-to-register and register-to-pin maximum timing\n");
-
-    fprintf(stdout, "\nTop %d maximum delay paths:\n", (numpaths >= numReportPaths) ?
-			numReportPaths : numpaths);
-    if (fsum) fprintf(fsum, "\nTop %d maximum delay paths:\n",
-			(numpaths >= numReportPaths) ?
-			numReportPaths : numpaths);
-    for (i = 0; ((i < numReportPaths) && (i < numpaths)); i++) {
-        testddata = orderedpaths[i];
-        for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
-
-        if (testddata->backtrace->receiver->refinst != NULL) {
-            fprintf(stdout, "Path input pin %s to %s/%s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path input pin %s to %s/%s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-        }
-        else {
-            fprintf(stdout, "Path input pin %s to output pin %s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path input pin %s to output pin %s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-        }
-        if (longFormat) print_path(testddata->backtrace, stdout);
-        if (fsum) print_path(testddata->backtrace, fsum);
+	for (i = REG_MAX; i <= PIN_MIN; i++)
+	    time_pass(&run, i);
 
-        if (testddata->backtrace->receiver->refinst != NULL) {
-	    if (longFormat) {
-		fprintf(stdout, "   setup at destination = %g\n", testddata->setup);
-		fprintf(stdout, "\n");
+	if (requiredmode) {
+	    fprintf(stdout, "Slack at pins:\n");
+	    print_slack_summary(stdout, &slacks);
+	    fprintf(stdout, "-----------------------------------------\n\n");
+	}
+	fflush(stdout);
+	if (freport) fflush(freport);
+	if (run.fsum != NULL) fclose(run.fsum);
+	run.fsum = NULL;
+
+	/*--------------------------------------------------*/
+	/* Write the extracted timing model (of each corner */
+	/* as <file>_<corner>.lib)                          */
+	/*--------------------------------------------------*/
+
+	if ((etmfile != NULL) && (modulename != NULL)) {
+	    profile_phase("timing model");
+	    if (numcorners > 0) {
+		etmname = (char *)malloc(strlen(etmfile) +
+			strlen(corners[curcorner].name) + 6);
+		strcpy(etmname, etmfile);
+		if ((strlen(etmname) > 4) &&
+			!strcmp(etmname + strlen(etmname) - 4, ".lib"))
+		    etmname[strlen(etmname) - 4] = '\0';
+		sprintf(etmname + strlen(etmname), "_%s.lib", corners[curcorner].name);
 	    }
-	    if (fsum) {
-		fprintf(fsum, "   setup at destination = %g\n", testddata->setup);
-		fprintf(fsum, "\n");
+	    else
+		etmname = etmfile;
+	    if (graph == NULL) {
+		graph = build_timing_graph(instlist, inputlist, outputlist);
+		run.graph = graph;
 	    }
+	    etm_write(etmname, modulename, graph, instlist, inputlist, outputlist,
+			outLoad);
+	    if (etmname != etmfile) free(etmname);
 	}
-    }
-
-    fprintf(stdout, "-----------------------------------------\n\n");
-    if (fsum) fprintf(fsum, "-----------------------------------------\n\n");
-    fflush(stdout);
-
-    /*--------------------------------------------------*/
-    /* Clean up the path list                           */
-    /*--------------------------------------------------*/
-
-    while (pathlist != NULL) {
-        freeddata = pathlist;
-        pathlist = pathlist->next;
-        while (freeddata->backtrace != NULL) {
-            freebt = freeddata->backtrace;
-            freeddata->backtrace = freeddata->backtrace->next;
-            freebt->refcnt--;
-            if (freebt->refcnt == 0) free(freebt);
-	    else break;
-        }
-        free(freeddata);
-    }
-
-    free(orderedpaths);
-
-    for (testconn = inputlist; testconn; testconn = testconn->next) {
-        testconn->tag = NULL;
-        testconn->metric = 1E50;
-    }
-
-    /*--------------------------------------------------*/
-    /* Now calculate minimum delay paths from inputs    */
-    /*--------------------------------------------------*/
-
-    reset_all(netlist, MINIMUM_TIME);
-    numpaths = find_clock_to_term_paths(inputconnlist, &pathlist, netlist, MINIMUM_TIME);
-    fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
-    fflush(stdout);
-
-    find_clock_skews(pathlist, MINIMUM_TIME);
-
-    /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that    */
-    /* they can be sorted by delay time                 */
-    /*--------------------------------------------------*/
-
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
-
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
-    }
-
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
-
-    /*----------------------------------------------------*/
-    /* Report on top <numReportPaths> minimum delay paths */
-    /*----------------------------------------------------*/
-
-    if (summarydir != NULL) {
-        if (fsum != NULL) fclose(fsum);
-	sprintf(summaryfile, "%s/pin_to_reg_min.log", summarydir);
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-	    fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
-	}
-    }
-    if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"pin-to-register and register-to-pin minimum timing\n");
-
-    fprintf(stdout, "\nTop %d minimum delay paths:\n", (numpaths >= numReportPaths) ?
-			numReportPaths : numpaths);
-    if (fsum) fprintf(fsum, "\nTop %d minimum delay paths:\n",
-			(numpaths >= numReportPaths) ?
-			numReportPaths : numpaths);
-    for (i = numpaths; (i > (numpaths - numReportPaths)) && (i > 0); i--) {
-        testddata = orderedpaths[i - 1];
-        for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
-
-        if (testddata->backtrace->receiver->refinst != NULL) {
-            fprintf(stdout, "Path input pin %s to %s/%s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path input pin %s to %s/%s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refinst->name,
-                        testddata->backtrace->receiver->refpin->name,
-                        testddata->delay);
-        }
-        else {
-            fprintf(stdout, "Path input pin %s to output pin %s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-            if (fsum) fprintf(fsum, "Path input pin %s to output pin %s delay %g ps\n",
-                        testbt->receiver->refnet->name,
-                        testddata->backtrace->receiver->refnet->name,
-                        testddata->delay);
-        }
-        if (longFormat) print_path(testddata->backtrace, stdout);
-        if (fsum) print_path(testddata->backtrace, fsum);
 
-        if (testddata->backtrace->receiver->refinst != NULL) {
-	    if (longFormat) {
-		fprintf(stdout, "   hold at destination = %g\n", testddata->setup);
-		fprintf(stdout, "\n");
-	    }
-	    if (fsum) {
-		fprintf(fsum, "   hold at destination = %g\n", testddata->setup);
-		fprintf(fsum, "\n");
+	/*--------------------------------------------------*/
+	/* Time the next corner, or report the worst delays */
+	/* over all of the corners                          */
+	/*--------------------------------------------------*/
+
+	if (numcorners > 0) {
+	    if (++curcorner < numcorners) {
+		profile_phase("net loads");
+		if (corner_bind(&corners[curcorner], instlist, netlist, wireloads,
+			    outLoad) == 0)
+		    exit (1);
+		if (alldirty == NULL) {
+		    alldirty = (unsigned char *)malloc(numconnects *
+				sizeof(unsigned char));
+		    memset(alldirty, 1, numconnects * sizeof(unsigned char));
+		}
+		invalidate_clock_chains(clocks, alldirty);
+		run.curcorner = curcorner;
+		continue;
 	    }
+	    corner_report(stdout, corners, numcorners, &merged, numReportPaths, period);
+	    fflush(stdout);
 	}
+
+	/*--------------------------------------------------*/
+	/* Apply the next set of edits from the ECO file or */
+	/* server clients, and analyze again.  Summary      */
+	/* files are rewritten with the new results.        */
+	/*--------------------------------------------------*/
+
+	if (incremental) profile_phase("ECO read");
+	if (!eco_next(&sess, sockfd, savefd)) break;
+	dirty = sess.dirty;
+	invalidate_clock_chains(clocks, dirty);
+	fprintf(stdout, "\nUpdate (line %d of %s):\n\n", sess.lineno, sess.name);
     }
+    if (sockfd >= 0) server_close(sockfd, socketname);
 
-    fprintf(stdout, "-----------------------------------------\n\n");
-    if (fsum) fprintf(fsum, "-----------------------------------------\n\n");
-    fflush(stdout);
+    if (profile) {
+	profile_phase(NULL);
+	profile_report(stdout);
+    }
 
-    if (fsum != NULL) fclose(fsum);
     if (summaryfile != NULL) free(summaryfile);
     if (summarydir != NULL) free(summarydir);
-
-    /*--------------------------------------------------*/
-    /* Clean up the path list                           */
-    /*--------------------------------------------------*/
-
-    while (pathlist != NULL) {
-        freeddata = pathlist;
-        pathlist = pathlist->next;
-        while (freeddata->backtrace != NULL) {
-            freebt = freeddata->backtrace;
-            freeddata->backtrace = freeddata->backtrace->next;
-            freebt->refcnt--;
-            if (freebt->refcnt == 0) free(freebt);
-	    else break;
-        }
-        free(freeddata);
-    }
-
-    free(orderedpaths);
+    if (freport != NULL) fclose(freport);
 
     return 0;
 }